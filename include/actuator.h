@@ -0,0 +1,78 @@
+#pragma once
+
+#include "driver/gpio.h"
+#include "esp_err.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @file actuator.h
+ * @brief Non-blocking pulse generator for impulse-driven relays.
+ *
+ * Each registered channel owns an esp_timer and a short command queue. Callers enqueue
+ * pulses or state changes and return immediately; the timer callback drives the GPIO
+ * through the queued pulse trains. State changes of impulse (toggle) relays are coalesced:
+ * requesting the state the relay is already heading to does nothing, and a toggle that has
+ * not started yet is cancelled by a request to go back. Commands are started and the output is
+ * driven only from the timer callback, outside the channel lock. When a channel has run all of its
+ * commands, an EVENT_ACTUATOR_IDLE event is published on the event bus (see events.h).
+ */
+
+/** @brief Maximum number of actuator channels. */
+#define ACTUATOR_MAX_CHANNELS 4
+
+/** @brief Number of commands that can be queued per channel. */
+#define ACTUATOR_QUEUE_LEN 4
+
+/**
+ * @brief Registers an active-high output as an actuator channel.
+ *
+ * Configures the GPIO as output and drives it low.
+ *
+ * @param gpio Output pin
+ * @param pulse_ms Width of the impulse used by actuator_set_state()
+ * @param channel Set to the new channel id
+ * @return esp_err_t ESP_OK on success, ESP_ERR_NO_MEM if all channels are used, or the
+ * esp_timer error.
+ */
+esp_err_t actuator_register(gpio_num_t gpio, uint32_t pulse_ms, int* channel);
+
+/**
+ * @brief Queues a pulse train.
+ *
+ * An identical train that is still waiting in the queue is not queued twice.
+ *
+ * @param channel Channel id
+ * @param count Number of pulses
+ * @param on_ms Time the output is held high per pulse
+ * @param off_ms Time the output stays low after each pulse, before the next pulse or command,
+ * also when that command arrives after the channel went idle
+ * @return esp_err_t ESP_OK if queued or coalesced, ESP_ERR_NO_MEM if the queue is full.
+ */
+esp_err_t actuator_pulse(int channel, int count, uint32_t on_ms, uint32_t off_ms);
+
+/**
+ * @brief Requests a logical state of an impulse (toggle) relay.
+ *
+ * Queues a single impulse if the requested state differs from the state the relay will have
+ * once all queued commands have run.
+ *
+ * @param channel Channel id
+ * @param state Desired logical state
+ * @return esp_err_t ESP_OK if queued or coalesced, ESP_ERR_NO_MEM if the queue is full.
+ */
+esp_err_t actuator_set_state(int channel, bool state);
+
+/**
+ * @brief Returns the logical state of an impulse relay, including queued changes.
+ *
+ * @param channel Channel id
+ */
+bool actuator_get_state(int channel);
+
+/**
+ * @brief Returns true while the channel is running or has queued pulses.
+ *
+ * @param channel Channel id
+ */
+bool actuator_is_busy(int channel);
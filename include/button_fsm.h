@@ -0,0 +1,107 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @file button_fsm.h
+ * @brief Debouncing and gesture recognition for push buttons.
+ *
+ * One state machine per button. The caller reports the first edge of a bounce burst with
+ * button_fsm_edge() and masks the pin's interrupt, so a bouncing contact costs one
+ * interrupt per settle window instead of one per bounce. Once the window has passed,
+ * button_fsm_update() samples the settled level and reports the resulting events; after
+ * that the interrupt is unmasked again. Press, release, click, double click and long press
+ * are derived from the debounced level and timestamps only, so the machine takes the current
+ * time as a parameter, has no platform dependencies and can be replayed from recorded edge
+ * traces.
+ */
+
+/** @brief Events reported by button_fsm_update(), as bits of its return value. */
+typedef enum
+{
+    BUTTON_EVENT_PRESS = 1 << 0,        ///< Debounced press
+    BUTTON_EVENT_RELEASE = 1 << 1,      ///< Debounced release
+    BUTTON_EVENT_CLICK = 1 << 2,        ///< Press and release shorter than a long press
+    BUTTON_EVENT_DOUBLE_CLICK = 1 << 3, ///< Second click within the double click window
+    BUTTON_EVENT_LONG_PRESS = 1 << 4,   ///< Held for the long press time (sent while held)
+} button_event_t;
+
+/**
+ * @struct button_cfg_t
+ * @brief Timing of a button.
+ *
+ * @var button_cfg_t::debounce_ms Time the contact needs to settle after an edge
+ * @var button_cfg_t::long_press_ms Hold time of a long press, 0 to disable long presses
+ * @var button_cfg_t::double_click_ms Time after a click in which a second click makes a
+ * double click, 0 to disable double clicks (clicks are then reported on release)
+ */
+typedef struct
+{
+    uint16_t debounce_ms;
+    uint16_t long_press_ms;
+    uint16_t double_click_ms;
+} button_cfg_t;
+
+/**
+ * @struct button_fsm_t
+ * @brief Button state. Treat as opaque.
+ */
+typedef struct
+{
+    button_cfg_t cfg;
+    bool pressed;
+    bool settling;
+    bool long_sent;
+    uint8_t clicks;
+    int64_t edge_ms;
+    int64_t pressed_ms;
+    int64_t click_until_ms;
+} button_fsm_t;
+
+/**
+ * @brief Initializes a button.
+ *
+ * @param button Button to initialize
+ * @param cfg Timing (copied)
+ * @param pressed Current level of the button
+ */
+void button_fsm_init(button_fsm_t* button, const button_cfg_t* cfg, bool pressed);
+
+/**
+ * @brief Reports an edge of the raw input.
+ *
+ * Starts a settle window unless one is already running; the caller should keep the pin's
+ * interrupt masked until button_fsm_settling() returns false.
+ *
+ * @param button Button
+ * @param now_ms Time of the edge
+ * @return bool True if the edge started a settle window.
+ */
+bool button_fsm_edge(button_fsm_t* button, int64_t now_ms);
+
+/**
+ * @brief Advances the state machine.
+ *
+ * @param button Button
+ * @param pressed Current raw level of the button; only used once the settle window is over
+ * @param now_ms Current time
+ * @return uint32_t Bits of the button_event_t events that happened, 0 if none.
+ */
+uint32_t button_fsm_update(button_fsm_t* button, bool pressed, int64_t now_ms);
+
+/**
+ * @brief Tells whether a settle window is running.
+ *
+ * @param button Button
+ * @return bool True while the raw input must not be trusted.
+ */
+bool button_fsm_settling(const button_fsm_t* button);
+
+/**
+ * @brief Returns when button_fsm_update() must be called next.
+ *
+ * @param button Button
+ * @return int64_t Time of the next deadline, or INT64_MAX if the button only waits for edges.
+ */
+int64_t button_fsm_next_ms(const button_fsm_t* button);
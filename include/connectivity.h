@@ -0,0 +1,98 @@
+#pragma once
+
+#include "freertos/FreeRTOS.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @file connectivity.h
+ * @brief Connectivity state shared by the network tasks.
+ *
+ * Wi-Fi provisioning reports the link and the stream task reports the cloud; tasks that
+ * need the network block in connectivity_wait() instead of retrying while offline, and
+ * resume as soon as the state is reached. The states are ordered, and waiting for one is
+ * satisfied by any higher state:
+ * - OFFLINE: no link and no attempt in progress (between backoff retries)
+ * - CONNECTING: associating or waiting for an address
+ * - ONLINE: the station has an address
+ * - CLOUD_READY: the Firebase stream is delivering events
+ *
+ * The state is kept in an event group, one bit per state reached, so any number of tasks
+ * can wait without polling. Transitions are logged and exported as the connectivity_state
+ * gauge. Retry backoffs sleep in connectivity_backoff(), which a new link cuts short.
+ */
+
+/** @brief Connectivity states, in order. */
+typedef enum
+{
+    CONNECTIVITY_OFFLINE,
+    CONNECTIVITY_CONNECTING,
+    CONNECTIVITY_ONLINE,
+    CONNECTIVITY_CLOUD_READY,
+} connectivity_state_t;
+
+/**
+ * @brief Creates the state, OFFLINE. Call before any task uses it.
+ */
+void connectivity_init(void);
+
+/**
+ * @brief Reports a connection attempt; ignored while the link is up.
+ */
+void connectivity_link_connecting(void);
+
+/**
+ * @brief Reports that the station got an address, starting a new link epoch.
+ */
+void connectivity_link_up(void);
+
+/**
+ * @brief Reports that the station lost its link.
+ */
+void connectivity_link_down(void);
+
+/**
+ * @brief Reports whether the cloud is reachable; only moves between ONLINE and CLOUD_READY.
+ *
+ * @param ready True when the stream delivers events, false when it is lost
+ */
+void connectivity_cloud_ready(bool ready);
+
+/**
+ * @brief Returns the current state.
+ */
+connectivity_state_t connectivity_state(void);
+
+/**
+ * @brief Returns the link epoch, which changes every time the link comes up.
+ *
+ * A connection opened in an earlier epoch did not survive the link in between.
+ */
+uint32_t connectivity_link_epoch(void);
+
+/**
+ * @brief Blocks until the given state or a higher one is reached.
+ *
+ * @param state State to wait for
+ * @param ticks_to_wait Longest wait; 0 only checks
+ * @return bool True if the state was reached, false on timeout.
+ */
+bool connectivity_wait(connectivity_state_t state, TickType_t ticks_to_wait);
+
+/**
+ * @brief Sleeps through a retry backoff, waking early when the link comes up again.
+ *
+ * Each link-up sends a task notification to every task that has called this, so a task that
+ * backs off after a failure retries on a new link at once instead of sleeping out a long delay
+ * from the previous one. The notifications consume the task's notification count, so tasks
+ * that also wait in ulTaskNotifyTake() for other reasons must tolerate a spurious wakeup.
+ *
+ * @param ticks Backoff delay
+ * @return bool True if a new link came up before the delay ran out.
+ */
+bool connectivity_backoff(TickType_t ticks);
+
+/**
+ * @brief Returns the name of a state, for logs.
+ */
+const char* connectivity_state_name(connectivity_state_t state);
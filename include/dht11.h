@@ -1,9 +1,10 @@
 #ifndef _DHT_11
 #define _DHT_11
 
+#include "dht11_decode.h"
 #include "esp_log.h"
+#include "sensor_sched.h"
 #include <driver/gpio.h>
-#include <rom/ets_sys.h>
 #include <stdio.h>
 #include <string.h>
 
@@ -11,10 +12,20 @@
  * @file dht11.h
  * @brief Functions and structures for reading temperature and humidity from DHT11 sensor
  *
- * Provides blocking functions for communication with the DHT11 sensor,
- * as well as a FreeRTOS task to send readings to Firebase.
+ * The data line is sampled by a GPIO interrupt that timestamps every edge; the frame is
+ * decoded afterwards by dht11_decode(). The reading task sleeps during the transfer.
+ * dht11_driver plugs the sensor into the sampling scheduler (see sensor.h).
  */
 
+/** @brief GPIO of the default DHT11 sensor. */
+#define DHT11_GPIO_PIN 5
+
+/** @brief Sampling interval of the default DHT11 sensor. */
+#define DHT11_SAMPLE_INTERVAL_MS (1000 * 60) // 1 minute
+
+/** @brief Maximum time without an upload of the default DHT11 sensor. */
+#define DHT11_HEARTBEAT_MS (1000 * 60 * 5) // 5 minutes
+
 /**
  * @struct dht11_t
  * @brief Structure containing DHT11 sensor pin and readings.
@@ -30,33 +41,11 @@ typedef struct
     float humidity;
 } dht11_t;
 
-/**
- * @brief Waits for the GPIO pin to reach the specified state.
- *
- * This function is blocking and will loop until the pin reaches the desired state
- * or the timeout is reached.
- *
- * @param dht11 DHT11 sensor structure
- * @param state GPIO state to wait for (0 or 1)
- * @param timeout Maximum time to wait (in microseconds)
- * @return Time waited in microseconds, or -1 if timeout occurs
- */
-int wait_for_state(dht11_t dht11, int state, int timeout);
-
-/**
- * @brief Drives the DHT11 pin low for the specified duration.
- *
- * Used to start communication with the sensor.
- *
- * @param dht11 DHT11 sensor structure
- * @param hold_time_us Duration to hold the pin low (in microseconds)
- */
-void hold_low(dht11_t dht11, int hold_time_us);
-
 /**
  * @brief Reads temperature and humidity from the DHT11 sensor.
  *
- * This function is blocking and performs a busy wait for communication.
+ * Blocks the calling task for about 25 ms per attempt without busy-waiting. Failed
+ * attempts are retried after 1 second.
  *
  * @note Wait at least 2 seconds between reads to avoid sensor errors
  * @param dht11 Pointer to the DHT11 sensor structure to update readings
@@ -66,18 +55,18 @@ void hold_low(dht11_t dht11, int hold_time_us);
 int dht11_read(dht11_t* dht11, int connection_timeout);
 
 /**
- * @brief FreeRTOS task that periodically reads DHT11 values and sends them to Firebase.
- *
- * The task reads the sensor every 5 minutes and logs temperature and humidity.
+ * @brief Sensor driver for dht11_t contexts.
  *
- * @param pvParameters Task parameters (unused)
+ * Reports "temperature" and "humidity". Several DHT11 sensors on different pins can be
+ * registered, each with its own dht11_t.
  */
-void firebase_dht11_task(void* pvParameters);
+extern const sensor_driver_t dht11_driver;
 
 /**
- * @brief Initializes the DHT11 sensor structure.
+ * @brief Registers the default DHT11 sensor with the sampling task.
  *
- * Sets the GPIO pin used for the sensor.
+ * Uses DHT11_GPIO_PIN and samples every DHT11_SAMPLE_INTERVAL_MS. Values are published under
+ * "DHT11" when they change by a whole unit, and at least every DHT11_HEARTBEAT_MS.
  */
 void dht11_init(void);
 
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <stdint.h>
+
+/**
+ * @file dht11_decode.h
+ * @brief Decoder for DHT11 frames captured as edge timestamps.
+ *
+ * The capture side only records when the data line changed and to which level; all timing
+ * checks happen afterwards in dht11_decode(). The decoder has no platform dependencies, so
+ * recorded or synthetic edge traces can be replayed on a host.
+ *
+ * A frame starts with the sensor response (~80 us low, ~80 us high) followed by 40 bits.
+ * Every bit is ~50 us low followed by ~27 us high for a 0 or ~70 us high for a 1.
+ */
+
+/** @brief Number of edges in a complete frame, including the host releasing the line. */
+#define DHT11_FRAME_EDGES 85
+
+/** @brief Decoding succeeded. */
+#define DHT11_DECODE_OK 0
+/** @brief No sensor response was found in the trace. */
+#define DHT11_ERROR_NO_RESPONSE -1
+/** @brief The trace ended early or a pulse was out of the allowed range. */
+#define DHT11_ERROR_TIMING -2
+/** @brief All 40 bits were received but the checksum does not match. */
+#define DHT11_ERROR_CHECKSUM -3
+
+/**
+ * @struct dht11_edge_t
+ * @brief One captured transition of the data line.
+ *
+ * @var dht11_edge_t::t_us Timestamp in microseconds; may wrap, only differences are used
+ * @var dht11_edge_t::level Line level after the transition (0 or 1)
+ */
+typedef struct
+{
+    uint32_t t_us;
+    uint8_t level;
+} dht11_edge_t;
+
+/**
+ * @brief Decodes a captured edge trace into the five frame bytes.
+ *
+ * Edges before the sensor response (such as the host releasing the line) and after the
+ * 40th bit are ignored.
+ *
+ * @param edges Captured edges in chronological order
+ * @param count Number of edges
+ * @param data Receives humidity (integer, decimal), temperature (integer, decimal), checksum
+ * @return int DHT11_DECODE_OK or one of the DHT11_ERROR_* codes.
+ */
+int dht11_decode(const dht11_edge_t* edges, int count, uint8_t data[5]);
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @file dns_reply.h
+ * @brief Captive-portal DNS responder logic: validates a query and builds the reply.
+ *
+ * Every question of a query is answered: A (and ANY) questions in class IN with the portal
+ * address, every other type (AAAA, HTTPS/SVCB, ...) with an empty NOERROR answer (NODATA),
+ * so clients stop asking instead of waiting for a timeout. Names are walked with full bounds
+ * checks; malformed queries get FORMERR, other opcodes NOTIMP, and packets that are
+ * responses or too short to carry a header are dropped. The answer record is prebuilt once
+ * in a template, so a reply is the query's header and questions plus one copied record per
+ * A question. EDNS and other additional records are not echoed. The module has no platform
+ * dependencies.
+ */
+
+/** @brief Classic UDP DNS message size; replies never exceed it. */
+#define DNS_MAX_PACKET 512
+
+/** @brief Questions accepted in one query. */
+#define DNS_MAX_QUESTIONS 8
+
+#define DNS_TYPE_A 1
+#define DNS_TYPE_AAAA 28
+#define DNS_TYPE_SVCB 64
+#define DNS_TYPE_HTTPS 65
+#define DNS_TYPE_ANY 255
+
+#define DNS_CLASS_IN 1
+#define DNS_CLASS_ANY 255
+
+#define DNS_RCODE_NOERROR 0
+#define DNS_RCODE_FORMERR 1
+#define DNS_RCODE_NOTIMP 4
+
+/**
+ * @struct dns_reply_template_t
+ * @brief Prebuilt A answer record: name pointer, type, class, TTL, length and address.
+ */
+typedef struct
+{
+    uint8_t answer[16];
+} dns_reply_template_t;
+
+/**
+ * @brief Prebuilds the answer record.
+ *
+ * @param tpl Template to fill
+ * @param ip IPv4 address of the portal, network order
+ * @param ttl_s Time to live of the answers in seconds
+ */
+void dns_reply_init(dns_reply_template_t* tpl, const uint8_t ip[4], uint32_t ttl_s);
+
+/**
+ * @brief Builds the reply to a query.
+ *
+ * If the answers do not all fit in reply_cap, the reply carries those that fit and has the
+ * TC flag set.
+ *
+ * @param tpl Answer template
+ * @param query Received packet
+ * @param query_len Length of the packet
+ * @param reply Buffer for the reply, may not overlap the query
+ * @param reply_cap Size of the buffer, at least 12
+ * @return size_t Length of the reply, 0 if the packet is to be dropped.
+ */
+size_t dns_reply_build(const dns_reply_template_t* tpl, const uint8_t* query, size_t query_len,
+                       uint8_t* reply, size_t reply_cap);
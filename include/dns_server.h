@@ -2,12 +2,18 @@
 #pragma once
 
 /**
- * Start the DNS server task. It will respond to any DNS query with the
- * configured captive portal IP (192.168.4.1 by default).
+ * @brief Starts the DNS server task, or keeps the running one.
+ *
+ * The task listens on UDP port DNS_SERVER_PORT (53 unless overridden at build time) and
+ * answers every A query with the captive portal IP (192.168.4.1) and every other query type
+ * with an immediate empty answer, so clients do not wait for IPv6 or HTTPS records. Replies
+ * are built by dns_reply.h; packets it rejects are dropped or answered with an error code.
  */
 void dns_server_start(void);
 
 /**
- * Stop the DNS server task.
+ * @brief Stops the DNS server task.
+ *
+ * Returns at once; the task closes its socket and exits within DNS_STOP_POLL_MS (500 ms).
  */
 void dns_server_stop(void);
@@ -0,0 +1,189 @@
+#pragma once
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @file event_bus.h
+ * @brief Lock-free broadcast bus for small typed events.
+ *
+ * The bus has a fixed set of channels, each written by exactly one producer (an ISR or a
+ * task) and read by any number of readers. A channel is a ring of preallocated slots guarded
+ * by per-slot sequence numbers (a seqlock): the producer never waits and never takes a lock,
+ * so it is safe to publish from an ISR, and every reader keeps its own cursor, so readers
+ * never contend with each other. A reader that falls more than a ring behind loses the oldest
+ * events and is told how many it missed. Channels that have never carried a type the reader
+ * subscribed to are skipped without reading them, so they cannot make it fall behind.
+ *
+ * All shared fields are C11 atomics. The producer publishes a slot with a release store of
+ * its sequence number and readers validate it with acquire loads, which orders the payload
+ * correctly between the two cores of the ESP32. The payload words are release stores and
+ * acquire loads too, so no fences are needed and ThreadSanitizer can check the ordering. The
+ * bus has no platform dependencies; waking a blocked reader is delegated to a callback.
+ */
+
+/** @brief Number of channels, i.e. independent producers. */
+#define EVENT_BUS_MAX_CHANNELS 4
+
+/** @brief Slots per channel; must be a power of two. */
+#define EVENT_BUS_CHANNEL_SLOTS 16
+
+/** @brief Maximum number of readers that can be woken on publish. */
+#define EVENT_BUS_MAX_READERS 8
+
+/** @brief Payload words per event (the event is four 32-bit words). */
+#define EVENT_BUS_EVENT_WORDS 4
+
+/**
+ * @brief Event types. Readers select the types they receive with a bit mask.
+ */
+typedef enum
+{
+    EVENT_BUTTON_EDGE,    ///< A push button input changed level (button)
+    EVENT_RELAY_COMMAND,  ///< The relay should be in the given state (relay)
+    EVENT_ACTUATOR_IDLE,  ///< An actuator channel finished its pulses (actuator)
+    EVENT_SENSOR_VALUE,   ///< A sensor value was published (sensor)
+    EVENT_TYPE_COUNT,
+} event_type_t;
+
+/** @brief Mask bit of an event type. */
+#define EVENT_MASK(type) (1u << (type))
+
+/**
+ * @struct event_t
+ * @brief One event; sixteen bytes so it can be copied as four atomic words.
+ *
+ * @var event_t::type An event_type_t
+ * @var event_t::channel Channel it was published on, filled in by the bus
+ * @var event_t::time_ms Low 32 bits of the time of the event in milliseconds since boot; wraps
+ * after 49.7 days, so compare it only with unsigned differences
+ */
+typedef struct
+{
+    uint16_t type;
+    uint16_t channel;
+    uint32_t time_ms;
+    union
+    {
+        struct
+        {
+            uint32_t button;
+            uint32_t time_us; ///< Low 32 bits of the microsecond clock, for latency measurements
+        } button;
+        struct
+        {
+            bool state;
+            uint8_t origin;
+        } relay;
+        struct
+        {
+            int8_t channel;
+            bool state;
+        } actuator;
+        struct
+        {
+            uint8_t sensor;
+            uint8_t index;
+            float value;
+        } sensor;
+        uint32_t raw[2];
+    };
+} event_t;
+
+_Static_assert(sizeof(event_t) == EVENT_BUS_EVENT_WORDS * sizeof(uint32_t),
+               "event_t must stay four words");
+
+/** @brief Wakes a reader after a matching event was published. */
+typedef void (*event_bus_wake_cb_t)(void* wake_ctx, bool from_isr);
+
+// Sequence is 2 * position + 2 once the slot holds the event at that position, odd while
+// it is being written
+typedef struct
+{
+    atomic_uint_least32_t seq;
+    atomic_uint_least32_t words[EVENT_BUS_EVENT_WORDS];
+} event_bus_slot_t;
+
+// types has the EVENT_MASK() bit of every type ever published on the channel
+typedef struct
+{
+    atomic_uint_least32_t head;
+    atomic_uint_least32_t types;
+    event_bus_slot_t slots[EVENT_BUS_CHANNEL_SLOTS];
+} event_bus_channel_t;
+
+/**
+ * @struct event_bus_reader_t
+ * @brief A reader's position in every channel. Owned by one task; treat as opaque.
+ */
+typedef struct
+{
+    uint32_t type_mask;
+    uint32_t cursor[EVENT_BUS_MAX_CHANNELS];
+    uint32_t lost;
+    int next_channel;
+    event_bus_wake_cb_t wake;
+    void* wake_ctx;
+} event_bus_reader_t;
+
+/**
+ * @struct event_bus_t
+ * @brief Bus state. A zero-initialized (static) bus is ready to use.
+ */
+typedef struct
+{
+    event_bus_channel_t channels[EVENT_BUS_MAX_CHANNELS];
+    event_bus_reader_t* readers[EVENT_BUS_MAX_READERS];
+    atomic_int reader_count;
+} event_bus_t;
+
+/**
+ * @brief Publishes an event on a channel.
+ *
+ * Only one context may publish on a given channel. Never blocks; readers whose mask matches
+ * the event type are woken through their callback.
+ *
+ * @param bus Bus
+ * @param channel Channel owned by the caller
+ * @param event Event to copy into the ring; its channel field is set by the bus
+ * @param from_isr True when called from an interrupt handler, passed to the wake callbacks
+ */
+void event_bus_publish(event_bus_t* bus, int channel, const event_t* event, bool from_isr);
+
+/**
+ * @brief Prepares a reader that starts with the next event published on each channel.
+ *
+ * @param bus Bus
+ * @param reader Reader to initialize
+ * @param type_mask EVENT_MASK() bits of the types to receive
+ * @param wake Called after a matching event is published, may be NULL for polling readers
+ * @param wake_ctx Passed to wake
+ * @return int 0 on success, -1 if wake is set and the wake list is full.
+ */
+int event_bus_subscribe(event_bus_t* bus, event_bus_reader_t* reader, uint32_t type_mask,
+                        event_bus_wake_cb_t wake, void* wake_ctx);
+
+/**
+ * @brief Takes the next event of a subscribed type.
+ *
+ * Channels are served round-robin, so events of one channel stay in order but events of
+ * different channels may be interleaved.
+ *
+ * @param bus Bus
+ * @param reader Reader owned by the caller
+ * @param out Receives the event
+ * @return bool True if an event was returned, false if none is pending.
+ */
+bool event_bus_read(event_bus_t* bus, event_bus_reader_t* reader, event_t* out);
+
+/**
+ * @brief Returns and clears the number of events the reader missed by falling behind.
+ *
+ * Only channels that carry a subscribed type count, but an overwritten event cannot be
+ * inspected, so on a channel that also carries other types the count includes those.
+ *
+ * @param reader Reader
+ * @return uint32_t Events overwritten before the reader got to them.
+ */
+uint32_t event_bus_take_lost(event_bus_reader_t* reader);
@@ -0,0 +1,102 @@
+#pragma once
+
+#include "esp_err.h"
+#include "event_bus.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <stdbool.h>
+
+/**
+ * @file events.h
+ * @brief Application event bus.
+ *
+ * One lock-free event bus (see event_bus.h) connects the button ISR, the Firebase stream, the
+ * actuator timer and the sensor task with the tasks that react to them. Every producer owns
+ * a channel, so no two contexts ever publish on the same ring. A reader is bound to the task
+ * that waits on it and is woken with a direct task notification.
+ */
+
+/** @brief Bus channels, one per producer. */
+typedef enum
+{
+    EVENTS_CH_BUTTON,   ///< Button GPIO interrupt
+    EVENTS_CH_STREAM,   ///< Firebase stream task
+    EVENTS_CH_ACTUATOR, ///< Actuator esp_timer callback
+    EVENTS_CH_SENSOR,   ///< Sensor task
+} events_channel_t;
+
+_Static_assert(EVENTS_CH_SENSOR < EVENT_BUS_MAX_CHANNELS, "not enough bus channels");
+
+/** @brief Origin of a relay command (event_t::relay.origin). */
+typedef enum
+{
+    EVENTS_ORIGIN_REMOTE, ///< Received from the database
+    EVENTS_ORIGIN_LOCAL,  ///< Decided on the device
+} events_origin_t;
+
+/**
+ * @struct events_reader_t
+ * @brief A bus reader served by one task.
+ *
+ * @var events_reader_t::reader Bus reader
+ * @var events_reader_t::task Task woken by matching events, set by the first events_wait()
+ */
+typedef struct
+{
+    event_bus_reader_t reader;
+    TaskHandle_t volatile task;
+} events_reader_t;
+
+/**
+ * @brief Publishes an event from task context, stamping the current time.
+ *
+ * @param channel Channel owned by the calling task
+ * @param event Event to publish
+ */
+void events_publish(events_channel_t channel, event_t* event);
+
+/**
+ * @brief Publishes an event from an interrupt handler, stamping the current time.
+ *
+ * Wakes the readers with the ISR notification API and yields if one of them has a higher
+ * priority than the interrupted task.
+ *
+ * @param channel Channel owned by the interrupt handler
+ * @param event Event to publish
+ */
+void events_publish_from_isr(events_channel_t channel, event_t* event);
+
+/**
+ * @brief Returns the full time of an event in milliseconds since boot.
+ *
+ * event_t::time_ms keeps only the low 32 bits of the clock; the high bits are taken from
+ * the current time, which is exact for any event younger than 49.7 days.
+ *
+ * @param event Event returned by events_wait()
+ * @return int64_t Time of the event, on the esp_timer_get_time() / 1000 clock.
+ */
+int64_t events_time_ms(const event_t* event);
+
+/**
+ * @brief Subscribes a reader to event types.
+ *
+ * May be called before the reading task exists; events published in between are kept in the
+ * rings and returned by the first events_wait().
+ *
+ * @param reader Reader, must stay valid forever
+ * @param type_mask EVENT_MASK() bits of the types to receive
+ * @return esp_err_t ESP_OK on success, ESP_ERR_NO_MEM if the bus has no free reader slot.
+ */
+esp_err_t events_subscribe(events_reader_t* reader, uint32_t type_mask);
+
+/**
+ * @brief Waits for the next event of a subscribed type.
+ *
+ * The reader is bound to the calling task on first use; only that task may wait on it.
+ *
+ * @param reader Reader
+ * @param out Receives the event
+ * @param timeout Maximum time to block
+ * @return bool True if an event was returned, false on timeout.
+ */
+bool events_wait(events_reader_t* reader, event_t* out, TickType_t timeout);
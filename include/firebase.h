@@ -9,7 +9,60 @@
  * * Provides generic functions for sending (PUT) and receiving (GET) data
  * to a Firebase Realtime Database endpoint using the ESP HTTP Client.
  */
-void firebase_switch_stream_task(void* pvParameters);
+
+// --------------------------------------------------------------------------
+// --- CONNECTION POOL ------------------------------------------------------
+// --------------------------------------------------------------------------
+
+/** @brief Number of keep-alive HTTPS clients kept open for REST requests. */
+#ifndef FIREBASE_POOL_SIZE
+#define FIREBASE_POOL_SIZE 2
+#endif
+
+/**
+ * @struct firebase_stats_t
+ * @brief Counters for REST requests sent through the connection pool.
+ *
+ * @var firebase_stats_t::requests Number of HTTP transactions performed (including retries)
+ * @var firebase_stats_t::failures Number of transactions that failed (transport or non-2xx)
+ * @var firebase_stats_t::connects Number of TCP/TLS sessions opened (handshakes)
+ * @var firebase_stats_t::last_latency_us Duration of the most recent transaction
+ * @var firebase_stats_t::max_latency_us Longest transaction seen so far
+ * @var firebase_stats_t::total_latency_us Sum of all durations, for computing the mean
+ */
+typedef struct
+{
+    uint32_t requests;
+    uint32_t failures;
+    uint32_t connects;
+    uint32_t last_latency_us;
+    uint32_t max_latency_us;
+    uint64_t total_latency_us;
+} firebase_stats_t;
+
+/**
+ * @brief Initializes the Firebase client connection pool.
+ *
+ * Must be called once before any application task issues a request; requests made
+ * without it fail with ESP_ERR_NO_MEM. Not thread-safe, so call it from startup code.
+ */
+void firebase_init(void);
+
+/**
+ * @brief Builds the REST URL (".json" endpoint) of a database path.
+ *
+ * @param url Destination buffer.
+ * @param url_len Size of the destination buffer.
+ * @param path The relative path in the database. An empty string addresses the root.
+ */
+void firebase_build_url(char* url, size_t url_len, const char* path);
+
+/**
+ * @brief Copies the current request counters.
+ *
+ * @param out Destination for the snapshot.
+ */
+void firebase_get_stats(firebase_stats_t* out);
 // --------------------------------------------------------------------------
 // --- PUT Implementation Functions (Hidden behind generic macro) ----------
 // --------------------------------------------------------------------------
@@ -71,10 +124,224 @@ esp_err_t firebase_put_string_impl(const char* path, const char* value);
         const char*: firebase_put_string_impl,                                                     \
         char*: firebase_put_string_impl)(path, value)
 
+// --------------------------------------------------------------------------
+// --- BATCHED WRITES -------------------------------------------------------
+// --------------------------------------------------------------------------
+
+/** @brief Maximum number of path/value pairs staged in a single batch. */
+#define FIREBASE_BATCH_MAX_ENTRIES 8
+
+/** @brief Size of the JSON body buffer of a batch. */
+#define FIREBASE_BATCH_BUF_SIZE 512
+
+/**
+ * @struct firebase_batch_t
+ * @brief Staging buffer for a Firebase multi-location update.
+ *
+ * Values are encoded into a single JSON object keyed by their database path and sent as one
+ * PATCH request to the database root when the batch is flushed.
+ *
+ * @var firebase_batch_t::payload JSON body being built
+ * @var firebase_batch_t::len Number of bytes used in payload
+ * @var firebase_batch_t::count Number of staged values
+ * @var firebase_batch_t::max_entries Value count that triggers an automatic flush
+ * @var firebase_batch_t::max_age_ms Age of the oldest staged value that triggers a flush (0 = off)
+ * @var firebase_batch_t::first_staged_us Timestamp of the oldest staged value
+ */
+typedef struct
+{
+    char payload[FIREBASE_BATCH_BUF_SIZE];
+    size_t len;
+    int count;
+    int max_entries;
+    uint32_t max_age_ms;
+    int64_t first_staged_us;
+} firebase_batch_t;
+
+/**
+ * @brief Initializes (or empties) a batch.
+ *
+ * @param batch The batch to initialize.
+ * @param max_entries Flush automatically once this many values are staged
+ * (clamped to FIREBASE_BATCH_MAX_ENTRIES).
+ * @param max_age_ms Flush automatically once the oldest staged value is this old, checked on
+ * every add and by firebase_batch_poll(). 0 disables the time-based flush.
+ */
+void firebase_batch_init(firebase_batch_t* batch, int max_entries, uint32_t max_age_ms);
+
+/**
+ * @brief Sends all staged values as a single multi-location PATCH and empties the batch.
+ *
+ * The batch is emptied even if the request fails.
+ *
+ * @param batch The batch to flush.
+ * @return esp_err_t ESP_OK if the batch was empty or the request succeeded.
+ */
+esp_err_t firebase_batch_flush(firebase_batch_t* batch);
+
+/**
+ * @brief Flushes the batch if its oldest value is older than max_age_ms.
+ *
+ * Intended to be called periodically by owners of long-lived batches.
+ *
+ * @param batch The batch to check.
+ * @return esp_err_t ESP_OK if nothing had to be sent or the flush succeeded.
+ */
+esp_err_t firebase_batch_poll(firebase_batch_t* batch);
+
+/**
+ * @brief Stages an already JSON-encoded value in a batch.
+ *
+ * Flushes first if the entry does not fit, and afterwards if the batch is full.
+ *
+ * @param batch The batch to add to.
+ * @param path The relative path in the database.
+ * @param json_value The JSON text of the value (e.g. "21.50", "true", "\"text\"").
+ * @return esp_err_t ESP_OK on success, ESP_ERR_INVALID_SIZE if the entry can never fit, or the
+ * error of an automatic flush.
+ */
+esp_err_t firebase_batch_add_json(firebase_batch_t* batch, const char* path,
+                                  const char* json_value);
+
+/**
+ * @brief Checks whether an entry can be staged without triggering an automatic flush.
+ *
+ * Lets callers that must know exactly which values went into a request fill a batch and
+ * flush it themselves.
+ *
+ * @param batch The batch.
+ * @param path The relative path in the database.
+ * @param json_value The JSON text of the value.
+ * @return true if firebase_batch_add_json() would only stage the entry.
+ */
+bool firebase_batch_has_room(const firebase_batch_t* batch, const char* path,
+                             const char* json_value);
+
+/**
+ * @brief Encodes a string as a quoted, escaped JSON string.
+ *
+ * Quotes and backslashes are escaped with a backslash, control characters as \\u00XX.
+ *
+ * @param out Destination buffer.
+ * @param out_len Size of the destination buffer.
+ * @param value The string to encode.
+ * @return esp_err_t ESP_OK on success, ESP_ERR_INVALID_SIZE if it does not fit.
+ */
+esp_err_t firebase_json_quote(char* out, size_t out_len, const char* value);
+
+/**
+ * @brief Stages a floating-point value in a batch.
+ * * @param batch The batch to add to.
+ * @param path The relative path in the database (e.g., "devices/temp").
+ * @param value The float value to be written.
+ * @return esp_err_t ESP_OK on success, or the error of an automatic flush.
+ */
+esp_err_t firebase_batch_add_float_impl(firebase_batch_t* batch, const char* path, float value);
+
+/**
+ * @brief Stages an integer value in a batch.
+ * * @param batch The batch to add to.
+ * @param path The relative path in the database (e.g., "devices/counter").
+ * @param value The integer value to be written.
+ * @return esp_err_t ESP_OK on success, or the error of an automatic flush.
+ */
+esp_err_t firebase_batch_add_int_impl(firebase_batch_t* batch, const char* path, int value);
+
+/**
+ * @brief Stages a boolean value in a batch.
+ * * @param batch The batch to add to.
+ * @param path The relative path in the database (e.g., "devices/status").
+ * @param value The boolean value to be written as a JSON literal.
+ * @return esp_err_t ESP_OK on success, or the error of an automatic flush.
+ */
+esp_err_t firebase_batch_add_bool_impl(firebase_batch_t* batch, const char* path, bool value);
+
+/**
+ * @brief Stages a string value in a batch.
+ * * @param batch The batch to add to.
+ * @param path The relative path in the database (e.g., "devices/message").
+ * @param value The string to be written. It is quoted and escaped as a JSON string.
+ * @return esp_err_t ESP_OK on success, ESP_ERR_INVALID_SIZE if the value does not fit, or the
+ * error of an automatic flush.
+ */
+esp_err_t firebase_batch_add_string_impl(firebase_batch_t* batch, const char* path,
+                                         const char* value);
+
+/**
+ * @brief Stages a generic value (float, int, bool, string) in a batch.
+ * * Batched counterpart of firebase_put(); the value is sent on the next flush.
+ * * @param batch Pointer to the batch.
+ * @param path The target path in the database (e.g., "devices/state").
+ * @param value The value to be sent (float, int, bool, or char*).
+ * @return esp_err_t Returns ESP_OK on success.
+ */
+#define firebase_batch_add(batch, path, value)                                                     \
+    _Generic((value),                                                                              \
+        float: firebase_batch_add_float_impl,                                                      \
+        int: firebase_batch_add_int_impl,                                                          \
+        bool: firebase_batch_add_bool_impl,                                                        \
+        const char*: firebase_batch_add_string_impl,                                               \
+        char*: firebase_batch_add_string_impl)(batch, path, value)
+
 // --------------------------------------------------------------------------
 // --- GET FUNCTION ---------------------------------------------------------
 // --------------------------------------------------------------------------
 
+/** @brief Room for an ETag value including the terminator. */
+#define FIREBASE_ETAG_MAX_LEN 64
+
+/**
+ * @brief Receives the next piece of a GET response body.
+ *
+ * @param data Body bytes, not NUL-terminated and only valid during the call.
+ * @param len Number of bytes.
+ * @param user_ctx Context from firebase_get_opts_t.
+ * @return esp_err_t ESP_OK to continue; anything else makes the GET fail with that code.
+ */
+typedef esp_err_t (*firebase_body_cb_t)(const char* data, size_t len, void* user_ctx);
+
+/**
+ * @struct firebase_get_opts_t
+ * @brief Options for firebase_get_ex().
+ *
+ * @var firebase_get_opts_t::shallow Return only the keys of an object (children set to true)
+ * @var firebase_get_opts_t::if_none_match ETag of the caller's copy, or NULL for a plain
+ * read. It is sent as If-None-Match, but Firebase ignores that and answers 200 with the full
+ * body, which is delivered as usual; afterwards the result is marked not modified if the
+ * returned ETag still matches, so the caller can skip parsing it. Only a server that answers
+ * 304 saves the transfer, and then no body is delivered.
+ * @var firebase_get_opts_t::on_data If set, the body is handed to this callback piece by
+ * piece instead of being collected, and out_buf is not used. Once the callback has received
+ * part of the body, a failed attempt is not retried, so it never gets the same bytes twice;
+ * firebase_get_ex() then returns the error and what the callback got is incomplete.
+ * @var firebase_get_opts_t::user_ctx Passed to on_data
+ */
+typedef struct
+{
+    bool shallow;
+    const char* if_none_match;
+    firebase_body_cb_t on_data;
+    void* user_ctx;
+} firebase_get_opts_t;
+
+/**
+ * @struct firebase_result_t
+ * @brief Outcome of a conditional request.
+ *
+ * @var firebase_result_t::status HTTP status of the last attempt
+ * @var firebase_result_t::not_modified The node still has the if_none_match ETag. Set after
+ * the body (if any) was delivered, so out_buf or on_data may still have received it
+ * @var firebase_result_t::body_len Number of body bytes delivered
+ * @var firebase_result_t::etag ETag of the node as returned by the server, or empty
+ */
+typedef struct
+{
+    int status;
+    bool not_modified;
+    size_t body_len;
+    char etag[FIREBASE_ETAG_MAX_LEN];
+} firebase_result_t;
+
 /**
  * @brief Reads the JSON data from the Realtime Database at a given path.
  * * The data received from Firebase is typically raw JSON and is stored
@@ -83,7 +350,40 @@ esp_err_t firebase_put_string_impl(const char* path, const char* value);
  * @param path The relative path in the database (e.g., "config/settings").
  * @param out_buf Pointer to the buffer where the received data will be stored.
  * @param out_len The size of the output buffer (out_buf).
- * @return esp_err_t Returns ESP_OK on successful HTTP transaction and data read, or an error code
- * otherwise.
+ * @return esp_err_t Returns ESP_OK on successful HTTP transaction and data read,
+ * ESP_ERR_INVALID_SIZE if the data did not fit, or another error code otherwise.
+ */
+esp_err_t firebase_get(const char* path, char* out_buf, size_t out_len);
+
+/**
+ * @brief Reads a path with shallow and conditional (ETag) options.
+ *
+ * Uses the pooled keep-alive connections. The body is written straight from the HTTP
+ * client's receive buffer into out_buf (NUL-terminated) or passed to opts->on_data, so a
+ * large node never needs a second full-size buffer. The server is always asked for the
+ * node's ETag, which can be passed back as if_none_match on the next call. A failed request
+ * is retried, unless opts->on_data has already received part of its body.
+ *
+ * @param path The relative path in the database. An empty string addresses the root.
+ * @param opts Options, or NULL for a plain read.
+ * @param out_buf Destination for the body; ignored (may be NULL) when on_data is set.
+ * @param out_len Size of out_buf.
+ * @param result Receives status, ETag and body length; may be NULL.
+ * @return esp_err_t ESP_OK on success (including not modified), ESP_ERR_INVALID_SIZE if the
+ * body did not fit in out_buf (a truncated prefix is kept), or another error code otherwise.
+ */
+esp_err_t firebase_get_ex(const char* path, const firebase_get_opts_t* opts, char* out_buf,
+                          size_t out_len, firebase_result_t* result);
+
+/**
+ * @brief Replaces the value at a path only if the node still has the given ETag.
+ *
+ * @param path The relative path in the database.
+ * @param json_value The new value as JSON text.
+ * @param etag ETag from a previous firebase_get_ex().
+ * @param result Receives status and, if the server returns it, the current ETag; may be NULL.
+ * @return esp_err_t ESP_OK if written, ESP_ERR_INVALID_STATE if the node changed in the
+ * meantime (read it again and retry), or another error code otherwise.
  */
-esp_err_t firebase_get(const char* path, char* out_buf, size_t out_len);
\ No newline at end of file
+esp_err_t firebase_put_if_match(const char* path, const char* json_value, const char* etag,
+                                firebase_result_t* result);
@@ -0,0 +1,135 @@
+#pragma once
+
+#include "esp_err.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @file firebase_queue.h
+ * @brief Persistent offline queue for Firebase writes.
+ *
+ * Producers stage values with firebase_queue_put(); the call only updates a RAM table and
+ * never touches flash or the network, so it is safe on time-critical tasks. A drain task
+ * replays pending values as multi-location PATCH requests, backing off while the cloud is
+ * unreachable, and writes values it could not send to NVS within a second, with one commit
+ * per pass; a value sent at its first flush never reaches flash. The queue keeps only the
+ * latest value per path, so its size is bounded by the number of distinct paths rather than
+ * by the length of an outage. Pending values survive a reboot.
+ */
+
+/** @brief Number of pending values that can be stored. */
+#define FIREBASE_QUEUE_LEN 16
+
+/** @brief Maximum path length, including the terminating NUL. */
+#define FIREBASE_QUEUE_PATH_MAX 48
+
+/** @brief Maximum length of a JSON-encoded value, including the terminating NUL. */
+#define FIREBASE_QUEUE_VALUE_MAX 32
+
+/**
+ * @struct firebase_queue_stats_t
+ * @brief Queue counters.
+ *
+ * @var firebase_queue_stats_t::pending Values waiting to be sent
+ * @var firebase_queue_stats_t::enqueued Values accepted by firebase_queue_put()
+ * @var firebase_queue_stats_t::coalesced Values that replaced an unsent value of the same path
+ * @var firebase_queue_stats_t::dropped Oldest values evicted because the queue was full
+ * @var firebase_queue_stats_t::sent Values confirmed by Firebase
+ * @var firebase_queue_stats_t::failed_flushes PATCH requests that failed and will be retried
+ */
+typedef struct
+{
+    uint32_t pending;
+    uint32_t enqueued;
+    uint32_t coalesced;
+    uint32_t dropped;
+    uint32_t sent;
+    uint32_t failed_flushes;
+} firebase_queue_stats_t;
+
+/**
+ * @brief Initializes the queue and restores values persisted before a reboot.
+ *
+ * NVS must be initialized first.
+ *
+ * @return esp_err_t ESP_OK on success, or the NVS error.
+ */
+esp_err_t firebase_queue_init(void);
+
+/**
+ * @brief FreeRTOS task that sends pending values to Firebase.
+ *
+ * @param pvParameters Task parameters (unused)
+ */
+void firebase_queue_task(void* pvParameters);
+
+/**
+ * @brief Wakes the drain task so pending values are sent now.
+ *
+ * Producers call this after staging a set of values that belong together. Staging alone
+ * does not send; values also go out when the link comes back or a retry is due.
+ */
+void firebase_queue_flush(void);
+
+/**
+ * @brief Copies the queue counters.
+ *
+ * @param out Destination for the snapshot.
+ */
+void firebase_queue_get_stats(firebase_queue_stats_t* out);
+
+/**
+ * @brief Tells whether a value of the path is still waiting to be confirmed by Firebase.
+ *
+ * @param path The relative path in the database.
+ * @return bool True while a value of the path is queued or in flight.
+ */
+bool firebase_queue_is_pending(const char* path);
+
+/**
+ * @brief Stages an already JSON-encoded value.
+ *
+ * @param path The relative path in the database (e.g., "DHT11/temperature").
+ * @param json_value The JSON text of the value.
+ * @return esp_err_t ESP_OK on success, ESP_ERR_INVALID_SIZE if path or value is too long.
+ */
+esp_err_t firebase_queue_put_json(const char* path, const char* json_value);
+
+/**
+ * @brief Stages a floating-point value. See firebase_queue_put().
+ */
+esp_err_t firebase_queue_put_float_impl(const char* path, float value);
+
+/**
+ * @brief Stages an integer value. See firebase_queue_put().
+ */
+esp_err_t firebase_queue_put_int_impl(const char* path, int value);
+
+/**
+ * @brief Stages a boolean value. See firebase_queue_put().
+ */
+esp_err_t firebase_queue_put_bool_impl(const char* path, bool value);
+
+/**
+ * @brief Stages a string value. See firebase_queue_put().
+ */
+esp_err_t firebase_queue_put_string_impl(const char* path, const char* value);
+
+/**
+ * @brief Stages a generic value (float, int, bool, string) for an asynchronous write.
+ *
+ * Queued counterpart of firebase_put(): returns without waiting for the network and
+ * replaces any unsent value of the same path.
+ *
+ * @param path The target path in the database (e.g., "devices/state").
+ * @param value The value to be sent (float, int, bool, or char*).
+ * @return esp_err_t Returns ESP_OK on success.
+ */
+#define firebase_queue_put(path, value)                                                            \
+    _Generic((value),                                                                              \
+        float: firebase_queue_put_float_impl,                                                      \
+        int: firebase_queue_put_int_impl,                                                          \
+        bool: firebase_queue_put_bool_impl,                                                        \
+        const char*: firebase_queue_put_string_impl,                                               \
+        char*: firebase_queue_put_string_impl)(path, value)
@@ -0,0 +1,158 @@
+#pragma once
+
+#include "esp_err.h"
+#include "json_tok.h"
+#include <stdint.h>
+
+/**
+ * @file firebase_stream.h
+ * @brief Shared Firebase streaming connection with path-based subscriptions.
+ *
+ * Modules subscribe to database paths before the stream task starts. The task opens a single
+ * event stream on the deepest node that is a common parent of all subscribed paths and routes
+ * each incoming event to the handlers whose paths overlap the event path, using a prefix trie
+ * of path segments. Adding subscriptions therefore costs neither a task nor a TLS session.
+ *
+ * After a dropped connection the stream is reopened with jittered exponential backoff starting
+ * at tens of milliseconds. The new connection starts with a full snapshot; each subscription
+ * remembers the last path and value it was given, so handlers only see the parts of the
+ * snapshot that actually changed while the stream was down.
+ */
+
+/** @brief Maximum number of subscriptions. */
+#define FIREBASE_STREAM_MAX_SUBSCRIPTIONS 8
+
+/**
+ * @brief Event types sent by the Firebase streaming (SSE) REST API.
+ */
+typedef enum
+{
+    FIREBASE_STREAM_PUT,          ///< Data at a path was replaced
+    FIREBASE_STREAM_PATCH,        ///< Children of a path were updated
+    FIREBASE_STREAM_KEEP_ALIVE,   ///< Periodic heartbeat, no data
+    FIREBASE_STREAM_CANCEL,       ///< Security rules no longer allow reading the path
+    FIREBASE_STREAM_AUTH_REVOKED, ///< The credential expired
+    FIREBASE_STREAM_UNKNOWN,
+} firebase_stream_event_type_t;
+
+/**
+ * @struct firebase_stream_update_t
+ * @brief A change delivered to a subscription handler.
+ *
+ * The event JSON is tokenized once and shared by all handlers; value indexes the token of the
+ * JSON value written at path. For subscriptions below the event path (e.g. on the initial
+ * snapshot of the stream root), path is the subscribed path and value is its part of the
+ * snapshot, or -1 if the snapshot does not contain it (the node was removed). Subscriptions
+ * above the event path receive the event path and value unchanged. Use the
+ * firebase_stream_get_* helpers to read typed values.
+ *
+ * FIREBASE_STREAM_CANCEL and FIREBASE_STREAM_AUTH_REVOKED are delivered to every handler with
+ * the stream root as path and value -1, so a handler that only reads values ignores them.
+ *
+ * @var firebase_stream_update_t::type FIREBASE_STREAM_PUT, FIREBASE_STREAM_PATCH,
+ * FIREBASE_STREAM_CANCEL or FIREBASE_STREAM_AUTH_REVOKED
+ * @var firebase_stream_update_t::path Absolute database path of the value, without slashes
+ * at either end (e.g. "CONTROLS/pc_switch")
+ * @var firebase_stream_update_t::json The event JSON document
+ * @var firebase_stream_update_t::tokens Tokens of the event JSON document
+ * @var firebase_stream_update_t::token_count Number of tokens
+ * @var firebase_stream_update_t::value Index of the value token, -1 if the node does not exist
+ */
+typedef struct
+{
+    firebase_stream_event_type_t type;
+    const char* path;
+    const char* json;
+    const json_token_t* tokens;
+    int token_count;
+    int value;
+} firebase_stream_update_t;
+
+/**
+ * @brief Subscription handler, called from the stream task.
+ *
+ * Handlers must not block: the stream is not read while they run.
+ *
+ * @param update The change
+ * @param user_ctx Context pointer given to firebase_stream_subscribe()
+ */
+typedef void (*firebase_stream_cb_t)(const firebase_stream_update_t* update, void* user_ctx);
+
+/**
+ * @struct firebase_stream_stats_t
+ * @brief Counters of the stream connection.
+ *
+ * @var firebase_stream_stats_t::connects Streams established
+ * @var firebase_stream_stats_t::failures Connection attempts that failed
+ * @var firebase_stream_stats_t::events Put and patch events received
+ * @var firebase_stream_stats_t::duplicates Deliveries skipped because the value was unchanged
+ * @var firebase_stream_stats_t::last_recovery_ms Time from losing the stream to the first
+ * event on the next one
+ * @var firebase_stream_stats_t::max_recovery_ms Longest recovery so far
+ */
+typedef struct
+{
+    uint32_t connects;
+    uint32_t failures;
+    uint32_t events;
+    uint32_t duplicates;
+    uint32_t last_recovery_ms;
+    uint32_t max_recovery_ms;
+} firebase_stream_stats_t;
+
+/**
+ * @brief Registers a handler for changes at or below a database path.
+ *
+ * Must be called before firebase_stream_task() is started.
+ *
+ * @param path The relative path in the database (e.g., "CONTROLS/pc_switch").
+ * @param cb Handler to call
+ * @param user_ctx Opaque pointer passed to the handler
+ * @return esp_err_t ESP_OK on success, ESP_ERR_NO_MEM if the registry is full,
+ * ESP_ERR_INVALID_ARG for an overlong path segment, ESP_ERR_INVALID_STATE if the stream is
+ * already running.
+ */
+esp_err_t firebase_stream_subscribe(const char* path, firebase_stream_cb_t cb, void* user_ctx);
+
+/**
+ * @brief FreeRTOS task that maintains the shared stream and dispatches events.
+ *
+ * Reconnects automatically when the connection drops, when it stays silent longer than the
+ * keep-alive interval allows, or when the server revokes the credential. After a cancel
+ * (security rules deny the read) it retries at a slow rate.
+ *
+ * @param pvParameters Task parameters (unused)
+ */
+void firebase_stream_task(void* pvParameters);
+
+/**
+ * @brief Copies the current stream counters.
+ *
+ * @param out Destination for the snapshot.
+ */
+void firebase_stream_get_stats(firebase_stream_stats_t* out);
+
+/**
+ * @brief Reads the value of an update as a boolean.
+ *
+ * @return esp_err_t ESP_OK on success, ESP_ERR_NOT_FOUND if the node was removed (null or
+ * absent), ESP_ERR_INVALID_ARG if the value is not a boolean.
+ */
+esp_err_t firebase_stream_get_bool(const firebase_stream_update_t* update, bool* out);
+
+/**
+ * @brief Reads the value of an update as a number.
+ *
+ * @return esp_err_t ESP_OK on success, ESP_ERR_NOT_FOUND if the node was removed (null or
+ * absent), ESP_ERR_INVALID_ARG if the value is not a number.
+ */
+esp_err_t firebase_stream_get_number(const firebase_stream_update_t* update, double* out);
+
+/**
+ * @brief Copies the value of an update as a string.
+ *
+ * @return esp_err_t ESP_OK on success, ESP_ERR_NOT_FOUND if the node was removed (null or
+ * absent), ESP_ERR_INVALID_ARG if the value is not a string or does not fit.
+ */
+esp_err_t firebase_stream_get_string(const firebase_stream_update_t* update, char* out,
+                                     size_t out_len);
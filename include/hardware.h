@@ -2,41 +2,77 @@
 
 #include "driver/gpio.h"
 #include "freertos/FreeRTOS.h"
-#include "freertos/queue.h"
+#include <stdbool.h>
+#include <stdint.h>
 
 /**
- * @brief Sets the relay state based on a JSON payload.
+ * @struct relay_stats_t
+ * @brief Relay control counters.
  *
- * This function parses the given JSON payload to determine
- * the desired relay state (e.g., ON or OFF) and updates
- * the GPIO output accordingly.
+ * @var relay_stats_t::presses Button presses that actuated the relay
+ * @var relay_stats_t::remote_actuations Relay changes requested through the database
+ * @var relay_stats_t::echoes_suppressed Remote commands held back while a local change was
+ * being synced
+ * @var relay_stats_t::last_latency_us Press-to-actuation latency of the last press
+ * @var relay_stats_t::max_latency_us Highest press-to-actuation latency
+ * @var relay_stats_t::total_latency_us Sum of all press-to-actuation latencies
+ */
+typedef struct
+{
+    uint32_t presses;
+    uint32_t remote_actuations;
+    uint32_t echoes_suppressed;
+    uint32_t last_latency_us;
+    uint32_t max_latency_us;
+    uint64_t total_latency_us;
+} relay_stats_t;
+
+/**
+ * @brief Sets the logical relay state.
+ *
+ * The relay is impulse-driven, so an impulse is only sent when the requested
+ * state differs from the current one. The impulse is queued on the actuator
+ * and the call returns immediately.
  *
- * @param json_payload A JSON-formatted string containing the relay state information.
- *                     Example: {"relay": "on"}
+ * @param state Desired state (true = ON, false = OFF)
  */
-void set_relay_state(const char* json_payload);
+void set_relay_state(bool state);
 
 /**
  * @brief Relay hardware initialization.
  *
- * Configures the relay GPIO pin as output and sets initial state to OFF.
+ * Registers the relay GPIO as an actuator channel (initial state OFF) and subscribes to the
+ * remote switch path on the Firebase stream.
  */
 void relay_init(void);
 
 /**
- * @brief Initialize PC switch (button) input.
+ * @brief Initialize PC switch (button) inputs.
  *
- * Configures the button GPIO pin with interrupt on falling edge,
- * creates the event queue, and attaches the ISR handler.
+ * Configures every button GPIO with an interrupt on both edges, subscribes the button task
+ * to the event bus, and attaches the ISR handler. The handler masks the pin's interrupt and
+ * publishes the edge; the button task unmasks it once the contact has settled.
  */
 void pc_switch_init(void);
 
 /**
- * @brief FreeRTOS task to handle button press events.
+ * @brief FreeRTOS task to handle button gestures and relay commands.
  *
- * Listens to the button GPIO event queue, applies debouncing,
- * toggles the relay state, and updates Firebase.
+ * Waits on the event bus for button edges and relay commands from the stream, and runs the
+ * debounce and gesture state machine of every button (see button_fsm.h) on its deadlines.
+ * A debounced press of the PC switch toggles the relay right away and stages the new state
+ * in the offline Firebase queue. Until that write is confirmed, and for a short window
+ * after, remote commands are held back so the echo of the write (or an older value it
+ * overwrites) cannot switch the relay again; the last held command is applied once the
+ * state has settled.
  *
  * @param pvParameters Task parameters (unused)
  */
 void button_handler_task(void* pvParameters);
+
+/**
+ * @brief Copies the relay control counters.
+ *
+ * @param out Destination for the snapshot
+ */
+void relay_get_stats(relay_stats_t* out);
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * @file json_tok.h
+ * @brief Allocation-free JSON tokenizer.
+ *
+ * The document is split in a single pass into a caller-provided array of tokens that refer
+ * back into the source text by offset (in the style of jsmn). Nothing is copied or allocated;
+ * values are converted on demand with the json_get_* helpers. The tokenizer has no platform
+ * dependencies.
+ */
+
+/** @brief Returned by json_parse() when the token array is too small. */
+#define JSON_ERROR_NOMEM -1
+/** @brief Returned by json_parse() for malformed input. */
+#define JSON_ERROR_INVAL -2
+/** @brief Returned by json_parse() when the input ends inside a value. */
+#define JSON_ERROR_PART -3
+
+/**
+ * @brief Kind of a token.
+ */
+typedef enum
+{
+    JSON_OBJECT,
+    JSON_ARRAY,
+    JSON_STRING,    ///< String value or object key; start/end exclude the quotes
+    JSON_PRIMITIVE, ///< Number, true, false or null
+} json_type_t;
+
+/**
+ * @struct json_token_t
+ * @brief A token, located at js[start, end).
+ *
+ * Tokens are stored in document order, so the children of a container directly follow it.
+ *
+ * @var json_token_t::type Kind of the token
+ * @var json_token_t::start Offset of the first character
+ * @var json_token_t::end Offset one past the last character
+ * @var json_token_t::size Number of keys (object), elements (array) or values (key: 1)
+ * @var json_token_t::parent Index of the enclosing container or key, -1 at the top level
+ */
+typedef struct
+{
+    json_type_t type;
+    int start;
+    int end;
+    int size;
+    int parent;
+} json_token_t;
+
+/**
+ * @brief Tokenizes a JSON document.
+ *
+ * @param js The document (need not be NUL-terminated)
+ * @param len Length of the document
+ * @param tokens Token array to fill
+ * @param max_tokens Capacity of the token array
+ * @return Number of tokens used, or JSON_ERROR_NOMEM / JSON_ERROR_INVAL / JSON_ERROR_PART
+ */
+int json_parse(const char* js, size_t len, json_token_t* tokens, int max_tokens);
+
+/**
+ * @brief Returns the index of the first token after the given token and all its children.
+ *
+ * @param tokens Tokens produced by json_parse()
+ * @param count Number of tokens
+ * @param index Token to skip
+ * @return Index of the next token (== count at the end of the document)
+ */
+int json_skip(const json_token_t* tokens, int count, int index);
+
+/**
+ * @brief Looks up a key in an object.
+ *
+ * @param js The document
+ * @param tokens Tokens produced by json_parse()
+ * @param count Number of tokens
+ * @param object Index of the object token
+ * @param key Key to look for (need not be NUL-terminated)
+ * @param key_len Length of the key
+ * @return Index of the value token, or -1 if the key is absent or object is not an object
+ */
+int json_object_get(const char* js, const json_token_t* tokens, int count, int object,
+                    const char* key, size_t key_len);
+
+/**
+ * @brief Compares a string or primitive token with a NUL-terminated string.
+ */
+bool json_token_eq(const char* js, const json_token_t* token, const char* str);
+
+/**
+ * @brief Reads a JSON boolean.
+ *
+ * @return 0 on success, -1 if the token is not true or false
+ */
+int json_get_bool(const char* js, const json_token_t* token, bool* out);
+
+/**
+ * @brief Reads a JSON number.
+ *
+ * @return 0 on success, -1 if the token is not a number
+ */
+int json_get_number(const char* js, const json_token_t* token, double* out);
+
+/**
+ * @brief Copies a JSON string into a buffer, resolving escape sequences.
+ *
+ * \u escapes outside ASCII are replaced with '?'.
+ *
+ * @return 0 on success, -1 if the token is not a string or does not fit (out is then
+ * truncated)
+ */
+int json_get_string(const char* js, const json_token_t* token, char* out, size_t out_len);
+
+/**
+ * @brief Returns true if the token is the null literal.
+ */
+bool json_is_null(const char* js, const json_token_t* token);
@@ -0,0 +1,158 @@
+#pragma once
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @file metrics.h
+ * @brief Preallocated runtime metrics: counters, gauges and latency histograms.
+ *
+ * Metrics live in a fixed table and are created once, usually at startup, by name and
+ * optional Prometheus labels (e.g. name "firebase_request_us", labels "method=\"PUT\"");
+ * creating an existing name/labels pair returns the same metric. Updates are single relaxed
+ * atomic operations, so any task or ISR can record without locks and a reader never blocks
+ * a writer. Histograms have fixed power-of-two buckets, from METRICS_HIST_MIN up to
+ * METRICS_HIST_MIN << (METRICS_HIST_BUCKETS - 1), plus an overflow bucket.
+ *
+ * Every update function accepts NULL, which is what the constructors return when the table
+ * is full, so instrumentation never needs error handling; the first metric that does not fit
+ * is logged. Apart from that warning the registry has no platform dependencies; exporting is
+ * done by metrics_export.h.
+ */
+
+/** @brief Metrics with fixed names and labels that the modules create (44 so far). */
+#define METRICS_FIXED_MAX 48
+
+/** @brief Tasks with metrics of their own; the profiler creates two gauges for each. */
+#define METRICS_TASKS_MAX 24
+
+/** @brief Maximum number of metrics (each label set counts). */
+#define METRICS_MAX (METRICS_FIXED_MAX + 2 * METRICS_TASKS_MAX)
+
+/** @brief Finite histogram buckets. */
+#define METRICS_HIST_BUCKETS 20
+
+/** @brief Upper bound of the first histogram bucket. */
+#define METRICS_HIST_MIN 16
+
+/** @brief Metric kinds. */
+typedef enum
+{
+    METRIC_COUNTER,   ///< Monotonic count
+    METRIC_GAUGE,     ///< Value that goes up and down
+    METRIC_HISTOGRAM, ///< Distribution of observed values
+} metric_type_t;
+
+/**
+ * @struct metric_t
+ * @brief One metric. Read it through the accessors; the fields are updated concurrently.
+ *
+ * @var metric_t::name Metric name, without the _total/_bucket suffixes
+ * @var metric_t::labels Prometheus label pairs without braces, or NULL
+ * @var metric_t::help Help text, the one of the first metric of a name is exported
+ * @var metric_t::type Kind of metric
+ * @var metric_t::value Counter or gauge value, histogram observation count
+ * @var metric_t::sum Sum of histogram observations
+ * @var metric_t::buckets Histogram bucket counts (not cumulative); the last is the overflow
+ */
+typedef struct
+{
+    const char* name;
+    const char* labels;
+    const char* help;
+    metric_type_t type;
+    atomic_int_least32_t value;
+    atomic_uint_least64_t sum;
+    atomic_uint_least32_t buckets[METRICS_HIST_BUCKETS + 1];
+} metric_t;
+
+/**
+ * @brief Creates or looks up a counter.
+ *
+ * @param name Metric name, must stay valid forever
+ * @param labels Label pairs (e.g. "method=\"PUT\""), or NULL; must stay valid forever
+ * @param help Help text, must stay valid forever
+ * @return metric_t* The counter, or NULL if the table is full or the name has another type.
+ */
+metric_t* metrics_counter(const char* name, const char* labels, const char* help);
+
+/**
+ * @brief Creates or looks up a gauge. See metrics_counter().
+ */
+metric_t* metrics_gauge(const char* name, const char* labels, const char* help);
+
+/**
+ * @brief Creates or looks up a histogram. See metrics_counter().
+ */
+metric_t* metrics_histogram(const char* name, const char* labels, const char* help);
+
+/**
+ * @brief Adds to a counter or gauge.
+ *
+ * @param metric Metric, may be NULL
+ * @param delta Amount to add
+ */
+void metrics_add(metric_t* metric, int32_t delta);
+
+/**
+ * @brief Adds one to a counter or gauge.
+ *
+ * @param metric Metric, may be NULL
+ */
+void metrics_inc(metric_t* metric);
+
+/**
+ * @brief Sets a gauge.
+ *
+ * @param metric Metric, may be NULL
+ * @param value New value
+ */
+void metrics_set(metric_t* metric, int32_t value);
+
+/**
+ * @brief Records one value in a histogram.
+ *
+ * @param metric Metric, may be NULL
+ * @param value Observed value (e.g. a duration in microseconds)
+ */
+void metrics_observe(metric_t* metric, uint32_t value);
+
+/**
+ * @brief Returns the upper bound of a finite histogram bucket.
+ *
+ * @param bucket Bucket index, below METRICS_HIST_BUCKETS
+ * @return uint32_t Largest value counted in the bucket.
+ */
+uint32_t metrics_bucket_bound(int bucket);
+
+/**
+ * @brief Returns the number of metrics created so far.
+ *
+ * @return int Count; metrics_at() is valid for indexes below it.
+ */
+int metrics_count(void);
+
+/**
+ * @brief Returns a metric by creation order.
+ *
+ * @param index Index below metrics_count()
+ * @return metric_t* The metric.
+ */
+metric_t* metrics_at(int index);
+
+/** @brief Receives chunks of formatted text; returns false to stop. */
+typedef bool (*metrics_write_cb_t)(void* ctx, const char* text, size_t len);
+
+/**
+ * @brief Formats all metrics in the Prometheus text exposition format.
+ *
+ * Metrics of one name are grouped under a single HELP/TYPE header. The text is produced in
+ * small chunks, so no buffer for the whole page is needed.
+ *
+ * @param write Called for every chunk
+ * @param ctx Passed to write
+ * @return bool False if write stopped the output.
+ */
+bool metrics_write_prometheus(metrics_write_cb_t write, void* ctx);
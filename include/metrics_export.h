@@ -0,0 +1,46 @@
+#pragma once
+
+#include "esp_err.h"
+
+/**
+ * @file metrics_export.h
+ * @brief Publishes the metrics registry: Prometheus text on GET /metrics and optional
+ * periodic snapshots in Firebase.
+ *
+ * Besides the metrics that modules record themselves, every export refreshes gauges for the
+ * free heap and uptime, and mirrors the statistics structures of the Firebase client, queue,
+ * stream, sensors and relay as counters. Per-task figures come from the profiler
+ * (profiler.h).
+ */
+
+/** @brief Period of the Firebase push task in milliseconds, 0 to disable pushing. */
+#ifndef METRICS_PUSH_INTERVAL_MS
+#define METRICS_PUSH_INTERVAL_MS 0
+#endif
+
+/** @brief Database node below which metrics_export_push() writes. */
+#define METRICS_PUSH_ROOT "METRICS"
+
+/**
+ * @brief Creates the collected metrics and registers GET /metrics with the web server.
+ *
+ * Call once at startup, before the web server's wildcard handlers are registered.
+ */
+void metrics_export_init(void);
+
+/**
+ * @brief Writes a snapshot of all metrics to Firebase in batched PATCH requests.
+ *
+ * Counters and gauges become numbers at METRICS_PUSH_ROOT/<name>[/<labels>], histograms
+ * objects with their count and sum.
+ *
+ * @return esp_err_t ESP_OK on success, or the error of the first failed request.
+ */
+esp_err_t metrics_export_push(void);
+
+/**
+ * @brief FreeRTOS task that calls metrics_export_push() every METRICS_PUSH_INTERVAL_MS.
+ *
+ * @param pvParameters Task parameters (unused)
+ */
+void metrics_export_task(void* pvParameters);
@@ -0,0 +1,9 @@
+// Generated by tools/gen_assets.py from assets/portal; do not edit.
+#pragma once
+
+#include "web_server.h"
+
+/** @brief index.html: 2846 bytes minified, 1440 gzipped. */
+extern const web_asset_t portal_index_html;
+/** @brief redirect.html: 102 bytes minified, 106 gzipped. */
+extern const web_asset_t portal_redirect_html;
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <stdint.h>
+
+/**
+ * @file profiler.h
+ * @brief Periodic per-task CPU, stack and heap profile.
+ *
+ * The profiler task samples the FreeRTOS task list every PROFILER_INTERVAL_MS: the CPU share
+ * each task used since the previous sample (run-time stats), its lowest free stack, and the
+ * internal and DMA-capable heap with the largest free block and the resulting fragmentation.
+ * The last PROFILER_HISTORY samples are kept in a ring. Every sample updates the
+ * task_cpu_permille and task_stack_free_bytes gauges (labelled by task) and the heap gauges
+ * of the metrics registry; every PROFILER_LOG_EVERY samples a table goes to the console.
+ *
+ * Needs CONFIG_FREERTOS_USE_TRACE_FACILITY; without CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS
+ * the CPU shares stay 0.
+ */
+
+/** @brief Sampling period in milliseconds. */
+#ifndef PROFILER_INTERVAL_MS
+#define PROFILER_INTERVAL_MS 10000
+#endif
+
+/** @brief Console report every this many samples, 0 for none. */
+#ifndef PROFILER_LOG_EVERY
+#define PROFILER_LOG_EVERY 6
+#endif
+
+/** @brief Samples kept in the history ring. */
+#define PROFILER_HISTORY 12
+
+/** @brief Tasks tracked; further tasks are ignored. */
+#define PROFILER_MAX_TASKS 24
+
+/**
+ * @struct profiler_task_sample_t
+ * @brief One task in a sample.
+ *
+ * @var profiler_task_sample_t::cpu_permille Share of the total CPU time of all cores used
+ * during the sample period, in tenths of a percent
+ * @var profiler_task_sample_t::stack_free Lowest free stack since the task started, bytes
+ */
+typedef struct
+{
+    uint16_t cpu_permille;
+    uint16_t stack_free;
+} profiler_task_sample_t;
+
+/**
+ * @struct profiler_sample_t
+ * @brief One sample of the history ring.
+ *
+ * @var profiler_sample_t::time_us Time of the sample
+ * @var profiler_sample_t::period_us Time since the previous sample
+ * @var profiler_sample_t::heap_internal_free Free internal RAM in bytes
+ * @var profiler_sample_t::heap_dma_free Free DMA-capable RAM in bytes
+ * @var profiler_sample_t::heap_largest_block Largest free internal block in bytes
+ * @var profiler_sample_t::heap_min_free Lowest free internal RAM since boot in bytes
+ * @var profiler_sample_t::fragmentation_pct Share of free internal RAM outside the largest
+ * block
+ * @var profiler_sample_t::task_count Number of valid task slots
+ * @var profiler_sample_t::tasks Tasks by slot, see profiler_task_name(); a slot whose task
+ * is gone has all fields 0
+ */
+typedef struct
+{
+    int64_t time_us;
+    uint32_t period_us;
+    uint32_t heap_internal_free;
+    uint32_t heap_dma_free;
+    uint32_t heap_largest_block;
+    uint32_t heap_min_free;
+    uint8_t fragmentation_pct;
+    uint8_t task_count;
+    profiler_task_sample_t tasks[PROFILER_MAX_TASKS];
+} profiler_sample_t;
+
+/**
+ * @brief FreeRTOS task that takes the samples.
+ *
+ * @param pvParameters Task parameters (unused)
+ */
+void profiler_task(void* pvParameters);
+
+/**
+ * @brief Copies the most recent samples.
+ *
+ * @param out Destination, newest sample first
+ * @param max Capacity of out
+ * @return int Number of samples copied.
+ */
+int profiler_get_history(profiler_sample_t* out, int max);
+
+/**
+ * @brief Returns the name of the task in a slot.
+ *
+ * @param slot Slot below profiler_sample_t::task_count
+ * @return const char* Task name.
+ */
+const char* profiler_task_name(int slot);
+
+/**
+ * @brief Writes the latest sample to the console as a table.
+ */
+void profiler_log_report(void);
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "esp_err.h"
+#include "sensor_sched.h"
+
+/**
+ * @file sensor.h
+ * @brief Sensor sampling task.
+ *
+ * Runs the sensor scheduler (see sensor_sched.h) in a single FreeRTOS task. Decoded values
+ * are staged in the offline Firebase queue as "<path>/<value name>", and every sampling pass
+ * ends with one queue flush, so sensors sampled together share one PATCH request. Every
+ * published value is also announced as an EVENT_SENSOR_VALUE on the event bus.
+ */
+
+/**
+ * @brief Adds a sensor to the sampling schedule.
+ *
+ * Must be called before sensor_task() is started.
+ *
+ * @param driver Driver operations
+ * @param ctx Driver context, must stay valid forever
+ * @param path Database path for the values (e.g., "DHT11"), must stay valid forever
+ * @param interval_ms Sampling interval
+ * @param report Reporting policy (copied), or NULL to publish every sample
+ * @return esp_err_t ESP_OK on success, ESP_FAIL if the schedule is full or the driver
+ * init failed.
+ */
+esp_err_t sensor_register(const sensor_driver_t* driver, void* ctx, const char* path,
+                          uint32_t interval_ms, const sensor_report_cfg_t* report);
+
+/**
+ * @struct sensor_stats_t
+ * @brief Counters summed over all registered sensors.
+ *
+ * @var sensor_stats_t::reads Successful samples
+ * @var sensor_stats_t::failures Failed reads or decodes
+ * @var sensor_stats_t::sent Values queued for upload
+ * @var sensor_stats_t::suppressed Values held back by the reporting policies
+ */
+typedef struct
+{
+    uint32_t reads;
+    uint32_t failures;
+    uint32_t sent;
+    uint32_t suppressed;
+} sensor_stats_t;
+
+/**
+ * @brief Copies the sensor counters.
+ *
+ * @param out Destination for the snapshot.
+ */
+void sensor_get_stats(sensor_stats_t* out);
+
+/**
+ * @brief FreeRTOS task that samples all registered sensors.
+ *
+ * @param pvParameters Task parameters (unused)
+ */
+void sensor_task(void* pvParameters);
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @file sensor_report.h
+ * @brief Reporting policy deciding which sensor samples are worth uploading.
+ *
+ * Each reported quantity (channel) optionally passes through a moving-average or median
+ * filter, and the filtered value is only reported when it moved by at least the deadband
+ * since the last report, or when the channel has been silent for the heartbeat interval.
+ * Sampling can then run faster than the upload rate without adding network traffic. The
+ * policy has no platform dependencies.
+ */
+
+/** @brief Maximum filter window length. */
+#define SENSOR_FILTER_MAX_LEN 5
+
+/** @brief Maximum number of channels per policy, matches SENSOR_MAX_VALUES. */
+#define SENSOR_REPORT_MAX_CHANNELS 4
+
+/**
+ * @brief Filter applied to raw samples before the deadband check.
+ */
+typedef enum
+{
+    SENSOR_FILTER_NONE,
+    SENSOR_FILTER_MEAN,
+    SENSOR_FILTER_MEDIAN,
+} sensor_filter_t;
+
+/**
+ * @struct sensor_report_cfg_t
+ * @brief Reporting policy of one sensor.
+ *
+ * @var sensor_report_cfg_t::deadband Minimum change to report, per channel; 0 reports any
+ * change
+ * @var sensor_report_cfg_t::heartbeat_ms Maximum time without a report, 0 to disable
+ * @var sensor_report_cfg_t::filter Filter type
+ * @var sensor_report_cfg_t::filter_len Filter window length (1..SENSOR_FILTER_MAX_LEN)
+ */
+typedef struct
+{
+    float deadband[SENSOR_REPORT_MAX_CHANNELS];
+    uint32_t heartbeat_ms;
+    sensor_filter_t filter;
+    uint8_t filter_len;
+} sensor_report_cfg_t;
+
+/**
+ * @struct sensor_channel_t
+ * @brief Filter and reporting state of one channel.
+ */
+typedef struct
+{
+    float window[SENSOR_FILTER_MAX_LEN];
+    uint8_t filled;
+    uint8_t next;
+    bool reported;
+    float last_value;
+    int64_t last_report_ms;
+    uint32_t sent;
+    uint32_t suppressed;
+} sensor_channel_t;
+
+/**
+ * @brief Resets a channel to its initial state; the next sample is always reported.
+ */
+void sensor_channel_reset(sensor_channel_t* channel);
+
+/**
+ * @brief Feeds a sample through the filter and applies the reporting policy.
+ *
+ * @param channel Channel state
+ * @param cfg Policy of the sensor the channel belongs to
+ * @param index Channel index, selects the deadband
+ * @param sample Raw sample
+ * @param now_ms Sample time
+ * @param out Receives the filtered value when it should be reported
+ * @return true if the value should be reported.
+ */
+bool sensor_channel_update(sensor_channel_t* channel, const sensor_report_cfg_t* cfg, int index,
+                           float sample, int64_t now_ms, float* out);
@@ -0,0 +1,153 @@
+#pragma once
+
+#include "sensor_report.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @file sensor_sched.h
+ * @brief Sampling scheduler for polled sensors.
+ *
+ * Sensors are described by a driver vtable and a driver-owned context. The scheduler keeps
+ * them in a min-heap ordered by their next due time and runs every sensor that is due in one
+ * pass, so a single task serves any number of sensors. All schedules share one epoch and
+ * advance in whole intervals, so sensors whose intervals are multiples of each other come
+ * due at the same moment and their values go out in one flush. An optional reporting policy
+ * (see sensor_report.h) filters the decoded values before they are published, so sensors can
+ * be sampled faster than they are uploaded. The scheduler takes the current time as a
+ * parameter and has no platform dependencies.
+ */
+
+/** @brief Maximum number of sensors per scheduler. */
+#define SENSOR_MAX 8
+
+/** @brief Maximum number of values one sensor can report per sample. */
+#define SENSOR_MAX_VALUES SENSOR_REPORT_MAX_CHANNELS
+
+/** @brief Sensors due within this window of each other are sampled in the same pass. */
+#define SENSOR_ALIGN_WINDOW_MS 1000
+
+/**
+ * @struct sensor_value_t
+ * @brief One decoded quantity.
+ *
+ * @var sensor_value_t::name Name of the quantity (e.g., "temperature")
+ * @var sensor_value_t::value Decoded value
+ */
+typedef struct
+{
+    const char* name;
+    float value;
+} sensor_value_t;
+
+/**
+ * @struct sensor_driver_t
+ * @brief Operations implemented by a sensor driver.
+ *
+ * All operations return a negative value on failure.
+ *
+ * @var sensor_driver_t::name Driver name used in logs
+ * @var sensor_driver_t::init Prepares the hardware; called once when the sensor is added
+ * @var sensor_driver_t::read Takes a sample and keeps the raw data in the context
+ * @var sensor_driver_t::decode Converts the last sample into values, returns their number
+ */
+typedef struct
+{
+    const char* name;
+    int (*init)(void* ctx);
+    int (*read)(void* ctx);
+    int (*decode)(void* ctx, sensor_value_t* values, int max_values);
+} sensor_driver_t;
+
+/**
+ * @struct sensor_t
+ * @brief A scheduled sensor instance.
+ *
+ * @var sensor_t::driver Driver operations
+ * @var sensor_t::ctx Driver context passed to every operation
+ * @var sensor_t::path Database path under which the values are published
+ * @var sensor_t::interval_ms Sampling interval
+ * @var sensor_t::next_due_ms Time of the next sample
+ * @var sensor_t::has_report True if the values pass through the reporting policy
+ * @var sensor_t::report Reporting policy
+ * @var sensor_t::channels Reporting state per value
+ * @var sensor_t::reads Successful samples
+ * @var sensor_t::failures Failed reads or decodes
+ * @var sensor_t::sent Values published
+ * @var sensor_t::suppressed Values held back by the reporting policy
+ */
+typedef struct
+{
+    const sensor_driver_t* driver;
+    void* ctx;
+    const char* path;
+    uint32_t interval_ms;
+    int64_t next_due_ms;
+    bool has_report;
+    sensor_report_cfg_t report;
+    sensor_channel_t channels[SENSOR_MAX_VALUES];
+    uint32_t reads;
+    uint32_t failures;
+    uint32_t sent;
+    uint32_t suppressed;
+} sensor_t;
+
+/** @brief Called for every decoded value; index is the value's position in the decode. */
+typedef void (*sensor_publish_cb_t)(const sensor_t* sensor, int index,
+                                    const sensor_value_t* value, void* user_ctx);
+
+/** @brief Called once at the end of a pass that published at least one value. */
+typedef void (*sensor_flush_cb_t)(void* user_ctx);
+
+/**
+ * @struct sensor_sched_t
+ * @brief Scheduler state. Treat as opaque.
+ */
+typedef struct
+{
+    sensor_t sensors[SENSOR_MAX];
+    int heap[SENSOR_MAX];
+    int count;
+    int64_t epoch_ms;
+    sensor_publish_cb_t publish;
+    sensor_flush_cb_t flush;
+    void* user_ctx;
+} sensor_sched_t;
+
+/**
+ * @brief Initializes an empty scheduler.
+ *
+ * @param sched Scheduler to initialize
+ * @param epoch_ms Common start of all schedules; sensors first come due at this time
+ * @param publish Callback for decoded values
+ * @param flush Callback at the end of a pass, may be NULL
+ * @param user_ctx Passed to both callbacks
+ */
+void sensor_sched_init(sensor_sched_t* sched, int64_t epoch_ms, sensor_publish_cb_t publish,
+                       sensor_flush_cb_t flush, void* user_ctx);
+
+/**
+ * @brief Initializes a sensor and adds it to the schedule.
+ *
+ * @param sched Scheduler
+ * @param driver Driver operations
+ * @param ctx Driver context, must stay valid while scheduled
+ * @param path Database path for the values, must stay valid while scheduled
+ * @param interval_ms Sampling interval, greater than zero
+ * @param report Reporting policy (copied), or NULL to publish every sample
+ * @param now_ms Current time
+ * @return int The sensor index, or -1 if the scheduler is full, the interval is zero or the
+ * driver init failed.
+ */
+int sensor_sched_add(sensor_sched_t* sched, const sensor_driver_t* driver, void* ctx,
+                     const char* path, uint32_t interval_ms, const sensor_report_cfg_t* report,
+                     int64_t now_ms);
+
+/**
+ * @brief Samples every sensor that is due and reschedules it.
+ *
+ * @param sched Scheduler
+ * @param now_ms Current time
+ * @return int64_t Time the next sensor comes due, or INT64_MAX if no sensor is scheduled.
+ */
+int64_t sensor_sched_run(sensor_sched_t* sched, int64_t now_ms);
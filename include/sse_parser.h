@@ -0,0 +1,134 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @file sse_parser.h
+ * @brief Incremental Server-Sent Events (text/event-stream) parser.
+ *
+ * The parser works on a caller-provided buffer. Network reads go straight into the free
+ * space of that buffer (see sse_parser_write_ptr()), and lines are split in place, so event
+ * data is handed to the callback without being copied. Multi-line `data:` fields are joined
+ * with '\n' by moving them together inside the buffer. Events that do not fit in the buffer
+ * are dropped and reported with the truncated flag set. The parser has no platform
+ * dependencies.
+ */
+
+/** @brief Maximum length of an event name, including the terminating NUL. */
+#define SSE_EVENT_NAME_MAX 24
+
+/**
+ * @struct sse_event_t
+ * @brief A complete event handed to the callback.
+ *
+ * Both strings point into the parser buffer and are only valid during the callback. The
+ * callback may modify data in place (e.g. to split it into NUL-terminated fields).
+ *
+ * @var sse_event_t::event NUL-terminated event name ("message" if the event had none)
+ * @var sse_event_t::data NUL-terminated data, multiple data lines joined with '\n'
+ * @var sse_event_t::data_len Length of data in bytes
+ * @var sse_event_t::truncated True if the event did not fit in the buffer; data is then empty
+ */
+typedef struct
+{
+    const char* event;
+    char* data;
+    size_t data_len;
+    bool truncated;
+} sse_event_t;
+
+/**
+ * @brief Callback invoked for every complete event.
+ *
+ * @param event The parsed event
+ * @param user_ctx Context pointer given to sse_parser_init()
+ */
+typedef void (*sse_event_cb_t)(const sse_event_t* event, void* user_ctx);
+
+/**
+ * @struct sse_parser_t
+ * @brief Parser state. Treat the fields as private except for the statistics.
+ *
+ * @var sse_parser_t::events Number of events dispatched
+ * @var sse_parser_t::overflows Number of events dropped because they exceeded the buffer
+ * @var sse_parser_t::bytes Number of bytes parsed
+ */
+typedef struct
+{
+    char* buf;
+    size_t cap;
+    size_t len;
+    size_t line_start;
+    size_t scan_pos;
+    size_t data_start;
+    size_t data_len;
+    bool has_data;
+    bool discarding;
+    bool skip_line;
+    char event[SSE_EVENT_NAME_MAX];
+    sse_event_cb_t cb;
+    void* user_ctx;
+    uint32_t events;
+    uint32_t overflows;
+    uint64_t bytes;
+} sse_parser_t;
+
+/**
+ * @brief Initializes a parser on top of a caller-owned buffer.
+ *
+ * The buffer bounds the size of a single event (all of its data lines plus the line being
+ * received).
+ *
+ * @param parser Parser to initialize
+ * @param buf Working buffer
+ * @param cap Size of buf in bytes
+ * @param cb Callback invoked for each event
+ * @param user_ctx Opaque pointer passed to the callback
+ */
+void sse_parser_init(sse_parser_t* parser, char* buf, size_t cap, sse_event_cb_t cb,
+                     void* user_ctx);
+
+/**
+ * @brief Discards any partially received event, e.g. after a reconnect.
+ *
+ * Statistics are kept.
+ *
+ * @param parser Parser to reset
+ */
+void sse_parser_reset(sse_parser_t* parser);
+
+/**
+ * @brief Returns where the next network read should be stored.
+ *
+ * Compacts the buffer first if needed. If a pending event fills the whole buffer, the event
+ * is dropped so that reading can continue.
+ *
+ * @param parser The parser
+ * @param avail Set to the number of bytes that may be written at the returned pointer
+ * @return Pointer into the parser buffer
+ */
+char* sse_parser_write_ptr(sse_parser_t* parser, size_t* avail);
+
+/**
+ * @brief Parses bytes previously written at sse_parser_write_ptr().
+ *
+ * @param parser The parser
+ * @param len Number of bytes written (must not exceed the reported avail)
+ * @return Number of events dispatched
+ */
+int sse_parser_commit(sse_parser_t* parser, size_t len);
+
+/**
+ * @brief Copies data into the parser and parses it.
+ *
+ * Convenience wrapper around sse_parser_write_ptr()/sse_parser_commit() for callers that
+ * already hold the data in their own buffer.
+ *
+ * @param parser The parser
+ * @param data Bytes to parse
+ * @param len Number of bytes
+ * @return Number of events dispatched
+ */
+int sse_parser_feed(sse_parser_t* parser, const char* data, size_t len);
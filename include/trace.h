@@ -0,0 +1,113 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @file trace.h
+ * @brief Cycle-stamped event tracing of the hot paths.
+ *
+ * Each core records into its own ring of fixed-size records (cycle count, event, phase,
+ * argument, task), claimed with one atomic increment, so recording takes no lock and is
+ * safe from ISRs. When the ring is full the oldest records are overwritten. The TRACE_*
+ * macros compile to nothing unless TRACE_ENABLE is 1, so instrumented code costs nothing in
+ * normal builds.
+ *
+ * trace_dump() writes the rings in a compact binary format, also served as GET /trace.bin;
+ * tools/trace2json.py converts it to Chrome trace JSON for chrome://tracing or Perfetto.
+ *
+ * Format (little endian): header "TRC1", u16 version, u16 record size, u32 ticks per
+ * microsecond, u16 cores, u16 event names; each name as u8 length and bytes; then per core
+ * u32 anchor cycles, i64 anchor microseconds (taken together on that core), u32 record
+ * count and the records, oldest first.
+ */
+
+/** @brief Records per core; a power of two. */
+#ifndef TRACE_RING_LEN
+#define TRACE_RING_LEN 512
+#endif
+
+#ifndef TRACE_ENABLE
+#define TRACE_ENABLE 0
+#endif
+
+/** @brief Traced events. Names for the dump are in trace.c. */
+typedef enum
+{
+    TRACE_STREAM_READ,     ///< Instant: esp_http_client_read() returned, arg = bytes
+    TRACE_SSE_PARSE,       ///< Span: newline scan and event dispatch of a read, arg = bytes
+    TRACE_STREAM_DISPATCH, ///< Span: handlers of one put/patch event, arg = JSON length
+    TRACE_RELAY_SET,       ///< Span: set_relay_state(), arg = state
+    TRACE_RELAY_APPLY,     ///< Instant: button task applies a remote command, arg = state
+    TRACE_GPIO_WRITE,      ///< Instant: actuator output edge, arg = gpio << 1 | level
+    TRACE_BUTTON_EDGE,     ///< Instant: button interrupt, arg = button
+    TRACE_HTTP_REQUEST,    ///< Span: one REST transaction, arg = method
+    TRACE_EVENT_COUNT,
+} trace_event_t;
+
+/** @brief Phase of a record. */
+typedef enum
+{
+    TRACE_PHASE_INSTANT,
+    TRACE_PHASE_BEGIN,
+    TRACE_PHASE_END,
+} trace_phase_t;
+
+/**
+ * @struct trace_record_t
+ * @brief One trace record.
+ *
+ * @var trace_record_t::cycles Low 32 bits of the core's cycle counter
+ * @var trace_record_t::arg Event argument
+ * @var trace_record_t::event trace_event_t
+ * @var trace_record_t::phase trace_phase_t
+ * @var trace_record_t::task Current task handle (low 32 bits), identifies the thread
+ */
+typedef struct
+{
+    uint32_t cycles;
+    uint32_t arg;
+    uint16_t event;
+    uint8_t phase;
+    uint8_t reserved;
+    uint32_t task;
+} trace_record_t;
+
+#if TRACE_ENABLE
+#define TRACE_INSTANT(event, arg) trace_record((event), TRACE_PHASE_INSTANT, (uint32_t)(arg))
+#define TRACE_BEGIN(event, arg) trace_record((event), TRACE_PHASE_BEGIN, (uint32_t)(arg))
+#define TRACE_END(event, arg) trace_record((event), TRACE_PHASE_END, (uint32_t)(arg))
+#else
+#define TRACE_INSTANT(event, arg) ((void)0)
+#define TRACE_BEGIN(event, arg) ((void)0)
+#define TRACE_END(event, arg) ((void)0)
+#endif
+
+/**
+ * @brief Appends a record to the current core's ring. Use the TRACE_* macros instead.
+ *
+ * @param event trace_event_t
+ * @param phase trace_phase_t
+ * @param arg Event argument
+ */
+void trace_record(uint16_t event, uint8_t phase, uint32_t arg);
+
+/**
+ * @brief Registers GET /trace.bin with the web server. Does nothing unless TRACE_ENABLE.
+ */
+void trace_init(void);
+
+/** @brief Receives chunks of the dump; returns false to stop. */
+typedef bool (*trace_write_cb_t)(void* ctx, const void* data, size_t len);
+
+/**
+ * @brief Writes all rings in the binary trace format.
+ *
+ * Recording is paused while the rings are copied out and resumes afterwards.
+ *
+ * @param write Called for every chunk
+ * @param ctx Passed to write
+ * @return bool False if write stopped the output.
+ */
+bool trace_dump(trace_write_cb_t write, void* ctx);
@@ -0,0 +1,75 @@
+#pragma once
+
+#include "esp_err.h"
+#include "esp_http_server.h"
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @file web_server.h
+ * @brief The device's single HTTP server, shared by the captive portal and diagnostics.
+ *
+ * The ESP32 can only run one server on port 80, and every httpd instance costs a task and
+ * its sockets, so modules register their URIs here instead of starting their own server.
+ * Registrations made before web_server_start() are kept and installed, in registration
+ * order, when the server starts. The first matching handler wins, so modules with exact URIs
+ * should register before the captive portal installs its wildcard catch-all.
+ */
+
+/** @brief Maximum number of URI handlers of all modules together. */
+#define WEB_SERVER_MAX_HANDLERS 16
+
+/**
+ * @struct web_asset_t
+ * @brief A static file kept in flash, usually generated by tools/gen_assets.py.
+ *
+ * @var web_asset_t::content_type Content-Type of the file
+ * @var web_asset_t::plain Minified content, for clients without gzip
+ * @var web_asset_t::plain_len Length of plain
+ * @var web_asset_t::gzip Gzip-compressed content, or NULL if compression does not pay off
+ * @var web_asset_t::gzip_len Length of gzip
+ * @var web_asset_t::etag Quoted ETag of the content, or NULL for responses not to be cached
+ */
+typedef struct
+{
+    const char* content_type;
+    const uint8_t* plain;
+    size_t plain_len;
+    const uint8_t* gzip;
+    size_t gzip_len;
+    const char* etag;
+} web_asset_t;
+
+/**
+ * @brief Starts the server on port 80. Further calls do nothing.
+ *
+ * @return esp_err_t ESP_OK if the server is running, or the httpd error.
+ */
+esp_err_t web_server_start(void);
+
+/**
+ * @brief Registers a URI handler, now or when the server starts.
+ *
+ * @param uri URI, may end in '*' (wildcard match); must stay valid forever
+ * @param method HTTP method
+ * @param handler Request handler
+ * @param ctx Passed to the handler as req->user_ctx
+ * @return esp_err_t ESP_OK on success, ESP_ERR_NO_MEM if the table is full, or the httpd
+ * error.
+ */
+esp_err_t web_server_register(const char* uri, httpd_method_t method,
+                              esp_err_t (*handler)(httpd_req_t* req), void* ctx);
+
+/**
+ * @brief Sends a static asset as the response.
+ *
+ * The gzip copy is sent with Content-Encoding: gzip when the request accepts it. Assets with
+ * an ETag are sent with Cache-Control: no-cache, so browsers keep them and revalidate, and a
+ * request whose If-None-Match holds the ETag gets an empty 304 Not Modified. Status and
+ * headers set by the caller before are kept.
+ *
+ * @param req Request
+ * @param asset Asset to send
+ * @return esp_err_t Result of the send.
+ */
+esp_err_t web_server_send_asset(httpd_req_t* req, const web_asset_t* asset);
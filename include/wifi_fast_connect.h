@@ -0,0 +1,64 @@
+#pragma once
+
+#include "esp_netif.h"
+#include "esp_wifi.h"
+#include <stdbool.h>
+
+/**
+ * @file wifi_fast_connect.h
+ * @brief Directed reconnects to the last access point, and boot-to-online timing.
+ *
+ * After a connection gets an address, the BSSID and channel of its access point are kept in
+ * NVS (written only when they change). On the next boot wifi_fast_connect_apply() adds them
+ * to the station config, so the driver probes a single channel and associates at once
+ * instead of sweeping all channels first. If the access point has moved, the attempt fails
+ * quickly and the caller drops the hints with wifi_fast_connect_clear() and scans as usual.
+ *
+ * DHCP is shortened by lwIP, which asks for the previous lease directly when built with
+ * CONFIG_LWIP_DHCP_RESTORE_LAST_IP. Building with -D WIFI_STATIC_IP=\"a.b.c.d\" and
+ * WIFI_STATIC_GW skips DHCP altogether; WIFI_STATIC_NETMASK defaults to 255.255.255.0 and
+ * WIFI_STATIC_DNS to the gateway.
+ *
+ * The time from boot to the first address is published as the wifi_boot_to_ip_ms gauge,
+ * labelled with the path that got there ("cached" or "scan").
+ *
+ * The state is not locked: call these before esp_wifi_start() or from the Wi-Fi event
+ * handler, which is where wifi_provisioning calls them, its timers included.
+ */
+
+/** @brief NVS namespace of the cached access point. */
+#define WIFI_FAST_CONNECT_NVS_NAMESPACE "wifi_fast"
+
+/**
+ * @brief Loads the cached access point and sets up the static address, if one is built in.
+ *
+ * Call once, after esp_netif_create_default_wifi_sta() and esp_wifi_init().
+ *
+ * @param sta_netif The station interface
+ */
+void wifi_fast_connect_init(esp_netif_t* sta_netif);
+
+/**
+ * @brief Adds the cached BSSID and channel to a station config for the same SSID.
+ *
+ * @param config Station config to connect with
+ * @return bool True if the config now targets the cached access point.
+ */
+bool wifi_fast_connect_apply(wifi_config_t* config);
+
+/**
+ * @brief Removes the BSSID and channel hints from a station config, after a failed attempt.
+ *
+ * @param config Station config to connect with
+ */
+void wifi_fast_connect_clear(wifi_config_t* config);
+
+/**
+ * @brief Remembers the access point of a new connection (WIFI_EVENT_STA_CONNECTED).
+ */
+void wifi_fast_connect_on_connected(const wifi_event_sta_connected_t* event);
+
+/**
+ * @brief Caches the access point and records the boot-to-online time (IP_EVENT_STA_GOT_IP).
+ */
+void wifi_fast_connect_on_got_ip(void);
@@ -0,0 +1,88 @@
+#pragma once
+
+#include "esp_netif.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @file wifi_prov_api.h
+ * @brief Asynchronous provisioning API of the captive portal.
+ *
+ * Registers three endpoints on the web server:
+ * - GET /scan returns the access points of the last background scan as JSON, strongest
+ *   first, and starts a new scan when the result is older than WIFI_PROV_SCAN_MAX_AGE_MS.
+ *   With ?wait=<s> a request made while a scan runs is answered when it ends.
+ * - GET or POST /connect with ssid and password (query string or form body) starts a
+ *   connection job and returns its id at once, with 202 Accepted.
+ * - GET /status?job=<id> reports the job: connecting, connected (with the address) or
+ *   failed (with the reason). With &wait=<s> a connecting job is reported when it finishes,
+ *   or after the wait, so clients can long-poll instead of polling.
+ *
+ * The station connects while the access point keeps running (APSTA), so the phone stays
+ * on the portal and sees the outcome. Waiting requests are parked with the httpd async
+ * handler API and answered by the provisioning task, so they do not hold up the server.
+ * The Wi-Fi events are fed in by wifi_provisioning.
+ */
+
+/** @brief Access points kept from a scan, after merging duplicate SSIDs. */
+#define WIFI_PROV_SCAN_MAX 20
+
+/** @brief Age at which a /scan request starts a new scan. */
+#define WIFI_PROV_SCAN_MAX_AGE_MS 30000
+
+/** @brief Connection attempts of a job before it fails; wrong passwords fail at once. */
+#define WIFI_PROV_CONNECT_ATTEMPTS 3
+
+/** @brief Time after which a connecting job fails. */
+#define WIFI_PROV_CONNECT_TIMEOUT_MS 20000
+
+/** @brief Longest wait a long-poll request can ask for. */
+#define WIFI_PROV_WAIT_MAX_MS 20000
+
+/** @brief Requests that can wait at the same time; further ones are answered at once. */
+#define WIFI_PROV_MAX_WAITERS 4
+
+/**
+ * @brief Creates the job state and the task that answers waiting requests.
+ *
+ * The Wi-Fi event handlers write the state through the functions below, so call this
+ * before they are registered. Further calls do nothing.
+ */
+void wifi_prov_api_init(void);
+
+/**
+ * @brief Registers the endpoints and starts the first scan. Further calls only scan.
+ *
+ * Call after wifi_prov_api_init(), before the portal's wildcard handler is registered, and
+ * with Wi-Fi started in APSTA mode.
+ */
+void wifi_prov_api_start(void);
+
+/**
+ * @brief Collects the results of a finished scan (WIFI_EVENT_SCAN_DONE).
+ */
+void wifi_prov_api_on_scan_done(void);
+
+/**
+ * @brief Handles a station disconnect (WIFI_EVENT_STA_DISCONNECTED).
+ *
+ * @param reason Disconnect reason from the event
+ * @return bool True if a connection job is running; it retries or fails by itself, so the
+ * caller must not reconnect.
+ */
+bool wifi_prov_api_on_disconnected(uint16_t reason);
+
+/**
+ * @brief Handles the station getting an address (IP_EVENT_STA_GOT_IP).
+ *
+ * @param ip The address
+ * @return bool True if this completed a connection job.
+ */
+bool wifi_prov_api_on_got_ip(const esp_ip4_addr_t* ip);
+
+/**
+ * @brief Tells whether the portal is using the station, so other connects should wait.
+ *
+ * @return bool True while a connection job or a scan runs.
+ */
+bool wifi_prov_api_busy(void);
@@ -21,7 +21,19 @@
  *
  * If credentials are stored, it will:
  * - Start WiFi in STA mode
- * - Attempt connection to the saved network
+ * - Connect to the saved network, directly to its last access point when that is known
+ *   (wifi_fast_connect.h), otherwise after a full scan
+ * - Retry failed connections with exponential backoff (1 s doubling up to 60 s); the portal
+ *   only opens when the device has not been online since boot and 7 attempts failed. The
+ *   retries go on next to the portal, which closes as soon as the saved network is back
  * - Start application tasks (DHT11 reading, Firebase, buttons, etc.) after successful connection
  */
 void wifi_provisioning_start(void);
+
+/**
+ * @brief Starts the application tasks (sensors, Firebase, buttons).
+ *
+ * Implemented by the application (main.c). Provisioning calls it once, when the station
+ * first gets an IP address.
+ */
+void start_application_tasks(void);
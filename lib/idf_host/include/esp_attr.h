@@ -0,0 +1,11 @@
+#pragma once
+
+/**
+ * @file esp_attr.h
+ * @brief Host build: placement attributes have no meaning off-target.
+ */
+
+#define IRAM_ATTR
+#define DRAM_ATTR
+#define RTC_DATA_ATTR
+#define RTC_NOINIT_ATTR
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <stdint.h>
+
+/**
+ * @file esp_cpu.h
+ * @brief Host build: CPU cycle counter and core number.
+ *
+ * The cycle counter is derived from CLOCK_MONOTONIC and runs at
+ * esp_rom_get_cpu_ticks_per_us() ticks per microsecond. Every thread reports core 0.
+ */
+
+typedef uint32_t esp_cpu_cycle_count_t;
+
+esp_cpu_cycle_count_t esp_cpu_get_cycle_count(void);
+int esp_cpu_get_core_id(void);
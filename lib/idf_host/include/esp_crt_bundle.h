@@ -0,0 +1,10 @@
+#pragma once
+
+#include "esp_err.h"
+
+/**
+ * @file esp_crt_bundle.h
+ * @brief Host build: certificate bundle hook. The host HTTP client only speaks plain HTTP.
+ */
+
+esp_err_t esp_crt_bundle_attach(void* conf);
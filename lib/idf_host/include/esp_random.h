@@ -0,0 +1,10 @@
+#pragma once
+
+#include <stdint.h>
+
+/**
+ * @file esp_random.h
+ * @brief Host build: random numbers from the C library instead of the hardware RNG.
+ */
+
+uint32_t esp_random(void);
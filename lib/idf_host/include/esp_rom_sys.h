@@ -0,0 +1,10 @@
+#pragma once
+
+#include <stdint.h>
+
+/**
+ * @file esp_rom_sys.h
+ * @brief Host build: CPU clock rate as seen by esp_cpu_get_cycle_count().
+ */
+
+uint32_t esp_rom_get_cpu_ticks_per_us(void);
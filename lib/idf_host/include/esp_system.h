@@ -0,0 +1,11 @@
+#pragma once
+
+#include <stdint.h>
+
+/**
+ * @file esp_system.h
+ * @brief Host build: heap statistics from the C library allocator.
+ */
+
+uint32_t esp_get_free_heap_size(void);
+uint32_t esp_get_minimum_free_heap_size(void);
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "esp_err.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @file esp_timer.h
+ * @brief Host build: esp_timer on CLOCK_MONOTONIC with one dispatch thread.
+ *
+ * Callbacks run one at a time on a dedicated thread, like ESP_TIMER_TASK dispatch. Tests can
+ * freeze the clock instead and step it with esp_timer_host_advance().
+ */
+
+typedef struct esp_timer* esp_timer_handle_t;
+typedef void (*esp_timer_cb_t)(void* arg);
+
+typedef enum
+{
+    ESP_TIMER_TASK,
+    ESP_TIMER_ISR,
+} esp_timer_dispatch_t;
+
+typedef struct
+{
+    esp_timer_cb_t callback;
+    void* arg;
+    esp_timer_dispatch_t dispatch_method;
+    const char* name;
+    bool skip_unhandled_events;
+} esp_timer_create_args_t;
+
+int64_t esp_timer_get_time(void);
+esp_err_t esp_timer_create(const esp_timer_create_args_t* create_args, esp_timer_handle_t* out);
+esp_err_t esp_timer_start_once(esp_timer_handle_t timer, uint64_t timeout_us);
+esp_err_t esp_timer_start_periodic(esp_timer_handle_t timer, uint64_t period_us);
+esp_err_t esp_timer_stop(esp_timer_handle_t timer);
+esp_err_t esp_timer_delete(esp_timer_handle_t timer);
+bool esp_timer_is_active(esp_timer_handle_t timer);
+
+/**
+ * @brief Stops the clock at the current time (host build only).
+ *
+ * From then on time only moves in esp_timer_host_advance(); the dispatch thread stays idle.
+ */
+void esp_timer_host_freeze(void);
+
+/**
+ * @brief Moves a frozen clock forward (host build only).
+ *
+ * Timers that fall due run on the calling thread, in order, each with the clock set to its
+ * alarm time.
+ *
+ * @param us Time to advance in microseconds
+ */
+void esp_timer_host_advance(uint64_t us);
@@ -0,0 +1,8 @@
+#pragma once
+
+/**
+ * @file inet.h
+ * @brief Host build: address conversion helpers.
+ */
+
+#include <arpa/inet.h>
@@ -0,0 +1,12 @@
+#pragma once
+
+/**
+ * @file sockets.h
+ * @brief Host build: lwIP's BSD socket API is the POSIX one.
+ */
+
+#include <netinet/in.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
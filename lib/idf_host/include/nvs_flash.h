@@ -0,0 +1,13 @@
+#pragma once
+
+#include "esp_err.h"
+#include "nvs.h"
+
+/**
+ * @file nvs_flash.h
+ * @brief Host build: NVS partition setup.
+ */
+
+esp_err_t nvs_flash_init(void);
+esp_err_t nvs_flash_erase(void);
+esp_err_t nvs_flash_deinit(void);
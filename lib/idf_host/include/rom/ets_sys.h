@@ -0,0 +1,10 @@
+#pragma once
+
+#include <stdint.h>
+
+/**
+ * @file ets_sys.h
+ * @brief Host build: ROM busy-wait delay.
+ */
+
+void ets_delay_us(uint32_t us);
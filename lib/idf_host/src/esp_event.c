@@ -0,0 +1,129 @@
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "esp_event.h"
+#include "esp_log.h"
+#include "freertos/queue.h"
+#include "freertos/task.h"
+
+#define EVENT_QUEUE_LEN 32
+
+static const char* TAG = "event_host";
+
+struct host_handler
+{
+    esp_event_base_t base;
+    int32_t id;
+    esp_event_handler_t fn;
+    void* arg;
+    bool removed;
+    struct host_handler* next;
+};
+
+typedef struct
+{
+    esp_event_base_t base;
+    int32_t id;
+    size_t size;
+    uint8_t data[ESP_EVENT_HOST_DATA_MAX];
+} host_event_t;
+
+static pthread_mutex_t handler_lock = PTHREAD_MUTEX_INITIALIZER;
+static struct host_handler* handlers = NULL;
+static QueueHandle_t event_queue = NULL;
+
+static void
+_event_task(void* arg)
+{
+    (void)arg;
+    host_event_t event;
+
+    while (xQueueReceive(event_queue, &event, portMAX_DELAY) == pdTRUE)
+    {
+        // Handlers are only appended and never freed, so the list can be walked unlocked
+        pthread_mutex_lock(&handler_lock);
+        struct host_handler* h = handlers;
+        pthread_mutex_unlock(&handler_lock);
+
+        for (; h != NULL; h = h->next)
+        {
+            if (h->removed || h->base != event.base
+                || (h->id != ESP_EVENT_ANY_ID && h->id != event.id))
+                continue;
+            h->fn(h->arg, event.base, event.id, event.size > 0 ? event.data : NULL);
+        }
+    }
+}
+
+esp_err_t
+esp_event_loop_create_default(void)
+{
+    if (event_queue != NULL)
+        return ESP_ERR_INVALID_STATE;
+    event_queue = xQueueCreate(EVENT_QUEUE_LEN, sizeof(host_event_t));
+    xTaskCreate(_event_task, "sys_evt", 2304, NULL, 20, NULL);
+    return ESP_OK;
+}
+
+esp_err_t
+esp_event_handler_instance_register(esp_event_base_t event_base, int32_t event_id,
+                                    esp_event_handler_t event_handler, void* event_handler_arg,
+                                    esp_event_handler_instance_t* instance)
+{
+    struct host_handler* h = calloc(1, sizeof(*h));
+    if (h == NULL)
+        return ESP_ERR_NO_MEM;
+    *h = (struct host_handler){
+        .base = event_base, .id = event_id, .fn = event_handler, .arg = event_handler_arg};
+
+    pthread_mutex_lock(&handler_lock);
+    struct host_handler** tail = &handlers;
+    while (*tail != NULL)
+        tail = &(*tail)->next;
+    *tail = h;
+    pthread_mutex_unlock(&handler_lock);
+
+    if (instance != NULL)
+        *instance = h;
+    return ESP_OK;
+}
+
+esp_err_t
+esp_event_handler_register(esp_event_base_t event_base, int32_t event_id,
+                           esp_event_handler_t event_handler, void* event_handler_arg)
+{
+    return esp_event_handler_instance_register(event_base, event_id, event_handler,
+                                               event_handler_arg, NULL);
+}
+
+esp_err_t
+esp_event_handler_instance_unregister(esp_event_base_t event_base, int32_t event_id,
+                                      esp_event_handler_instance_t instance)
+{
+    struct host_handler* h = instance;
+    if (h == NULL || h->base != event_base || h->id != event_id)
+        return ESP_ERR_INVALID_ARG;
+    h->removed = true;
+    return ESP_OK;
+}
+
+esp_err_t
+esp_event_post(esp_event_base_t event_base, int32_t event_id, const void* event_data,
+               size_t event_data_size, TickType_t ticks_to_wait)
+{
+    if (event_queue == NULL)
+        return ESP_ERR_INVALID_STATE;
+    if (event_data_size > ESP_EVENT_HOST_DATA_MAX)
+    {
+        ESP_LOGE(TAG, "Event %s:%d payload of %zu bytes is too large", event_base,
+                 (int)event_id, event_data_size);
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    host_event_t event = {.base = event_base, .id = event_id, .size = event_data_size};
+    if (event_data != NULL)
+        memcpy(event.data, event_data, event_data_size);
+    return xQueueSend(event_queue, &event, ticks_to_wait) == pdTRUE ? ESP_OK : ESP_ERR_TIMEOUT;
+}
@@ -0,0 +1,753 @@
+#define _GNU_SOURCE
+#include <ctype.h>
+#include <errno.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include "esp_http_client.h"
+#include "esp_log.h"
+
+#define HTTP_HOST_MAX 128
+#define HTTP_PATH_MAX 512
+#define HTTP_HEADERS_MAX 16
+#define HTTP_RX_BUF_SIZE 4096
+#define HTTP_LINE_MAX 1024
+#define HTTP_DEFAULT_TIMEOUT_MS 5000
+
+// Results of the low-level receive helpers
+#define RX_OK 1
+#define RX_EOF 0
+#define RX_TIMEOUT -1
+#define RX_ERROR -2
+
+static const char* TAG = "http_client_host";
+
+typedef struct
+{
+    char* key;
+    char* value;
+} http_header_t;
+
+struct esp_http_client
+{
+    char host[HTTP_HOST_MAX];
+    int port;
+    char path[HTTP_PATH_MAX];
+    bool tls;
+    esp_http_client_method_t method;
+    int timeout_ms;
+    bool keep_alive;
+    http_event_handle_cb event_handler;
+    void* user_data;
+    http_header_t headers[HTTP_HEADERS_MAX];
+    const char* post_data;
+    int post_len;
+
+    int sock;
+    char conn_host[HTTP_HOST_MAX];
+    int conn_port;
+
+    int status;
+    int64_t content_length;
+    bool chunked;
+    bool conn_close;
+    bool headers_done;
+    bool body_done;
+    int64_t remaining;
+    bool chunk_crlf;
+
+    char rx[HTTP_RX_BUF_SIZE];
+    int rx_pos;
+    int rx_len;
+};
+
+static const char* method_names[HTTP_METHOD_MAX] = {
+    [HTTP_METHOD_GET] = "GET",       [HTTP_METHOD_POST] = "POST",
+    [HTTP_METHOD_PUT] = "PUT",       [HTTP_METHOD_PATCH] = "PATCH",
+    [HTTP_METHOD_DELETE] = "DELETE", [HTTP_METHOD_HEAD] = "HEAD",
+};
+
+static void
+_dispatch(esp_http_client_handle_t client, esp_http_client_event_id_t id, void* data, int len,
+          char* key, char* value)
+{
+    if (client->event_handler == NULL)
+        return;
+
+    esp_http_client_event_t evt = {
+        .event_id = id,
+        .client = client,
+        .data = data,
+        .data_len = len,
+        .user_data = client->user_data,
+        .header_key = key,
+        .header_value = value,
+    };
+    client->event_handler(&evt);
+}
+
+esp_err_t
+esp_http_client_set_url(esp_http_client_handle_t client, const char* url)
+{
+    const char* p = url;
+    bool tls = false;
+    if (strncmp(p, "http://", 7) == 0)
+    {
+        p += 7;
+    }
+    else if (strncmp(p, "https://", 8) == 0)
+    {
+        p += 8;
+        tls = true;
+    }
+
+    size_t host_len = strcspn(p, ":/?");
+    if (host_len == 0 || host_len >= HTTP_HOST_MAX)
+        return ESP_ERR_INVALID_ARG;
+
+    char host[HTTP_HOST_MAX];
+    memcpy(host, p, host_len);
+    host[host_len] = '\0';
+    p += host_len;
+
+    int port = tls ? 443 : 80;
+    if (*p == ':')
+    {
+        port = atoi(p + 1);
+        p += 1 + strspn(p + 1, "0123456789");
+    }
+
+    const char* path = (*p == '\0') ? "/" : p;
+    if (strlen(path) >= HTTP_PATH_MAX)
+        return ESP_ERR_INVALID_ARG;
+
+    strcpy(client->host, host);
+    client->port = port;
+    client->tls = tls;
+    if (*path == '?')
+        snprintf(client->path, sizeof(client->path), "/%s", path);
+    else
+        strcpy(client->path, path);
+    return ESP_OK;
+}
+
+esp_http_client_handle_t
+esp_http_client_init(const esp_http_client_config_t* config)
+{
+    struct esp_http_client* client = calloc(1, sizeof(*client));
+    if (client == NULL)
+        return NULL;
+
+    client->sock = -1;
+    client->method = config->method;
+    client->timeout_ms = config->timeout_ms > 0 ? config->timeout_ms : HTTP_DEFAULT_TIMEOUT_MS;
+    client->keep_alive = config->keep_alive_enable;
+    client->event_handler = config->event_handler;
+    client->user_data = config->user_data;
+    client->content_length = -1;
+
+    esp_err_t err = ESP_ERR_INVALID_ARG;
+    if (config->url != NULL)
+    {
+        err = esp_http_client_set_url(client, config->url);
+    }
+    else if (config->host != NULL)
+    {
+        char url[HTTP_HOST_MAX + HTTP_PATH_MAX + 32];
+        snprintf(url, sizeof(url), "http://%s:%d%s%s%s", config->host,
+                 config->port > 0 ? config->port : 80, config->path ? config->path : "/",
+                 config->query ? "?" : "", config->query ? config->query : "");
+        err = esp_http_client_set_url(client, url);
+    }
+
+    if (err != ESP_OK)
+    {
+        ESP_LOGE(TAG, "Invalid URL");
+        free(client);
+        return NULL;
+    }
+    return client;
+}
+
+esp_err_t
+esp_http_client_set_method(esp_http_client_handle_t client, esp_http_client_method_t method)
+{
+    client->method = method;
+    return ESP_OK;
+}
+
+esp_err_t
+esp_http_client_delete_header(esp_http_client_handle_t client, const char* key)
+{
+    for (int i = 0; i < HTTP_HEADERS_MAX; i++)
+    {
+        if (client->headers[i].key != NULL && strcasecmp(client->headers[i].key, key) == 0)
+        {
+            free(client->headers[i].key);
+            free(client->headers[i].value);
+            client->headers[i].key = NULL;
+            client->headers[i].value = NULL;
+            return ESP_OK;
+        }
+    }
+    return ESP_ERR_NOT_FOUND;
+}
+
+esp_err_t
+esp_http_client_set_header(esp_http_client_handle_t client, const char* key, const char* value)
+{
+    if (value == NULL)
+        return esp_http_client_delete_header(client, key);
+
+    int free_slot = -1;
+    for (int i = 0; i < HTTP_HEADERS_MAX; i++)
+    {
+        if (client->headers[i].key == NULL)
+        {
+            if (free_slot < 0)
+                free_slot = i;
+        }
+        else if (strcasecmp(client->headers[i].key, key) == 0)
+        {
+            char* copy = strdup(value);
+            if (copy == NULL)
+                return ESP_ERR_NO_MEM;
+            free(client->headers[i].value);
+            client->headers[i].value = copy;
+            return ESP_OK;
+        }
+    }
+
+    if (free_slot < 0)
+        return ESP_ERR_NO_MEM;
+    client->headers[free_slot].key = strdup(key);
+    client->headers[free_slot].value = strdup(value);
+    return ESP_OK;
+}
+
+esp_err_t
+esp_http_client_get_header(esp_http_client_handle_t client, const char* key, char** value)
+{
+    *value = NULL;
+    for (int i = 0; i < HTTP_HEADERS_MAX; i++)
+    {
+        if (client->headers[i].key != NULL && strcasecmp(client->headers[i].key, key) == 0)
+            *value = client->headers[i].value;
+    }
+    return ESP_OK;
+}
+
+esp_err_t
+esp_http_client_set_post_field(esp_http_client_handle_t client, const char* data, int len)
+{
+    client->post_data = data;
+    client->post_len = (data != NULL) ? len : 0;
+    return ESP_OK;
+}
+
+esp_err_t
+esp_http_client_set_timeout_ms(esp_http_client_handle_t client, int timeout_ms)
+{
+    client->timeout_ms = timeout_ms;
+    if (client->sock >= 0)
+    {
+        struct timeval tv = {.tv_sec = timeout_ms / 1000, .tv_usec = (timeout_ms % 1000) * 1000};
+        setsockopt(client->sock, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+        setsockopt(client->sock, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+    }
+    return ESP_OK;
+}
+
+esp_err_t
+esp_http_client_set_user_data(esp_http_client_handle_t client, void* data)
+{
+    client->user_data = data;
+    return ESP_OK;
+}
+
+esp_err_t
+esp_http_client_get_user_data(esp_http_client_handle_t client, void** data)
+{
+    *data = client->user_data;
+    return ESP_OK;
+}
+
+esp_err_t
+esp_http_client_close(esp_http_client_handle_t client)
+{
+    if (client->sock >= 0)
+    {
+        close(client->sock);
+        client->sock = -1;
+        _dispatch(client, HTTP_EVENT_DISCONNECTED, NULL, 0, NULL, NULL);
+    }
+    client->rx_pos = 0;
+    client->rx_len = 0;
+    return ESP_OK;
+}
+
+esp_err_t
+esp_http_client_cleanup(esp_http_client_handle_t client)
+{
+    if (client == NULL)
+        return ESP_ERR_INVALID_ARG;
+
+    esp_http_client_close(client);
+    for (int i = 0; i < HTTP_HEADERS_MAX; i++)
+    {
+        free(client->headers[i].key);
+        free(client->headers[i].value);
+    }
+    free(client);
+    return ESP_OK;
+}
+
+static esp_err_t
+_connect(esp_http_client_handle_t client)
+{
+    if (client->tls)
+    {
+        ESP_LOGE(TAG, "https:// is not supported on the host, use a local http:// server");
+        return ESP_ERR_HTTP_INVALID_TRANSPORT;
+    }
+
+    char port[8];
+    snprintf(port, sizeof(port), "%d", client->port);
+    struct addrinfo hints = {.ai_family = AF_UNSPEC, .ai_socktype = SOCK_STREAM};
+    struct addrinfo* res = NULL;
+    if (getaddrinfo(client->host, port, &hints, &res) != 0)
+    {
+        ESP_LOGE(TAG, "Cannot resolve %s", client->host);
+        return ESP_ERR_HTTP_CONNECT;
+    }
+
+    int sock = -1;
+    for (struct addrinfo* ai = res; ai != NULL && sock < 0; ai = ai->ai_next)
+    {
+        sock = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+        if (sock < 0)
+            continue;
+        if (connect(sock, ai->ai_addr, ai->ai_addrlen) != 0)
+        {
+            close(sock);
+            sock = -1;
+        }
+    }
+    freeaddrinfo(res);
+
+    if (sock < 0)
+    {
+        ESP_LOGE(TAG, "Connection to %s:%d failed: %s", client->host, client->port,
+                 strerror(errno));
+        return ESP_ERR_HTTP_CONNECT;
+    }
+
+    int one = 1;
+    setsockopt(sock, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    client->sock = sock;
+    esp_http_client_set_timeout_ms(client, client->timeout_ms);
+    strcpy(client->conn_host, client->host);
+    client->conn_port = client->port;
+    client->rx_pos = 0;
+    client->rx_len = 0;
+
+    _dispatch(client, HTTP_EVENT_ON_CONNECTED, NULL, 0, NULL, NULL);
+    return ESP_OK;
+}
+
+static bool
+_send_all(int sock, const char* data, int len)
+{
+    while (len > 0)
+    {
+        ssize_t sent = send(sock, data, (size_t)len, MSG_NOSIGNAL);
+        if (sent <= 0)
+        {
+            if (sent < 0 && errno == EINTR)
+                continue;
+            return false;
+        }
+        data += sent;
+        len -= (int)sent;
+    }
+    return true;
+}
+
+// Makes unread bytes available in rx; RX_OK, RX_EOF, RX_TIMEOUT or RX_ERROR
+static int
+_rx_fill(esp_http_client_handle_t client)
+{
+    if (client->rx_pos < client->rx_len)
+        return RX_OK;
+
+    client->rx_pos = 0;
+    client->rx_len = 0;
+    // A zero timeout polls, as it does on the device, rather than blocking for good
+    int flags = client->timeout_ms == 0 ? MSG_DONTWAIT : 0;
+    ssize_t n = recv(client->sock, client->rx, sizeof(client->rx), flags);
+    if (n > 0)
+    {
+        client->rx_len = (int)n;
+        return RX_OK;
+    }
+    if (n == 0)
+        return RX_EOF;
+    return (errno == EAGAIN || errno == EWOULDBLOCK) ? RX_TIMEOUT : RX_ERROR;
+}
+
+// Reads one CRLF-terminated line; on timeout nothing is consumed, so it can be retried
+static int
+_read_line(esp_http_client_handle_t client, char* line, size_t line_len)
+{
+    while (true)
+    {
+        char* start = client->rx + client->rx_pos;
+        char* nl = memchr(start, '\n', (size_t)(client->rx_len - client->rx_pos));
+        if (nl != NULL)
+        {
+            size_t len = (size_t)(nl - start);
+            if (len > 0 && start[len - 1] == '\r')
+                len--;
+            if (len >= line_len)
+                return RX_ERROR;
+            memcpy(line, start, len);
+            line[len] = '\0';
+            client->rx_pos += (int)(nl - start) + 1;
+            return RX_OK;
+        }
+
+        // Keep the partial line at the front and append to it
+        int pending = client->rx_len - client->rx_pos;
+        if (pending >= (int)sizeof(client->rx))
+            return RX_ERROR;
+        memmove(client->rx, start, (size_t)pending);
+        client->rx_pos = 0;
+        client->rx_len = pending;
+
+        int flags = client->timeout_ms == 0 ? MSG_DONTWAIT : 0;
+        ssize_t n = recv(client->sock, client->rx + pending, sizeof(client->rx) - pending, flags);
+        if (n == 0)
+            return RX_EOF;
+        if (n < 0)
+            return (errno == EAGAIN || errno == EWOULDBLOCK) ? RX_TIMEOUT : RX_ERROR;
+        client->rx_len += (int)n;
+    }
+}
+
+esp_err_t
+esp_http_client_open(esp_http_client_handle_t client, int write_len)
+{
+    // A connection can only be reused if the previous response was read completely
+    if (client->sock >= 0
+        && (!client->keep_alive || client->conn_close || !client->body_done
+            || strcmp(client->conn_host, client->host) != 0 || client->conn_port != client->port))
+        esp_http_client_close(client);
+
+    if (client->sock < 0)
+    {
+        esp_err_t err = _connect(client);
+        if (err != ESP_OK)
+            return err;
+    }
+
+    char request[HTTP_PATH_MAX + HTTP_HOST_MAX + 2048];
+    int len = snprintf(request, sizeof(request),
+                       "%s %s HTTP/1.1\r\nHost: %s:%d\r\nUser-Agent: ESP32 HTTP Client/1.0\r\n"
+                       "Connection: %s\r\n",
+                       method_names[client->method], client->path, client->host, client->port,
+                       client->keep_alive ? "keep-alive" : "close");
+    if (write_len > 0)
+        len += snprintf(request + len, sizeof(request) - len, "Content-Length: %d\r\n", write_len);
+    for (int i = 0; i < HTTP_HEADERS_MAX; i++)
+    {
+        if (client->headers[i].key != NULL && len < (int)sizeof(request))
+            len += snprintf(request + len, sizeof(request) - len, "%s: %s\r\n",
+                            client->headers[i].key, client->headers[i].value);
+    }
+    if (len + 2 >= (int)sizeof(request))
+        return ESP_ERR_INVALID_SIZE;
+    len += snprintf(request + len, sizeof(request) - len, "\r\n");
+
+    client->status = 0;
+    client->content_length = -1;
+    client->chunked = false;
+    client->conn_close = !client->keep_alive;
+    client->headers_done = false;
+    client->body_done = false;
+    client->remaining = 0;
+    client->chunk_crlf = false;
+
+    if (!_send_all(client->sock, request, len))
+    {
+        esp_http_client_close(client);
+        return ESP_ERR_HTTP_WRITE_DATA;
+    }
+
+    _dispatch(client, HTTP_EVENT_HEADERS_SENT, NULL, 0, NULL, NULL);
+    return ESP_OK;
+}
+
+int
+esp_http_client_write(esp_http_client_handle_t client, const char* buffer, int len)
+{
+    if (client->sock < 0 || !_send_all(client->sock, buffer, len))
+        return -1;
+    return len;
+}
+
+int64_t
+esp_http_client_fetch_headers(esp_http_client_handle_t client)
+{
+    char line[HTTP_LINE_MAX];
+
+    if (client->sock < 0)
+        return ESP_FAIL;
+
+    // Skip interim 1xx responses
+    do
+    {
+        if (_read_line(client, line, sizeof(line)) != RX_OK)
+            return ESP_FAIL;
+        if (sscanf(line, "HTTP/%*d.%*d %d", &client->status) != 1)
+            return ESP_FAIL;
+
+        while (true)
+        {
+            if (_read_line(client, line, sizeof(line)) != RX_OK)
+                return ESP_FAIL;
+            if (line[0] == '\0')
+                break;
+
+            char* colon = strchr(line, ':');
+            if (colon == NULL)
+                continue;
+            *colon = '\0';
+            char* value = colon + 1;
+            while (*value == ' ' || *value == '\t')
+                value++;
+
+            if (strcasecmp(line, "Content-Length") == 0)
+                client->content_length = strtoll(value, NULL, 10);
+            else if (strcasecmp(line, "Transfer-Encoding") == 0 && strcasestr(value, "chunked"))
+                client->chunked = true;
+            else if (strcasecmp(line, "Connection") == 0 && strcasecmp(value, "close") == 0)
+                client->conn_close = true;
+
+            _dispatch(client, HTTP_EVENT_ON_HEADER, NULL, 0, line, value);
+        }
+    } while (client->status >= 100 && client->status < 200);
+
+    client->headers_done = true;
+    if (client->method == HTTP_METHOD_HEAD || client->status == 204 || client->status == 304)
+    {
+        client->body_done = true;
+    }
+    else if (client->chunked)
+    {
+        client->content_length = -1;
+        client->remaining = 0;
+    }
+    else if (client->content_length >= 0)
+    {
+        client->remaining = client->content_length;
+        client->body_done = client->remaining == 0;
+    }
+    else
+    {
+        // Body runs until the server closes the connection
+        client->remaining = -1;
+        client->conn_close = true;
+    }
+
+    return client->content_length >= 0 ? client->content_length : 0;
+}
+
+// Reads the next chunk size line (and the CRLF ending the previous chunk)
+static int
+_next_chunk(esp_http_client_handle_t client)
+{
+    char line[64];
+
+    if (client->chunk_crlf)
+    {
+        int rc = _read_line(client, line, sizeof(line));
+        if (rc != RX_OK)
+            return rc;
+        client->chunk_crlf = false;
+    }
+
+    int rc = _read_line(client, line, sizeof(line));
+    if (rc != RX_OK)
+        return rc;
+
+    char* end;
+    long long size = strtoll(line, &end, 16);
+    if (end == line || size < 0)
+        return RX_ERROR;
+
+    if (size == 0)
+    {
+        // Trailer section ends with an empty line
+        do
+        {
+            rc = _read_line(client, line, sizeof(line));
+            if (rc != RX_OK)
+                return rc;
+        } while (line[0] != '\0');
+        client->body_done = true;
+        return RX_OK;
+    }
+
+    client->remaining = size;
+    client->chunk_crlf = true;
+    return RX_OK;
+}
+
+int
+esp_http_client_read(esp_http_client_handle_t client, char* buffer, int len)
+{
+    if (client->sock < 0 || !client->headers_done)
+        return -1;
+
+    int total = 0;
+    int rc = RX_OK;
+    while (total < len && !client->body_done)
+    {
+        if (client->chunked && client->remaining == 0)
+        {
+            rc = _next_chunk(client);
+            if (rc != RX_OK)
+                break;
+            continue;
+        }
+
+        rc = _rx_fill(client);
+        if (rc != RX_OK)
+        {
+            if (rc == RX_EOF && client->remaining < 0)
+            {
+                client->body_done = true;
+                rc = RX_OK;
+            }
+            break;
+        }
+
+        int take = client->rx_len - client->rx_pos;
+        if (take > len - total)
+            take = len - total;
+        if (client->remaining >= 0 && take > client->remaining)
+            take = (int)client->remaining;
+
+        memcpy(buffer + total, client->rx + client->rx_pos, (size_t)take);
+        _dispatch(client, HTTP_EVENT_ON_DATA, buffer + total, take, NULL, NULL);
+        client->rx_pos += take;
+        total += take;
+        if (client->remaining >= 0)
+        {
+            client->remaining -= take;
+            if (!client->chunked && client->remaining == 0)
+                client->body_done = true;
+        }
+    }
+
+    if (total > 0)
+        return total;
+    if (rc == RX_TIMEOUT)
+        return -ESP_ERR_HTTP_EAGAIN;
+    if (rc == RX_EOF)
+    {
+        client->conn_close = true;
+        return 0;
+    }
+    if (rc == RX_ERROR)
+        return -1;
+    return 0;
+}
+
+esp_err_t
+esp_http_client_flush_response(esp_http_client_handle_t client, int* len)
+{
+    char buf[512];
+    int total = 0;
+    int n;
+    while ((n = esp_http_client_read(client, buf, sizeof(buf))) > 0)
+        total += n;
+    if (len != NULL)
+        *len = total;
+    return (n == 0 && client->body_done) ? ESP_OK : ESP_FAIL;
+}
+
+esp_err_t
+esp_http_client_perform(esp_http_client_handle_t client)
+{
+    for (int attempt = 0; attempt < 2; attempt++)
+    {
+        // A kept-alive connection may have been closed by the server since the last request
+        bool reused = client->sock >= 0 && client->keep_alive && !client->conn_close
+                      && client->body_done;
+
+        esp_err_t err = esp_http_client_open(client, client->post_len);
+        if (err != ESP_OK)
+            return err;
+
+        if (client->post_len > 0
+            && esp_http_client_write(client, client->post_data, client->post_len) < 0)
+        {
+            esp_http_client_close(client);
+            if (reused)
+                continue;
+            return ESP_ERR_HTTP_WRITE_DATA;
+        }
+
+        if (esp_http_client_fetch_headers(client) < 0)
+        {
+            esp_http_client_close(client);
+            if (reused)
+                continue;
+            return ESP_ERR_HTTP_FETCH_HEADER;
+        }
+
+        if (esp_http_client_flush_response(client, NULL) != ESP_OK)
+        {
+            esp_http_client_close(client);
+            return ESP_FAIL;
+        }
+
+        _dispatch(client, HTTP_EVENT_ON_FINISH, NULL, 0, NULL, NULL);
+        if (client->conn_close)
+            esp_http_client_close(client);
+        return ESP_OK;
+    }
+    return ESP_ERR_HTTP_CONNECT;
+}
+
+int
+esp_http_client_get_status_code(esp_http_client_handle_t client)
+{
+    return client->status;
+}
+
+int64_t
+esp_http_client_get_content_length(esp_http_client_handle_t client)
+{
+    return client->content_length;
+}
+
+bool
+esp_http_client_is_chunked_response(esp_http_client_handle_t client)
+{
+    return client->chunked;
+}
+
+bool
+esp_http_client_is_complete_data_received(esp_http_client_handle_t client)
+{
+    return client->body_done;
+}
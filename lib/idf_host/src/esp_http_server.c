@@ -0,0 +1,530 @@
+#define _GNU_SOURCE
+#include <errno.h>
+#include <netinet/in.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include "esp_http_server.h"
+#include "esp_log.h"
+
+#define HTTPD_HEADERS_MAX 24
+#define HTTPD_RESP_HEADERS_MAX 8
+#define HTTPD_RX_TIMEOUT_MS 5000
+
+static const char* TAG = "httpd_host";
+
+typedef struct
+{
+    httpd_config_t config;
+    int listen_sock;
+    pthread_t thread;
+    httpd_uri_t* handlers;
+    int handler_count;
+} host_server_t;
+
+// Per-request state behind httpd_req_t::aux
+typedef struct
+{
+    int sock;
+    char head[8192];
+    size_t head_len;
+    char* query;
+    char* header_names[HTTPD_HEADERS_MAX];
+    char* header_values[HTTPD_HEADERS_MAX];
+    int header_count;
+    const char* body_start;
+    size_t body_buffered;
+    size_t body_left;
+    char status[48];
+    char type[64];
+    const char* resp_names[HTTPD_RESP_HEADERS_MAX];
+    const char* resp_values[HTTPD_RESP_HEADERS_MAX];
+    int resp_count;
+    bool headers_sent;
+    bool chunked;
+    bool detached; // Owned by an async copy, which closes the connection
+} host_req_t;
+
+static bool
+_send_all(int sock, const char* buf, size_t len)
+{
+    while (len > 0)
+    {
+        ssize_t n = send(sock, buf, len, MSG_NOSIGNAL);
+        if (n <= 0)
+            return false;
+        buf += n;
+        len -= (size_t)n;
+    }
+    return true;
+}
+
+static bool
+_send_headers(host_req_t* r, ssize_t content_len)
+{
+    char head[1024];
+    int len = snprintf(head, sizeof(head),
+                       "HTTP/1.1 %s\r\nContent-Type: %s\r\nConnection: close\r\n", r->status,
+                       r->type);
+    for (int i = 0; i < r->resp_count; i++)
+    {
+        len += snprintf(head + len, sizeof(head) - len, "%s: %s\r\n", r->resp_names[i],
+                        r->resp_values[i]);
+    }
+    if (content_len >= 0)
+        len += snprintf(head + len, sizeof(head) - len, "Content-Length: %zd\r\n\r\n",
+                        content_len);
+    else
+        len += snprintf(head + len, sizeof(head) - len, "Transfer-Encoding: chunked\r\n\r\n");
+    r->headers_sent = true;
+    return _send_all(r->sock, head, (size_t)len);
+}
+
+esp_err_t
+httpd_resp_set_status(httpd_req_t* req, const char* status)
+{
+    host_req_t* r = req->aux;
+    snprintf(r->status, sizeof(r->status), "%s", status);
+    return ESP_OK;
+}
+
+esp_err_t
+httpd_resp_set_type(httpd_req_t* req, const char* type)
+{
+    host_req_t* r = req->aux;
+    snprintf(r->type, sizeof(r->type), "%s", type);
+    return ESP_OK;
+}
+
+esp_err_t
+httpd_resp_set_hdr(httpd_req_t* req, const char* field, const char* value)
+{
+    host_req_t* r = req->aux;
+    if (r->resp_count >= HTTPD_RESP_HEADERS_MAX)
+        return ESP_ERR_HTTPD_RESP_SEND;
+    // Like the IDF server, the strings are referenced, not copied
+    r->resp_names[r->resp_count] = field;
+    r->resp_values[r->resp_count] = value;
+    r->resp_count++;
+    return ESP_OK;
+}
+
+esp_err_t
+httpd_resp_send(httpd_req_t* req, const char* buf, ssize_t buf_len)
+{
+    host_req_t* r = req->aux;
+    if (buf == NULL)
+        buf_len = 0;
+    else if (buf_len == HTTPD_RESP_USE_STRLEN)
+        buf_len = (ssize_t)strlen(buf);
+
+    if (!_send_headers(r, buf_len) || !_send_all(r->sock, buf, (size_t)buf_len))
+        return ESP_ERR_HTTPD_RESP_SEND;
+    return ESP_OK;
+}
+
+esp_err_t
+httpd_resp_send_chunk(httpd_req_t* req, const char* buf, ssize_t buf_len)
+{
+    host_req_t* r = req->aux;
+    if (buf == NULL)
+        buf_len = 0;
+    else if (buf_len == HTTPD_RESP_USE_STRLEN)
+        buf_len = (ssize_t)strlen(buf);
+
+    if (!r->headers_sent)
+    {
+        r->chunked = true;
+        if (!_send_headers(r, -1))
+            return ESP_ERR_HTTPD_RESP_SEND;
+    }
+
+    char size[16];
+    int len = snprintf(size, sizeof(size), "%zx\r\n", buf_len);
+    if (!_send_all(r->sock, size, (size_t)len) || !_send_all(r->sock, buf, (size_t)buf_len)
+        || !_send_all(r->sock, "\r\n", 2))
+    {
+        return ESP_ERR_HTTPD_RESP_SEND;
+    }
+    return ESP_OK;
+}
+
+esp_err_t
+httpd_resp_send_err(httpd_req_t* req, httpd_err_code_t error, const char* msg)
+{
+    static const char* statuses[] = {
+        [HTTPD_400_BAD_REQUEST] = "400 Bad Request",
+        [HTTPD_404_NOT_FOUND] = "404 Not Found",
+        [HTTPD_405_METHOD_NOT_ALLOWED] = "405 Method Not Allowed",
+        [HTTPD_408_REQ_TIMEOUT] = "408 Request Timeout",
+        [HTTPD_500_INTERNAL_SERVER_ERROR] = "500 Internal Server Error",
+    };
+    httpd_resp_set_status(req, statuses[error]);
+    httpd_resp_set_type(req, "text/plain");
+    return httpd_resp_send(req, msg != NULL ? msg : statuses[error], HTTPD_RESP_USE_STRLEN);
+}
+
+esp_err_t
+httpd_resp_send_404(httpd_req_t* req)
+{
+    return httpd_resp_send_err(req, HTTPD_404_NOT_FOUND, NULL);
+}
+
+size_t
+httpd_req_get_url_query_len(httpd_req_t* req)
+{
+    host_req_t* r = req->aux;
+    return r->query != NULL ? strlen(r->query) : 0;
+}
+
+esp_err_t
+httpd_req_get_url_query_str(httpd_req_t* req, char* buf, size_t buf_len)
+{
+    host_req_t* r = req->aux;
+    if (r->query == NULL)
+        return ESP_ERR_NOT_FOUND;
+    if (strlen(r->query) >= buf_len)
+        return ESP_ERR_HTTPD_RESULT_TRUNC;
+    strcpy(buf, r->query);
+    return ESP_OK;
+}
+
+esp_err_t
+httpd_query_key_value(const char* qry, const char* key, char* val, size_t val_size)
+{
+    size_t key_len = strlen(key);
+    const char* p = qry;
+
+    while (p != NULL && *p != '\0')
+    {
+        const char* end = strchr(p, '&');
+        size_t pair_len = end != NULL ? (size_t)(end - p) : strlen(p);
+        if (pair_len > key_len && strncmp(p, key, key_len) == 0 && p[key_len] == '=')
+        {
+            size_t value_len = pair_len - key_len - 1;
+            size_t copy = value_len < val_size - 1 ? value_len : val_size - 1;
+            memcpy(val, p + key_len + 1, copy);
+            val[copy] = '\0';
+            return copy < value_len ? ESP_ERR_HTTPD_RESULT_TRUNC : ESP_OK;
+        }
+        p = end != NULL ? end + 1 : NULL;
+    }
+    return ESP_ERR_NOT_FOUND;
+}
+
+static const char*
+_header(host_req_t* r, const char* field)
+{
+    for (int i = 0; i < r->header_count; i++)
+    {
+        if (strcasecmp(r->header_names[i], field) == 0)
+            return r->header_values[i];
+    }
+    return NULL;
+}
+
+size_t
+httpd_req_get_hdr_value_len(httpd_req_t* req, const char* field)
+{
+    const char* value = _header(req->aux, field);
+    return value != NULL ? strlen(value) : 0;
+}
+
+esp_err_t
+httpd_req_get_hdr_value_str(httpd_req_t* req, const char* field, char* val, size_t val_size)
+{
+    const char* value = _header(req->aux, field);
+    if (value == NULL)
+        return ESP_ERR_NOT_FOUND;
+    snprintf(val, val_size, "%s", value);
+    return strlen(value) >= val_size ? ESP_ERR_HTTPD_RESULT_TRUNC : ESP_OK;
+}
+
+int
+httpd_req_recv(httpd_req_t* req, char* buf, size_t buf_len)
+{
+    host_req_t* r = req->aux;
+    if (r->body_left == 0)
+        return 0;
+    if (buf_len > r->body_left)
+        buf_len = r->body_left;
+
+    // Body bytes that arrived with the headers come first
+    if (r->body_buffered > 0)
+    {
+        size_t n = buf_len < r->body_buffered ? buf_len : r->body_buffered;
+        memcpy(buf, r->body_start, n);
+        r->body_start += n;
+        r->body_buffered -= n;
+        r->body_left -= n;
+        return (int)n;
+    }
+
+    ssize_t n = recv(r->sock, buf, buf_len, 0);
+    if (n < 0)
+        return (errno == EAGAIN || errno == EWOULDBLOCK) ? HTTPD_SOCK_ERR_TIMEOUT
+                                                         : HTTPD_SOCK_ERR_FAIL;
+    if (n == 0)
+        return HTTPD_SOCK_ERR_FAIL;
+    r->body_left -= (size_t)n;
+    return (int)n;
+}
+
+esp_err_t
+httpd_req_async_handler_begin(httpd_req_t* r, httpd_req_t** out)
+{
+    httpd_req_t* copy = malloc(sizeof(*copy));
+    if (copy == NULL)
+        return ESP_ERR_NO_MEM;
+    *copy = *r;
+    ((host_req_t*)r->aux)->detached = true;
+    *out = copy;
+    return ESP_OK;
+}
+
+esp_err_t
+httpd_req_async_handler_complete(httpd_req_t* r)
+{
+    host_req_t* aux = r->aux;
+    shutdown(aux->sock, SHUT_WR);
+    close(aux->sock);
+    free(aux);
+    free(r);
+    return ESP_OK;
+}
+
+bool
+httpd_uri_match_wildcard(const char* uri_template, const char* uri_to_match, size_t match_upto)
+{
+    size_t tpl_len = strlen(uri_template);
+
+    // "/path/*" matches "/path" and everything below it; "/path?" makes the last char optional
+    if (tpl_len > 0 && uri_template[tpl_len - 1] == '*')
+    {
+        size_t prefix = tpl_len - 1;
+        if (match_upto >= prefix)
+            return strncmp(uri_template, uri_to_match, prefix) == 0;
+        return prefix > 0 && uri_template[prefix - 1] == '/' && match_upto == prefix - 1
+               && strncmp(uri_template, uri_to_match, match_upto) == 0;
+    }
+    if (tpl_len > 0 && uri_template[tpl_len - 1] == '?')
+    {
+        return (match_upto == tpl_len - 1 || match_upto == tpl_len)
+               && strncmp(uri_template, uri_to_match, match_upto) == 0;
+    }
+    return tpl_len == match_upto && strncmp(uri_template, uri_to_match, match_upto) == 0;
+}
+
+static int
+_parse_method(const char* name)
+{
+    static const char* names[] = {
+        [HTTP_DELETE] = "DELETE", [HTTP_GET] = "GET", [HTTP_HEAD] = "HEAD",
+        [HTTP_POST] = "POST",     [HTTP_PUT] = "PUT",
+    };
+    for (int i = 0; i < (int)(sizeof(names) / sizeof(names[0])); i++)
+    {
+        if (strcmp(name, names[i]) == 0)
+            return i;
+    }
+    return -1;
+}
+
+// Reads the request head; returns false on a malformed or truncated request
+static bool
+_read_head(host_req_t* r)
+{
+    while (r->head_len < sizeof(r->head) - 1)
+    {
+        ssize_t n = recv(r->sock, r->head + r->head_len, sizeof(r->head) - 1 - r->head_len, 0);
+        if (n <= 0)
+            return false;
+        r->head_len += (size_t)n;
+        r->head[r->head_len] = '\0';
+
+        char* end = strstr(r->head, "\r\n\r\n");
+        if (end != NULL)
+        {
+            *end = '\0';
+            r->body_start = end + 4;
+            r->body_buffered = r->head_len - (size_t)(r->body_start - r->head);
+            return true;
+        }
+    }
+    return false;
+}
+
+// Serves one request; returns false if an async handler kept the connection
+static bool
+_serve(host_server_t* server, int sock)
+{
+    host_req_t* r = calloc(1, sizeof(*r));
+    httpd_req_t req = {.handle = server, .aux = r};
+    r->sock = sock;
+    snprintf(r->status, sizeof(r->status), "200 OK");
+    snprintf(r->type, sizeof(r->type), "text/html");
+
+    if (!_read_head(r))
+        goto done;
+
+    char* save = NULL;
+    char* line = strtok_r(r->head, "\r\n", &save);
+    char* method = line != NULL ? strtok(line, " ") : NULL;
+    char* target = method != NULL ? strtok(NULL, " ") : NULL;
+    if (target == NULL || strlen(target) > HTTPD_MAX_URI_LEN)
+    {
+        httpd_resp_send_err(&req, HTTPD_400_BAD_REQUEST, NULL);
+        goto done;
+    }
+    req.method = _parse_method(method);
+    snprintf(req.uri, sizeof(req.uri), "%s", target);
+    char* query = strchr(target, '?');
+    if (query != NULL)
+        r->query = query + 1;
+
+    while ((line = strtok_r(NULL, "\r\n", &save)) != NULL && r->header_count < HTTPD_HEADERS_MAX)
+    {
+        char* colon = strchr(line, ':');
+        if (colon == NULL)
+            continue;
+        *colon = '\0';
+        char* value = colon + 1;
+        while (*value == ' ')
+            value++;
+        r->header_names[r->header_count] = line;
+        r->header_values[r->header_count] = value;
+        r->header_count++;
+    }
+    const char* length = _header(r, "Content-Length");
+    req.content_len = length != NULL ? strtoul(length, NULL, 10) : 0;
+    r->body_left = req.content_len;
+    if (r->body_buffered > r->body_left)
+        r->body_buffered = r->body_left;
+
+    // Handlers are matched on the path only, in registration order
+    size_t path_len = strcspn(req.uri, "?");
+    httpd_uri_match_func_t match = server->config.uri_match_fn;
+    bool path_found = false;
+    for (int i = 0; i < server->handler_count; i++)
+    {
+        httpd_uri_t* h = &server->handlers[i];
+        bool hit = match != NULL ? match(h->uri, req.uri, path_len)
+                                 : strlen(h->uri) == path_len
+                                       && strncmp(h->uri, req.uri, path_len) == 0;
+        if (!hit)
+            continue;
+        path_found = true;
+        if ((int)h->method != req.method)
+            continue;
+
+        // A chunked body is ended by the handler itself with an empty chunk
+        req.user_ctx = h->user_ctx;
+        if (h->handler(&req) != ESP_OK && !r->headers_sent)
+            httpd_resp_send_err(&req, HTTPD_500_INTERNAL_SERVER_ERROR, NULL);
+        goto done;
+    }
+    httpd_resp_send_err(&req, path_found ? HTTPD_405_METHOD_NOT_ALLOWED : HTTPD_404_NOT_FOUND,
+                        NULL);
+
+done:
+    if (r->detached)
+        return false;
+    free(r);
+    return true;
+}
+
+static void*
+_server_thread(void* arg)
+{
+    host_server_t* server = arg;
+    while (true)
+    {
+        int sock = accept(server->listen_sock, NULL, NULL);
+        if (sock < 0)
+        {
+            if (errno == EINTR || errno == ECONNABORTED)
+                continue;
+            break;
+        }
+
+        struct timeval tv = {.tv_sec = HTTPD_RX_TIMEOUT_MS / 1000};
+        setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+        if (_serve(server, sock))
+        {
+            shutdown(sock, SHUT_WR);
+            close(sock);
+        }
+    }
+    return NULL;
+}
+
+esp_err_t
+httpd_start(httpd_handle_t* handle, const httpd_config_t* config)
+{
+    host_server_t* server = calloc(1, sizeof(*server));
+    server->config = *config;
+    server->handlers = calloc(config->max_uri_handlers, sizeof(httpd_uri_t));
+
+    const char* env_port = getenv("HTTPD_HOST_PORT");
+    uint16_t port = env_port != NULL ? (uint16_t)atoi(env_port) : config->server_port;
+
+    server->listen_sock = socket(AF_INET, SOCK_STREAM, 0);
+    int one = 1;
+    setsockopt(server->listen_sock, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    struct sockaddr_in addr = {
+        .sin_family = AF_INET,
+        .sin_port = htons(port),
+        .sin_addr.s_addr = htonl(INADDR_ANY),
+    };
+    if (bind(server->listen_sock, (struct sockaddr*)&addr, sizeof(addr)) != 0
+        || listen(server->listen_sock, 4) != 0)
+    {
+        ESP_LOGE(TAG, "Cannot listen on port %u: %s", port, strerror(errno));
+        close(server->listen_sock);
+        free(server->handlers);
+        free(server);
+        return ESP_ERR_HTTPD_TASK;
+    }
+
+    pthread_create(&server->thread, NULL, _server_thread, server);
+    ESP_LOGI(TAG, "Listening on port %u", port);
+    *handle = server;
+    return ESP_OK;
+}
+
+esp_err_t
+httpd_stop(httpd_handle_t handle)
+{
+    host_server_t* server = handle;
+    shutdown(server->listen_sock, SHUT_RDWR);
+    close(server->listen_sock);
+    pthread_join(server->thread, NULL);
+    free(server->handlers);
+    free(server);
+    return ESP_OK;
+}
+
+esp_err_t
+httpd_register_uri_handler(httpd_handle_t handle, const httpd_uri_t* uri_handler)
+{
+    host_server_t* server = handle;
+    for (int i = 0; i < server->handler_count; i++)
+    {
+        if (strcmp(server->handlers[i].uri, uri_handler->uri) == 0
+            && server->handlers[i].method == uri_handler->method)
+        {
+            return ESP_ERR_HTTPD_HANDLER_EXISTS;
+        }
+    }
+    if (server->handler_count >= server->config.max_uri_handlers)
+        return ESP_ERR_HTTPD_HANDLERS_FULL;
+
+    server->handlers[server->handler_count++] = *uri_handler;
+    return ESP_OK;
+}
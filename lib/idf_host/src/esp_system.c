@@ -0,0 +1,215 @@
+#include <malloc.h>
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "esp_crt_bundle.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_random.h"
+#include "esp_system.h"
+#include "esp_timer.h"
+#include "rom/ets_sys.h"
+
+#define LOG_TAG_LEVELS 16
+
+typedef struct
+{
+    const char* tag;
+    esp_log_level_t level;
+} tag_level_t;
+
+static esp_log_level_t default_level = ESP_LOG_INFO;
+static tag_level_t tag_levels[LOG_TAG_LEVELS];
+static int tag_level_count = 0;
+static pthread_mutex_t log_lock = PTHREAD_MUTEX_INITIALIZER;
+
+const char*
+esp_err_to_name(esp_err_t code)
+{
+    switch (code)
+    {
+    case ESP_OK:
+        return "ESP_OK";
+    case ESP_FAIL:
+        return "ESP_FAIL";
+    case ESP_ERR_NO_MEM:
+        return "ESP_ERR_NO_MEM";
+    case ESP_ERR_INVALID_ARG:
+        return "ESP_ERR_INVALID_ARG";
+    case ESP_ERR_INVALID_STATE:
+        return "ESP_ERR_INVALID_STATE";
+    case ESP_ERR_INVALID_SIZE:
+        return "ESP_ERR_INVALID_SIZE";
+    case ESP_ERR_NOT_FOUND:
+        return "ESP_ERR_NOT_FOUND";
+    case ESP_ERR_NOT_SUPPORTED:
+        return "ESP_ERR_NOT_SUPPORTED";
+    case ESP_ERR_TIMEOUT:
+        return "ESP_ERR_TIMEOUT";
+    case ESP_ERR_INVALID_RESPONSE:
+        return "ESP_ERR_INVALID_RESPONSE";
+    case ESP_ERR_NVS_NOT_FOUND:
+        return "ESP_ERR_NVS_NOT_FOUND";
+    case ESP_ERR_NVS_TYPE_MISMATCH:
+        return "ESP_ERR_NVS_TYPE_MISMATCH";
+    case ESP_ERR_NVS_INVALID_LENGTH:
+        return "ESP_ERR_NVS_INVALID_LENGTH";
+    case ESP_ERR_HTTP_CONNECT:
+        return "ESP_ERR_HTTP_CONNECT";
+    case ESP_ERR_HTTP_WRITE_DATA:
+        return "ESP_ERR_HTTP_WRITE_DATA";
+    case ESP_ERR_HTTP_FETCH_HEADER:
+        return "ESP_ERR_HTTP_FETCH_HEADER";
+    case ESP_ERR_HTTP_INVALID_TRANSPORT:
+        return "ESP_ERR_HTTP_INVALID_TRANSPORT";
+    case ESP_ERR_HTTP_EAGAIN:
+        return "ESP_ERR_HTTP_EAGAIN";
+    case ESP_ERR_HTTP_CONNECTION_CLOSED:
+        return "ESP_ERR_HTTP_CONNECTION_CLOSED";
+    default:
+        return "UNKNOWN ERROR";
+    }
+}
+
+void
+esp_log_level_set(const char* tag, esp_log_level_t level)
+{
+    pthread_mutex_lock(&log_lock);
+    if (strcmp(tag, "*") == 0)
+    {
+        default_level = level;
+        tag_level_count = 0;
+    }
+    else
+    {
+        int i = 0;
+        while (i < tag_level_count && strcmp(tag_levels[i].tag, tag) != 0)
+            i++;
+        if (i < LOG_TAG_LEVELS)
+        {
+            tag_levels[i].tag = tag;
+            tag_levels[i].level = level;
+            if (i == tag_level_count)
+                tag_level_count++;
+        }
+    }
+    pthread_mutex_unlock(&log_lock);
+}
+
+void
+esp_log_write(esp_log_level_t level, const char* tag, const char* format, ...)
+{
+    static const char letters[] = "NEWIDV";
+
+    pthread_mutex_lock(&log_lock);
+    esp_log_level_t limit = default_level;
+    for (int i = 0; i < tag_level_count; i++)
+    {
+        if (strcmp(tag_levels[i].tag, tag) == 0)
+            limit = tag_levels[i].level;
+    }
+    if (level > limit)
+    {
+        pthread_mutex_unlock(&log_lock);
+        return;
+    }
+
+    fprintf(stderr, "%c (%lld) %s: ", letters[level], (long long)(esp_timer_get_time() / 1000),
+            tag);
+    va_list args;
+    va_start(args, format);
+    vfprintf(stderr, format, args);
+    va_end(args);
+    fputc('\n', stderr);
+    pthread_mutex_unlock(&log_lock);
+}
+
+void
+ets_delay_us(uint32_t us)
+{
+    struct timespec ts = {.tv_sec = us / 1000000, .tv_nsec = (long)(us % 1000000) * 1000};
+    nanosleep(&ts, NULL);
+}
+
+uint32_t
+esp_random(void)
+{
+    static unsigned int seed;
+    static pthread_mutex_t seed_lock = PTHREAD_MUTEX_INITIALIZER;
+
+    pthread_mutex_lock(&seed_lock);
+    if (seed == 0)
+        seed = (unsigned int)time(NULL) ^ (unsigned int)esp_timer_get_time();
+    uint32_t value = ((uint32_t)rand_r(&seed) << 16) ^ (uint32_t)rand_r(&seed);
+    pthread_mutex_unlock(&seed_lock);
+    return value;
+}
+
+static pthread_mutex_t heap_lock = PTHREAD_MUTEX_INITIALIZER;
+static uint32_t heap_minimum = UINT32_MAX;
+
+// Free bytes inside the allocator's arena; the host has no fixed heap size
+uint32_t
+esp_get_free_heap_size(void)
+{
+    struct mallinfo2 info = mallinfo2();
+    uint32_t free_bytes = (uint32_t)info.fordblks;
+    pthread_mutex_lock(&heap_lock);
+    if (free_bytes < heap_minimum)
+        heap_minimum = free_bytes;
+    pthread_mutex_unlock(&heap_lock);
+    return free_bytes;
+}
+
+// The low-water mark only covers the moments the free size was queried
+uint32_t
+esp_get_minimum_free_heap_size(void)
+{
+    esp_get_free_heap_size();
+    pthread_mutex_lock(&heap_lock);
+    uint32_t minimum = heap_minimum;
+    pthread_mutex_unlock(&heap_lock);
+    return minimum;
+}
+
+size_t
+heap_caps_get_free_size(uint32_t caps)
+{
+    (void)caps;
+    return esp_get_free_heap_size();
+}
+
+size_t
+heap_caps_get_minimum_free_size(uint32_t caps)
+{
+    (void)caps;
+    return esp_get_minimum_free_heap_size();
+}
+
+size_t
+heap_caps_get_largest_free_block(uint32_t caps)
+{
+    (void)caps;
+    return esp_get_free_heap_size();
+}
+
+esp_err_t
+esp_crt_bundle_attach(void* conf)
+{
+    (void)conf;
+    return ESP_OK;
+}
+
+extern void app_main(void);
+
+// Like the IDF linux target: app_main runs on the main thread, which then parks
+int
+main(void)
+{
+    setvbuf(stderr, NULL, _IOLBF, 0);
+    app_main();
+    pthread_exit(NULL);
+}
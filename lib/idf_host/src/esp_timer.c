@@ -0,0 +1,260 @@
+#include <errno.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <string.h>
+#include <time.h>
+
+#include "esp_timer.h"
+
+struct esp_timer
+{
+    esp_timer_cb_t callback;
+    void* arg;
+    int64_t alarm_us;
+    uint64_t period_us;
+    bool armed;
+    struct esp_timer* next;
+};
+
+static pthread_mutex_t timer_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t timer_cond;
+static pthread_once_t timer_once = PTHREAD_ONCE_INIT;
+static struct esp_timer* armed_list = NULL;
+static int64_t start_us;
+// Time of the simulated clock, or -1 while time comes from CLOCK_MONOTONIC
+static _Atomic int64_t frozen_us = -1;
+
+static int64_t
+_monotonic_us(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (int64_t)now.tv_sec * 1000000 + now.tv_nsec / 1000;
+}
+
+// Counts from process start, like the device counts from boot
+__attribute__((constructor)) static void
+_timer_start_clock(void)
+{
+    start_us = _monotonic_us();
+}
+
+int64_t
+esp_timer_get_time(void)
+{
+    int64_t now_us = frozen_us;
+    return now_us >= 0 ? now_us : _monotonic_us() - start_us;
+}
+
+// Keeps the armed list sorted by alarm time (lock held)
+static void
+_timer_insert(struct esp_timer* timer)
+{
+    struct esp_timer** link = &armed_list;
+    while (*link != NULL && (*link)->alarm_us <= timer->alarm_us)
+        link = &(*link)->next;
+    timer->next = *link;
+    *link = timer;
+    timer->armed = true;
+}
+
+static void
+_timer_remove(struct esp_timer* timer)
+{
+    for (struct esp_timer** link = &armed_list; *link != NULL; link = &(*link)->next)
+    {
+        if (*link == timer)
+        {
+            *link = timer->next;
+            break;
+        }
+    }
+    timer->armed = false;
+}
+
+static void*
+_timer_dispatch(void* arg)
+{
+    (void)arg;
+
+    pthread_mutex_lock(&timer_lock);
+    while (true)
+    {
+        // A frozen clock only moves in esp_timer_host_advance(), which runs the callbacks
+        if (armed_list == NULL || frozen_us >= 0)
+        {
+            pthread_cond_wait(&timer_cond, &timer_lock);
+            continue;
+        }
+
+        int64_t wait_us = armed_list->alarm_us - esp_timer_get_time();
+        if (wait_us > 0)
+        {
+            struct timespec ts;
+            clock_gettime(CLOCK_MONOTONIC, &ts);
+            ts.tv_sec += wait_us / 1000000;
+            ts.tv_nsec += (wait_us % 1000000) * 1000;
+            if (ts.tv_nsec >= 1000000000L)
+            {
+                ts.tv_sec++;
+                ts.tv_nsec -= 1000000000L;
+            }
+            pthread_cond_timedwait(&timer_cond, &timer_lock, &ts);
+            continue;
+        }
+
+        struct esp_timer* timer = armed_list;
+        _timer_remove(timer);
+        if (timer->period_us > 0)
+        {
+            timer->alarm_us += timer->period_us;
+            _timer_insert(timer);
+        }
+
+        // Callbacks may start or stop timers, so they run without the lock
+        esp_timer_cb_t callback = timer->callback;
+        void* cb_arg = timer->arg;
+        pthread_mutex_unlock(&timer_lock);
+        callback(cb_arg);
+        pthread_mutex_lock(&timer_lock);
+    }
+    return NULL;
+}
+
+void
+esp_timer_host_freeze(void)
+{
+    pthread_mutex_lock(&timer_lock);
+    if (frozen_us < 0)
+        frozen_us = _monotonic_us() - start_us;
+    pthread_mutex_unlock(&timer_lock);
+}
+
+void
+esp_timer_host_advance(uint64_t us)
+{
+    pthread_mutex_lock(&timer_lock);
+    int64_t target_us = frozen_us + (int64_t)us;
+    while (armed_list != NULL && armed_list->alarm_us <= target_us)
+    {
+        struct esp_timer* timer = armed_list;
+        if (timer->alarm_us > frozen_us)
+            frozen_us = timer->alarm_us;
+        _timer_remove(timer);
+        if (timer->period_us > 0)
+        {
+            timer->alarm_us += timer->period_us;
+            _timer_insert(timer);
+        }
+
+        esp_timer_cb_t callback = timer->callback;
+        void* cb_arg = timer->arg;
+        pthread_mutex_unlock(&timer_lock);
+        callback(cb_arg);
+        pthread_mutex_lock(&timer_lock);
+    }
+    frozen_us = target_us;
+    pthread_mutex_unlock(&timer_lock);
+}
+
+static void
+_timer_start_thread(void)
+{
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&timer_cond, &attr);
+    pthread_condattr_destroy(&attr);
+
+    pthread_t thread;
+    pthread_create(&thread, NULL, _timer_dispatch, NULL);
+    pthread_detach(thread);
+}
+
+esp_err_t
+esp_timer_create(const esp_timer_create_args_t* create_args, esp_timer_handle_t* out)
+{
+    if (create_args == NULL || create_args->callback == NULL || out == NULL)
+        return ESP_ERR_INVALID_ARG;
+
+    pthread_once(&timer_once, _timer_start_thread);
+
+    struct esp_timer* timer = calloc(1, sizeof(*timer));
+    if (timer == NULL)
+        return ESP_ERR_NO_MEM;
+    timer->callback = create_args->callback;
+    timer->arg = create_args->arg;
+    *out = timer;
+    return ESP_OK;
+}
+
+static esp_err_t
+_timer_start(esp_timer_handle_t timer, uint64_t timeout_us, uint64_t period_us)
+{
+    if (timer == NULL)
+        return ESP_ERR_INVALID_ARG;
+
+    pthread_mutex_lock(&timer_lock);
+    if (timer->armed)
+    {
+        pthread_mutex_unlock(&timer_lock);
+        return ESP_ERR_INVALID_STATE;
+    }
+    timer->alarm_us = esp_timer_get_time() + (int64_t)timeout_us;
+    timer->period_us = period_us;
+    _timer_insert(timer);
+    pthread_cond_signal(&timer_cond);
+    pthread_mutex_unlock(&timer_lock);
+    return ESP_OK;
+}
+
+esp_err_t
+esp_timer_start_once(esp_timer_handle_t timer, uint64_t timeout_us)
+{
+    return _timer_start(timer, timeout_us, 0);
+}
+
+esp_err_t
+esp_timer_start_periodic(esp_timer_handle_t timer, uint64_t period_us)
+{
+    return _timer_start(timer, period_us, period_us);
+}
+
+esp_err_t
+esp_timer_stop(esp_timer_handle_t timer)
+{
+    if (timer == NULL)
+        return ESP_ERR_INVALID_ARG;
+
+    pthread_mutex_lock(&timer_lock);
+    esp_err_t err = timer->armed ? ESP_OK : ESP_ERR_INVALID_STATE;
+    if (timer->armed)
+        _timer_remove(timer);
+    pthread_mutex_unlock(&timer_lock);
+    return err;
+}
+
+esp_err_t
+esp_timer_delete(esp_timer_handle_t timer)
+{
+    if (timer == NULL)
+        return ESP_ERR_INVALID_ARG;
+
+    pthread_mutex_lock(&timer_lock);
+    bool armed = timer->armed;
+    pthread_mutex_unlock(&timer_lock);
+    if (armed)
+        return ESP_ERR_INVALID_STATE;
+
+    free(timer);
+    return ESP_OK;
+}
+
+bool
+esp_timer_is_active(esp_timer_handle_t timer)
+{
+    pthread_mutex_lock(&timer_lock);
+    bool armed = timer->armed;
+    pthread_mutex_unlock(&timer_lock);
+    return armed;
+}
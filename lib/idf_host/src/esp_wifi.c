@@ -0,0 +1,643 @@
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "esp_log.h"
+#include "esp_netif.h"
+#include "esp_wifi.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/task.h"
+#include "nvs.h"
+
+#define SIM_MAX_NETWORKS 16
+#define SIM_DHCP_MS 100
+// How often the radio task looks at the out-of-range switch
+#define SIM_POLL_MS 100
+#define SIM_NVS_NAMESPACE "wifi_sim"
+
+static const char* TAG = "wifi_host";
+
+ESP_EVENT_DEFINE_BASE(WIFI_EVENT);
+ESP_EVENT_DEFINE_BASE(IP_EVENT);
+
+struct esp_netif_obj
+{
+    int unused;
+};
+
+typedef struct
+{
+    char ssid[33];
+    char password[64];
+    int8_t rssi;
+    uint8_t channel;
+} sim_network_t;
+
+typedef enum
+{
+    SIM_SCAN,
+    SIM_CONNECT,
+} sim_command_t;
+
+typedef struct
+{
+    sim_command_t command;
+    uint32_t generation;
+} sim_request_t;
+
+static sim_network_t networks[SIM_MAX_NETWORKS];
+static int network_count;
+static int scan_ms = 1500;
+static int connect_ms = 800;
+
+// Driver state, guarded by sim_lock
+static pthread_mutex_t sim_lock = PTHREAD_MUTEX_INITIALIZER;
+static bool initialized;
+static bool started;
+static wifi_mode_t mode = WIFI_MODE_NULL;
+static wifi_storage_t storage = WIFI_STORAGE_FLASH;
+static wifi_config_t sta_config;
+static wifi_config_t ap_config;
+static bool connected;
+static bool dhcpc_stopped;
+static esp_netif_ip_info_t static_ip;
+static uint32_t connect_generation;
+static bool scanning;
+static wifi_ap_record_t scan_records[SIM_MAX_NETWORKS];
+static uint16_t scan_count;
+
+// Toggled by SIGUSR1; all networks are out of range while it is set
+static volatile sig_atomic_t out_of_range;
+static bool link_lost;
+
+static QueueHandle_t requests;
+static struct esp_netif_obj sta_netif;
+static struct esp_netif_obj ap_netif;
+
+static void
+_parse_networks(const char* spec)
+{
+    char* copy = strdup(spec);
+    char* save = NULL;
+
+    for (char* entry = strtok_r(copy, ",", &save);
+         entry != NULL && network_count < SIM_MAX_NETWORKS; entry = strtok_r(NULL, ",", &save))
+    {
+        sim_network_t* net = &networks[network_count];
+        *net = (sim_network_t){.rssi = -50, .channel = 6};
+
+        // Fields are split by hand, since strtok would merge an empty password away
+        char* fields[4] = {entry, NULL, NULL, NULL};
+        for (int i = 1; i < 4 && fields[i - 1] != NULL; i++)
+        {
+            char* colon = strchr(fields[i - 1], ':');
+            if (colon != NULL)
+            {
+                *colon = '\0';
+                fields[i] = colon + 1;
+            }
+        }
+        if (fields[0][0] == '\0')
+            continue;
+        snprintf(net->ssid, sizeof(net->ssid), "%s", fields[0]);
+        if (fields[1] != NULL)
+            snprintf(net->password, sizeof(net->password), "%s", fields[1]);
+        if (fields[2] != NULL && fields[2][0] != '\0')
+            net->rssi = (int8_t)atoi(fields[2]);
+        if (fields[3] != NULL && fields[3][0] != '\0')
+            net->channel = (uint8_t)atoi(fields[3]);
+        network_count++;
+    }
+    free(copy);
+}
+
+static int
+_env_ms(const char* name, int fallback)
+{
+    const char* value = getenv(name);
+    return value != NULL ? atoi(value) : fallback;
+}
+
+static void
+_post(int32_t event_id, const void* data, size_t size)
+{
+    esp_event_post(WIFI_EVENT, event_id, data, size, portMAX_DELAY);
+}
+
+static void
+_post_disconnected(const char* ssid, uint16_t reason)
+{
+    wifi_event_sta_disconnected_t event = {.reason = reason, .rssi = -100};
+    event.ssid_len = (uint8_t)strnlen(ssid, sizeof(event.ssid));
+    memcpy(event.ssid, ssid, event.ssid_len);
+    _post(WIFI_EVENT_STA_DISCONNECTED, &event, sizeof(event));
+}
+
+static bool
+_still_current(uint32_t generation)
+{
+    pthread_mutex_lock(&sim_lock);
+    bool current = generation == connect_generation && started;
+    pthread_mutex_unlock(&sim_lock);
+    return current;
+}
+
+static void
+_sim_scan(void)
+{
+    vTaskDelay(pdMS_TO_TICKS(scan_ms));
+
+    pthread_mutex_lock(&sim_lock);
+    scan_count = 0;
+    for (int i = 0; i < network_count && !out_of_range; i++)
+    {
+        wifi_ap_record_t* record = &scan_records[scan_count++];
+        *record = (wifi_ap_record_t){
+            .bssid = {0x02, 0, 0, 0, 0, (uint8_t)i},
+            .primary = networks[i].channel,
+            .rssi = networks[i].rssi,
+            .authmode = networks[i].password[0] != '\0' ? WIFI_AUTH_WPA2_PSK : WIFI_AUTH_OPEN,
+        };
+        memcpy(record->ssid, networks[i].ssid, sizeof(record->ssid));
+    }
+    scanning = false;
+    wifi_event_sta_scan_done_t event = {.status = 0, .number = (uint8_t)scan_count};
+    pthread_mutex_unlock(&sim_lock);
+
+    _post(WIFI_EVENT_SCAN_DONE, &event, sizeof(event));
+}
+
+// Whether a network matches the SSID and, when the config names them, channel and BSSID
+static bool
+_sim_matches(int index, const char* ssid, const wifi_sta_config_t* config)
+{
+    const uint8_t bssid[6] = {0x02, 0, 0, 0, 0, (uint8_t)index};
+    if (strcmp(networks[index].ssid, ssid) != 0)
+        return false;
+    if (config->channel != 0 && config->channel != networks[index].channel)
+        return false;
+    return !config->bssid_set || memcmp(config->bssid, bssid, sizeof(bssid)) == 0;
+}
+
+static void
+_sim_connect(uint32_t generation)
+{
+    pthread_mutex_lock(&sim_lock);
+    wifi_sta_config_t config = sta_config.sta;
+    pthread_mutex_unlock(&sim_lock);
+
+    char ssid[33];
+    char password[65];
+    snprintf(ssid, sizeof(ssid), "%.32s", (const char*)config.ssid);
+    snprintf(password, sizeof(password), "%.64s", (const char*)config.password);
+
+    // Without a channel the driver sweeps all of them before it can associate
+    int delay_ms = connect_ms + (config.channel == 0 ? scan_ms : 0);
+    vTaskDelay(pdMS_TO_TICKS(delay_ms));
+    if (!_still_current(generation))
+        return;
+
+    int found = -1;
+    for (int i = 0; i < network_count && found < 0 && !out_of_range; i++)
+    {
+        if (_sim_matches(i, ssid, &config))
+            found = i;
+    }
+    if (found < 0)
+    {
+        _post_disconnected(ssid, WIFI_REASON_NO_AP_FOUND);
+        return;
+    }
+    if (networks[found].password[0] != '\0' && strcmp(networks[found].password, password) != 0)
+    {
+        _post_disconnected(ssid, WIFI_REASON_4WAY_HANDSHAKE_TIMEOUT);
+        return;
+    }
+
+    pthread_mutex_lock(&sim_lock);
+    connected = generation == connect_generation;
+    pthread_mutex_unlock(&sim_lock);
+    if (!connected)
+        return;
+
+    wifi_event_sta_connected_t event = {
+        .bssid = {0x02, 0, 0, 0, 0, (uint8_t)found},
+        .channel = networks[found].channel,
+        .authmode = networks[found].password[0] != '\0' ? WIFI_AUTH_WPA2_PSK : WIFI_AUTH_OPEN,
+    };
+    event.ssid_len = (uint8_t)strlen(ssid);
+    memcpy(event.ssid, ssid, event.ssid_len);
+    _post(WIFI_EVENT_STA_CONNECTED, &event, sizeof(event));
+
+    ip_event_got_ip_t got_ip = {.esp_netif = &sta_netif, .ip_changed = true};
+    pthread_mutex_lock(&sim_lock);
+    bool use_static = dhcpc_stopped && static_ip.ip.addr != 0;
+    got_ip.ip_info = static_ip;
+    pthread_mutex_unlock(&sim_lock);
+
+    if (!use_static)
+    {
+        vTaskDelay(pdMS_TO_TICKS(SIM_DHCP_MS));
+        uint8_t* ip = (uint8_t*)&got_ip.ip_info.ip.addr;
+        uint8_t* gw = (uint8_t*)&got_ip.ip_info.gw.addr;
+        uint8_t* mask = (uint8_t*)&got_ip.ip_info.netmask.addr;
+        memcpy(ip, (uint8_t[]){192, 168, 1, (uint8_t)(100 + found)}, 4);
+        memcpy(gw, (uint8_t[]){192, 168, 1, 1}, 4);
+        memcpy(mask, (uint8_t[]){255, 255, 255, 0}, 4);
+    }
+    if (!_still_current(generation))
+        return;
+    esp_event_post(IP_EVENT, IP_EVENT_STA_GOT_IP, &got_ip, sizeof(got_ip), portMAX_DELAY);
+}
+
+// Drops the station link; called with sim_lock held, returns whether it was up
+static bool
+_drop_link(void)
+{
+    bool was_connected = connected;
+    connected = false;
+    connect_generation++;
+    return was_connected;
+}
+
+static void
+_toggle_range(int signal)
+{
+    (void)signal;
+    out_of_range = !out_of_range;
+}
+
+// Drops the link when the networks go out of range
+static void
+_sim_check_range(void)
+{
+    if (link_lost == (bool)out_of_range)
+        return;
+    link_lost = out_of_range;
+    ESP_LOGW(TAG, "Networks %s range", link_lost ? "out of" : "back in");
+
+    pthread_mutex_lock(&sim_lock);
+    bool dropped = link_lost && _drop_link();
+    pthread_mutex_unlock(&sim_lock);
+    if (dropped)
+        _post_disconnected((const char*)sta_config.sta.ssid, WIFI_REASON_BEACON_TIMEOUT);
+}
+
+// The radio: scans and connection attempts run one at a time
+static void
+_sim_task(void* arg)
+{
+    (void)arg;
+    sim_request_t request;
+
+    while (true)
+    {
+        _sim_check_range();
+        if (xQueueReceive(requests, &request, pdMS_TO_TICKS(SIM_POLL_MS)) != pdTRUE)
+            continue;
+        if (request.command == SIM_SCAN)
+            _sim_scan();
+        else
+            _sim_connect(request.generation);
+    }
+}
+
+static void
+_load_sta_config(void)
+{
+    nvs_handle_t handle;
+    if (nvs_open(SIM_NVS_NAMESPACE, NVS_READONLY, &handle) != ESP_OK)
+        return;
+    size_t len = sizeof(sta_config.sta);
+    nvs_get_blob(handle, "sta", &sta_config.sta, &len);
+    nvs_close(handle);
+}
+
+static void
+_save_sta_config(void)
+{
+    nvs_handle_t handle;
+    if (nvs_open(SIM_NVS_NAMESPACE, NVS_READWRITE, &handle) != ESP_OK)
+        return;
+    nvs_set_blob(handle, "sta", &sta_config.sta, sizeof(sta_config.sta));
+    nvs_commit(handle);
+    nvs_close(handle);
+}
+
+bool
+esp_wifi_sim_enabled(void)
+{
+    return getenv("WIFI_SIM_NETWORKS") != NULL;
+}
+
+esp_err_t
+esp_netif_init(void)
+{
+    return ESP_OK;
+}
+
+esp_netif_t*
+esp_netif_create_default_wifi_sta(void)
+{
+    return &sta_netif;
+}
+
+esp_netif_t*
+esp_netif_create_default_wifi_ap(void)
+{
+    return &ap_netif;
+}
+
+esp_err_t
+esp_netif_dhcpc_start(esp_netif_t* netif)
+{
+    (void)netif;
+    pthread_mutex_lock(&sim_lock);
+    dhcpc_stopped = false;
+    pthread_mutex_unlock(&sim_lock);
+    return ESP_OK;
+}
+
+esp_err_t
+esp_netif_dhcpc_stop(esp_netif_t* netif)
+{
+    (void)netif;
+    pthread_mutex_lock(&sim_lock);
+    dhcpc_stopped = true;
+    pthread_mutex_unlock(&sim_lock);
+    return ESP_OK;
+}
+
+esp_err_t
+esp_netif_set_ip_info(esp_netif_t* netif, const esp_netif_ip_info_t* ip_info)
+{
+    (void)netif;
+    pthread_mutex_lock(&sim_lock);
+    static_ip = *ip_info;
+    pthread_mutex_unlock(&sim_lock);
+    return ESP_OK;
+}
+
+esp_err_t
+esp_netif_set_dns_info(esp_netif_t* netif, esp_netif_dns_type_t type, esp_netif_dns_info_t* dns)
+{
+    // Name lookups on the host use the system resolver
+    (void)netif;
+    (void)type;
+    (void)dns;
+    return ESP_OK;
+}
+
+esp_err_t
+esp_netif_str_to_ip4(const char* src, esp_ip4_addr_t* dst)
+{
+    unsigned a, b, c, d;
+    char tail;
+    if (src == NULL || sscanf(src, "%u.%u.%u.%u%c", &a, &b, &c, &d, &tail) != 4 || a > 255
+        || b > 255 || c > 255 || d > 255)
+        return ESP_ERR_INVALID_ARG;
+    uint8_t* bytes = (uint8_t*)&dst->addr;
+    bytes[0] = (uint8_t)a;
+    bytes[1] = (uint8_t)b;
+    bytes[2] = (uint8_t)c;
+    bytes[3] = (uint8_t)d;
+    return ESP_OK;
+}
+
+esp_err_t
+esp_wifi_init(const wifi_init_config_t* config)
+{
+    (void)config;
+    if (initialized)
+        return ESP_OK;
+
+    const char* spec = getenv("WIFI_SIM_NETWORKS");
+    if (spec != NULL)
+        _parse_networks(spec);
+    scan_ms = _env_ms("WIFI_SIM_SCAN_MS", scan_ms);
+    connect_ms = _env_ms("WIFI_SIM_CONNECT_MS", connect_ms);
+    _load_sta_config();
+
+    signal(SIGUSR1, _toggle_range);
+    requests = xQueueCreate(8, sizeof(sim_request_t));
+    xTaskCreate(_sim_task, "wifi", 3584, NULL, 23, NULL);
+    initialized = true;
+    ESP_LOGI(TAG, "Simulated radio with %d networks", network_count);
+    return ESP_OK;
+}
+
+esp_err_t
+esp_wifi_set_storage(wifi_storage_t new_storage)
+{
+    pthread_mutex_lock(&sim_lock);
+    storage = new_storage;
+    pthread_mutex_unlock(&sim_lock);
+    return ESP_OK;
+}
+
+esp_err_t
+esp_wifi_set_mode(wifi_mode_t new_mode)
+{
+    if (!initialized)
+        return ESP_ERR_WIFI_NOT_INIT;
+    if (new_mode >= WIFI_MODE_MAX)
+        return ESP_ERR_INVALID_ARG;
+
+    pthread_mutex_lock(&sim_lock);
+    bool had_sta = mode == WIFI_MODE_STA || mode == WIFI_MODE_APSTA;
+    bool had_ap = mode == WIFI_MODE_AP || mode == WIFI_MODE_APSTA;
+    bool has_sta = new_mode == WIFI_MODE_STA || new_mode == WIFI_MODE_APSTA;
+    bool has_ap = new_mode == WIFI_MODE_AP || new_mode == WIFI_MODE_APSTA;
+    mode = new_mode;
+    bool running = started;
+    bool dropped = running && had_sta && !has_sta && _drop_link();
+    pthread_mutex_unlock(&sim_lock);
+
+    // Like the IDF driver, a mode change on a running driver starts and stops interfaces
+    if (!running)
+        return ESP_OK;
+    if (dropped)
+        _post_disconnected((const char*)sta_config.sta.ssid, WIFI_REASON_ASSOC_LEAVE);
+    if (had_sta && !has_sta)
+        _post(WIFI_EVENT_STA_STOP, NULL, 0);
+    if (had_ap && !has_ap)
+        _post(WIFI_EVENT_AP_STOP, NULL, 0);
+    if (!had_sta && has_sta)
+        _post(WIFI_EVENT_STA_START, NULL, 0);
+    if (!had_ap && has_ap)
+        _post(WIFI_EVENT_AP_START, NULL, 0);
+    return ESP_OK;
+}
+
+esp_err_t
+esp_wifi_get_mode(wifi_mode_t* out_mode)
+{
+    pthread_mutex_lock(&sim_lock);
+    *out_mode = mode;
+    pthread_mutex_unlock(&sim_lock);
+    return ESP_OK;
+}
+
+esp_err_t
+esp_wifi_set_config(wifi_interface_t interface, wifi_config_t* conf)
+{
+    if (!initialized)
+        return ESP_ERR_WIFI_NOT_INIT;
+
+    pthread_mutex_lock(&sim_lock);
+    if (interface == WIFI_IF_STA)
+    {
+        sta_config = *conf;
+        if (storage == WIFI_STORAGE_FLASH)
+            _save_sta_config();
+    }
+    else
+    {
+        ap_config = *conf;
+    }
+    pthread_mutex_unlock(&sim_lock);
+    return ESP_OK;
+}
+
+esp_err_t
+esp_wifi_get_config(wifi_interface_t interface, wifi_config_t* conf)
+{
+    if (!initialized)
+        return ESP_ERR_WIFI_NOT_INIT;
+
+    pthread_mutex_lock(&sim_lock);
+    *conf = interface == WIFI_IF_STA ? sta_config : ap_config;
+    pthread_mutex_unlock(&sim_lock);
+    return ESP_OK;
+}
+
+esp_err_t
+esp_wifi_start(void)
+{
+    if (!initialized)
+        return ESP_ERR_WIFI_NOT_INIT;
+
+    pthread_mutex_lock(&sim_lock);
+    bool was_started = started;
+    started = true;
+    wifi_mode_t current = mode;
+    pthread_mutex_unlock(&sim_lock);
+
+    if (was_started)
+        return ESP_OK;
+    if (current == WIFI_MODE_STA || current == WIFI_MODE_APSTA)
+        _post(WIFI_EVENT_STA_START, NULL, 0);
+    if (current == WIFI_MODE_AP || current == WIFI_MODE_APSTA)
+        _post(WIFI_EVENT_AP_START, NULL, 0);
+    return ESP_OK;
+}
+
+esp_err_t
+esp_wifi_stop(void)
+{
+    pthread_mutex_lock(&sim_lock);
+    bool was_started = started;
+    bool dropped = _drop_link();
+    started = false;
+    pthread_mutex_unlock(&sim_lock);
+
+    if (dropped)
+        _post_disconnected((const char*)sta_config.sta.ssid, WIFI_REASON_ASSOC_LEAVE);
+    if (was_started)
+        _post(WIFI_EVENT_STA_STOP, NULL, 0);
+    return ESP_OK;
+}
+
+esp_err_t
+esp_wifi_connect(void)
+{
+    pthread_mutex_lock(&sim_lock);
+    esp_err_t err = ESP_OK;
+    if (!started)
+        err = ESP_ERR_WIFI_NOT_STARTED;
+    else if (mode != WIFI_MODE_STA && mode != WIFI_MODE_APSTA)
+        err = ESP_ERR_WIFI_MODE;
+    else if (sta_config.sta.ssid[0] == '\0')
+        err = ESP_ERR_WIFI_SSID;
+    sim_request_t request = {.command = SIM_CONNECT, .generation = ++connect_generation};
+    pthread_mutex_unlock(&sim_lock);
+
+    if (err == ESP_OK)
+        xQueueSend(requests, &request, portMAX_DELAY);
+    return err;
+}
+
+esp_err_t
+esp_wifi_disconnect(void)
+{
+    pthread_mutex_lock(&sim_lock);
+    bool dropped = _drop_link();
+    pthread_mutex_unlock(&sim_lock);
+
+    if (dropped)
+        _post_disconnected((const char*)sta_config.sta.ssid, WIFI_REASON_ASSOC_LEAVE);
+    return ESP_OK;
+}
+
+esp_err_t
+esp_wifi_scan_start(const wifi_scan_config_t* config, bool block)
+{
+    (void)config;
+
+    pthread_mutex_lock(&sim_lock);
+    esp_err_t err = ESP_OK;
+    if (!started)
+        err = ESP_ERR_WIFI_NOT_STARTED;
+    else if (mode != WIFI_MODE_STA && mode != WIFI_MODE_APSTA)
+        err = ESP_ERR_WIFI_MODE;
+    else if (scanning)
+        err = ESP_ERR_WIFI_STATE;
+    else
+        scanning = true;
+    pthread_mutex_unlock(&sim_lock);
+    if (err != ESP_OK)
+        return err;
+
+    sim_request_t request = {.command = SIM_SCAN};
+    xQueueSend(requests, &request, portMAX_DELAY);
+    while (block)
+    {
+        vTaskDelay(pdMS_TO_TICKS(10));
+        pthread_mutex_lock(&sim_lock);
+        block = scanning;
+        pthread_mutex_unlock(&sim_lock);
+    }
+    return ESP_OK;
+}
+
+esp_err_t
+esp_wifi_scan_get_ap_num(uint16_t* number)
+{
+    pthread_mutex_lock(&sim_lock);
+    *number = scan_count;
+    pthread_mutex_unlock(&sim_lock);
+    return ESP_OK;
+}
+
+esp_err_t
+esp_wifi_scan_get_ap_records(uint16_t* number, wifi_ap_record_t* ap_records)
+{
+    // Like the IDF driver, reading the records frees the whole list
+    pthread_mutex_lock(&sim_lock);
+    if (*number > scan_count)
+        *number = scan_count;
+    memcpy(ap_records, scan_records, *number * sizeof(wifi_ap_record_t));
+    scan_count = 0;
+    pthread_mutex_unlock(&sim_lock);
+    return ESP_OK;
+}
+
+esp_err_t
+esp_wifi_set_ps(wifi_ps_type_t type)
+{
+    (void)type;
+    return ESP_OK;
+}
@@ -0,0 +1,710 @@
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/event_groups.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+
+// Tasks get generous host stacks; IDF stack sizes are tuned for the target
+#define HOST_TASK_STACK_SIZE (512 * 1024)
+
+struct host_task
+{
+    pthread_t thread;
+    TaskFunction_t fn;
+    void* arg;
+    char name[16];
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    uint32_t notify;
+    uint32_t stack_depth;
+    UBaseType_t number;
+    UBaseType_t priority;
+    bool alive;
+    struct host_task* next;
+};
+
+struct host_queue
+{
+    pthread_mutex_t lock;
+    pthread_cond_t not_empty;
+    pthread_cond_t not_full;
+    uint8_t* items;
+    UBaseType_t length;
+    UBaseType_t item_size;
+    UBaseType_t head;
+    UBaseType_t count;
+};
+
+struct host_event_group
+{
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    EventBits_t bits;
+};
+
+static __thread struct host_task* current_task = NULL;
+static pthread_mutex_t critical_lock;
+static pthread_once_t init_once = PTHREAD_ONCE_INIT;
+static struct timespec boot_time;
+static volatile UBaseType_t task_count = 0;
+
+// Tasks created by xTaskCreate, for uxTaskGetSystemState(); entries are never freed
+static pthread_mutex_t registry_lock = PTHREAD_MUTEX_INITIALIZER;
+static struct host_task* registry = NULL;
+static UBaseType_t next_task_number = 1;
+
+static void
+_host_init(void)
+{
+    pthread_mutexattr_t attr;
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutex_init(&critical_lock, &attr);
+    pthread_mutexattr_destroy(&attr);
+    clock_gettime(CLOCK_MONOTONIC, &boot_time);
+}
+
+static void
+_cond_init(pthread_cond_t* cond)
+{
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(cond, &attr);
+    pthread_condattr_destroy(&attr);
+}
+
+static void
+_deadline(TickType_t ticks, struct timespec* ts)
+{
+    clock_gettime(CLOCK_MONOTONIC, ts);
+    uint64_t ns = (uint64_t)ticks * (1000000000ULL / configTICK_RATE_HZ);
+    ts->tv_sec += ns / 1000000000ULL;
+    ts->tv_nsec += ns % 1000000000ULL;
+    if (ts->tv_nsec >= 1000000000L)
+    {
+        ts->tv_sec++;
+        ts->tv_nsec -= 1000000000L;
+    }
+}
+
+// One wait step on a condition; returns false once the deadline has passed
+static bool
+_cond_wait(pthread_cond_t* cond, pthread_mutex_t* lock, TickType_t ticks,
+           const struct timespec* deadline)
+{
+    if (ticks == 0)
+        return false;
+    if (ticks == portMAX_DELAY)
+    {
+        pthread_cond_wait(cond, lock);
+        return true;
+    }
+    return pthread_cond_timedwait(cond, lock, deadline) != ETIMEDOUT;
+}
+
+void
+vPortEnterCritical(void)
+{
+    pthread_once(&init_once, _host_init);
+    pthread_mutex_lock(&critical_lock);
+}
+
+void
+vPortExitCritical(void)
+{
+    pthread_mutex_unlock(&critical_lock);
+}
+
+/* ---------------------------------------------------------------- tasks */
+
+static struct host_task*
+_task_alloc(const char* name)
+{
+    struct host_task* task = calloc(1, sizeof(*task));
+    if (task == NULL)
+        return NULL;
+    snprintf(task->name, sizeof(task->name), "%s", name);
+    pthread_mutex_init(&task->lock, NULL);
+    _cond_init(&task->cond);
+    return task;
+}
+
+// The thread still exists while it unregisters, so readers holding the lock can query it
+static void
+_task_unregister(struct host_task* task)
+{
+    pthread_mutex_lock(&registry_lock);
+    task->alive = false;
+    pthread_mutex_unlock(&registry_lock);
+}
+
+static void*
+_task_entry(void* arg)
+{
+    current_task = (struct host_task*)arg;
+    current_task->fn(current_task->arg);
+
+    // FreeRTOS tasks must not return; treat it like vTaskDelete(NULL)
+    fprintf(stderr, "Task '%s' returned\n", current_task->name);
+    _task_unregister(current_task);
+    __sync_fetch_and_sub(&task_count, 1);
+    return NULL;
+}
+
+BaseType_t
+xTaskCreate(TaskFunction_t fn, const char* name, uint32_t stack_depth, void* arg,
+            UBaseType_t priority, TaskHandle_t* out)
+{
+    pthread_once(&init_once, _host_init);
+
+    struct host_task* task = _task_alloc(name);
+    if (task == NULL)
+        return pdFAIL;
+    task->fn = fn;
+    task->arg = arg;
+    task->stack_depth = stack_depth;
+    task->priority = priority;
+
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setstacksize(&attr, HOST_TASK_STACK_SIZE);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+    // Registered before it runs, so a task that exits at once is unregistered after this
+    pthread_mutex_lock(&registry_lock);
+    int rc = pthread_create(&task->thread, &attr, _task_entry, task);
+    if (rc == 0)
+    {
+        task->number = next_task_number++;
+        task->alive = true;
+        task->next = registry;
+        registry = task;
+    }
+    pthread_mutex_unlock(&registry_lock);
+    pthread_attr_destroy(&attr);
+    if (rc != 0)
+    {
+        free(task);
+        return pdFAIL;
+    }
+
+    __sync_fetch_and_add(&task_count, 1);
+    if (out != NULL)
+        *out = task;
+    return pdPASS;
+}
+
+BaseType_t
+xTaskCreatePinnedToCore(TaskFunction_t fn, const char* name, uint32_t stack_depth, void* arg,
+                        UBaseType_t priority, TaskHandle_t* out, BaseType_t core_id)
+{
+    (void)core_id;
+    return xTaskCreate(fn, name, stack_depth, arg, priority, out);
+}
+
+void
+vTaskDelete(TaskHandle_t task)
+{
+    if (task == NULL || task == current_task)
+    {
+        if (current_task != NULL)
+            _task_unregister(current_task);
+        __sync_fetch_and_sub(&task_count, 1);
+        pthread_exit(NULL);
+    }
+
+    // Only safe for tasks blocked outside of locks, which is how the firmware uses it
+    _task_unregister(task);
+    pthread_cancel(task->thread);
+    __sync_fetch_and_sub(&task_count, 1);
+}
+
+TickType_t
+xTaskGetTickCount(void)
+{
+    pthread_once(&init_once, _host_init);
+
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    int64_t ms = (int64_t)(now.tv_sec - boot_time.tv_sec) * 1000
+                 + (now.tv_nsec - boot_time.tv_nsec) / 1000000;
+    return pdMS_TO_TICKS(ms);
+}
+
+TickType_t
+xTaskGetTickCountFromISR(void)
+{
+    return xTaskGetTickCount();
+}
+
+void
+vTaskDelay(TickType_t ticks)
+{
+    if (ticks == 0)
+    {
+        sched_yield();
+        return;
+    }
+
+    struct timespec ts;
+    _deadline(ticks, &ts);
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR)
+        ;
+}
+
+BaseType_t
+xTaskDelayUntil(TickType_t* previous_wake, TickType_t increment)
+{
+    pthread_once(&init_once, _host_init);
+
+    *previous_wake += increment;
+    TickType_t now = xTaskGetTickCount();
+    if ((int32_t)(*previous_wake - now) <= 0)
+        return pdFALSE;
+
+    uint64_t ns = (uint64_t)*previous_wake * (1000000000ULL / configTICK_RATE_HZ);
+    struct timespec ts = boot_time;
+    ts.tv_sec += ns / 1000000000ULL;
+    ts.tv_nsec += ns % 1000000000ULL;
+    if (ts.tv_nsec >= 1000000000L)
+    {
+        ts.tv_sec++;
+        ts.tv_nsec -= 1000000000L;
+    }
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR)
+        ;
+    return pdTRUE;
+}
+
+void
+vTaskDelayUntil(TickType_t* previous_wake, TickType_t increment)
+{
+    xTaskDelayUntil(previous_wake, increment);
+}
+
+TaskHandle_t
+xTaskGetCurrentTaskHandle(void)
+{
+    // Threads not created by xTaskCreate (main, timer dispatch) get a handle on first use
+    if (current_task == NULL)
+    {
+        current_task = _task_alloc("main");
+        if (current_task != NULL)
+            current_task->thread = pthread_self();
+    }
+    return current_task;
+}
+
+const char*
+pcTaskGetName(TaskHandle_t task)
+{
+    if (task == NULL)
+        task = xTaskGetCurrentTaskHandle();
+    return task->name;
+}
+
+// Host threads have large stacks and no watermark; report the requested size as unused
+UBaseType_t
+uxTaskGetStackHighWaterMark(TaskHandle_t task)
+{
+    if (task == NULL)
+        task = xTaskGetCurrentTaskHandle();
+    return task != NULL ? task->stack_depth : 0;
+}
+
+UBaseType_t
+uxTaskGetNumberOfTasks(void)
+{
+    return task_count;
+}
+
+static uint32_t
+_timespec_us(const struct timespec* ts)
+{
+    return (uint32_t)((uint64_t)ts->tv_sec * 1000000 + (uint64_t)ts->tv_nsec / 1000);
+}
+
+// Run time is the thread's CPU time and the total is the time since boot, both in
+// microseconds like CONFIG_FREERTOS_RUN_TIME_STATS_USING_ESP_TIMER
+UBaseType_t
+uxTaskGetSystemState(TaskStatus_t* status, UBaseType_t size, uint32_t* total_run_time)
+{
+    pthread_once(&init_once, _host_init);
+    UBaseType_t count = 0;
+
+    pthread_mutex_lock(&registry_lock);
+    for (struct host_task* task = registry; task != NULL && count < size; task = task->next)
+    {
+        clockid_t clock;
+        struct timespec cpu = {0};
+        if (!task->alive || pthread_getcpuclockid(task->thread, &clock) != 0
+            || clock_gettime(clock, &cpu) != 0)
+            continue;
+
+        status[count++] = (TaskStatus_t){
+            .xHandle = task,
+            .pcTaskName = task->name,
+            .xTaskNumber = task->number,
+            .eCurrentState = task == current_task ? eRunning : eBlocked,
+            .uxCurrentPriority = task->priority,
+            .uxBasePriority = task->priority,
+            .ulRunTimeCounter = _timespec_us(&cpu),
+            .usStackHighWaterMark = task->stack_depth,
+            .xCoreID = 0,
+        };
+    }
+    pthread_mutex_unlock(&registry_lock);
+
+    if (total_run_time != NULL)
+    {
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        *total_run_time = _timespec_us(&now) - _timespec_us(&boot_time);
+    }
+    return count;
+}
+
+uint32_t
+ulTaskNotifyTake(BaseType_t clear_on_exit, TickType_t ticks_to_wait)
+{
+    struct host_task* task = xTaskGetCurrentTaskHandle();
+    struct timespec deadline;
+    _deadline(ticks_to_wait, &deadline);
+
+    pthread_mutex_lock(&task->lock);
+    while (task->notify == 0)
+    {
+        if (!_cond_wait(&task->cond, &task->lock, ticks_to_wait, &deadline))
+            break;
+    }
+
+    uint32_t value = task->notify;
+    if (value > 0)
+        task->notify = clear_on_exit ? 0 : value - 1;
+    pthread_mutex_unlock(&task->lock);
+    return value;
+}
+
+BaseType_t
+xTaskNotifyGive(TaskHandle_t task)
+{
+    pthread_mutex_lock(&task->lock);
+    task->notify++;
+    pthread_cond_signal(&task->cond);
+    pthread_mutex_unlock(&task->lock);
+    return pdPASS;
+}
+
+void
+vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t* higher_priority_task_woken)
+{
+    xTaskNotifyGive(task);
+    if (higher_priority_task_woken != NULL)
+        *higher_priority_task_woken = pdTRUE;
+}
+
+/* ---------------------------------------------------------------- queues */
+
+static struct host_queue*
+_queue_alloc(UBaseType_t length, UBaseType_t item_size, UBaseType_t initial_count)
+{
+    struct host_queue* queue = calloc(1, sizeof(*queue));
+    if (queue == NULL)
+        return NULL;
+    if (item_size > 0)
+    {
+        queue->items = calloc(length, item_size);
+        if (queue->items == NULL)
+        {
+            free(queue);
+            return NULL;
+        }
+    }
+    queue->length = length;
+    queue->item_size = item_size;
+    queue->count = initial_count;
+    pthread_mutex_init(&queue->lock, NULL);
+    _cond_init(&queue->not_empty);
+    _cond_init(&queue->not_full);
+    return queue;
+}
+
+QueueHandle_t
+xQueueCreate(UBaseType_t length, UBaseType_t item_size)
+{
+    return _queue_alloc(length, item_size, 0);
+}
+
+void
+vQueueDelete(QueueHandle_t queue)
+{
+    if (queue == NULL)
+        return;
+    free(queue->items);
+    free(queue);
+}
+
+static BaseType_t
+_queue_send(QueueHandle_t queue, const void* item, TickType_t ticks_to_wait, bool front,
+            bool overwrite)
+{
+    struct timespec deadline;
+    _deadline(ticks_to_wait, &deadline);
+
+    pthread_mutex_lock(&queue->lock);
+    while (queue->count >= queue->length && !overwrite)
+    {
+        if (!_cond_wait(&queue->not_full, &queue->lock, ticks_to_wait, &deadline))
+        {
+            pthread_mutex_unlock(&queue->lock);
+            return errQUEUE_FULL;
+        }
+    }
+
+    if (queue->item_size > 0)
+    {
+        UBaseType_t slot;
+        if (overwrite && queue->count >= queue->length)
+        {
+            slot = queue->head;
+            queue->count--;
+        }
+        else if (front)
+        {
+            queue->head = (queue->head + queue->length - 1) % queue->length;
+            slot = queue->head;
+        }
+        else
+        {
+            slot = (queue->head + queue->count) % queue->length;
+        }
+        memcpy(queue->items + slot * queue->item_size, item, queue->item_size);
+    }
+    else if (overwrite && queue->count >= queue->length)
+    {
+        queue->count--;
+    }
+    queue->count++;
+
+    pthread_cond_signal(&queue->not_empty);
+    pthread_mutex_unlock(&queue->lock);
+    return pdPASS;
+}
+
+static BaseType_t
+_queue_receive(QueueHandle_t queue, void* item, TickType_t ticks_to_wait, bool peek)
+{
+    struct timespec deadline;
+    _deadline(ticks_to_wait, &deadline);
+
+    pthread_mutex_lock(&queue->lock);
+    while (queue->count == 0)
+    {
+        if (!_cond_wait(&queue->not_empty, &queue->lock, ticks_to_wait, &deadline))
+        {
+            pthread_mutex_unlock(&queue->lock);
+            return pdFALSE;
+        }
+    }
+
+    if (queue->item_size > 0)
+        memcpy(item, queue->items + queue->head * queue->item_size, queue->item_size);
+    if (!peek)
+    {
+        if (queue->item_size > 0)
+            queue->head = (queue->head + 1) % queue->length;
+        queue->count--;
+        pthread_cond_signal(&queue->not_full);
+    }
+
+    pthread_mutex_unlock(&queue->lock);
+    return pdTRUE;
+}
+
+BaseType_t
+xQueueSend(QueueHandle_t queue, const void* item, TickType_t ticks_to_wait)
+{
+    return _queue_send(queue, item, ticks_to_wait, false, false);
+}
+
+BaseType_t
+xQueueSendToFront(QueueHandle_t queue, const void* item, TickType_t ticks_to_wait)
+{
+    return _queue_send(queue, item, ticks_to_wait, true, false);
+}
+
+BaseType_t
+xQueueOverwrite(QueueHandle_t queue, const void* item)
+{
+    return _queue_send(queue, item, 0, false, true);
+}
+
+BaseType_t
+xQueueSendFromISR(QueueHandle_t queue, const void* item, BaseType_t* higher_priority_task_woken)
+{
+    if (higher_priority_task_woken != NULL)
+        *higher_priority_task_woken = pdFALSE;
+    return _queue_send(queue, item, 0, false, false);
+}
+
+BaseType_t
+xQueueReceive(QueueHandle_t queue, void* item, TickType_t ticks_to_wait)
+{
+    return _queue_receive(queue, item, ticks_to_wait, false);
+}
+
+BaseType_t
+xQueuePeek(QueueHandle_t queue, void* item, TickType_t ticks_to_wait)
+{
+    return _queue_receive(queue, item, ticks_to_wait, true);
+}
+
+UBaseType_t
+uxQueueMessagesWaiting(QueueHandle_t queue)
+{
+    pthread_mutex_lock(&queue->lock);
+    UBaseType_t count = queue->count;
+    pthread_mutex_unlock(&queue->lock);
+    return count;
+}
+
+BaseType_t
+xQueueReset(QueueHandle_t queue)
+{
+    pthread_mutex_lock(&queue->lock);
+    queue->head = 0;
+    queue->count = 0;
+    pthread_cond_broadcast(&queue->not_full);
+    pthread_mutex_unlock(&queue->lock);
+    return pdPASS;
+}
+
+/* ---------------------------------------------------------------- semaphores */
+
+SemaphoreHandle_t
+xSemaphoreCreateMutex(void)
+{
+    return _queue_alloc(1, 0, 1);
+}
+
+SemaphoreHandle_t
+xSemaphoreCreateBinary(void)
+{
+    return _queue_alloc(1, 0, 0);
+}
+
+SemaphoreHandle_t
+xSemaphoreCreateCounting(UBaseType_t max_count, UBaseType_t initial_count)
+{
+    return _queue_alloc(max_count, 0, initial_count);
+}
+
+BaseType_t
+xSemaphoreTake(SemaphoreHandle_t sem, TickType_t ticks_to_wait)
+{
+    return _queue_receive(sem, NULL, ticks_to_wait, false);
+}
+
+BaseType_t
+xSemaphoreGive(SemaphoreHandle_t sem)
+{
+    return _queue_send(sem, NULL, 0, false, false);
+}
+
+BaseType_t
+xSemaphoreGiveFromISR(SemaphoreHandle_t sem, BaseType_t* higher_priority_task_woken)
+{
+    if (higher_priority_task_woken != NULL)
+        *higher_priority_task_woken = pdFALSE;
+    return xSemaphoreGive(sem);
+}
+
+UBaseType_t
+uxSemaphoreGetCount(SemaphoreHandle_t sem)
+{
+    return uxQueueMessagesWaiting(sem);
+}
+
+/* ---------------------------------------------------------------- event groups */
+
+EventGroupHandle_t
+xEventGroupCreate(void)
+{
+    struct host_event_group* group = calloc(1, sizeof(*group));
+    if (group == NULL)
+        return NULL;
+    pthread_mutex_init(&group->lock, NULL);
+    _cond_init(&group->cond);
+    return group;
+}
+
+void
+vEventGroupDelete(EventGroupHandle_t group)
+{
+    free(group);
+}
+
+EventBits_t
+xEventGroupSetBits(EventGroupHandle_t group, EventBits_t bits)
+{
+    pthread_mutex_lock(&group->lock);
+    group->bits |= bits;
+    EventBits_t result = group->bits;
+    pthread_cond_broadcast(&group->cond);
+    pthread_mutex_unlock(&group->lock);
+    return result;
+}
+
+EventBits_t
+xEventGroupClearBits(EventGroupHandle_t group, EventBits_t bits)
+{
+    pthread_mutex_lock(&group->lock);
+    EventBits_t previous = group->bits;
+    group->bits &= ~bits;
+    pthread_mutex_unlock(&group->lock);
+    return previous;
+}
+
+EventBits_t
+xEventGroupGetBits(EventGroupHandle_t group)
+{
+    pthread_mutex_lock(&group->lock);
+    EventBits_t bits = group->bits;
+    pthread_mutex_unlock(&group->lock);
+    return bits;
+}
+
+EventBits_t
+xEventGroupWaitBits(EventGroupHandle_t group, EventBits_t bits, BaseType_t clear_on_exit,
+                    BaseType_t wait_for_all, TickType_t ticks_to_wait)
+{
+    struct timespec deadline;
+    _deadline(ticks_to_wait, &deadline);
+
+    pthread_mutex_lock(&group->lock);
+    while (true)
+    {
+        EventBits_t set = group->bits & bits;
+        if ((wait_for_all && set == bits) || (!wait_for_all && set != 0))
+        {
+            EventBits_t result = group->bits;
+            if (clear_on_exit)
+                group->bits &= ~bits;
+            pthread_mutex_unlock(&group->lock);
+            return result;
+        }
+        if (!_cond_wait(&group->cond, &group->lock, ticks_to_wait, &deadline))
+            break;
+    }
+
+    EventBits_t result = group->bits;
+    pthread_mutex_unlock(&group->lock);
+    return result;
+}
@@ -0,0 +1,261 @@
+#include <string.h>
+
+#include "driver/gpio.h"
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+
+static const char* TAG = "gpio_host";
+
+typedef struct
+{
+    gpio_mode_t mode;
+    gpio_pull_mode_t pull;
+    gpio_int_type_t intr_type;
+    bool intr_enabled;
+    gpio_isr_t isr;
+    void* isr_arg;
+    int output;
+    int input;
+    bool driven;
+} host_pin_t;
+
+static host_pin_t pins[GPIO_NUM_MAX];
+static bool isr_service = false;
+
+static bool
+_valid(gpio_num_t gpio_num)
+{
+    return gpio_num >= 0 && gpio_num < GPIO_NUM_MAX;
+}
+
+// Level seen by the input buffer: external drive, then own output, then the pull
+static int
+_pin_level(const host_pin_t* pin)
+{
+    if (pin->driven)
+        return pin->input;
+    if (pin->mode & GPIO_MODE_OUTPUT)
+        return pin->output;
+    return pin->pull == GPIO_PULLUP_ONLY || pin->pull == GPIO_PULLUP_PULLDOWN;
+}
+
+// Runs the ISR for a level change, with "interrupts" (critical sections) held off
+static void
+_pin_changed(gpio_num_t gpio_num, int before, int after)
+{
+    host_pin_t* pin = &pins[gpio_num];
+    if (before == after || !pin->intr_enabled || pin->isr == NULL || !isr_service)
+        return;
+
+    bool fire = pin->intr_type == GPIO_INTR_ANYEDGE
+                || (pin->intr_type == GPIO_INTR_POSEDGE && after == 1)
+                || (pin->intr_type == GPIO_INTR_NEGEDGE && after == 0)
+                || (pin->intr_type == GPIO_INTR_HIGH_LEVEL && after == 1)
+                || (pin->intr_type == GPIO_INTR_LOW_LEVEL && after == 0);
+    if (fire)
+        pin->isr(pin->isr_arg);
+}
+
+esp_err_t
+gpio_config(const gpio_config_t* config)
+{
+    for (gpio_num_t i = 0; i < GPIO_NUM_MAX; i++)
+    {
+        if (!(config->pin_bit_mask & (1ULL << i)))
+            continue;
+
+        portENTER_CRITICAL(NULL);
+        pins[i].mode = config->mode;
+        if (config->pull_up_en && config->pull_down_en)
+            pins[i].pull = GPIO_PULLUP_PULLDOWN;
+        else if (config->pull_up_en)
+            pins[i].pull = GPIO_PULLUP_ONLY;
+        else if (config->pull_down_en)
+            pins[i].pull = GPIO_PULLDOWN_ONLY;
+        else
+            pins[i].pull = GPIO_FLOATING;
+        pins[i].intr_type = config->intr_type;
+        pins[i].intr_enabled = config->intr_type != GPIO_INTR_DISABLE;
+        portEXIT_CRITICAL(NULL);
+    }
+    return ESP_OK;
+}
+
+esp_err_t
+gpio_reset_pin(gpio_num_t gpio_num)
+{
+    if (!_valid(gpio_num))
+        return ESP_ERR_INVALID_ARG;
+
+    portENTER_CRITICAL(NULL);
+    gpio_isr_t isr = pins[gpio_num].isr;
+    void* isr_arg = pins[gpio_num].isr_arg;
+    memset(&pins[gpio_num], 0, sizeof(pins[gpio_num]));
+    pins[gpio_num].pull = GPIO_PULLUP_ONLY;
+    pins[gpio_num].isr = isr;
+    pins[gpio_num].isr_arg = isr_arg;
+    portEXIT_CRITICAL(NULL);
+    return ESP_OK;
+}
+
+esp_err_t
+gpio_set_direction(gpio_num_t gpio_num, gpio_mode_t mode)
+{
+    if (!_valid(gpio_num))
+        return ESP_ERR_INVALID_ARG;
+
+    portENTER_CRITICAL(NULL);
+    int before = _pin_level(&pins[gpio_num]);
+    pins[gpio_num].mode = mode;
+    _pin_changed(gpio_num, before, _pin_level(&pins[gpio_num]));
+    portEXIT_CRITICAL(NULL);
+    return ESP_OK;
+}
+
+esp_err_t
+gpio_set_pull_mode(gpio_num_t gpio_num, gpio_pull_mode_t pull)
+{
+    if (!_valid(gpio_num))
+        return ESP_ERR_INVALID_ARG;
+
+    portENTER_CRITICAL(NULL);
+    pins[gpio_num].pull = pull;
+    portEXIT_CRITICAL(NULL);
+    return ESP_OK;
+}
+
+esp_err_t
+gpio_set_level(gpio_num_t gpio_num, uint32_t level)
+{
+    if (!_valid(gpio_num))
+        return ESP_ERR_INVALID_ARG;
+
+    portENTER_CRITICAL(NULL);
+    int before = _pin_level(&pins[gpio_num]);
+    pins[gpio_num].output = level ? 1 : 0;
+    _pin_changed(gpio_num, before, _pin_level(&pins[gpio_num]));
+    portEXIT_CRITICAL(NULL);
+    return ESP_OK;
+}
+
+int
+gpio_get_level(gpio_num_t gpio_num)
+{
+    if (!_valid(gpio_num))
+        return 0;
+
+    portENTER_CRITICAL(NULL);
+    int level = _pin_level(&pins[gpio_num]);
+    portEXIT_CRITICAL(NULL);
+    return level;
+}
+
+esp_err_t
+gpio_set_intr_type(gpio_num_t gpio_num, gpio_int_type_t intr_type)
+{
+    if (!_valid(gpio_num))
+        return ESP_ERR_INVALID_ARG;
+
+    portENTER_CRITICAL(NULL);
+    pins[gpio_num].intr_type = intr_type;
+    portEXIT_CRITICAL(NULL);
+    return ESP_OK;
+}
+
+esp_err_t
+gpio_intr_enable(gpio_num_t gpio_num)
+{
+    if (!_valid(gpio_num))
+        return ESP_ERR_INVALID_ARG;
+
+    portENTER_CRITICAL(NULL);
+    pins[gpio_num].intr_enabled = true;
+    portEXIT_CRITICAL(NULL);
+    return ESP_OK;
+}
+
+esp_err_t
+gpio_intr_disable(gpio_num_t gpio_num)
+{
+    if (!_valid(gpio_num))
+        return ESP_ERR_INVALID_ARG;
+
+    portENTER_CRITICAL(NULL);
+    pins[gpio_num].intr_enabled = false;
+    portEXIT_CRITICAL(NULL);
+    return ESP_OK;
+}
+
+esp_err_t
+gpio_install_isr_service(int intr_alloc_flags)
+{
+    (void)intr_alloc_flags;
+
+    if (isr_service)
+        return ESP_ERR_INVALID_STATE;
+    isr_service = true;
+    return ESP_OK;
+}
+
+void
+gpio_uninstall_isr_service(void)
+{
+    isr_service = false;
+}
+
+esp_err_t
+gpio_isr_handler_add(gpio_num_t gpio_num, gpio_isr_t isr_handler, void* args)
+{
+    if (!_valid(gpio_num))
+        return ESP_ERR_INVALID_ARG;
+    if (!isr_service)
+    {
+        ESP_LOGE(TAG, "GPIO ISR service not installed");
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    portENTER_CRITICAL(NULL);
+    pins[gpio_num].isr = isr_handler;
+    pins[gpio_num].isr_arg = args;
+    portEXIT_CRITICAL(NULL);
+    return ESP_OK;
+}
+
+esp_err_t
+gpio_isr_handler_remove(gpio_num_t gpio_num)
+{
+    if (!_valid(gpio_num))
+        return ESP_ERR_INVALID_ARG;
+
+    portENTER_CRITICAL(NULL);
+    pins[gpio_num].isr = NULL;
+    pins[gpio_num].isr_arg = NULL;
+    portEXIT_CRITICAL(NULL);
+    return ESP_OK;
+}
+
+void
+gpio_host_set_input(gpio_num_t gpio_num, int level)
+{
+    if (!_valid(gpio_num))
+        return;
+
+    portENTER_CRITICAL(NULL);
+    int before = _pin_level(&pins[gpio_num]);
+    pins[gpio_num].input = level ? 1 : 0;
+    pins[gpio_num].driven = true;
+    _pin_changed(gpio_num, before, _pin_level(&pins[gpio_num]));
+    portEXIT_CRITICAL(NULL);
+}
+
+int
+gpio_host_get_output(gpio_num_t gpio_num)
+{
+    if (!_valid(gpio_num))
+        return 0;
+
+    portENTER_CRITICAL(NULL);
+    int level = pins[gpio_num].output;
+    portEXIT_CRITICAL(NULL);
+    return level;
+}
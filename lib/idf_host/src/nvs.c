@@ -0,0 +1,331 @@
+#include <dirent.h>
+#include <errno.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "esp_log.h"
+#include "nvs_flash.h"
+
+#define NVS_MAX_HANDLES 16
+#define NVS_NAMESPACE_MAX 16
+
+static const char* TAG = "nvs_host";
+
+// Stored type tags, so typed getters reject values written with another type
+enum
+{
+    NVS_TYPE_U8 = 1,
+    NVS_TYPE_U16,
+    NVS_TYPE_U32,
+    NVS_TYPE_I32,
+    NVS_TYPE_U64,
+    NVS_TYPE_STR,
+    NVS_TYPE_BLOB,
+};
+
+typedef struct
+{
+    bool used;
+    bool writable;
+    char name[NVS_NAMESPACE_MAX];
+} nvs_host_handle_t;
+
+static nvs_host_handle_t handles[NVS_MAX_HANDLES];
+static pthread_mutex_t nvs_lock = PTHREAD_MUTEX_INITIALIZER;
+static bool initialized = false;
+static uint32_t commit_count = 0;
+
+static const char*
+_nvs_dir(void)
+{
+    const char* dir = getenv("NVS_HOST_DIR");
+    return (dir != NULL && dir[0] != '\0') ? dir : ".nvs";
+}
+
+esp_err_t
+nvs_flash_init(void)
+{
+    if (mkdir(_nvs_dir(), 0755) != 0 && errno != EEXIST)
+    {
+        ESP_LOGE(TAG, "Cannot create %s: %s", _nvs_dir(), strerror(errno));
+        return ESP_FAIL;
+    }
+    initialized = true;
+    return ESP_OK;
+}
+
+esp_err_t
+nvs_flash_erase(void)
+{
+    char path[PATH_MAX];
+    DIR* root = opendir(_nvs_dir());
+    if (root == NULL)
+        return ESP_OK;
+
+    struct dirent* ns;
+    while ((ns = readdir(root)) != NULL)
+    {
+        if (ns->d_name[0] == '.')
+            continue;
+        snprintf(path, sizeof(path), "%s/%s", _nvs_dir(), ns->d_name);
+        DIR* keys = opendir(path);
+        if (keys == NULL)
+            continue;
+
+        struct dirent* key;
+        while ((key = readdir(keys)) != NULL)
+        {
+            if (key->d_name[0] == '.')
+                continue;
+            char key_path[PATH_MAX + NAME_MAX + 2];
+            snprintf(key_path, sizeof(key_path), "%s/%s", path, key->d_name);
+            unlink(key_path);
+        }
+        closedir(keys);
+        rmdir(path);
+    }
+    closedir(root);
+    return ESP_OK;
+}
+
+esp_err_t
+nvs_flash_deinit(void)
+{
+    initialized = false;
+    return ESP_OK;
+}
+
+static nvs_host_handle_t*
+_nvs_handle(nvs_handle_t handle)
+{
+    if (handle == 0 || handle > NVS_MAX_HANDLES || !handles[handle - 1].used)
+        return NULL;
+    return &handles[handle - 1];
+}
+
+esp_err_t
+nvs_open(const char* namespace_name, nvs_open_mode_t open_mode, nvs_handle_t* out_handle)
+{
+    if (!initialized)
+        return ESP_ERR_NVS_NOT_INITIALIZED;
+    if (namespace_name == NULL || strlen(namespace_name) >= NVS_NAMESPACE_MAX
+        || strchr(namespace_name, '/') != NULL)
+        return ESP_ERR_NVS_INVALID_NAME;
+
+    char path[PATH_MAX];
+    snprintf(path, sizeof(path), "%s/%s", _nvs_dir(), namespace_name);
+    if (access(path, F_OK) != 0)
+    {
+        if (open_mode == NVS_READONLY)
+            return ESP_ERR_NVS_NOT_FOUND;
+        if (mkdir(path, 0755) != 0 && errno != EEXIST)
+            return ESP_FAIL;
+    }
+
+    pthread_mutex_lock(&nvs_lock);
+    for (int i = 0; i < NVS_MAX_HANDLES; i++)
+    {
+        if (!handles[i].used)
+        {
+            handles[i].used = true;
+            handles[i].writable = open_mode == NVS_READWRITE;
+            strcpy(handles[i].name, namespace_name);
+            pthread_mutex_unlock(&nvs_lock);
+            *out_handle = i + 1;
+            return ESP_OK;
+        }
+    }
+    pthread_mutex_unlock(&nvs_lock);
+    return ESP_ERR_NO_MEM;
+}
+
+void
+nvs_close(nvs_handle_t handle)
+{
+    pthread_mutex_lock(&nvs_lock);
+    nvs_host_handle_t* h = _nvs_handle(handle);
+    if (h != NULL)
+        h->used = false;
+    pthread_mutex_unlock(&nvs_lock);
+}
+
+esp_err_t
+nvs_commit(nvs_handle_t handle)
+{
+    if (_nvs_handle(handle) == NULL)
+        return ESP_ERR_NVS_INVALID_HANDLE;
+    pthread_mutex_lock(&nvs_lock);
+    commit_count++;
+    pthread_mutex_unlock(&nvs_lock);
+    return ESP_OK;
+}
+
+uint32_t
+nvs_host_commit_count(void)
+{
+    pthread_mutex_lock(&nvs_lock);
+    uint32_t count = commit_count;
+    pthread_mutex_unlock(&nvs_lock);
+    return count;
+}
+
+static esp_err_t
+_nvs_key_path(nvs_handle_t handle, const char* key, char* path, size_t path_len, bool write)
+{
+    nvs_host_handle_t* h = _nvs_handle(handle);
+    if (h == NULL)
+        return ESP_ERR_NVS_INVALID_HANDLE;
+    if (write && !h->writable)
+        return ESP_ERR_NVS_READ_ONLY;
+    if (key == NULL || key[0] == '\0' || strchr(key, '/') != NULL || key[0] == '.')
+        return ESP_ERR_NVS_INVALID_NAME;
+    if (strlen(key) >= NVS_KEY_NAME_MAX_SIZE)
+        return ESP_ERR_NVS_KEY_TOO_LONG;
+
+    snprintf(path, path_len, "%s/%s/%s", _nvs_dir(), h->name, key);
+    return ESP_OK;
+}
+
+// Writes the type tag and value to a temporary file and renames it, so readers never
+// see a partial value
+static esp_err_t
+_nvs_write(nvs_handle_t handle, const char* key, uint8_t type, const void* value, size_t len)
+{
+    char path[PATH_MAX];
+    esp_err_t err = _nvs_key_path(handle, key, path, sizeof(path), true);
+    if (err != ESP_OK)
+        return err;
+
+    char tmp[PATH_MAX + 8];
+    snprintf(tmp, sizeof(tmp), "%s.tmp", path);
+
+    pthread_mutex_lock(&nvs_lock);
+    FILE* f = fopen(tmp, "wb");
+    bool ok = f != NULL && fwrite(&type, 1, 1, f) == 1
+              && (len == 0 || fwrite(value, 1, len, f) == len);
+    if (f != NULL && fclose(f) != 0)
+        ok = false;
+    if (ok)
+        ok = rename(tmp, path) == 0;
+    pthread_mutex_unlock(&nvs_lock);
+
+    return ok ? ESP_OK : ESP_FAIL;
+}
+
+// Reads a value; with value NULL only its length is returned
+static esp_err_t
+_nvs_read(nvs_handle_t handle, const char* key, uint8_t type, void* value, size_t* len)
+{
+    char path[PATH_MAX];
+    esp_err_t err = _nvs_key_path(handle, key, path, sizeof(path), false);
+    if (err != ESP_OK)
+        return err;
+
+    pthread_mutex_lock(&nvs_lock);
+    FILE* f = fopen(path, "rb");
+    if (f == NULL)
+    {
+        pthread_mutex_unlock(&nvs_lock);
+        return ESP_ERR_NVS_NOT_FOUND;
+    }
+
+    uint8_t stored_type = 0;
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f) - 1;
+    fseek(f, 0, SEEK_SET);
+    if (fread(&stored_type, 1, 1, f) != 1 || size < 0)
+        err = ESP_FAIL;
+    else if (stored_type != type)
+        err = ESP_ERR_NVS_TYPE_MISMATCH;
+    else if (value == NULL)
+        *len = (size_t)size;
+    else if (*len < (size_t)size)
+        err = ESP_ERR_NVS_INVALID_LENGTH;
+    else if (fread(value, 1, (size_t)size, f) != (size_t)size)
+        err = ESP_FAIL;
+    else
+        *len = (size_t)size;
+
+    fclose(f);
+    pthread_mutex_unlock(&nvs_lock);
+    return err;
+}
+
+esp_err_t
+nvs_erase_key(nvs_handle_t handle, const char* key)
+{
+    char path[PATH_MAX];
+    esp_err_t err = _nvs_key_path(handle, key, path, sizeof(path), true);
+    if (err != ESP_OK)
+        return err;
+    return unlink(path) == 0 ? ESP_OK : ESP_ERR_NVS_NOT_FOUND;
+}
+
+esp_err_t
+nvs_erase_all(nvs_handle_t handle)
+{
+    nvs_host_handle_t* h = _nvs_handle(handle);
+    if (h == NULL)
+        return ESP_ERR_NVS_INVALID_HANDLE;
+
+    char path[PATH_MAX];
+    snprintf(path, sizeof(path), "%s/%s", _nvs_dir(), h->name);
+    DIR* dir = opendir(path);
+    if (dir == NULL)
+        return ESP_OK;
+
+    struct dirent* entry;
+    while ((entry = readdir(dir)) != NULL)
+    {
+        if (entry->d_name[0] != '.')
+            nvs_erase_key(handle, entry->d_name);
+    }
+    closedir(dir);
+    return ESP_OK;
+}
+
+esp_err_t
+nvs_set_blob(nvs_handle_t handle, const char* key, const void* value, size_t length)
+{
+    return _nvs_write(handle, key, NVS_TYPE_BLOB, value, length);
+}
+
+esp_err_t
+nvs_get_blob(nvs_handle_t handle, const char* key, void* out_value, size_t* length)
+{
+    return _nvs_read(handle, key, NVS_TYPE_BLOB, out_value, length);
+}
+
+esp_err_t
+nvs_set_str(nvs_handle_t handle, const char* key, const char* value)
+{
+    return _nvs_write(handle, key, NVS_TYPE_STR, value, strlen(value) + 1);
+}
+
+esp_err_t
+nvs_get_str(nvs_handle_t handle, const char* key, char* out_value, size_t* length)
+{
+    return _nvs_read(handle, key, NVS_TYPE_STR, out_value, length);
+}
+
+#define NVS_HOST_INT(suffix, type, tag)                                                            \
+    esp_err_t nvs_set_##suffix(nvs_handle_t handle, const char* key, type value)                   \
+    {                                                                                              \
+        return _nvs_write(handle, key, tag, &value, sizeof(value));                                \
+    }                                                                                              \
+    esp_err_t nvs_get_##suffix(nvs_handle_t handle, const char* key, type* out_value)              \
+    {                                                                                              \
+        size_t len = sizeof(*out_value);                                                           \
+        return _nvs_read(handle, key, tag, out_value, &len);                                       \
+    }
+
+NVS_HOST_INT(u8, uint8_t, NVS_TYPE_U8)
+NVS_HOST_INT(u16, uint16_t, NVS_TYPE_U16)
+NVS_HOST_INT(u32, uint32_t, NVS_TYPE_U32)
+NVS_HOST_INT(i32, int32_t, NVS_TYPE_I32)
+NVS_HOST_INT(u64, uint64_t, NVS_TYPE_U64)
@@ -0,0 +1,294 @@
+#include "actuator.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "events.h"
+#include "metrics.h"
+#include "trace.h"
+#include "freertos/FreeRTOS.h"
+
+static const char* TAG = "actuator";
+
+typedef struct
+{
+    uint16_t count;
+    bool toggle;
+    uint32_t on_us;
+    uint32_t off_us;
+} actuator_cmd_t;
+
+typedef struct
+{
+    gpio_num_t gpio;
+    esp_timer_handle_t timer;
+    uint32_t pulse_us;
+
+    actuator_cmd_t queue[ACTUATOR_QUEUE_LEN];
+    int queue_head;
+    int queue_len;
+
+    actuator_cmd_t current;
+    uint16_t remaining;
+    bool output_high;
+    bool running;
+    bool state;
+    int64_t busy_since_us;
+    // Last falling edge, and how long the output must stay low after it
+    int64_t low_since_us;
+    uint32_t gap_us;
+} actuator_channel_t;
+
+static actuator_channel_t channels[ACTUATOR_MAX_CHANNELS];
+static int channel_count = 0;
+static portMUX_TYPE actuator_lock = portMUX_INITIALIZER_UNLOCKED;
+static metric_t* busy_us;
+static metric_t* commands_dropped;
+
+// Moves to the next pulse of the current command, or the next queued command, and returns
+// false if there is none (lock held). The caller drives the output high for current.on_us.
+static bool
+_actuator_start_next(actuator_channel_t* ch)
+{
+    if (ch->remaining == 0)
+    {
+        if (ch->queue_len == 0)
+        {
+            ch->running = false;
+            return false;
+        }
+        ch->current = ch->queue[ch->queue_head];
+        ch->queue_head = (ch->queue_head + 1) % ACTUATOR_QUEUE_LEN;
+        ch->queue_len--;
+        ch->remaining = ch->current.count;
+    }
+
+    ch->remaining--;
+    ch->output_high = true;
+    ch->running = true;
+    return true;
+}
+
+// All GPIO writes happen here, so they stay in order without holding the lock while driving
+// the pin or arming the timer
+static void
+_actuator_timer_cb(void* arg)
+{
+    actuator_channel_t* ch = (actuator_channel_t*)arg;
+    int64_t now_us = esp_timer_get_time();
+    int level = -1;
+    uint32_t timeout_us = 0;
+
+    portENTER_CRITICAL(&actuator_lock);
+    bool was_running = ch->running;
+    if (ch->output_high)
+    {
+        level = 0;
+        ch->output_high = false;
+        ch->low_since_us = now_us;
+        ch->gap_us = ch->current.off_us;
+
+        // Keep the output low for the gap before anything else runs
+        if (ch->remaining > 0 || ch->queue_len > 0)
+            timeout_us = ch->current.off_us;
+        else
+            ch->running = false;
+    }
+    else if (_actuator_start_next(ch))
+    {
+        level = 1;
+        timeout_us = ch->current.on_us;
+    }
+    bool rearm = ch->running;
+    bool idle = was_running && !ch->running;
+    bool state = ch->state;
+    int64_t busy_since_us = ch->busy_since_us;
+    portEXIT_CRITICAL(&actuator_lock);
+
+    if (level >= 0)
+    {
+        gpio_set_level(ch->gpio, level);
+        TRACE_INSTANT(TRACE_GPIO_WRITE, ch->gpio << 1 | level);
+    }
+    if (rearm)
+        esp_timer_start_once(ch->timer, timeout_us);
+
+    // All channels share the esp_timer task, the single producer of the actuator channel
+    if (idle)
+    {
+        metrics_observe(busy_us, (uint32_t)(esp_timer_get_time() - busy_since_us));
+
+        event_t event = {
+            .type = EVENT_ACTUATOR_IDLE,
+            .actuator = {.channel = (int8_t)(ch - channels), .state = state},
+        };
+        events_publish(EVENTS_CH_ACTUATOR, &event);
+    }
+}
+
+esp_err_t
+actuator_register(gpio_num_t gpio, uint32_t pulse_ms, int* channel)
+{
+    if (channel_count >= ACTUATOR_MAX_CHANNELS)
+        return ESP_ERR_NO_MEM;
+
+    busy_us = metrics_histogram("actuator_busy_us", NULL,
+                                "Time from a command to the end of its pulses in microseconds");
+    commands_dropped = metrics_counter("actuator_commands_dropped", NULL,
+                                       "Commands rejected because the queue was full");
+
+    actuator_channel_t* ch = &channels[channel_count];
+    ch->gpio = gpio;
+    ch->pulse_us = pulse_ms * 1000;
+
+    gpio_reset_pin(gpio);
+    gpio_set_direction(gpio, GPIO_MODE_OUTPUT);
+    gpio_set_level(gpio, 0);
+
+    esp_timer_create_args_t timer_args = {
+        .callback = _actuator_timer_cb,
+        .arg = ch,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = "actuator",
+    };
+    esp_err_t err = esp_timer_create(&timer_args, &ch->timer);
+    if (err != ESP_OK)
+    {
+        ESP_LOGE(TAG, "Timer creation failed: %s", esp_err_to_name(err));
+        return err;
+    }
+
+    *channel = channel_count++;
+    return ESP_OK;
+}
+
+// Appends a command (lock held). If the channel was idle, sets *kick_us to the time left of
+// the gap after the last pulse; the caller then arms the timer, which starts the command.
+static esp_err_t
+_actuator_enqueue(actuator_channel_t* ch, const actuator_cmd_t* cmd, int64_t* kick_us)
+{
+    if (ch->queue_len >= ACTUATOR_QUEUE_LEN)
+    {
+        metrics_inc(commands_dropped);
+        return ESP_ERR_NO_MEM;
+    }
+
+    ch->queue[(ch->queue_head + ch->queue_len) % ACTUATOR_QUEUE_LEN] = *cmd;
+    ch->queue_len++;
+
+    if (!ch->running)
+    {
+        int64_t now_us = esp_timer_get_time();
+        int64_t wait_us = ch->gap_us - (now_us - ch->low_since_us);
+        *kick_us = wait_us > 0 ? wait_us : 0;
+        ch->busy_since_us = now_us;
+        ch->running = true;
+    }
+
+    return ESP_OK;
+}
+
+static void
+_actuator_kick(actuator_channel_t* ch, int64_t kick_us)
+{
+    if (kick_us >= 0)
+        esp_timer_start_once(ch->timer, (uint64_t)kick_us);
+}
+
+static actuator_cmd_t*
+_actuator_last_queued(actuator_channel_t* ch)
+{
+    if (ch->queue_len == 0)
+        return NULL;
+    return &ch->queue[(ch->queue_head + ch->queue_len - 1) % ACTUATOR_QUEUE_LEN];
+}
+
+esp_err_t
+actuator_pulse(int channel, int count, uint32_t on_ms, uint32_t off_ms)
+{
+    if (channel < 0 || channel >= channel_count || count <= 0)
+        return ESP_ERR_INVALID_ARG;
+
+    actuator_channel_t* ch = &channels[channel];
+    actuator_cmd_t cmd = {
+        .count = (uint16_t)count,
+        .toggle = false,
+        .on_us = on_ms * 1000,
+        .off_us = off_ms * 1000,
+    };
+    esp_err_t err = ESP_OK;
+    int64_t kick_us = -1;
+
+    portENTER_CRITICAL(&actuator_lock);
+    actuator_cmd_t* last = _actuator_last_queued(ch);
+    if (last == NULL || last->toggle || last->count != cmd.count || last->on_us != cmd.on_us
+        || last->off_us != cmd.off_us)
+    {
+        err = _actuator_enqueue(ch, &cmd, &kick_us);
+    }
+    portEXIT_CRITICAL(&actuator_lock);
+
+    _actuator_kick(ch, kick_us);
+    return err;
+}
+
+esp_err_t
+actuator_set_state(int channel, bool state)
+{
+    if (channel < 0 || channel >= channel_count)
+        return ESP_ERR_INVALID_ARG;
+
+    actuator_channel_t* ch = &channels[channel];
+    esp_err_t err = ESP_OK;
+    int64_t kick_us = -1;
+
+    portENTER_CRITICAL(&actuator_lock);
+    if (ch->state != state)
+    {
+        actuator_cmd_t* last = _actuator_last_queued(ch);
+        if (last != NULL && last->toggle)
+        {
+            // The pending toggle has not started yet: going back just cancels it
+            ch->queue_len--;
+            ch->state = state;
+        }
+        else
+        {
+            actuator_cmd_t cmd = {
+                .count = 1,
+                .toggle = true,
+                .on_us = ch->pulse_us,
+                .off_us = ch->pulse_us,
+            };
+            err = _actuator_enqueue(ch, &cmd, &kick_us);
+            if (err == ESP_OK)
+                ch->state = state;
+        }
+    }
+    portEXIT_CRITICAL(&actuator_lock);
+
+    _actuator_kick(ch, kick_us);
+    return err;
+}
+
+bool
+actuator_get_state(int channel)
+{
+    if (channel < 0 || channel >= channel_count)
+        return false;
+
+    portENTER_CRITICAL(&actuator_lock);
+    bool state = channels[channel].state;
+    portEXIT_CRITICAL(&actuator_lock);
+    return state;
+}
+
+bool
+actuator_is_busy(int channel)
+{
+    if (channel < 0 || channel >= channel_count)
+        return false;
+
+    portENTER_CRITICAL(&actuator_lock);
+    bool busy = channels[channel].running || channels[channel].queue_len > 0;
+    portEXIT_CRITICAL(&actuator_lock);
+    return busy;
+}
@@ -0,0 +1,119 @@
+#include <string.h>
+
+#include "button_fsm.h"
+
+void
+button_fsm_init(button_fsm_t* button, const button_cfg_t* cfg, bool pressed)
+{
+    memset(button, 0, sizeof(*button));
+    button->cfg = *cfg;
+    button->pressed = pressed;
+    // A button held at startup must be released before it can produce a gesture
+    button->long_sent = pressed;
+}
+
+bool
+button_fsm_edge(button_fsm_t* button, int64_t now_ms)
+{
+    if (button->settling)
+        return false;
+
+    button->settling = true;
+    button->edge_ms = now_ms;
+    return true;
+}
+
+// Applies a debounced level change at the time of the edge that started it
+static uint32_t
+_button_fsm_level(button_fsm_t* button, bool pressed)
+{
+    button->pressed = pressed;
+    if (pressed)
+    {
+        button->pressed_ms = button->edge_ms;
+        button->long_sent = false;
+
+        // Pressed again too late for a double click: the pending click stands on its own
+        if (button->clicks == 1 && button->edge_ms >= button->click_until_ms)
+        {
+            button->clicks = 0;
+            return BUTTON_EVENT_PRESS | BUTTON_EVENT_CLICK;
+        }
+        return BUTTON_EVENT_PRESS;
+    }
+
+    // The release of a long press is not a click
+    if (button->long_sent)
+    {
+        button->clicks = 0;
+        return BUTTON_EVENT_RELEASE;
+    }
+
+    if (button->cfg.double_click_ms == 0)
+        return BUTTON_EVENT_RELEASE | BUTTON_EVENT_CLICK;
+
+    if (++button->clicks == 2)
+    {
+        button->clicks = 0;
+        return BUTTON_EVENT_RELEASE | BUTTON_EVENT_DOUBLE_CLICK;
+    }
+    button->click_until_ms = button->edge_ms + button->cfg.double_click_ms;
+    return BUTTON_EVENT_RELEASE;
+}
+
+uint32_t
+button_fsm_update(button_fsm_t* button, bool pressed, int64_t now_ms)
+{
+    uint32_t events = 0;
+
+    if (button->settling)
+    {
+        if (now_ms < button->edge_ms + button->cfg.debounce_ms)
+            return 0;
+
+        // A burst that ends at the level it started from was noise
+        button->settling = false;
+        if (pressed != button->pressed)
+            events |= _button_fsm_level(button, pressed);
+    }
+
+    // A single click is only final once no second click can follow
+    if (button->clicks == 1 && !button->pressed && now_ms >= button->click_until_ms)
+    {
+        button->clicks = 0;
+        events |= BUTTON_EVENT_CLICK;
+    }
+
+    if (button->pressed && !button->long_sent && button->cfg.long_press_ms > 0
+        && now_ms - button->pressed_ms >= button->cfg.long_press_ms)
+    {
+        button->long_sent = true;
+        button->clicks = 0;
+        events |= BUTTON_EVENT_LONG_PRESS;
+    }
+
+    return events;
+}
+
+bool
+button_fsm_settling(const button_fsm_t* button)
+{
+    return button->settling;
+}
+
+int64_t
+button_fsm_next_ms(const button_fsm_t* button)
+{
+    int64_t next = INT64_MAX;
+
+    if (button->settling)
+        next = button->edge_ms + button->cfg.debounce_ms;
+    if (button->clicks == 1 && !button->pressed && button->click_until_ms < next)
+        next = button->click_until_ms;
+    if (button->pressed && !button->long_sent && button->cfg.long_press_ms > 0
+        && button->pressed_ms + button->cfg.long_press_ms < next)
+    {
+        next = button->pressed_ms + button->cfg.long_press_ms;
+    }
+    return next;
+}
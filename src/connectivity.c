@@ -0,0 +1,184 @@
+#include "connectivity.h"
+#include "esp_log.h"
+#include "freertos/event_groups.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+
+#include "metrics.h"
+
+static const char* TAG = "connectivity";
+
+// Bit n - 1 is set while the state is n or higher; OFFLINE has no bit
+#define STATE_BITS(state) ((EventBits_t)((1u << (state)) - 1))
+#define ALL_BITS STATE_BITS(CONNECTIVITY_CLOUD_READY)
+#define BACKOFF_TASKS_MAX 4
+
+static EventGroupHandle_t state_group = NULL;
+// Serializes transitions, so the bits never show a mix of two states
+static SemaphoreHandle_t state_lock = NULL;
+static uint32_t link_epoch = 0;
+static metric_t* state_gauge;
+// Tasks that have slept in connectivity_backoff(), notified whenever the link comes up
+static TaskHandle_t backoff_tasks[BACKOFF_TASKS_MAX];
+static int backoff_task_count = 0;
+
+static connectivity_state_t
+_state_of(EventBits_t bits)
+{
+    connectivity_state_t state = CONNECTIVITY_OFFLINE;
+    while (state < CONNECTIVITY_CLOUD_READY && (bits & (1u << state)) != 0)
+        state++;
+    return state;
+}
+
+// Moves to a new state if allowed is true for the current one
+static void
+_transition(connectivity_state_t to, bool (*allowed)(connectivity_state_t from))
+{
+    xSemaphoreTake(state_lock, portMAX_DELAY);
+    connectivity_state_t from = _state_of(xEventGroupGetBits(state_group));
+    bool change = from != to && (allowed == NULL || allowed(from));
+    bool new_link = change && to == CONNECTIVITY_ONLINE && from < CONNECTIVITY_ONLINE;
+    if (change)
+    {
+        if (new_link)
+            link_epoch++;
+        xEventGroupClearBits(state_group, ALL_BITS & ~STATE_BITS(to));
+        xEventGroupSetBits(state_group, STATE_BITS(to));
+    }
+    int notify_count = new_link ? backoff_task_count : 0;
+    xSemaphoreGive(state_lock);
+
+    if (!change)
+        return;
+    // Tasks are only ever added, so the first notify_count entries are stable
+    for (int i = 0; i < notify_count; i++)
+        xTaskNotifyGive(backoff_tasks[i]);
+    metrics_set(state_gauge, to);
+    ESP_LOGI(TAG, "%s -> %s", connectivity_state_name(from), connectivity_state_name(to));
+}
+
+static bool
+_link_is_down(connectivity_state_t from)
+{
+    return from < CONNECTIVITY_ONLINE;
+}
+
+static bool
+_link_is_up(connectivity_state_t from)
+{
+    return from >= CONNECTIVITY_ONLINE;
+}
+
+void
+connectivity_init(void)
+{
+    if (state_group != NULL)
+        return;
+    state_group = xEventGroupCreate();
+    state_lock = xSemaphoreCreateMutex();
+    state_gauge = metrics_gauge("connectivity_state", NULL,
+                                "0 offline, 1 connecting, 2 online, 3 cloud ready");
+}
+
+void
+connectivity_link_connecting(void)
+{
+    _transition(CONNECTIVITY_CONNECTING, _link_is_down);
+}
+
+void
+connectivity_link_up(void)
+{
+    // A renewed lease on a live link is not a new link
+    _transition(CONNECTIVITY_ONLINE, _link_is_down);
+}
+
+void
+connectivity_link_down(void)
+{
+    _transition(CONNECTIVITY_OFFLINE, NULL);
+}
+
+void
+connectivity_cloud_ready(bool ready)
+{
+    _transition(ready ? CONNECTIVITY_CLOUD_READY : CONNECTIVITY_ONLINE, _link_is_up);
+}
+
+connectivity_state_t
+connectivity_state(void)
+{
+    return _state_of(xEventGroupGetBits(state_group));
+}
+
+uint32_t
+connectivity_link_epoch(void)
+{
+    xSemaphoreTake(state_lock, portMAX_DELAY);
+    uint32_t epoch = link_epoch;
+    xSemaphoreGive(state_lock);
+    return epoch;
+}
+
+bool
+connectivity_wait(connectivity_state_t state, TickType_t ticks_to_wait)
+{
+    if (state == CONNECTIVITY_OFFLINE)
+        return true;
+    EventBits_t bit = 1u << (state - 1);
+    return (xEventGroupWaitBits(state_group, bit, pdFALSE, pdFALSE, ticks_to_wait) & bit) != 0;
+}
+
+bool
+connectivity_backoff(TickType_t ticks)
+{
+    TaskHandle_t self = xTaskGetCurrentTaskHandle();
+
+    xSemaphoreTake(state_lock, portMAX_DELAY);
+    bool registered = false;
+    for (int i = 0; i < backoff_task_count; i++)
+        registered |= backoff_tasks[i] == self;
+    if (!registered && backoff_task_count < BACKOFF_TASKS_MAX)
+    {
+        backoff_tasks[backoff_task_count++] = self;
+        registered = true;
+    }
+    uint32_t epoch = link_epoch;
+    xSemaphoreGive(state_lock);
+
+    if (!registered)
+    {
+        ESP_LOGW(TAG, "No free backoff slot, %s sleeps the full time", pcTaskGetName(self));
+        vTaskDelay(ticks);
+        return false;
+    }
+
+    // Other notifications of the task end the wait early too; keep sleeping through them
+    TickType_t start = xTaskGetTickCount();
+    TickType_t elapsed;
+    while ((elapsed = xTaskGetTickCount() - start) < ticks)
+    {
+        ulTaskNotifyTake(pdTRUE, ticks - elapsed);
+        if (connectivity_link_epoch() != epoch)
+            return true;
+    }
+    return false;
+}
+
+const char*
+connectivity_state_name(connectivity_state_t state)
+{
+    switch (state)
+    {
+    case CONNECTIVITY_OFFLINE:
+        return "OFFLINE";
+    case CONNECTIVITY_CONNECTING:
+        return "CONNECTING";
+    case CONNECTIVITY_ONLINE:
+        return "ONLINE";
+    case CONNECTIVITY_CLOUD_READY:
+        return "CLOUD_READY";
+    }
+    return "?";
+}
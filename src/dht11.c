@@ -1,120 +1,179 @@
 #include "dht11.h"
-#include "firebase.h"
-
-dht11_t dht11;
-
-void
-dht11_init()
+#include "esp_attr.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "metrics.h"
+#include "sensor.h"
+
+#define DHT11_MAX_EDGES 96
+#define DHT11_START_LOW_MS 18
+#define DHT11_FRAME_TIMEOUT_MS 20
+#define DHT11_RETRY_DELAY_MS 1000
+#define DHT11_READ_ATTEMPTS 5
+static const char* TAG = "DHT11";
+
+// Edge ring filled by the GPIO ISR while a frame is being received
+typedef struct
 {
-    dht11.dht11_pin = 5;
-}
-
-void
-firebase_dht11_task(void* pvParameters)
+    gpio_num_t pin;
+    dht11_edge_t edges[DHT11_MAX_EDGES];
+    volatile int count;
+    volatile TaskHandle_t waiter;
+} dht11_capture_t;
+
+static dht11_capture_t capture;
+static metric_t* read_us;
+static metric_t* read_failures;
+
+static void IRAM_ATTR
+_dht11_edge_isr(void* arg)
 {
+    dht11_capture_t* cap = (dht11_capture_t*)arg;
+    int n = cap->count;
+    if (n >= DHT11_MAX_EDGES)
+        return;
 
-    while (true)
-    {
-        dht11_read(&dht11, 5);
-        ESP_LOGI("dht11", "%.2f", dht11.temperature);
-        firebase_put("DHT11/temperature", dht11.temperature);
-        firebase_put("DHT11/humidity", dht11.humidity);
-        vTaskDelay(pdMS_TO_TICKS(1000 * 60 * 5)); // 5 minutes
-    }
-}
-
-int
-wait_for_state(dht11_t dht11, int state, int timeout)
-{
-    gpio_set_direction(dht11.dht11_pin, GPIO_MODE_INPUT);
-    int count = 0;
+    cap->edges[n].t_us = (uint32_t)esp_timer_get_time();
+    cap->edges[n].level = (uint8_t)gpio_get_level(cap->pin);
+    cap->count = ++n;
 
-    while (gpio_get_level(dht11.dht11_pin) != state)
+    if (n == DHT11_FRAME_EDGES && cap->waiter != NULL)
     {
-        if (count >= timeout)
-            return -1;
-        count += 2;
-        ets_delay_us(2);
+        BaseType_t woken = pdFALSE;
+        vTaskNotifyGiveFromISR(cap->waiter, &woken);
+        portYIELD_FROM_ISR(woken);
     }
-
-    return count;
 }
 
-void
-hold_low(dht11_t dht11, int hold_time_us)
+// Sends the start signal and records the edges of one frame; the task sleeps throughout
+static int
+_dht11_capture_frame(gpio_num_t pin)
 {
-    gpio_set_direction(dht11.dht11_pin, GPIO_MODE_OUTPUT);
-    gpio_set_level(dht11.dht11_pin, 0);
-    ets_delay_us(hold_time_us);
-    gpio_set_level(dht11.dht11_pin, 1);
+    capture.pin = pin;
+    gpio_intr_disable(capture.pin);
+    gpio_set_direction(capture.pin, GPIO_MODE_OUTPUT);
+    gpio_set_level(capture.pin, 0);
+    // pdMS_TO_TICKS() rounds down (18 ms is a single tick at 100 Hz), so round up, plus one
+    // tick because the first tick of a delay may be partial
+    vTaskDelay(pdMS_TO_TICKS(DHT11_START_LOW_MS + portTICK_PERIOD_MS - 1) + 1);
+
+    capture.count = 0;
+    capture.waiter = xTaskGetCurrentTaskHandle();
+    ulTaskNotifyTake(pdTRUE, 0);
+
+    // Releasing the line lets the pull-up raise it; that edge is captured too
+    gpio_intr_enable(capture.pin);
+    gpio_set_direction(capture.pin, GPIO_MODE_INPUT);
+
+    // A frame lasts ~5 ms; on a timeout whatever arrived is still decoded
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(DHT11_FRAME_TIMEOUT_MS));
+
+    gpio_intr_disable(capture.pin);
+    capture.waiter = NULL;
+    return capture.count;
 }
 
 int
 dht11_read(dht11_t* dht11, int connection_timeout)
 {
-    int waited = 0;
-    int one_duration = 0;
-    int zero_duration = 0;
-    int timeout_counter = 0;
-
-    uint8_t received_data[5] = {0x00, 0x00, 0x00, 0x00, 0x00};
+    uint8_t received_data[5];
 
-    while (timeout_counter < connection_timeout)
+    for (int attempt = 0; attempt < connection_timeout; attempt++)
     {
-        timeout_counter++;
-        gpio_set_direction(dht11->dht11_pin, GPIO_MODE_INPUT);
-        hold_low(*dht11, 18000);
-
-        waited = wait_for_state(*dht11, 0, 40);
-
-        if (waited == -1)
-        {
-            ESP_LOGE("DHT11:", "Failed at phase 1");
-            ets_delay_us(20000);
-            continue;
-        }
+        if (attempt > 0)
+            vTaskDelay(pdMS_TO_TICKS(DHT11_RETRY_DELAY_MS));
 
-        waited = wait_for_state(*dht11, 1, 90);
-        if (waited == -1)
+        int count = _dht11_capture_frame(dht11->dht11_pin);
+        int result = dht11_decode(capture.edges, count, received_data);
+        if (result == DHT11_DECODE_OK)
         {
-            ESP_LOGE("DHT11:", "Failed at phase 2");
-            ets_delay_us(20000);
-            continue;
+            dht11->humidity = received_data[0] + received_data[1] / 10.0;
+            dht11->temperature = received_data[2] + received_data[3] / 10.0;
+            return 0;
         }
 
-        waited = wait_for_state(*dht11, 0, 90);
-        if (waited == -1)
-        {
-            ESP_LOGE("DHT11:", "Failed at phase 3");
-            ets_delay_us(20000);
-            continue;
-        }
-        break;
+        if (result == DHT11_ERROR_CHECKSUM)
+            ESP_LOGE(TAG, "Wrong checksum");
+        else
+            ESP_LOGE(TAG, "Bad frame (%d), %d edges captured", result, count);
     }
 
-    if (timeout_counter == connection_timeout)
-        return -1;
+    return -1;
+}
 
-    for (int i = 0; i < 5; i++)
-    {
-        for (int j = 0; j < 8; j++)
-        {
-            zero_duration = wait_for_state(*dht11, 1, 58);
-            one_duration = wait_for_state(*dht11, 0, 74);
-            received_data[i] |= (one_duration > zero_duration) << (7 - j);
-        }
-    }
-    int crc = received_data[0] + received_data[1] + received_data[2] + received_data[3];
-    crc = crc & 0xff;
-    if (crc == received_data[4])
-    {
-        dht11->humidity = received_data[0] + received_data[1] / 10.0;
-        dht11->temperature = received_data[2] + received_data[3] / 10.0;
-        return 0;
-    }
-    else
+static int
+_dht11_driver_init(void* ctx)
+{
+    dht11_t* dht11 = (dht11_t*)ctx;
+
+    gpio_reset_pin(dht11->dht11_pin);
+    gpio_set_pull_mode(dht11->dht11_pin, GPIO_PULLUP_ONLY);
+    gpio_set_direction(dht11->dht11_pin, GPIO_MODE_INPUT);
+    gpio_set_intr_type(dht11->dht11_pin, GPIO_INTR_ANYEDGE);
+
+    // The service may already be installed by another driver
+    esp_err_t err = gpio_install_isr_service(0);
+    if (err != ESP_OK && err != ESP_ERR_INVALID_STATE)
     {
-        ESP_LOGE("DHT11:", "Wrong checksum");
+        ESP_LOGE(TAG, "ISR service install failed: %s", esp_err_to_name(err));
         return -1;
     }
-}
\ No newline at end of file
+
+    // Sensors share one capture buffer; reads are serialized by the sensor task
+    gpio_isr_handler_add(dht11->dht11_pin, _dht11_edge_isr, &capture);
+    gpio_intr_disable(dht11->dht11_pin);
+
+    read_us = metrics_histogram("dht11_read_us", NULL,
+                                "Duration of a DHT11 read including retries in microseconds");
+    read_failures = metrics_counter("dht11_read_failures", NULL,
+                                    "DHT11 reads that failed after all attempts");
+    return 0;
+}
+
+static int
+_dht11_driver_read(void* ctx)
+{
+    int64_t start_us = esp_timer_get_time();
+    int result = dht11_read((dht11_t*)ctx, DHT11_READ_ATTEMPTS);
+    metrics_observe(read_us, (uint32_t)(esp_timer_get_time() - start_us));
+    if (result != 0)
+        metrics_inc(read_failures);
+    return result;
+}
+
+static int
+_dht11_driver_decode(void* ctx, sensor_value_t* values, int max_values)
+{
+    dht11_t* dht11 = (dht11_t*)ctx;
+
+    if (max_values < 2)
+        return -1;
+    values[0] = (sensor_value_t){.name = "temperature", .value = dht11->temperature};
+    values[1] = (sensor_value_t){.name = "humidity", .value = dht11->humidity};
+    return 2;
+}
+
+const sensor_driver_t dht11_driver = {
+    .name = "DHT11",
+    .init = _dht11_driver_init,
+    .read = _dht11_driver_read,
+    .decode = _dht11_driver_decode,
+};
+
+void
+dht11_init()
+{
+    static dht11_t dht11 = {.dht11_pin = DHT11_GPIO_PIN};
+
+    // Whole degrees and percent are the sensor's resolution; a median of three drops
+    // single-sample flicker between two adjacent steps
+    static const sensor_report_cfg_t report = {
+        .deadband = {1.0f, 1.0f},
+        .heartbeat_ms = DHT11_HEARTBEAT_MS,
+        .filter = SENSOR_FILTER_MEDIAN,
+        .filter_len = 3,
+    };
+
+    sensor_register(&dht11_driver, &dht11, "DHT11", DHT11_SAMPLE_INTERVAL_MS, &report);
+}
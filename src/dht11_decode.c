@@ -0,0 +1,68 @@
+#include <string.h>
+
+#include "dht11_decode.h"
+
+// Accepted pulse widths in microseconds, wide enough for ISR latency jitter
+#define RESPONSE_MIN_US 60
+#define RESPONSE_MAX_US 120
+#define BIT_LOW_MIN_US 30
+#define BIT_LOW_MAX_US 90
+#define BIT_HIGH_MIN_US 10
+#define BIT_HIGH_MAX_US 100
+#define BIT_ONE_THRESHOLD_US 48
+
+static uint32_t
+_width(const dht11_edge_t* edges, int i)
+{
+    return edges[i + 1].t_us - edges[i].t_us;
+}
+
+// Finds the falling edge that starts the sensor response (~80 us low, ~80 us high)
+static int
+_find_response(const dht11_edge_t* edges, int count)
+{
+    for (int i = 0; i + 2 < count; i++)
+    {
+        if (edges[i].level != 0 || edges[i + 1].level != 1 || edges[i + 2].level != 0)
+            continue;
+
+        uint32_t low = _width(edges, i);
+        uint32_t high = _width(edges, i + 1);
+        if (low >= RESPONSE_MIN_US && low <= RESPONSE_MAX_US && high >= RESPONSE_MIN_US
+            && high <= RESPONSE_MAX_US)
+            return i;
+    }
+    return -1;
+}
+
+int
+dht11_decode(const dht11_edge_t* edges, int count, uint8_t data[5])
+{
+    memset(data, 0, 5);
+
+    int start = _find_response(edges, count);
+    if (start < 0)
+        return DHT11_ERROR_NO_RESPONSE;
+
+    // Each bit is a falling edge, a rising edge and the next falling edge
+    int i = start + 2;
+    for (int bit = 0; bit < 40; bit++, i += 2)
+    {
+        if (i + 2 >= count)
+            return DHT11_ERROR_TIMING;
+        if (edges[i].level != 0 || edges[i + 1].level != 1 || edges[i + 2].level != 0)
+            return DHT11_ERROR_TIMING;
+
+        uint32_t low = _width(edges, i);
+        uint32_t high = _width(edges, i + 1);
+        if (low < BIT_LOW_MIN_US || low > BIT_LOW_MAX_US || high < BIT_HIGH_MIN_US
+            || high > BIT_HIGH_MAX_US)
+            return DHT11_ERROR_TIMING;
+
+        if (high > BIT_ONE_THRESHOLD_US)
+            data[bit / 8] |= 0x80 >> (bit % 8);
+    }
+
+    uint8_t crc = (uint8_t)(data[0] + data[1] + data[2] + data[3]);
+    return (crc == data[4]) ? DHT11_DECODE_OK : DHT11_ERROR_CHECKSUM;
+}
@@ -0,0 +1,144 @@
+#include <stdbool.h>
+#include <string.h>
+
+#include "dns_reply.h"
+
+#define HEADER_LEN 12
+#define FLAG_QR 0x8000
+#define FLAG_AA 0x0400
+#define FLAG_TC 0x0200
+#define FLAG_RD 0x0100
+#define LABEL_MAX 63
+#define NAME_MAX_LEN 255
+
+typedef struct
+{
+    uint16_t name_offset;
+    uint16_t type;
+    uint16_t cls;
+} dns_question_t;
+
+static uint16_t
+_get16(const uint8_t* p)
+{
+    return (uint16_t)(p[0] << 8 | p[1]);
+}
+
+static void
+_put16(uint8_t* p, uint16_t value)
+{
+    p[0] = (uint8_t)(value >> 8);
+    p[1] = (uint8_t)value;
+}
+
+// Returns the offset after the name at pos, or 0 if it runs past len or breaks the limits.
+// Clients do not compress question names, so pointers are rejected.
+static size_t
+_skip_name(const uint8_t* buf, size_t len, size_t pos)
+{
+    size_t name_len = 0;
+
+    while (pos < len)
+    {
+        uint8_t label = buf[pos++];
+        if (label == 0)
+            return name_len + 1 <= NAME_MAX_LEN ? pos : 0;
+        if (label > LABEL_MAX)
+            return 0;
+
+        name_len += (size_t)label + 1;
+        if (name_len > NAME_MAX_LEN || label > len - pos)
+            return 0;
+        pos += label;
+    }
+    return 0;
+}
+
+// Header-only reply with an error code and no sections
+static size_t
+_dns_reply_error(const uint8_t* query, uint16_t flags, uint8_t* reply, uint16_t rcode)
+{
+    memcpy(reply, query, 2);
+    _put16(reply + 2, flags | rcode);
+    memset(reply + 4, 0, HEADER_LEN - 4);
+    return HEADER_LEN;
+}
+
+void
+dns_reply_init(dns_reply_template_t* tpl, const uint8_t ip[4], uint32_t ttl_s)
+{
+    uint8_t* p = tpl->answer;
+
+    _put16(p, 0xc000 | HEADER_LEN); // Pointer to the name, patched per question
+    _put16(p + 2, DNS_TYPE_A);
+    _put16(p + 4, DNS_CLASS_IN);
+    _put16(p + 6, (uint16_t)(ttl_s >> 16));
+    _put16(p + 8, (uint16_t)ttl_s);
+    _put16(p + 10, 4);
+    memcpy(p + 12, ip, 4);
+}
+
+size_t
+dns_reply_build(const dns_reply_template_t* tpl, const uint8_t* query, size_t query_len,
+                uint8_t* reply, size_t reply_cap)
+{
+    if (query_len < HEADER_LEN || reply_cap < HEADER_LEN)
+        return 0;
+
+    uint16_t query_flags = _get16(query + 2);
+    if (query_flags & FLAG_QR)
+        return 0; // Never answer responses, that could start a loop
+
+    uint16_t opcode = (query_flags >> 11) & 0xf;
+    uint16_t flags = FLAG_QR | FLAG_AA | (opcode << 11) | (query_flags & FLAG_RD);
+    if (opcode != 0)
+        return _dns_reply_error(query, flags, reply, DNS_RCODE_NOTIMP);
+
+    uint16_t qdcount = _get16(query + 4);
+    if (qdcount == 0 || qdcount > DNS_MAX_QUESTIONS)
+        return _dns_reply_error(query, flags, reply, DNS_RCODE_FORMERR);
+
+    dns_question_t questions[DNS_MAX_QUESTIONS];
+    size_t pos = HEADER_LEN;
+    for (int i = 0; i < qdcount; i++)
+    {
+        size_t end = _skip_name(query, query_len, pos);
+        if (end == 0 || query_len - end < 4)
+            return _dns_reply_error(query, flags, reply, DNS_RCODE_FORMERR);
+
+        questions[i].name_offset = (uint16_t)pos;
+        questions[i].type = _get16(query + end);
+        questions[i].cls = _get16(query + end + 2);
+        pos = end + 4;
+    }
+
+    // The questions are echoed as received; what follows them (e.g. EDNS) is not
+    if (pos > reply_cap)
+        return _dns_reply_error(query, flags | FLAG_TC, reply, DNS_RCODE_NOERROR);
+    memcpy(reply, query, pos);
+
+    uint16_t ancount = 0;
+    for (int i = 0; i < qdcount; i++)
+    {
+        const dns_question_t* q = &questions[i];
+        bool in_class = q->cls == DNS_CLASS_IN || q->cls == DNS_CLASS_ANY;
+        if (!in_class || (q->type != DNS_TYPE_A && q->type != DNS_TYPE_ANY))
+            continue; // NODATA: the name exists, the type does not
+
+        if (reply_cap - pos < sizeof(tpl->answer))
+        {
+            flags |= FLAG_TC;
+            break;
+        }
+        memcpy(reply + pos, tpl->answer, sizeof(tpl->answer));
+        _put16(reply + pos, 0xc000 | q->name_offset);
+        pos += sizeof(tpl->answer);
+        ancount++;
+    }
+
+    _put16(reply + 2, flags | DNS_RCODE_NOERROR);
+    _put16(reply + 6, ancount);
+    _put16(reply + 8, 0);
+    _put16(reply + 10, 0);
+    return pos;
+}
@@ -1,170 +1,173 @@
 #include "dns_server.h"
 #include "esp_log.h"
 #include "freertos/FreeRTOS.h"
-#include "freertos/event_groups.h"
 #include "freertos/task.h"
 #include "lwip/inet.h"
 #include "lwip/sockets.h"
-#include <stdio.h>
+#include <errno.h>
+#include <stdbool.h>
 #include <string.h>
 
+#include "dns_reply.h"
+#include "metrics.h"
+
 static const char* TAG = "dns_server";
-static TaskHandle_t dns_task_handle = NULL;
 
-static const char captive_ip[] = {192, 168, 4, 1};
+#ifndef DNS_SERVER_PORT
+#define DNS_SERVER_PORT 53
+#endif
 
-// Minimal DNS packet helpers
-struct dns_header
-{
-    uint16_t id;
-    uint16_t flags;
-    uint16_t qdcount;
-    uint16_t ancount;
-    uint16_t nscount;
-    uint16_t arcount;
-} __attribute__((packed));
+// How often a blocked server checks for a stop request
+#define DNS_STOP_POLL_MS 500
+// Queries answered per wakeup before select() is asked again
+#define DNS_BURST_MAX 16
+#define DNS_TTL_S 60
 
-static int
-parse_qname(const uint8_t* buf, int offset, char* out, int outlen)
-{
-    int i = offset;
-    int pos = 0;
-    while (buf[i] != 0 && i < 512)
-    {
-        uint8_t len = buf[i++];
-        if (len + pos + 1 >= outlen)
-            return -1;
+static const uint8_t captive_ip[4] = {192, 168, 4, 1};
 
-        for (int j = 0; j < len; j++)
-        {
-            out[pos++] = buf[i++];
-        }
-        out[pos++] = '.';
-    }
+static TaskHandle_t dns_task_handle = NULL;
+static bool dns_stop = false;
+static portMUX_TYPE dns_lock = portMUX_INITIALIZER_UNLOCKED;
 
-    if (pos == 0)
-    {
-        out[0] = '\0';
-    }
-    else
-    {
-        out[pos - 1] = '\0'; // remove trailing dot
-    }
+static metric_t* queries;
+static metric_t* dropped;
 
-    return i + 1; // position after the trailing zero
-}
-
-static void
-dns_task(void* arg)
+static int
+_dns_open_socket(void)
 {
-    (void)arg;
-
     int sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
     if (sock < 0)
     {
         ESP_LOGE(TAG, "Failed to create socket");
-        vTaskDelete(NULL);
-        return;
+        return -1;
     }
 
-    struct sockaddr_in addr;
-    addr.sin_family = AF_INET;
-    addr.sin_port = htons(53);
-    addr.sin_addr.s_addr = INADDR_ANY;
+    int reuse = 1;
+    setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
 
+    struct sockaddr_in addr = {
+        .sin_family = AF_INET,
+        .sin_port = htons(DNS_SERVER_PORT),
+        .sin_addr.s_addr = htonl(INADDR_ANY),
+    };
     if (bind(sock, (struct sockaddr*)&addr, sizeof(addr)) < 0)
     {
-        ESP_LOGE(TAG, "Failed to bind socket");
+        ESP_LOGE(TAG, "Failed to bind UDP/%d: errno %d", DNS_SERVER_PORT, errno);
         close(sock);
-        vTaskDelete(NULL);
-        return;
+        return -1;
     }
+    return sock;
+}
+
+// Tells the task whether to go on; clears the handle in the same critical section as the
+// stop check, so a dns_server_start() racing with the exit starts a new task
+static bool
+_dns_keep_running(void)
+{
+    portENTER_CRITICAL(&dns_lock);
+    bool keep = !dns_stop;
+    if (!keep)
+        dns_task_handle = NULL;
+    portEXIT_CRITICAL(&dns_lock);
+    return keep;
+}
 
-    ESP_LOGI(TAG, "DNS server started on UDP/53");
+// Answers the queries waiting on the socket without blocking
+static void
+_dns_answer_pending(int sock, const dns_reply_template_t* tpl)
+{
+    uint8_t query[DNS_MAX_PACKET];
+    uint8_t reply[DNS_MAX_PACKET];
 
-    uint8_t buf[512];
-    while (1)
+    for (int i = 0; i < DNS_BURST_MAX; i++)
     {
         struct sockaddr_in src_addr;
         socklen_t socklen = sizeof(src_addr);
-        int len = recvfrom(sock, buf, sizeof(buf), 0, (struct sockaddr*)&src_addr, &socklen);
-        if (len <= 0)
+        int len = recvfrom(sock, query, sizeof(query), MSG_DONTWAIT, (struct sockaddr*)&src_addr,
+                           &socklen);
+        if (len < 0)
+            return;
+
+        metrics_inc(queries);
+        size_t reply_len = dns_reply_build(tpl, query, (size_t)len, reply, sizeof(reply));
+        if (reply_len == 0)
         {
-            vTaskDelay(pdMS_TO_TICKS(10));
+            metrics_inc(dropped);
             continue;
         }
+        sendto(sock, reply, reply_len, 0, (struct sockaddr*)&src_addr, socklen);
+    }
+}
 
-        if (len < (int)sizeof(struct dns_header))
-            continue;
-        struct dns_header* hdr = (struct dns_header*)buf;
-        uint16_t qdcount = ntohs(hdr->qdcount);
-        if (qdcount == 0)
-            continue;
+static void
+dns_task(void* arg)
+{
+    (void)arg;
 
-        // Parse question section
-        int pos = sizeof(struct dns_header);
-        char qname[256];
-        int next = parse_qname(buf, pos, qname, sizeof(qname));
-        if (next < 0)
-            continue;
-        pos = next;
-        if (pos + 4 > len)
-            continue; // type(2) + class(2)
+    dns_reply_template_t tpl;
+    dns_reply_init(&tpl, captive_ip, DNS_TTL_S);
 
-        // Prepare response in the same buffer
-        hdr->flags = htons(0x8180); // Standard response, no error
-        hdr->ancount = htons(1);
-        hdr->nscount = 0;
-        hdr->arcount = 0;
+    int sock = _dns_open_socket();
+    if (sock < 0)
+    {
+        portENTER_CRITICAL(&dns_lock);
+        dns_task_handle = NULL;
+        portEXIT_CRITICAL(&dns_lock);
+        vTaskDelete(NULL);
+        return;
+    }
 
-        // Move write pointer to end of question
-        int wpos = pos + 4;
+    ESP_LOGI(TAG, "DNS server started on UDP/%d", DNS_SERVER_PORT);
 
-        // Write answer: name as pointer to question (0xc00c)
-        if (wpos + 16 > (int)sizeof(buf))
-            continue;
-        buf[wpos++] = 0xc0;
-        buf[wpos++] = 0x0c;
-        buf[wpos++] = 0x00; // TYPE A
-        buf[wpos++] = 0x01;
-        buf[wpos++] = 0x00; // CLASS IN
-        buf[wpos++] = 0x01;
-        buf[wpos++] = 0x00;
-        buf[wpos++] = 0x00;
-        buf[wpos++] = 0x00;
-        buf[wpos++] = 0x3c; // TTL 60s
-        buf[wpos++] = 0x00;
-        buf[wpos++] = 0x04; // RDLENGTH 4
-
-        // RDATA (IP address)
-        buf[wpos++] = (uint8_t)captive_ip[0];
-        buf[wpos++] = (uint8_t)captive_ip[1];
-        buf[wpos++] = (uint8_t)captive_ip[2];
-        buf[wpos++] = (uint8_t)captive_ip[3];
-
-        int resp_len = wpos;
-        sendto(sock, buf, resp_len, 0, (struct sockaddr*)&src_addr, socklen);
+    while (_dns_keep_running())
+    {
+        fd_set readable;
+        FD_ZERO(&readable);
+        FD_SET(sock, &readable);
+        struct timeval timeout = {
+            .tv_sec = DNS_STOP_POLL_MS / 1000,
+            .tv_usec = (DNS_STOP_POLL_MS % 1000) * 1000,
+        };
+
+        int ready = select(sock + 1, &readable, NULL, NULL, &timeout);
+        if (ready > 0)
+            _dns_answer_pending(sock, &tpl);
+        else if (ready < 0 && errno != EINTR)
+        {
+            ESP_LOGE(TAG, "select failed: errno %d", errno);
+            vTaskDelay(pdMS_TO_TICKS(DNS_STOP_POLL_MS));
+        }
     }
 
     close(sock);
+    ESP_LOGI(TAG, "DNS server stopped");
     vTaskDelete(NULL);
 }
 
 void
 dns_server_start(void)
 {
-    if (dns_task_handle == NULL)
+    if (queries == NULL)
     {
-        xTaskCreate(dns_task, "dns_task", 4096, NULL, 5, &dns_task_handle);
+        queries = metrics_counter("dns_queries", NULL, "Packets received by the DNS server");
+        dropped = metrics_counter("dns_dropped", NULL,
+                                  "DNS packets dropped without a reply (responses, runts)");
     }
+
+    portENTER_CRITICAL(&dns_lock);
+    dns_stop = false;
+    bool running = dns_task_handle != NULL;
+    portEXIT_CRITICAL(&dns_lock);
+
+    if (!running)
+        xTaskCreate(dns_task, "dns_task", 4096, NULL, 5, &dns_task_handle);
 }
 
 void
 dns_server_stop(void)
 {
-    if (dns_task_handle)
-    {
-        vTaskDelete(dns_task_handle);
-        dns_task_handle = NULL;
-    }
+    // The task closes its socket and exits within DNS_STOP_POLL_MS
+    portENTER_CRITICAL(&dns_lock);
+    dns_stop = true;
+    portEXIT_CRITICAL(&dns_lock);
 }
@@ -0,0 +1,153 @@
+#include <string.h>
+
+#include "event_bus.h"
+
+#define SLOT_MASK (EVENT_BUS_CHANNEL_SLOTS - 1)
+
+_Static_assert((EVENT_BUS_CHANNEL_SLOTS & SLOT_MASK) == 0, "slot count must be a power of 2");
+
+static uint32_t
+_published_seq(uint32_t pos)
+{
+    return pos * 2 + 2;
+}
+
+void
+event_bus_publish(event_bus_t* bus, int channel, const event_t* event, bool from_isr)
+{
+    event_bus_channel_t* ch = &bus->channels[channel];
+    event_t copy = *event;
+    uint32_t words[EVENT_BUS_EVENT_WORDS];
+
+    copy.channel = (uint16_t)channel;
+    memcpy(words, &copy, sizeof(words));
+
+    // Only this producer writes head and types, so a relaxed load sees its own last store
+    uint32_t pos = atomic_load_explicit(&ch->head, memory_order_relaxed);
+    uint32_t types = atomic_load_explicit(&ch->types, memory_order_relaxed);
+    if ((types & EVENT_MASK(event->type)) == 0)
+        atomic_store_explicit(&ch->types, types | EVENT_MASK(event->type), memory_order_relaxed);
+    event_bus_slot_t* slot = &ch->slots[pos & SLOT_MASK];
+
+    // Odd sequence first: a reader that copies the slot now will see it change. Each word
+    // is a release store, so a reader that sees a new word also sees the odd sequence.
+    atomic_store_explicit(&slot->seq, pos * 2 + 1, memory_order_relaxed);
+    for (int i = 0; i < EVENT_BUS_EVENT_WORDS; i++)
+    {
+        atomic_store_explicit(&slot->words[i], words[i], memory_order_release);
+    }
+    atomic_store_explicit(&slot->seq, _published_seq(pos), memory_order_release);
+    atomic_store_explicit(&ch->head, pos + 1, memory_order_release);
+
+    int count = atomic_load_explicit(&bus->reader_count, memory_order_acquire);
+    for (int i = 0; i < count; i++)
+    {
+        event_bus_reader_t* reader = bus->readers[i];
+        if (reader->type_mask & EVENT_MASK(event->type))
+            reader->wake(reader->wake_ctx, from_isr);
+    }
+}
+
+int
+event_bus_subscribe(event_bus_t* bus, event_bus_reader_t* reader, uint32_t type_mask,
+                    event_bus_wake_cb_t wake, void* wake_ctx)
+{
+    memset(reader, 0, sizeof(*reader));
+    reader->type_mask = type_mask;
+    reader->wake = wake;
+    reader->wake_ctx = wake_ctx;
+    for (int i = 0; i < EVENT_BUS_MAX_CHANNELS; i++)
+    {
+        reader->cursor[i] = atomic_load_explicit(&bus->channels[i].head, memory_order_acquire);
+    }
+
+    if (wake == NULL)
+        return 0;
+
+    // Subscriptions happen at startup from one task; the entry is complete before it is
+    // made visible to producers by the release store of the count
+    int count = atomic_load_explicit(&bus->reader_count, memory_order_relaxed);
+    if (count >= EVENT_BUS_MAX_READERS)
+        return -1;
+    bus->readers[count] = reader;
+    atomic_store_explicit(&bus->reader_count, count + 1, memory_order_release);
+    return 0;
+}
+
+// Copies the event at the reader's cursor; returns false if the channel has nothing new
+static bool
+_read_channel(event_bus_channel_t* ch, event_bus_reader_t* reader, int channel, event_t* out)
+{
+    while (true)
+    {
+        uint32_t pos = reader->cursor[channel];
+        uint32_t head = atomic_load_explicit(&ch->head, memory_order_acquire);
+        if (pos == head)
+            return false;
+
+        // Nothing for this reader was ever published here; the acquire of head makes the
+        // types of all events up to head visible
+        if ((atomic_load_explicit(&ch->types, memory_order_relaxed) & reader->type_mask) == 0)
+        {
+            reader->cursor[channel] = head;
+            return false;
+        }
+
+        // Lapped by the producer: skip to the oldest event that is still in the ring
+        if (head - pos > EVENT_BUS_CHANNEL_SLOTS)
+        {
+            reader->lost += head - pos - EVENT_BUS_CHANNEL_SLOTS;
+            reader->cursor[channel] = head - EVENT_BUS_CHANNEL_SLOTS;
+            continue;
+        }
+
+        event_bus_slot_t* slot = &ch->slots[pos & SLOT_MASK];
+        uint32_t words[EVENT_BUS_EVENT_WORDS];
+
+        // Acquire loads of the words keep the second sequence load after them; no fences,
+        // which ThreadSanitizer cannot model
+        uint32_t seq1 = atomic_load_explicit(&slot->seq, memory_order_acquire);
+        for (int i = 0; i < EVENT_BUS_EVENT_WORDS; i++)
+        {
+            words[i] = atomic_load_explicit(&slot->words[i], memory_order_acquire);
+        }
+        uint32_t seq2 = atomic_load_explicit(&slot->seq, memory_order_acquire);
+
+        if (seq1 == seq2 && seq1 == _published_seq(pos))
+        {
+            memcpy(out, words, sizeof(*out));
+            reader->cursor[channel] = pos + 1;
+            return true;
+        }
+
+        // Overwritten while copying; the next pass re-reads head and skips ahead
+        reader->lost++;
+        reader->cursor[channel] = pos + 1;
+    }
+}
+
+bool
+event_bus_read(event_bus_t* bus, event_bus_reader_t* reader, event_t* out)
+{
+    for (int n = 0; n < EVENT_BUS_MAX_CHANNELS; n++)
+    {
+        int channel = (reader->next_channel + n) % EVENT_BUS_MAX_CHANNELS;
+        while (_read_channel(&bus->channels[channel], reader, channel, out))
+        {
+            if (reader->type_mask & EVENT_MASK(out->type))
+            {
+                reader->next_channel = (channel + 1) % EVENT_BUS_MAX_CHANNELS;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+uint32_t
+event_bus_take_lost(event_bus_reader_t* reader)
+{
+    uint32_t lost = reader->lost;
+    reader->lost = 0;
+    return lost;
+}
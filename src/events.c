@@ -0,0 +1,81 @@
+#include "events.h"
+#include <inttypes.h>
+#include "esp_log.h"
+#include "esp_timer.h"
+
+static const char* TAG = "events";
+
+static event_bus_t bus;
+
+static void
+_events_wake(void* wake_ctx, bool from_isr)
+{
+    events_reader_t* reader = (events_reader_t*)wake_ctx;
+    TaskHandle_t task = reader->task;
+
+    // Not waited on yet; the first events_wait() drains the rings before blocking
+    if (task == NULL)
+        return;
+
+    if (from_isr)
+    {
+        BaseType_t woken = pdFALSE;
+        vTaskNotifyGiveFromISR(task, &woken);
+        portYIELD_FROM_ISR(woken);
+    }
+    else
+    {
+        xTaskNotifyGive(task);
+    }
+}
+
+void
+events_publish(events_channel_t channel, event_t* event)
+{
+    event->time_ms = (uint32_t)(esp_timer_get_time() / 1000);
+    event_bus_publish(&bus, channel, event, false);
+}
+
+void
+events_publish_from_isr(events_channel_t channel, event_t* event)
+{
+    event->time_ms = (uint32_t)(esp_timer_get_time() / 1000);
+    event_bus_publish(&bus, channel, event, true);
+}
+
+int64_t
+events_time_ms(const event_t* event)
+{
+    int64_t now_ms = esp_timer_get_time() / 1000;
+    return now_ms - (uint32_t)((uint32_t)now_ms - event->time_ms);
+}
+
+esp_err_t
+events_subscribe(events_reader_t* reader, uint32_t type_mask)
+{
+    reader->task = NULL;
+    if (event_bus_subscribe(&bus, &reader->reader, type_mask, _events_wake, reader) != 0)
+    {
+        ESP_LOGE(TAG, "No free reader slot");
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+bool
+events_wait(events_reader_t* reader, event_t* out, TickType_t timeout)
+{
+    if (reader->task == NULL)
+        reader->task = xTaskGetCurrentTaskHandle();
+
+    // A notification only means "look again": it may be left over from an event that was
+    // already read, so the rings are checked before and after blocking
+    bool found = event_bus_read(&bus, &reader->reader, out);
+    if (!found && ulTaskNotifyTake(pdTRUE, timeout) > 0)
+        found = event_bus_read(&bus, &reader->reader, out);
+
+    uint32_t lost = event_bus_take_lost(&reader->reader);
+    if (lost > 0)
+        ESP_LOGW(TAG, "Reader fell behind, %" PRIu32 " events lost", lost);
+    return found;
+}
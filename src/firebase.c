@@ -1,63 +1,407 @@
 #include <stdbool.h>
 #include <string.h>
+#include <strings.h>
 
 #include "esp_crt_bundle.h"
 #include "esp_log.h"
+#include "esp_timer.h"
 #include "firebase.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "metrics.h"
+#include "trace.h"
 
-typedef esp_http_client_handle_t firebase_stream_handle_t;
 #define MAX_RETRY_NUM 5
 #define RETRY_DELAY_MS 500
+#define POOL_ACQUIRE_TIMEOUT_MS 10000
+#define HOST_MAX_LEN 96
 static const char* TAG = "firebase_client";
 
-const char* FIREBASE_BASE_URL
-    = "https://espbackendapp-default-rtdb.europe-west1.firebasedatabase.app/";
+// Overridable at build time, e.g. to point the host build at a local server
+#ifndef FIREBASE_URL
+#define FIREBASE_URL "https://espbackendapp-default-rtdb.europe-west1.firebasedatabase.app/"
+#endif
 
-extern void set_relay_state(const char* json_payload);
+const char* FIREBASE_BASE_URL = FIREBASE_URL;
 
-// Internal helper to perform HTTP PUT with retries
+// One long-lived keep-alive client per host, reused across requests
+typedef struct
+{
+    char host[HOST_MAX_LEN];
+    esp_http_client_handle_t client;
+    bool busy;
+} firebase_conn_t;
+
+// Per-request state read by the event handler; NULL user data means no extras
+typedef struct
+{
+    const char* cond_header;
+    const char* cond_value;
+    firebase_body_cb_t on_data;
+    void* user_ctx;
+    char* out_buf;
+    size_t out_len;
+    size_t body_len;
+    bool overflow;
+    esp_err_t body_err;
+    char etag[FIREBASE_ETAG_MAX_LEN];
+} firebase_request_t;
+
+static firebase_conn_t conn_pool[FIREBASE_POOL_SIZE];
+static SemaphoreHandle_t pool_lock = NULL;
+static SemaphoreHandle_t pool_slots = NULL;
+
+static firebase_stats_t stats;
+static portMUX_TYPE stats_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static metric_t* request_us_get;
+static metric_t* request_us_put;
+static metric_t* request_us_patch;
+static metric_t* request_failures;
+static metric_t* request_retries;
+
+void
+firebase_init(void)
+{
+    if (pool_lock != NULL)
+        return;
+
+    pool_lock = xSemaphoreCreateMutex();
+    pool_slots = xSemaphoreCreateCounting(FIREBASE_POOL_SIZE, FIREBASE_POOL_SIZE);
+
+    const char* help = "Duration of REST transactions in microseconds";
+    request_us_get = metrics_histogram("firebase_request_us", "method=\"GET\"", help);
+    request_us_put = metrics_histogram("firebase_request_us", "method=\"PUT\"", help);
+    request_us_patch = metrics_histogram("firebase_request_us", "method=\"PATCH\"", help);
+    request_failures = metrics_counter("firebase_request_failures", NULL,
+                                       "REST transactions that failed (transport or status)");
+    request_retries = metrics_counter("firebase_request_retries", NULL,
+                                      "REST transactions repeated after a failure");
+}
+
+void
+firebase_get_stats(firebase_stats_t* out)
+{
+    portENTER_CRITICAL(&stats_lock);
+    *out = stats;
+    portEXIT_CRITICAL(&stats_lock);
+}
+
+static void
+_firebase_record_request(esp_http_client_method_t method, int64_t latency_us, bool ok)
+{
+    metric_t* histogram = request_us_put;
+    if (method == HTTP_METHOD_GET)
+        histogram = request_us_get;
+    else if (method == HTTP_METHOD_PATCH)
+        histogram = request_us_patch;
+    metrics_observe(histogram, (uint32_t)latency_us);
+    if (!ok)
+        metrics_inc(request_failures);
+
+    portENTER_CRITICAL(&stats_lock);
+    stats.requests++;
+    if (!ok)
+        stats.failures++;
+    stats.last_latency_us = (uint32_t)latency_us;
+    stats.total_latency_us += (uint64_t)latency_us;
+    if (stats.last_latency_us > stats.max_latency_us)
+        stats.max_latency_us = stats.last_latency_us;
+    portEXIT_CRITICAL(&stats_lock);
+}
+
+// Hands a piece of a successful response body to the request's callback or buffer
+static void
+_firebase_request_on_data(firebase_request_t* req, const char* data, size_t len)
+{
+    if (req->body_err != ESP_OK)
+        return;
+
+    if (req->on_data != NULL)
+    {
+        req->body_err = req->on_data(data, len, req->user_ctx);
+        req->body_len += len;
+        return;
+    }
+
+    if (req->out_buf == NULL || req->out_len == 0)
+        return;
+
+    size_t room = req->out_len - 1 - req->body_len;
+    if (len > room)
+    {
+        len = room;
+        req->overflow = true;
+    }
+    memcpy(req->out_buf + req->body_len, data, len);
+    req->body_len += len;
+    req->out_buf[req->body_len] = '\0';
+}
+
+// Counts real TCP/TLS session setups, so reuse can be verified from the stats; also captures
+// the ETag and the body of requests that asked for them
 static esp_err_t
-_firebase_put_http(const char* path, const char* json_payload)
+_firebase_http_event_handler(esp_http_client_event_t* evt)
 {
-    int retry_cnt = 0;
-    char url[256];
-    esp_err_t err = ESP_FAIL;
-    snprintf(url, sizeof(url), "%s/%s.json", FIREBASE_BASE_URL, path);
+    firebase_request_t* req = (firebase_request_t*)evt->user_data;
 
-    do
+    switch (evt->event_id)
+    {
+    case HTTP_EVENT_ON_CONNECTED:
+        portENTER_CRITICAL(&stats_lock);
+        stats.connects++;
+        portEXIT_CRITICAL(&stats_lock);
+        break;
+    case HTTP_EVENT_ON_HEADER:
+        if (req != NULL && strcasecmp(evt->header_key, "ETag") == 0)
+            snprintf(req->etag, sizeof(req->etag), "%s", evt->header_value);
+        break;
+    case HTTP_EVENT_ON_DATA:
+        // Error responses carry a JSON message that is not the caller's data
+        if (req != NULL && esp_http_client_get_status_code(evt->client) == 200)
+            _firebase_request_on_data(req, (const char*)evt->data, (size_t)evt->data_len);
+        break;
+    default:
+        break;
+    }
+    return ESP_OK;
+}
+
+static void
+_firebase_url_host(const char* url, char* host, size_t host_len)
+{
+    const char* start = strstr(url, "://");
+    start = (start != NULL) ? start + 3 : url;
+
+    size_t len = strcspn(start, "/:");
+    if (len >= host_len)
+        len = host_len - 1;
+
+    memcpy(host, start, len);
+    host[len] = '\0';
+}
+
+// Takes a free pooled client for the URL's host, creating or re-targeting one if needed
+static firebase_conn_t*
+_firebase_conn_acquire(const char* url)
+{
+    // Creating the pool here would race between the first requests of two tasks
+    if (pool_lock == NULL)
+    {
+        ESP_LOGE(TAG, "firebase_init() was not called");
+        return NULL;
+    }
+
+    if (xSemaphoreTake(pool_slots, pdMS_TO_TICKS(POOL_ACQUIRE_TIMEOUT_MS)) != pdTRUE)
+    {
+        ESP_LOGE(TAG, "No free HTTP client in pool");
+        return NULL;
+    }
+
+    char host[HOST_MAX_LEN];
+    _firebase_url_host(url, host, sizeof(host));
+
+    xSemaphoreTake(pool_lock, portMAX_DELAY);
+
+    firebase_conn_t* conn = NULL;
+    for (int i = 0; i < FIREBASE_POOL_SIZE && conn == NULL; i++)
+    {
+        if (!conn_pool[i].busy && conn_pool[i].client != NULL
+            && strcmp(conn_pool[i].host, host) == 0)
+            conn = &conn_pool[i];
+    }
+    for (int i = 0; i < FIREBASE_POOL_SIZE && conn == NULL; i++)
+    {
+        if (!conn_pool[i].busy && conn_pool[i].client == NULL)
+            conn = &conn_pool[i];
+    }
+    for (int i = 0; i < FIREBASE_POOL_SIZE && conn == NULL; i++)
+    {
+        if (!conn_pool[i].busy)
+            conn = &conn_pool[i];
+    }
+
+    if (conn->client != NULL && strcmp(conn->host, host) != 0)
+    {
+        esp_http_client_cleanup(conn->client);
+        conn->client = NULL;
+    }
+
+    if (conn->client == NULL)
     {
         esp_http_client_config_t config = {
             .url = url,
             .method = HTTP_METHOD_PUT,
             .crt_bundle_attach = esp_crt_bundle_attach,
+            .keep_alive_enable = true,
+            .event_handler = _firebase_http_event_handler,
         };
 
-        esp_http_client_handle_t client = esp_http_client_init(&config);
-        esp_http_client_set_header(client, "Content-Type", "application/json");
-        esp_http_client_set_post_field(client, json_payload, strlen(json_payload));
+        conn->client = esp_http_client_init(&config);
+        if (conn->client != NULL)
+        {
+            esp_http_client_set_header(conn->client, "Content-Type", "application/json");
+            strcpy(conn->host, host);
+        }
+    }
+
+    if (conn->client == NULL)
+    {
+        ESP_LOGE(TAG, "Failed to initialize HTTP client");
+        conn = NULL;
+    }
+    else
+    {
+        conn->busy = true;
+    }
+
+    xSemaphoreGive(pool_lock);
+
+    if (conn == NULL)
+        xSemaphoreGive(pool_slots);
+
+    return conn;
+}
+
+// Returns a client to the pool; a broken session is torn down so the next user reconnects
+static void
+_firebase_conn_release(firebase_conn_t* conn, bool broken)
+{
+    xSemaphoreTake(pool_lock, portMAX_DELAY);
+    if (broken)
+    {
+        esp_http_client_cleanup(conn->client);
+        conn->client = NULL;
+    }
+    conn->busy = false;
+    xSemaphoreGive(pool_lock);
+    xSemaphoreGive(pool_slots);
+}
+
+void
+firebase_build_url(char* url, size_t url_len, const char* path)
+{
+    if (path[0] == '\0')
+        snprintf(url, url_len, "%s.json", FIREBASE_BASE_URL);
+    else
+        snprintf(url, url_len, "%s/%s.json", FIREBASE_BASE_URL, path);
+}
+
+static const char*
+_firebase_method_name(esp_http_client_method_t method)
+{
+    switch (method)
+    {
+    case HTTP_METHOD_GET:
+        return "GET";
+    case HTTP_METHOD_PATCH:
+        return "PATCH";
+    default:
+        return "PUT";
+    }
+}
+
+// Performs one REST request on a pooled client with retries. With req set, the ETag is
+// requested, the conditional header is sent and the body is delivered as it arrives.
+static esp_err_t
+_firebase_request(esp_http_client_method_t method, const char* url, const char* json_payload,
+                  firebase_request_t* req, int* status_out)
+{
+    const char* method_name = _firebase_method_name(method);
+    int retry_cnt = 0;
+    esp_err_t err = ESP_FAIL;
+
+    do
+    {
+        if (retry_cnt > 0)
+            metrics_inc(request_retries);
 
+        firebase_conn_t* conn = _firebase_conn_acquire(url);
+        if (conn == NULL)
+        {
+            err = ESP_ERR_NO_MEM;
+            break;
+        }
+
+        esp_http_client_handle_t client = conn->client;
+        esp_http_client_set_url(client, url);
+        esp_http_client_set_method(client, method);
+        esp_http_client_set_post_field(client, json_payload,
+                                       json_payload != NULL ? strlen(json_payload) : 0);
+        if (req != NULL)
+        {
+            req->body_len = 0;
+            req->overflow = false;
+            req->body_err = ESP_OK;
+            req->etag[0] = '\0';
+            esp_http_client_set_user_data(client, req);
+            esp_http_client_set_header(client, "X-Firebase-ETag", "true");
+            if (req->cond_header != NULL)
+                esp_http_client_set_header(client, req->cond_header, req->cond_value);
+        }
+
+        int64_t start_us = esp_timer_get_time();
+        TRACE_BEGIN(TRACE_HTTP_REQUEST, method);
         err = esp_http_client_perform(client);
-        if (err == ESP_OK)
+        TRACE_END(TRACE_HTTP_REQUEST, method);
+        bool transport_ok = (err == ESP_OK);
+        bool retry = true;
+        int status_code = transport_ok ? esp_http_client_get_status_code(client) : 0;
+        if (status_out != NULL)
+            *status_out = status_code;
+
+        if (!transport_ok)
+        {
+            ESP_LOGE(TAG, "%s failed (transport): %s", method_name, esp_err_to_name(err));
+        }
+        else if (status_code >= 200 && status_code < 300)
+        {
+            ESP_LOGI(TAG, "%s success, status=%d", method_name, status_code);
+            err = ESP_OK;
+        }
+        else if (status_code == 304 && req != NULL && req->cond_header != NULL)
+        {
+            ESP_LOGI(TAG, "%s not modified", method_name);
+            err = ESP_OK;
+        }
+        else if (status_code == 412 && req != NULL && req->cond_header != NULL)
         {
-            int status_code = esp_http_client_get_status_code(client);
-
-            if (status_code >= 200 && status_code < 300)
-            {
-                ESP_LOGI(TAG, "PUT success, status=%d", status_code);
-                err = ESP_OK;
-            }
-            else
-            {
-                ESP_LOGW(TAG, "PUT failed (HTTP status %d)", status_code);
-                err = ESP_FAIL;
-            }
+            // The node changed since the caller read it; retrying cannot help
+            ESP_LOGW(TAG, "%s precondition failed, ETag is now '%s'", method_name, req->etag);
+            err = ESP_ERR_INVALID_STATE;
+            retry = false;
         }
         else
         {
-            ESP_LOGE(TAG, "PUT failed (transport): %s", esp_err_to_name(err));
+            ESP_LOGW(TAG, "%s failed (HTTP status %d)", method_name, status_code);
+            err = ESP_FAIL;
+        }
+
+        if (err == ESP_OK && req != NULL && req->body_err != ESP_OK)
+        {
+            err = req->body_err;
+            retry = false;
         }
 
-        esp_http_client_cleanup(client);
+        // A callback that already consumed part of the body would get the same bytes again
+        // from a new attempt; the caller learns of the failure and reads again instead
+        if (err != ESP_OK && req != NULL && req->on_data != NULL && req->body_len > 0)
+            retry = false;
+
+        if (req != NULL)
+        {
+            esp_http_client_set_user_data(client, NULL);
+            esp_http_client_delete_header(client, "X-Firebase-ETag");
+            if (req->cond_header != NULL)
+                esp_http_client_delete_header(client, req->cond_header);
+        }
+
+        _firebase_record_request(method, esp_timer_get_time() - start_us, err == ESP_OK);
+        _firebase_conn_release(conn, !transport_ok);
+
+        if (!retry)
+            break;
 
         if (err != ESP_OK && retry_cnt < MAX_RETRY_NUM)
         {
@@ -67,11 +411,106 @@ _firebase_put_http(const char* path, const char* json_payload)
         retry_cnt++;
     } while (err != ESP_OK && retry_cnt < MAX_RETRY_NUM);
 
+    if (err != ESP_OK && retry_cnt >= MAX_RETRY_NUM)
+    {
+        ESP_LOGE(TAG, "%s FAILED after %d attempts.", method_name, MAX_RETRY_NUM);
+    }
+
+    return err;
+}
+
+// Internal helper to perform an HTTP write (PUT/PATCH) with retries
+static esp_err_t
+_firebase_write_http(esp_http_client_method_t method, const char* path,
+                     const char* json_payload)
+{
+    char url[256];
+    firebase_build_url(url, sizeof(url), path);
+    return _firebase_request(method, url, json_payload, NULL, NULL);
+}
+
+static void
+_firebase_fill_result(firebase_result_t* result, const firebase_request_t* req, int status)
+{
+    if (result == NULL)
+        return;
+
+    result->status = status;
+    result->not_modified = false;
+    result->body_len = req->body_len;
+    snprintf(result->etag, sizeof(result->etag), "%s", req->etag);
+}
+
+esp_err_t
+firebase_get_ex(const char* path, const firebase_get_opts_t* opts, char* out_buf,
+                size_t out_len, firebase_result_t* result)
+{
+    static const firebase_get_opts_t no_opts = {0};
+    if (opts == NULL)
+        opts = &no_opts;
+    if (opts->on_data == NULL && (out_buf == NULL || out_len == 0))
+        return ESP_ERR_INVALID_ARG;
+
+    char url[256];
+    firebase_build_url(url, sizeof(url), path);
+    if (opts->shallow)
+    {
+        size_t len = strlen(url);
+        snprintf(url + len, sizeof(url) - len, "?shallow=true");
+    }
+
+    firebase_request_t req = {
+        .cond_header = (opts->if_none_match != NULL) ? "If-None-Match" : NULL,
+        .cond_value = opts->if_none_match,
+        .on_data = opts->on_data,
+        .user_ctx = opts->user_ctx,
+        .out_buf = (opts->on_data == NULL) ? out_buf : NULL,
+        .out_len = out_len,
+    };
+    if (req.out_buf != NULL)
+        req.out_buf[0] = '\0';
+
+    int status = 0;
+    esp_err_t err = _firebase_request(HTTP_METHOD_GET, url, NULL, &req, &status);
+    _firebase_fill_result(result, &req, status);
     if (err != ESP_OK)
+        return err;
+
+    // Servers without conditional GET still return the ETag, so an unchanged node is
+    // recognized even though its body was transferred
+    if (result != NULL && opts->if_none_match != NULL
+        && (status == 304 || strcmp(req.etag, opts->if_none_match) == 0))
+        result->not_modified = true;
+
+    if (req.overflow)
     {
-        ESP_LOGE(TAG, "PUT FAILED after %d attempts.", MAX_RETRY_NUM);
+        ESP_LOGE(TAG, "GET '%s' truncated to %u bytes", path, (unsigned)(out_len - 1));
+        return ESP_ERR_INVALID_SIZE;
     }
+    return ESP_OK;
+}
+
+esp_err_t
+firebase_get(const char* path, char* out_buf, size_t out_len)
+{
+    return firebase_get_ex(path, NULL, out_buf, out_len, NULL);
+}
+
+esp_err_t
+firebase_put_if_match(const char* path, const char* json_value, const char* etag,
+                      firebase_result_t* result)
+{
+    char url[256];
+    firebase_build_url(url, sizeof(url), path);
+
+    firebase_request_t req = {
+        .cond_header = "if-match",
+        .cond_value = etag,
+    };
 
+    int status = 0;
+    esp_err_t err = _firebase_request(HTTP_METHOD_PUT, url, json_value, &req, &status);
+    _firebase_fill_result(result, &req, status);
     return err;
 }
 
@@ -80,7 +519,7 @@ firebase_put_float_impl(const char* path, float value)
 {
     char payload_str[32];
     snprintf(payload_str, sizeof(payload_str), "%.2f", value);
-    return _firebase_put_http(path, payload_str);
+    return _firebase_write_http(HTTP_METHOD_PUT, path, payload_str);
 }
 
 esp_err_t
@@ -88,7 +527,7 @@ firebase_put_int_impl(const char* path, int value)
 {
     char payload_str[32];
     snprintf(payload_str, sizeof(payload_str), "%d", value);
-    return _firebase_put_http(path, payload_str);
+    return _firebase_write_http(HTTP_METHOD_PUT, path, payload_str);
 }
 
 esp_err_t
@@ -97,125 +536,180 @@ firebase_put_bool_impl(const char* path, bool value)
     char payload_str[8];
     const char* bool_string = value ? "true" : "false";
     snprintf(payload_str, sizeof(payload_str), "%s", bool_string);
-    return _firebase_put_http(path, payload_str);
+    return _firebase_write_http(HTTP_METHOD_PUT, path, payload_str);
 }
 
 esp_err_t
 firebase_put_string_impl(const char* path, const char* value)
 {
-    return _firebase_put_http(path, value);
+    return _firebase_write_http(HTTP_METHOD_PUT, path, value);
 }
 
-firebase_stream_handle_t
-firebase_start_stream(const char* path)
+void
+firebase_batch_init(firebase_batch_t* batch, int max_entries, uint32_t max_age_ms)
 {
-    char url[256];
-    snprintf(url, sizeof(url), "%s/%s.json", FIREBASE_BASE_URL, path);
+    if (max_entries <= 0 || max_entries > FIREBASE_BATCH_MAX_ENTRIES)
+        max_entries = FIREBASE_BATCH_MAX_ENTRIES;
+
+    batch->max_entries = max_entries;
+    batch->max_age_ms = max_age_ms;
+    batch->count = 0;
+    batch->first_staged_us = 0;
+    batch->len = 1;
+    batch->payload[0] = '{';
+    batch->payload[1] = '\0';
+}
 
-    esp_http_client_config_t config = {
-        .url = url,
-        .method = HTTP_METHOD_GET,
-        .crt_bundle_attach = esp_crt_bundle_attach,
-        .timeout_ms = 60000,
-    };
+esp_err_t
+firebase_batch_flush(firebase_batch_t* batch)
+{
+    if (batch->count == 0)
+        return ESP_OK;
 
-    esp_http_client_handle_t client = esp_http_client_init(&config);
-    if (client == NULL)
+    // Turn the trailing ',' of the last entry into the closing brace
+    batch->payload[batch->len - 1] = '}';
+
+    ESP_LOGI(TAG, "Flushing batch of %d values", batch->count);
+    esp_err_t err = _firebase_write_http(HTTP_METHOD_PATCH, "", batch->payload);
+
+    firebase_batch_init(batch, batch->max_entries, batch->max_age_ms);
+    return err;
+}
+
+esp_err_t
+firebase_batch_poll(firebase_batch_t* batch)
+{
+    if (batch->count == 0 || batch->max_age_ms == 0)
+        return ESP_OK;
+
+    int64_t age_ms = (esp_timer_get_time() - batch->first_staged_us) / 1000;
+    if (age_ms < batch->max_age_ms)
+        return ESP_OK;
+
+    return firebase_batch_flush(batch);
+}
+
+// Bytes taken by "path":value,
+static size_t
+_firebase_batch_entry_len(const char* path, const char* json_value)
+{
+    return strlen(path) + strlen(json_value) + 4;
+}
+
+bool
+firebase_batch_has_room(const firebase_batch_t* batch, const char* path, const char* json_value)
+{
+    return batch->count + 1 < batch->max_entries
+           && batch->len + _firebase_batch_entry_len(path, json_value) + 1
+                  < FIREBASE_BATCH_BUF_SIZE;
+}
+
+esp_err_t
+firebase_batch_add_json(firebase_batch_t* batch, const char* path, const char* json_value)
+{
+    esp_err_t err = ESP_OK;
+    size_t entry_len = _firebase_batch_entry_len(path, json_value);
+
+    // Opening and closing braces must always fit around a single entry
+    if (entry_len + 2 >= FIREBASE_BATCH_BUF_SIZE)
     {
-        ESP_LOGE(TAG, "Failed to initialize HTTP client for stream");
-        return NULL;
+        ESP_LOGE(TAG, "Batch entry for '%s' is too large", path);
+        return ESP_ERR_INVALID_SIZE;
     }
 
-    esp_http_client_set_header(client, "Accept", "text/event-stream");
+    if (batch->len + entry_len + 1 >= FIREBASE_BATCH_BUF_SIZE)
+    {
+        err = firebase_batch_flush(batch);
+    }
 
-    esp_err_t err = esp_http_client_open(client, 0);
-    if (err != ESP_OK)
+    if (batch->count == 0)
     {
-        ESP_LOGE(TAG, "Stream connection failed: %s", esp_err_to_name(err));
-        esp_http_client_cleanup(client);
-        return NULL;
+        batch->first_staged_us = esp_timer_get_time();
     }
 
-    int headers_len = esp_http_client_fetch_headers(client);
-    if (headers_len < 0 || esp_http_client_get_status_code(client) != 200)
+    batch->len += snprintf(batch->payload + batch->len, FIREBASE_BATCH_BUF_SIZE - batch->len,
+                           "\"%s\":%s,", path, json_value);
+    batch->count++;
+
+    esp_err_t flush_err = ESP_OK;
+    if (batch->count >= batch->max_entries)
     {
-        ESP_LOGE(TAG, "Stream header fetch failed or bad status: %d",
-                 esp_http_client_get_status_code(client));
-        esp_http_client_close(client);
-        esp_http_client_cleanup(client);
-        return NULL;
+        flush_err = firebase_batch_flush(batch);
+    }
+    else
+    {
+        flush_err = firebase_batch_poll(batch);
     }
 
-    ESP_LOGI(TAG, "Firebase stream established successfully.");
-    return client;
+    return (err != ESP_OK) ? err : flush_err;
 }
 
-void
-firebase_switch_stream_task(void* pvParameters)
+esp_err_t
+firebase_batch_add_float_impl(firebase_batch_t* batch, const char* path, float value)
 {
-    (void)pvParameters;
+    char value_str[32];
+    snprintf(value_str, sizeof(value_str), "%.2f", value);
+    return firebase_batch_add_json(batch, path, value_str);
+}
 
-    firebase_stream_handle_t stream_handle = NULL;
-    const char* path = "CONTROLS/pc_switch";
+esp_err_t
+firebase_batch_add_int_impl(firebase_batch_t* batch, const char* path, int value)
+{
+    char value_str[32];
+    snprintf(value_str, sizeof(value_str), "%d", value);
+    return firebase_batch_add_json(batch, path, value_str);
+}
 
-    char stream_buffer[256] = {0};
-    int current_pos = 0;
+esp_err_t
+firebase_batch_add_bool_impl(firebase_batch_t* batch, const char* path, bool value)
+{
+    return firebase_batch_add_json(batch, path, value ? "true" : "false");
+}
 
-    while (true)
-    {
-        if (stream_handle == NULL)
-        {
-            ESP_LOGW(TAG, "Attempting to start Firebase stream...");
-            stream_handle = firebase_start_stream(path);
-            if (stream_handle == NULL)
-            {
-                vTaskDelay(pdMS_TO_TICKS(5000)); // Retry after 5s if failed
-                continue;
-            }
-        }
+esp_err_t
+firebase_json_quote(char* out, size_t out_len, const char* value)
+{
+    size_t pos = 0;
 
-        int read_len = esp_http_client_read(stream_handle, stream_buffer + current_pos, 1);
+    if (out_len < 3)
+        return ESP_ERR_INVALID_SIZE;
 
-        if (read_len > 0)
+    out[pos++] = '"';
+    for (const unsigned char* c = (const unsigned char*)value; *c != '\0'; c++)
+    {
+        bool escaped = *c == '"' || *c == '\\';
+        size_t needed = escaped ? 2 : (*c < 0x20 ? 6 : 1);
+        // The closing quote and the NUL must still fit
+        if (pos + needed + 2 > out_len)
+            return ESP_ERR_INVALID_SIZE;
+        if (escaped)
         {
-            if (stream_buffer[current_pos] == '\n')
-            {
-                stream_buffer[current_pos] = '\0';
-
-                if (strstr(stream_buffer, "data:") != NULL)
-                {
-                    char* data_ptr = strchr(stream_buffer, '{');
-                    if (data_ptr != NULL)
-                    {
-                        set_relay_state(data_ptr);
-                    }
-                }
-                current_pos = 0;
-                memset(stream_buffer, 0, sizeof(stream_buffer));
-            }
-            else if (current_pos < sizeof(stream_buffer) - 1)
-            {
-                current_pos++;
-            }
-            else
-            {
-                ESP_LOGE(TAG, "Stream buffer overflow, resetting.");
-                current_pos = 0;
-            }
+            out[pos++] = '\\';
+            out[pos++] = (char)*c;
         }
-        else if (read_len == 0)
+        else if (*c < 0x20)
         {
-            ESP_LOGW(TAG, "Stream closed by server, reconnecting...");
-            esp_http_client_close(stream_handle);
-            esp_http_client_cleanup(stream_handle);
-            stream_handle = NULL;
+            pos += (size_t)snprintf(out + pos, out_len - pos, "\\u%04x", *c);
         }
         else
         {
-            ESP_LOGE(TAG, "Stream read error: %s", esp_err_to_name((esp_err_t)read_len));
-            esp_http_client_close(stream_handle);
-            esp_http_client_cleanup(stream_handle);
-            stream_handle = NULL;
+            out[pos++] = (char)*c;
         }
     }
+    out[pos++] = '"';
+    out[pos] = '\0';
+
+    return ESP_OK;
+}
+
+esp_err_t
+firebase_batch_add_string_impl(firebase_batch_t* batch, const char* path, const char* value)
+{
+    char value_str[FIREBASE_BATCH_BUF_SIZE / 2];
+
+    esp_err_t err = firebase_json_quote(value_str, sizeof(value_str), value);
+    if (err != ESP_OK)
+        return err;
+
+    return firebase_batch_add_json(batch, path, value_str);
 }
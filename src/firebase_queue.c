@@ -0,0 +1,433 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "connectivity.h"
+#include "esp_log.h"
+#include "firebase.h"
+#include "firebase_queue.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "nvs.h"
+
+#define NVS_NAMESPACE "fb_queue"
+#define RETRY_MIN_MS 1000
+#define RETRY_MAX_MS 60000
+// Longest time a staged value waits for flash when it is not sent right away
+#define PERSIST_POLL_MS 1000
+static const char* TAG = "firebase_queue";
+
+// One pending value; seq orders entries and detects overwrites during a flush (0 = free)
+typedef struct
+{
+    uint32_t seq;
+    char path[FIREBASE_QUEUE_PATH_MAX];
+    char value[FIREBASE_QUEUE_VALUE_MAX];
+} queue_entry_t;
+
+static queue_entry_t entries[FIREBASE_QUEUE_LEN];
+static uint32_t next_seq = 1;
+static firebase_queue_stats_t stats;
+static SemaphoreHandle_t queue_lock = NULL;
+static nvs_handle_t queue_nvs = 0;
+static bool nvs_ready = false;
+static TaskHandle_t drain_task = NULL;
+// Slots whose NVS copy is stale, one bit each; only the drain task writes flash
+static uint32_t dirty_slots = 0;
+static bool flush_requested = false;
+// Slots that have a copy in NVS; owned by the drain task once init has run
+static uint32_t persisted_slots = 0;
+
+_Static_assert(FIREBASE_QUEUE_LEN <= 32, "dirty_slots has one bit per slot");
+
+static void
+_slot_key(int slot, char* key, size_t key_len)
+{
+    snprintf(key, key_len, "e%d", slot);
+}
+
+// Stages the slot's NVS copy without committing; returns false if there was nothing to write
+static bool
+_persist_slot(int slot, const queue_entry_t* entry)
+{
+    char key[8];
+    _slot_key(slot, key, sizeof(key));
+
+    esp_err_t err;
+    if (entry->seq == 0)
+    {
+        // A value sent before it ever reached flash costs no write at all
+        if (!(persisted_slots & (1u << slot)))
+            return false;
+        err = nvs_erase_key(queue_nvs, key);
+        if (err == ESP_ERR_NVS_NOT_FOUND)
+            err = ESP_OK;
+        persisted_slots &= ~(1u << slot);
+    }
+    else
+    {
+        err = nvs_set_blob(queue_nvs, key, entry, sizeof(*entry));
+        if (err == ESP_OK)
+            persisted_slots |= 1u << slot;
+    }
+
+    if (err != ESP_OK)
+        ESP_LOGW(TAG, "Failed to persist slot %d: %s", slot, esp_err_to_name(err));
+    return true;
+}
+
+// Writes the slots changed since the last call with a single commit. Runs on the drain task
+// and copies the slots out under the lock, so producers never wait for a flash write.
+static void
+_persist_dirty(void)
+{
+    static queue_entry_t copies[FIREBASE_QUEUE_LEN];
+
+    xSemaphoreTake(queue_lock, portMAX_DELAY);
+    uint32_t dirty = dirty_slots;
+    dirty_slots = 0;
+    for (int slot = 0; slot < FIREBASE_QUEUE_LEN; slot++)
+    {
+        if (dirty & (1u << slot))
+            copies[slot] = entries[slot];
+    }
+    xSemaphoreGive(queue_lock);
+
+    if (!nvs_ready)
+        return;
+    bool written = false;
+    for (int slot = 0; slot < FIREBASE_QUEUE_LEN; slot++)
+    {
+        if (dirty & (1u << slot))
+            written |= _persist_slot(slot, &copies[slot]);
+    }
+
+    esp_err_t err = written ? nvs_commit(queue_nvs) : ESP_OK;
+    if (err != ESP_OK)
+        ESP_LOGW(TAG, "Failed to commit the queue: %s", esp_err_to_name(err));
+}
+
+// Returns and clears the pending flush request
+static bool
+_take_flush_request(void)
+{
+    xSemaphoreTake(queue_lock, portMAX_DELAY);
+    bool requested = flush_requested;
+    flush_requested = false;
+    xSemaphoreGive(queue_lock);
+    return requested;
+}
+
+esp_err_t
+firebase_queue_init(void)
+{
+    if (queue_lock == NULL)
+        queue_lock = xSemaphoreCreateMutex();
+
+    esp_err_t err = nvs_open(NVS_NAMESPACE, NVS_READWRITE, &queue_nvs);
+    if (err != ESP_OK)
+    {
+        ESP_LOGE(TAG, "NVS open failed, queue is RAM-only: %s", esp_err_to_name(err));
+        return err;
+    }
+    nvs_ready = true;
+
+    xSemaphoreTake(queue_lock, portMAX_DELAY);
+    for (int slot = 0; slot < FIREBASE_QUEUE_LEN; slot++)
+    {
+        char key[8];
+        size_t len = sizeof(entries[slot]);
+        _slot_key(slot, key, sizeof(key));
+
+        if (nvs_get_blob(queue_nvs, key, &entries[slot], &len) != ESP_OK
+            || len != sizeof(entries[slot]))
+        {
+            memset(&entries[slot], 0, sizeof(entries[slot]));
+            continue;
+        }
+
+        entries[slot].path[FIREBASE_QUEUE_PATH_MAX - 1] = '\0';
+        entries[slot].value[FIREBASE_QUEUE_VALUE_MAX - 1] = '\0';
+        persisted_slots |= 1u << slot;
+        stats.pending++;
+        if (entries[slot].seq >= next_seq)
+            next_seq = entries[slot].seq + 1;
+    }
+    xSemaphoreGive(queue_lock);
+
+    if (stats.pending > 0)
+        ESP_LOGI(TAG, "Restored %lu pending values", (unsigned long)stats.pending);
+
+    return ESP_OK;
+}
+
+esp_err_t
+firebase_queue_put_json(const char* path, const char* json_value)
+{
+    if (strlen(path) >= FIREBASE_QUEUE_PATH_MAX || strlen(json_value) >= FIREBASE_QUEUE_VALUE_MAX)
+        return ESP_ERR_INVALID_SIZE;
+
+    xSemaphoreTake(queue_lock, portMAX_DELAY);
+
+    // Latest value per path wins; otherwise take a free slot or evict the oldest entry
+    int slot = -1;
+    int free_slot = -1;
+    int oldest = 0;
+    for (int i = 0; i < FIREBASE_QUEUE_LEN; i++)
+    {
+        if (entries[i].seq == 0)
+        {
+            if (free_slot < 0)
+                free_slot = i;
+            continue;
+        }
+        if (strcmp(entries[i].path, path) == 0)
+        {
+            slot = i;
+            break;
+        }
+        if (entries[oldest].seq == 0 || entries[i].seq < entries[oldest].seq)
+            oldest = i;
+    }
+
+    if (slot >= 0)
+    {
+        stats.coalesced++;
+    }
+    else if (free_slot >= 0)
+    {
+        slot = free_slot;
+        stats.pending++;
+    }
+    else
+    {
+        ESP_LOGW(TAG, "Queue full, dropping unsent value of '%s'", entries[oldest].path);
+        slot = oldest;
+        stats.dropped++;
+    }
+
+    entries[slot].seq = next_seq++;
+    strcpy(entries[slot].path, path);
+    strcpy(entries[slot].value, json_value);
+    stats.enqueued++;
+    // Only the first staged value has to wake an idle drain task to start the persist timer
+    bool wake = dirty_slots == 0;
+    dirty_slots |= 1u << slot;
+    xSemaphoreGive(queue_lock);
+
+    if (wake && drain_task != NULL)
+        xTaskNotifyGive(drain_task);
+    return ESP_OK;
+}
+
+esp_err_t
+firebase_queue_put_float_impl(const char* path, float value)
+{
+    char value_str[FIREBASE_QUEUE_VALUE_MAX];
+    snprintf(value_str, sizeof(value_str), "%.2f", value);
+    return firebase_queue_put_json(path, value_str);
+}
+
+esp_err_t
+firebase_queue_put_int_impl(const char* path, int value)
+{
+    char value_str[FIREBASE_QUEUE_VALUE_MAX];
+    snprintf(value_str, sizeof(value_str), "%d", value);
+    return firebase_queue_put_json(path, value_str);
+}
+
+esp_err_t
+firebase_queue_put_bool_impl(const char* path, bool value)
+{
+    return firebase_queue_put_json(path, value ? "true" : "false");
+}
+
+esp_err_t
+firebase_queue_put_string_impl(const char* path, const char* value)
+{
+    char value_str[FIREBASE_QUEUE_VALUE_MAX];
+
+    esp_err_t err = firebase_json_quote(value_str, sizeof(value_str), value);
+    if (err != ESP_OK)
+        return err;
+
+    return firebase_queue_put_json(path, value_str);
+}
+
+void
+firebase_queue_flush(void)
+{
+    xSemaphoreTake(queue_lock, portMAX_DELAY);
+    flush_requested = true;
+    xSemaphoreGive(queue_lock);
+    if (drain_task != NULL)
+        xTaskNotifyGive(drain_task);
+}
+
+void
+firebase_queue_get_stats(firebase_queue_stats_t* out)
+{
+    xSemaphoreTake(queue_lock, portMAX_DELAY);
+    *out = stats;
+    xSemaphoreGive(queue_lock);
+}
+
+bool
+firebase_queue_is_pending(const char* path)
+{
+    bool pending = false;
+
+    xSemaphoreTake(queue_lock, portMAX_DELAY);
+    for (int i = 0; i < FIREBASE_QUEUE_LEN && !pending; i++)
+    {
+        pending = entries[i].seq != 0 && strcmp(entries[i].path, path) == 0;
+    }
+    xSemaphoreGive(queue_lock);
+    return pending;
+}
+
+// Sends the oldest pending values in one PATCH; returns ESP_ERR_NOT_FOUND when empty
+static esp_err_t
+_firebase_queue_send_batch(void)
+{
+    static firebase_batch_t batch;
+    static queue_entry_t selected[FIREBASE_BATCH_MAX_ENTRIES];
+    int count = 0;
+
+    firebase_batch_init(&batch, FIREBASE_BATCH_MAX_ENTRIES, 0);
+
+    // Stage entries oldest first under the lock, send without it
+    xSemaphoreTake(queue_lock, portMAX_DELAY);
+    uint32_t last_seq = 0;
+    while (count < FIREBASE_BATCH_MAX_ENTRIES)
+    {
+        int next = -1;
+        for (int i = 0; i < FIREBASE_QUEUE_LEN; i++)
+        {
+            if (entries[i].seq > last_seq && (next < 0 || entries[i].seq < entries[next].seq))
+                next = i;
+        }
+        if (next < 0 || !firebase_batch_has_room(&batch, entries[next].path, entries[next].value))
+            break;
+
+        firebase_batch_add_json(&batch, entries[next].path, entries[next].value);
+        selected[count++] = entries[next];
+        last_seq = entries[next].seq;
+    }
+    xSemaphoreGive(queue_lock);
+
+    if (count == 0)
+        return ESP_ERR_NOT_FOUND;
+
+    esp_err_t err = firebase_batch_flush(&batch);
+
+    xSemaphoreTake(queue_lock, portMAX_DELAY);
+    if (err == ESP_OK)
+    {
+        // Entries overwritten while the request was in flight stay queued
+        for (int n = 0; n < count; n++)
+        {
+            for (int i = 0; i < FIREBASE_QUEUE_LEN; i++)
+            {
+                if (entries[i].seq == selected[n].seq)
+                {
+                    entries[i].seq = 0;
+                    dirty_slots |= 1u << i;
+                    stats.pending--;
+                    stats.sent++;
+                    break;
+                }
+            }
+        }
+    }
+    else
+    {
+        stats.failed_flushes++;
+    }
+    xSemaphoreGive(queue_lock);
+
+    return err;
+}
+
+// Waits for a flush request; values staged without one still reach flash after PERSIST_POLL_MS
+static void
+_wait_for_flush(void)
+{
+    while (!_take_flush_request())
+    {
+        xSemaphoreTake(queue_lock, portMAX_DELAY);
+        bool dirty = dirty_slots != 0;
+        xSemaphoreGive(queue_lock);
+
+        TickType_t wait = dirty ? pdMS_TO_TICKS(PERSIST_POLL_MS) : portMAX_DELAY;
+        if (ulTaskNotifyTake(pdTRUE, wait) == 0)
+            _persist_dirty();
+    }
+}
+
+// Sleeps through a retry backoff in steps, persisting staged values in between; returns true
+// if a new link came up
+static bool
+_backoff_persisting(uint32_t ms)
+{
+    uint32_t epoch = connectivity_link_epoch();
+    while (ms > 0 && connectivity_link_epoch() == epoch)
+    {
+        uint32_t step = (ms < PERSIST_POLL_MS) ? ms : PERSIST_POLL_MS;
+        connectivity_backoff(pdMS_TO_TICKS(step));
+        _persist_dirty();
+        ms -= step;
+    }
+    return connectivity_link_epoch() != epoch;
+}
+
+void
+firebase_queue_task(void* pvParameters)
+{
+    (void)pvParameters;
+
+    drain_task = xTaskGetCurrentTaskHandle();
+    uint32_t retry_ms = 0;
+
+    while (true)
+    {
+        // Nothing is sent while offline; the flush resumes as soon as the link is back
+        if (!connectivity_wait(CONNECTIVITY_ONLINE, 0))
+        {
+            while (!connectivity_wait(CONNECTIVITY_ONLINE, pdMS_TO_TICKS(PERSIST_POLL_MS)))
+                _persist_dirty();
+            retry_ms = 0;
+        }
+
+        // Values restored from NVS or staged before the task started are sent right away
+        _take_flush_request();
+        esp_err_t err;
+        do
+        {
+            err = _firebase_queue_send_batch();
+        } while (err == ESP_OK);
+
+        // One commit per pass; values that went out never reach flash
+        _persist_dirty();
+
+        if (err == ESP_ERR_NOT_FOUND)
+        {
+            retry_ms = 0;
+            _wait_for_flush();
+            continue;
+        }
+
+        // A failure caused by the link going down is not the cloud's fault
+        if (!connectivity_wait(CONNECTIVITY_ONLINE, 0))
+            continue;
+
+        retry_ms = (retry_ms == 0) ? RETRY_MIN_MS : retry_ms * 2;
+        if (retry_ms > RETRY_MAX_MS)
+            retry_ms = RETRY_MAX_MS;
+        ESP_LOGW(TAG, "Flush failed, retrying in %lu ms", (unsigned long)retry_ms);
+
+        // A new flush request does not cut the backoff short, a new link does
+        if (_backoff_persisting(retry_ms))
+            retry_ms = 0;
+    }
+}
@@ -0,0 +1,693 @@
+#include <stdbool.h>
+#include <string.h>
+
+#include "connectivity.h"
+#include "esp_crt_bundle.h"
+#include "esp_http_client.h"
+#include "esp_log.h"
+#include "esp_random.h"
+#include "esp_timer.h"
+#include "firebase.h"
+#include "firebase_stream.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "json_tok.h"
+#include "metrics.h"
+#include "sse_parser.h"
+#include "trace.h"
+
+typedef esp_http_client_handle_t firebase_stream_handle_t;
+#define STREAM_BUFFER_SIZE 1024
+#define STREAM_KEEPALIVE_MS 30000
+#define STREAM_IDLE_TIMEOUT_MS (2 * STREAM_KEEPALIVE_MS)
+#define STREAM_BACKOFF_MIN_MS 50
+#define STREAM_BACKOFF_MAX_MS 30000
+#define STREAM_CANCEL_BACKOFF_MS 60000
+#define PATH_MAX_LEN 128
+#define SEGMENT_MAX_LEN 24
+#define TRIE_MAX_NODES 32
+#define STREAM_MAX_TOKENS 64
+#define NO_INDEX -1
+static const char* TAG = "firebase_stream";
+
+// Prefix trie of path segments; node 0 is the database root
+typedef struct
+{
+    char segment[SEGMENT_MAX_LEN];
+    int8_t first_child;
+    int8_t next_sibling;
+    int8_t first_sub;
+} trie_node_t;
+
+// last_hash identifies the last path and value delivered, to skip repeats after a resync
+typedef struct
+{
+    firebase_stream_cb_t cb;
+    void* user_ctx;
+    int8_t next;
+    bool delivered;
+    uint32_t last_hash;
+} subscription_t;
+
+static trie_node_t trie[TRIE_MAX_NODES];
+static int trie_len = 0;
+static subscription_t subscriptions[FIREBASE_STREAM_MAX_SUBSCRIPTIONS];
+static int subscription_count = 0;
+static bool stream_running = false;
+
+// Set by the event callback: data arrived, or the stream must be reopened after a delay
+static bool stream_event_seen = false;
+static bool stream_restart = false;
+static uint32_t stream_restart_delay_ms = 0;
+
+static firebase_stream_stats_t stream_stats;
+static portMUX_TYPE stream_stats_lock = portMUX_INITIALIZER_UNLOCKED;
+static metric_t* event_us;
+static metric_t* recovery_ms_hist;
+
+// Common parent of all subscriptions, where the stream is opened
+static int stream_root_node = 0;
+static char stream_root_path[PATH_MAX_LEN];
+
+// Returns the next path segment (without slashes) and advances *path past it
+static const char*
+_next_segment(const char** path, size_t* len)
+{
+    const char* p = *path;
+    while (*p == '/')
+        p++;
+
+    const char* start = p;
+    while (*p != '\0' && *p != '/')
+        p++;
+
+    *len = (size_t)(p - start);
+    *path = p;
+    return (*len > 0) ? start : NULL;
+}
+
+static int
+_trie_find_child(int node, const char* segment, size_t len)
+{
+    for (int child = trie[node].first_child; child != NO_INDEX; child = trie[child].next_sibling)
+    {
+        if (strncmp(trie[child].segment, segment, len) == 0 && trie[child].segment[len] == '\0')
+            return child;
+    }
+    return NO_INDEX;
+}
+
+static int
+_trie_new_node(void)
+{
+    if (trie_len >= TRIE_MAX_NODES)
+        return NO_INDEX;
+
+    trie_node_t* node = &trie[trie_len];
+    node->segment[0] = '\0';
+    node->first_child = NO_INDEX;
+    node->next_sibling = NO_INDEX;
+    node->first_sub = NO_INDEX;
+    return trie_len++;
+}
+
+esp_err_t
+firebase_stream_subscribe(const char* path, firebase_stream_cb_t cb, void* user_ctx)
+{
+    if (stream_running)
+        return ESP_ERR_INVALID_STATE;
+    if (subscription_count >= FIREBASE_STREAM_MAX_SUBSCRIPTIONS)
+        return ESP_ERR_NO_MEM;
+    if (trie_len == 0)
+        _trie_new_node();
+
+    int node = 0;
+    size_t len;
+    const char* segment;
+    while ((segment = _next_segment(&path, &len)) != NULL)
+    {
+        if (len >= SEGMENT_MAX_LEN)
+            return ESP_ERR_INVALID_ARG;
+
+        int child = _trie_find_child(node, segment, len);
+        if (child == NO_INDEX)
+        {
+            child = _trie_new_node();
+            if (child == NO_INDEX)
+                return ESP_ERR_NO_MEM;
+
+            memcpy(trie[child].segment, segment, len);
+            trie[child].segment[len] = '\0';
+            trie[child].next_sibling = trie[node].first_child;
+            trie[node].first_child = child;
+        }
+        node = child;
+    }
+
+    subscription_t* sub = &subscriptions[subscription_count];
+    sub->cb = cb;
+    sub->user_ctx = user_ctx;
+    sub->next = trie[node].first_sub;
+    trie[node].first_sub = subscription_count++;
+
+    return ESP_OK;
+}
+
+// Descends from the root while the path is unambiguous: the deepest common parent
+static void
+_firebase_stream_find_root(void)
+{
+    int node = 0;
+    size_t pos = 0;
+    stream_root_path[0] = '\0';
+
+    while (trie_len > 0 && trie[node].first_sub == NO_INDEX && trie[node].first_child != NO_INDEX
+           && trie[trie[node].first_child].next_sibling == NO_INDEX)
+    {
+        node = trie[node].first_child;
+        pos += snprintf(stream_root_path + pos, sizeof(stream_root_path) - pos, "%s%s",
+                        (pos > 0) ? "/" : "", trie[node].segment);
+    }
+
+    stream_root_node = node;
+}
+
+static uint32_t
+_fnv1a(uint32_t hash, const char* data, size_t len)
+{
+    for (size_t i = 0; i < len; i++)
+    {
+        hash = (hash ^ (uint8_t)data[i]) * 16777619u;
+    }
+    return hash;
+}
+
+// Identifies an update by its path and value text; a missing node hashes like null
+static uint32_t
+_update_hash(const firebase_stream_update_t* update)
+{
+    uint32_t hash = _fnv1a(2166136261u, update->path, strlen(update->path) + 1);
+    if (update->value >= 0 && !json_is_null(update->json, &update->tokens[update->value]))
+    {
+        const json_token_t* tok = &update->tokens[update->value];
+        hash = _fnv1a(hash, update->json + tok->start, (size_t)(tok->end - tok->start));
+    }
+    return hash;
+}
+
+static void
+_deliver_node(int node, const firebase_stream_update_t* update)
+{
+    if (trie[node].first_sub == NO_INDEX)
+        return;
+
+    uint32_t hash = _update_hash(update);
+    for (int i = trie[node].first_sub; i != NO_INDEX; i = subscriptions[i].next)
+    {
+        subscription_t* sub = &subscriptions[i];
+        if (sub->delivered && sub->last_hash == hash)
+        {
+            portENTER_CRITICAL(&stream_stats_lock);
+            stream_stats.duplicates++;
+            portEXIT_CRITICAL(&stream_stats_lock);
+            continue;
+        }
+
+        sub->delivered = true;
+        sub->last_hash = hash;
+        sub->cb(update, sub->user_ctx);
+    }
+}
+
+// Tells every handler about a stream-level event such as cancel
+static void
+_deliver_all(firebase_stream_event_type_t type, const char* json)
+{
+    firebase_stream_update_t update = {
+        .type = type,
+        .path = stream_root_path,
+        .json = json,
+        .value = -1,
+    };
+
+    for (int i = 0; i < subscription_count; i++)
+    {
+        subscriptions[i].cb(&update, subscriptions[i].user_ctx);
+    }
+}
+
+// Appends a segment to a path held in a PATH_MAX_LEN buffer, returns the new length
+static size_t
+_path_append(char* path, size_t pos, const char* segment, size_t len)
+{
+    int n = snprintf(path + pos, PATH_MAX_LEN - pos, "%s%.*s", (pos > 0) ? "/" : "", (int)len,
+                     segment);
+    pos += (n > 0) ? (size_t)n : 0;
+    return (pos < PATH_MAX_LEN) ? pos : PATH_MAX_LEN - 1;
+}
+
+// Hands each subscription below node its own part of the value at path
+static void
+_deliver_descendants(int node, char* path, size_t path_len, int value,
+                     firebase_stream_update_t* update)
+{
+    for (int child = trie[node].first_child; child != NO_INDEX; child = trie[child].next_sibling)
+    {
+        const char* segment = trie[child].segment;
+        size_t len = _path_append(path, path_len, segment, strlen(segment));
+        int child_value = json_object_get(update->json, update->tokens, update->token_count,
+                                          value, segment, strlen(segment));
+
+        update->path = path;
+        update->value = child_value;
+        _deliver_node(child, update);
+        _deliver_descendants(child, path, len, child_value, update);
+
+        path[path_len] = '\0';
+    }
+}
+
+// Delivers the value written at abs_path to every subscription whose path overlaps it
+static void
+_firebase_stream_route(firebase_stream_update_t* update, char* abs_path, int value)
+{
+    update->path = abs_path;
+    update->value = value;
+
+    if (trie_len == 0)
+        return;
+
+    int node = 0;
+    const char* p = abs_path;
+    while (true)
+    {
+        _deliver_node(node, update);
+
+        size_t len;
+        const char* segment = _next_segment(&p, &len);
+        if (segment == NULL)
+        {
+            _deliver_descendants(node, abs_path, strlen(abs_path), value, update);
+            return;
+        }
+
+        node = _trie_find_child(node, segment, len);
+        if (node == NO_INDEX)
+            return;
+    }
+}
+
+// Parses the {"path":...,"data":...} envelope once and routes its value(s)
+static void
+_firebase_stream_dispatch(firebase_stream_event_type_t type, const char* json, size_t json_len)
+{
+    static json_token_t tokens[STREAM_MAX_TOKENS];
+
+    int count = json_parse(json, json_len, tokens, STREAM_MAX_TOKENS);
+    if (count < 1)
+    {
+        ESP_LOGE(TAG, "Malformed stream payload (%d): %s", count, json);
+        return;
+    }
+
+    int path_tok = json_object_get(json, tokens, count, 0, "path", 4);
+    int data_tok = json_object_get(json, tokens, count, 0, "data", 4);
+    char rel_path[PATH_MAX_LEN];
+    if (path_tok < 0 || data_tok < 0
+        || json_get_string(json, &tokens[path_tok], rel_path, sizeof(rel_path)) != 0)
+    {
+        ESP_LOGE(TAG, "Stream payload without path/data: %s", json);
+        return;
+    }
+
+    char abs_path[PATH_MAX_LEN];
+    size_t pos = _path_append(abs_path, 0, stream_root_path, strlen(stream_root_path));
+    const char* p = rel_path;
+    const char* segment;
+    size_t len;
+    while ((segment = _next_segment(&p, &len)) != NULL)
+    {
+        pos = _path_append(abs_path, pos, segment, len);
+    }
+
+    firebase_stream_update_t update = {
+        .type = type,
+        .json = json,
+        .tokens = tokens,
+        .token_count = count,
+    };
+
+    if (type == FIREBASE_STREAM_PUT)
+    {
+        _firebase_stream_route(&update, abs_path, data_tok);
+        return;
+    }
+
+    // A patch carries an object of relative child paths, each replaced independently
+    if (tokens[data_tok].type != JSON_OBJECT)
+    {
+        ESP_LOGE(TAG, "Patch without object data: %s", json);
+        return;
+    }
+
+    int key = data_tok + 1;
+    for (int n = 0; n < tokens[data_tok].size && key + 1 < count; n++)
+    {
+        char child_path[PATH_MAX_LEN];
+        char key_str[PATH_MAX_LEN];
+        memcpy(child_path, abs_path, pos + 1);
+
+        size_t child_len = pos;
+        if (json_get_string(json, &tokens[key], key_str, sizeof(key_str)) == 0)
+        {
+            p = key_str;
+            while ((segment = _next_segment(&p, &len)) != NULL)
+            {
+                child_len = _path_append(child_path, child_len, segment, len);
+            }
+            _firebase_stream_route(&update, child_path, key + 1);
+        }
+
+        key = json_skip(tokens, count, key + 1);
+    }
+}
+
+esp_err_t
+firebase_stream_get_bool(const firebase_stream_update_t* update, bool* out)
+{
+    if (update->value < 0 || json_is_null(update->json, &update->tokens[update->value]))
+        return ESP_ERR_NOT_FOUND;
+    if (json_get_bool(update->json, &update->tokens[update->value], out) != 0)
+        return ESP_ERR_INVALID_ARG;
+    return ESP_OK;
+}
+
+esp_err_t
+firebase_stream_get_number(const firebase_stream_update_t* update, double* out)
+{
+    if (update->value < 0 || json_is_null(update->json, &update->tokens[update->value]))
+        return ESP_ERR_NOT_FOUND;
+    if (json_get_number(update->json, &update->tokens[update->value], out) != 0)
+        return ESP_ERR_INVALID_ARG;
+    return ESP_OK;
+}
+
+esp_err_t
+firebase_stream_get_string(const firebase_stream_update_t* update, char* out, size_t out_len)
+{
+    if (update->value < 0 || json_is_null(update->json, &update->tokens[update->value]))
+        return ESP_ERR_NOT_FOUND;
+    if (json_get_string(update->json, &update->tokens[update->value], out, out_len) != 0)
+        return ESP_ERR_INVALID_ARG;
+    return ESP_OK;
+}
+
+static firebase_stream_handle_t
+firebase_start_stream(const char* path)
+{
+    char url[256];
+    firebase_build_url(url, sizeof(url), path);
+
+    esp_http_client_config_t config = {
+        .url = url,
+        .method = HTTP_METHOD_GET,
+        .crt_bundle_attach = esp_crt_bundle_attach,
+        .timeout_ms = 60000,
+    };
+
+    esp_http_client_handle_t client = esp_http_client_init(&config);
+    if (client == NULL)
+    {
+        ESP_LOGE(TAG, "Failed to initialize HTTP client for stream");
+        return NULL;
+    }
+
+    esp_http_client_set_header(client, "Accept", "text/event-stream");
+
+    esp_err_t err = esp_http_client_open(client, 0);
+    if (err != ESP_OK)
+    {
+        ESP_LOGE(TAG, "Stream connection failed: %s", esp_err_to_name(err));
+        esp_http_client_cleanup(client);
+        return NULL;
+    }
+
+    int headers_len = esp_http_client_fetch_headers(client);
+    if (headers_len < 0 || esp_http_client_get_status_code(client) != 200)
+    {
+        ESP_LOGE(TAG, "Stream header fetch failed or bad status: %d",
+                 esp_http_client_get_status_code(client));
+        esp_http_client_close(client);
+        esp_http_client_cleanup(client);
+        return NULL;
+    }
+
+    ESP_LOGI(TAG, "Firebase stream established successfully.");
+    return client;
+}
+
+// Classifies the Firebase streaming event names
+static firebase_stream_event_type_t
+_firebase_stream_event_type(const char* name)
+{
+    if (strcmp(name, "put") == 0)
+        return FIREBASE_STREAM_PUT;
+    if (strcmp(name, "patch") == 0)
+        return FIREBASE_STREAM_PATCH;
+    if (strcmp(name, "keep-alive") == 0)
+        return FIREBASE_STREAM_KEEP_ALIVE;
+    if (strcmp(name, "cancel") == 0)
+        return FIREBASE_STREAM_CANCEL;
+    if (strcmp(name, "auth_revoked") == 0)
+        return FIREBASE_STREAM_AUTH_REVOKED;
+    return FIREBASE_STREAM_UNKNOWN;
+}
+
+static void
+_firebase_stream_event_cb(const sse_event_t* event, void* user_ctx)
+{
+    (void)user_ctx;
+
+    if (event->truncated)
+    {
+        ESP_LOGE(TAG, "Stream event '%s' exceeded %d byte buffer, dropped", event->event,
+                 STREAM_BUFFER_SIZE);
+        return;
+    }
+
+    firebase_stream_event_type_t type = _firebase_stream_event_type(event->event);
+    switch (type)
+    {
+    case FIREBASE_STREAM_PUT:
+    case FIREBASE_STREAM_PATCH:
+    {
+        portENTER_CRITICAL(&stream_stats_lock);
+        stream_stats.events++;
+        portEXIT_CRITICAL(&stream_stats_lock);
+        stream_event_seen = true;
+        int64_t start_us = esp_timer_get_time();
+        TRACE_BEGIN(TRACE_STREAM_DISPATCH, event->data_len);
+        _firebase_stream_dispatch(type, event->data, event->data_len);
+        TRACE_END(TRACE_STREAM_DISPATCH, event->data_len);
+        metrics_observe(event_us, (uint32_t)(esp_timer_get_time() - start_us));
+        break;
+    }
+    case FIREBASE_STREAM_KEEP_ALIVE:
+        stream_event_seen = true;
+        break;
+    case FIREBASE_STREAM_CANCEL:
+        // Retrying right away cannot succeed until the rules change
+        ESP_LOGE(TAG, "Stream cancelled by security rules: %s", event->data);
+        _deliver_all(type, event->data);
+        stream_restart = true;
+        stream_restart_delay_ms = STREAM_CANCEL_BACKOFF_MS;
+        break;
+    case FIREBASE_STREAM_AUTH_REVOKED:
+        // The request is sent again with the current credential; the snapshot resyncs
+        ESP_LOGW(TAG, "Stream credential revoked, reconnecting");
+        _deliver_all(type, event->data);
+        stream_restart = true;
+        stream_restart_delay_ms = STREAM_BACKOFF_MIN_MS;
+        break;
+    default:
+        ESP_LOGW(TAG, "Unhandled stream event '%s': %s", event->event, event->data);
+        break;
+    }
+}
+
+void
+firebase_stream_get_stats(firebase_stream_stats_t* out)
+{
+    portENTER_CRITICAL(&stream_stats_lock);
+    *out = stream_stats;
+    portEXIT_CRITICAL(&stream_stats_lock);
+}
+
+// Equal jitter: half the delay is fixed, the other half random, so clients spread out
+static uint32_t
+_backoff_jitter(uint32_t delay_ms)
+{
+    return delay_ms / 2 + esp_random() % (delay_ms / 2 + 1);
+}
+
+static uint32_t
+_backoff_next(uint32_t delay_ms)
+{
+    if (delay_ms < STREAM_BACKOFF_MIN_MS)
+        return STREAM_BACKOFF_MIN_MS;
+    return (delay_ms >= STREAM_BACKOFF_MAX_MS / 2) ? STREAM_BACKOFF_MAX_MS : delay_ms * 2;
+}
+
+// Records the first event of a new connection as the end of an outage
+static void
+_firebase_stream_recovered(int64_t lost_us)
+{
+    uint32_t recovery_ms = (uint32_t)((esp_timer_get_time() - lost_us) / 1000);
+
+    portENTER_CRITICAL(&stream_stats_lock);
+    stream_stats.last_recovery_ms = recovery_ms;
+    if (recovery_ms > stream_stats.max_recovery_ms)
+        stream_stats.max_recovery_ms = recovery_ms;
+    portEXIT_CRITICAL(&stream_stats_lock);
+    metrics_observe(recovery_ms_hist, recovery_ms);
+
+    ESP_LOGI(TAG, "Stream recovered in %u ms", (unsigned)recovery_ms);
+}
+
+void
+firebase_stream_task(void* pvParameters)
+{
+    (void)pvParameters;
+
+    firebase_stream_handle_t stream_handle = NULL;
+
+    stream_running = true;
+    event_us = metrics_histogram("stream_event_us", NULL,
+                                 "Time to parse and dispatch a stream event in microseconds");
+    recovery_ms_hist = metrics_histogram("stream_recovery_ms", NULL,
+                                         "Time from losing the stream to its next event in ms");
+    _firebase_stream_find_root();
+    ESP_LOGI(TAG, "Streaming '/%s' for %d subscriptions", stream_root_path, subscription_count);
+
+    static char stream_buffer[STREAM_BUFFER_SIZE];
+    sse_parser_t parser;
+    sse_parser_init(&parser, stream_buffer, sizeof(stream_buffer), _firebase_stream_event_cb,
+                    NULL);
+    int64_t last_rx_us = 0;
+    int64_t lost_us = esp_timer_get_time();
+    uint32_t backoff_ms = 0;
+    bool awaiting_event = false;
+    uint32_t link_epoch = 0;
+
+    while (true)
+    {
+        if (stream_handle == NULL)
+        {
+            // Offline attempts would only fail; a link coming up is worth trying at once
+            if (!connectivity_wait(CONNECTIVITY_ONLINE, 0))
+            {
+                ESP_LOGI(TAG, "Offline, stream waits for the link");
+                connectivity_wait(CONNECTIVITY_ONLINE, portMAX_DELAY);
+                backoff_ms = 0;
+            }
+            else if (backoff_ms > 0)
+            {
+                uint32_t delay_ms = _backoff_jitter(backoff_ms);
+                ESP_LOGW(TAG, "Reconnecting stream in %u ms", (unsigned)delay_ms);
+                if (connectivity_backoff(pdMS_TO_TICKS(delay_ms) + 1))
+                    backoff_ms = 0;
+            }
+            link_epoch = connectivity_link_epoch();
+
+            stream_handle = firebase_start_stream(stream_root_path);
+            if (stream_handle == NULL)
+            {
+                portENTER_CRITICAL(&stream_stats_lock);
+                stream_stats.failures++;
+                portEXIT_CRITICAL(&stream_stats_lock);
+                backoff_ms = _backoff_next(backoff_ms);
+                continue;
+            }
+
+            portENTER_CRITICAL(&stream_stats_lock);
+            stream_stats.connects++;
+            portEXIT_CRITICAL(&stream_stats_lock);
+
+            sse_parser_reset(&parser);
+            last_rx_us = esp_timer_get_time();
+            awaiting_event = true;
+            stream_event_seen = false;
+            stream_restart = false;
+        }
+
+        // A read returns only once its buffer is full, so block for the first byte alone and
+        // then take whatever else has arrived without waiting; an idle stream wakes the task
+        // once per keep-alive instead of polling. A partial event waits in the parser for the
+        // bytes that complete it, and those end the next blocking read.
+        size_t avail;
+        char* dst = sse_parser_write_ptr(&parser, &avail);
+        esp_http_client_set_timeout_ms(stream_handle, STREAM_KEEPALIVE_MS);
+        int read_len = esp_http_client_read(stream_handle, dst, 1);
+        if (read_len > 0 && avail > 1)
+        {
+            esp_http_client_set_timeout_ms(stream_handle, 0);
+            int more = esp_http_client_read(stream_handle, dst + 1, avail - 1);
+            if (more > 0)
+                read_len += more;
+        }
+
+        if (read_len > 0)
+        {
+            last_rx_us = esp_timer_get_time();
+            TRACE_INSTANT(TRACE_STREAM_READ, read_len);
+            TRACE_BEGIN(TRACE_SSE_PARSE, read_len);
+            sse_parser_commit(&parser, read_len);
+            TRACE_END(TRACE_SSE_PARSE, read_len);
+
+            // Only a stream that delivers events counts as up; backoff restarts from the bottom
+            if (awaiting_event && stream_event_seen)
+            {
+                awaiting_event = false;
+                backoff_ms = STREAM_BACKOFF_MIN_MS;
+                _firebase_stream_recovered(lost_us);
+                connectivity_cloud_ready(true);
+            }
+
+            if (!stream_restart)
+                continue;
+            backoff_ms = stream_restart_delay_ms;
+        }
+        else if (read_len == -ESP_ERR_HTTP_EAGAIN)
+        {
+            // Firebase sends keep-alive events every 30 s, so a stream that missed two is dead;
+            // so is one opened before the link last went down
+            bool stale_link = connectivity_link_epoch() != link_epoch;
+            if (!stale_link
+                && esp_timer_get_time() - last_rx_us < (int64_t)STREAM_IDLE_TIMEOUT_MS * 1000)
+                continue;
+            if (stale_link)
+                ESP_LOGW(TAG, "Link was lost, reconnecting stream...");
+            else
+                ESP_LOGW(TAG, "Stream idle for %d ms, reconnecting...", STREAM_IDLE_TIMEOUT_MS);
+        }
+        else if (read_len == 0)
+        {
+            ESP_LOGW(TAG, "Stream closed by server, reconnecting...");
+        }
+        else
+        {
+            ESP_LOGE(TAG, "Stream read error: %s", esp_err_to_name((esp_err_t)read_len));
+        }
+
+        // A connection that never delivered an event counts as a failed attempt
+        if (!awaiting_event)
+            lost_us = esp_timer_get_time();
+        else if (!stream_restart)
+            backoff_ms = _backoff_next(backoff_ms);
+
+        connectivity_cloud_ready(false);
+        esp_http_client_close(stream_handle);
+        esp_http_client_cleanup(stream_handle);
+        stream_handle = NULL;
+    }
+}
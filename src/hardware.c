@@ -1,115 +1,316 @@
 #include "hardware.h"
+#include <inttypes.h>
+#include "actuator.h"
+#include "button_fsm.h"
 #include "esp_log.h"
 #include "esp_timer.h"
-#include "firebase.h"
+#include "events.h"
+#include "firebase_queue.h"
+#include "firebase_stream.h"
+#include "metrics.h"
+#include "trace.h"
 
 #define RELAY_GPIO_PIN 22
-#define RELAY_ON 1
-#define RELAY_OFF 0
 #define RELAY_IMPULSE_TIME_MS 500
 
-#define DEBOUNCE_TIME_MS 3000
 #define BUTTON_GPIO_PIN 17
+#define BUTTON_DEBOUNCE_MS 30
+#define BUTTON_LONG_PRESS_MS 1500
+#define BUTTON_DOUBLE_CLICK_MS 300
 
-static QueueHandle_t gpio_evt_queue = NULL;
-static bool relay_state = RELAY_OFF;
+#define PC_SWITCH_PATH "CONTROLS/pc_switch"
 
-// Interrupt service routine for button press
+// Remote commands are held back while a local change is unconfirmed and for this long after
+#define ECHO_WINDOW_MS 2000
+#define SYNC_POLL_MS 100
+
+// Active-low push buttons; edge_us is the time of the edge that started the current burst
+typedef struct
+{
+    gpio_num_t gpio;
+    button_cfg_t cfg;
+    button_fsm_t fsm;
+    uint32_t edge_us;
+} button_t;
+
+static button_t buttons[] = {
+    {
+        .gpio = BUTTON_GPIO_PIN,
+        .cfg = {BUTTON_DEBOUNCE_MS, BUTTON_LONG_PRESS_MS, BUTTON_DOUBLE_CLICK_MS},
+    },
+};
+
+#define BUTTON_COUNT ((int)(sizeof(buttons) / sizeof(buttons[0])))
+#define PC_SWITCH_BUTTON 0
+
+static events_reader_t button_reader;
+static int relay_channel = -1;
+static relay_stats_t relay_stats;
+static portMUX_TYPE relay_stats_lock = portMUX_INITIALIZER_UNLOCKED;
+static metric_t* press_latency_us;
+
+// Interrupt service routine for button edges; the interrupt stays masked until the button
+// task has seen the contact settle, so a bouncing contact interrupts once per burst
 static void IRAM_ATTR
 button_isr_handler(void* arg)
 {
-    uint32_t gpio_num = (uint32_t)arg;
-    xQueueSendFromISR(gpio_evt_queue, &gpio_num, NULL);
+    uint32_t index = (uint32_t)(uintptr_t)arg;
+    gpio_intr_disable(buttons[index].gpio);
+    TRACE_INSTANT(TRACE_BUTTON_EDGE, index);
+
+    event_t event = {
+        .type = EVENT_BUTTON_EDGE,
+        .button = {.button = index, .time_us = (uint32_t)esp_timer_get_time()},
+    };
+    events_publish_from_isr(EVENTS_CH_BUTTON, &event);
+}
+
+static void
+relay_stream_handler(const firebase_stream_update_t* update, void* user_ctx)
+{
+    bool state;
+    esp_err_t err = firebase_stream_get_bool(update, &state);
+    if (err == ESP_OK)
+    {
+        // Actuated by the button task, which also owns the local button logic
+        event_t event = {
+            .type = EVENT_RELAY_COMMAND,
+            .relay = {.state = state, .origin = EVENTS_ORIGIN_REMOTE},
+        };
+        events_publish(EVENTS_CH_STREAM, &event);
+    }
+    else if (err != ESP_ERR_NOT_FOUND)
+    {
+        ESP_LOGE("RELAY", "Received non-boolean value for %s", update->path);
+    }
 }
 
 void
 relay_init(void)
 {
-    gpio_reset_pin(RELAY_GPIO_PIN);
-    gpio_set_direction(RELAY_GPIO_PIN, GPIO_MODE_OUTPUT);
-    gpio_set_level(RELAY_GPIO_PIN, RELAY_OFF);
+    ESP_ERROR_CHECK(actuator_register(RELAY_GPIO_PIN, RELAY_IMPULSE_TIME_MS, &relay_channel));
+    press_latency_us = metrics_histogram("relay_press_latency_us", NULL,
+                                         "Time from a button edge to relay actuation in "
+                                         "microseconds");
+
+    firebase_stream_subscribe(PC_SWITCH_PATH, relay_stream_handler, NULL);
 }
 
 void
-set_relay_state(const char* json_payload)
+set_relay_state(bool state)
 {
-    if (json_payload == NULL)
-        return;
-
-    if (strstr(json_payload, "true") != NULL)
+    // Returns immediately; the impulse is generated by the actuator timer
+    TRACE_BEGIN(TRACE_RELAY_SET, state);
+    esp_err_t err = actuator_set_state(relay_channel, state);
+    TRACE_END(TRACE_RELAY_SET, state);
+    if (err != ESP_OK)
     {
-        if (!relay_state)
-        {
-            gpio_set_level(RELAY_GPIO_PIN, RELAY_ON);
-            vTaskDelay(pdMS_TO_TICKS(RELAY_IMPULSE_TIME_MS));
-            gpio_set_level(RELAY_GPIO_PIN, RELAY_OFF);
-        }
-        relay_state = RELAY_ON;
-        ESP_LOGI("RELAY", "RELAY SET HIGH.");
-    }
-    else if (strstr(json_payload, "false") != NULL)
-    {
-        if (relay_state)
-        {
-            gpio_set_level(RELAY_GPIO_PIN, RELAY_ON);
-            vTaskDelay(pdMS_TO_TICKS(RELAY_IMPULSE_TIME_MS));
-            gpio_set_level(RELAY_GPIO_PIN, RELAY_OFF);
-        }
-        relay_state = RELAY_OFF;
-        ESP_LOGI("RELAY", "RELAY SET LOW.");
-    }
-    else
-    {
-        ESP_LOGE("RELAY", "Received unrecognized payload: %s", json_payload);
+        ESP_LOGE("RELAY", "Relay command dropped: %s", esp_err_to_name(err));
+        return;
     }
+    ESP_LOGI("RELAY", "RELAY SET %s.", state ? "HIGH" : "LOW");
 }
 
 void
 pc_switch_init()
 {
+    uint64_t pin_mask = 0;
+    for (int i = 0; i < BUTTON_COUNT; i++)
+    {
+        pin_mask |= 1ULL << buttons[i].gpio;
+    }
+
     gpio_config_t io_conf = {
-        .intr_type = GPIO_INTR_NEGEDGE, // Trigger on falling edge
+        .intr_type = GPIO_INTR_ANYEDGE, // Presses and releases
         .mode = GPIO_MODE_INPUT,
-        .pin_bit_mask = (1ULL << BUTTON_GPIO_PIN),
+        .pin_bit_mask = pin_mask,
         .pull_down_en = GPIO_PULLDOWN_DISABLE,
         .pull_up_en = GPIO_PULLUP_ENABLE, // Enable pull-up resistor
     };
 
     gpio_config(&io_conf);
 
-    gpio_evt_queue = xQueueCreate(10, sizeof(uint32_t));
+    // Subscribed before the ISR and the stream can publish, so no event is missed
+    ESP_ERROR_CHECK(events_subscribe(&button_reader, EVENT_MASK(EVENT_BUTTON_EDGE)
+                                                         | EVENT_MASK(EVENT_RELAY_COMMAND)));
 
     gpio_install_isr_service(0);
 
-    gpio_isr_handler_add(BUTTON_GPIO_PIN, button_isr_handler, (void*)BUTTON_GPIO_PIN);
+    for (int i = 0; i < BUTTON_COUNT; i++)
+    {
+        button_fsm_init(&buttons[i].fsm, &buttons[i].cfg, gpio_get_level(buttons[i].gpio) == 0);
+        gpio_isr_handler_add(buttons[i].gpio, button_isr_handler, (void*)(uintptr_t)i);
+    }
 }
 
-// Task to handle button presses with debounce
 void
-button_handler_task(void* pvParameters)
+relay_get_stats(relay_stats_t* out)
 {
-    uint32_t io_num;
-    uint64_t last_interrupt_time = 0;
+    portENTER_CRITICAL(&relay_stats_lock);
+    *out = relay_stats;
+    portEXIT_CRITICAL(&relay_stats_lock);
+}
 
-    for (;;)
+// Actuates the relay for a button press and returns the press-to-actuation latency
+static uint32_t
+_relay_local_toggle(uint32_t press_us)
+{
+    bool new_state = !actuator_get_state(relay_channel);
+    set_relay_state(new_state);
+    uint32_t latency_us = (uint32_t)esp_timer_get_time() - press_us;
+    metrics_observe(press_latency_us, latency_us);
+
+    // The cloud copy follows asynchronously; repeated presses coalesce in the queue
+    if (firebase_queue_put(PC_SWITCH_PATH, new_state) == ESP_OK)
+        firebase_queue_flush();
+
+    portENTER_CRITICAL(&relay_stats_lock);
+    relay_stats.presses++;
+    relay_stats.last_latency_us = latency_us;
+    if (latency_us > relay_stats.max_latency_us)
+        relay_stats.max_latency_us = latency_us;
+    relay_stats.total_latency_us += latency_us;
+    portEXIT_CRITICAL(&relay_stats_lock);
+
+    return latency_us;
+}
+
+static void
+_relay_apply_remote(bool state)
+{
+    TRACE_INSTANT(TRACE_RELAY_APPLY, state);
+    if (state == actuator_get_state(relay_channel))
+        return;
+
+    set_relay_state(state);
+    portENTER_CRITICAL(&relay_stats_lock);
+    relay_stats.remote_actuations++;
+    portEXIT_CRITICAL(&relay_stats_lock);
+}
+
+// Acts on the gestures of a button; returns true if the relay was switched locally
+static bool
+_button_gestures(int index, uint32_t events)
+{
+    const char* names[] = {"press", "release", "click", "double click", "long press"};
+    for (int bit = 0; bit < 5; bit++)
     {
-        if (xQueueReceive(gpio_evt_queue, &io_num, portMAX_DELAY))
+        if (events & (1u << bit))
+            ESP_LOGD("BUTTON_TASK", "Button %d: %s", index, names[bit]);
+    }
+
+    // The PC switch acts on the press itself, so every press counts and nothing waits for
+    // the gesture to complete
+    if (index != PC_SWITCH_BUTTON || !(events & BUTTON_EVENT_PRESS))
+        return false;
+
+    uint32_t latency_us = _relay_local_toggle(buttons[index].edge_us);
+    ESP_LOGI("BUTTON_TASK", "Button on GPIO %d pressed, actuated in %" PRIu32 " us",
+             buttons[index].gpio, latency_us);
+    return true;
+}
+
+// Runs every button state machine; returns the earliest deadline and whether a button
+// switched the relay
+static int64_t
+_buttons_run(int64_t now_ms, bool* toggled)
+{
+    int64_t next_ms = INT64_MAX;
+
+    for (int i = 0; i < BUTTON_COUNT; i++)
+    {
+        button_t* button = &buttons[i];
+        bool was_settling = button_fsm_settling(&button->fsm);
+        uint32_t events =
+            button_fsm_update(&button->fsm, gpio_get_level(button->gpio) == 0, now_ms);
+
+        if (was_settling && !button_fsm_settling(&button->fsm))
         {
+            gpio_intr_enable(button->gpio);
 
-            uint64_t current_time = esp_timer_get_time() / 1000; // Time in ms
-            if (current_time - last_interrupt_time < DEBOUNCE_TIME_MS)
+            // An edge between sampling and unmasking raised no interrupt
+            if ((gpio_get_level(button->gpio) == 0) != button->fsm.pressed
+                && button_fsm_edge(&button->fsm, now_ms))
             {
-                continue; // Ignore presses within debounce period
+                gpio_intr_disable(button->gpio);
+                button->edge_us = (uint32_t)esp_timer_get_time();
             }
+        }
 
-            ESP_LOGI("BUTTON_TASK", "Button on GPIO %d pressed! Time: %llums", io_num,
-                     current_time);
+        if (events != 0 && _button_gestures(i, events))
+            *toggled = true;
 
-            // Toggle relay state and send to Firebase
-            relay_state = !relay_state;
-            firebase_put("CONTROLS/pc_switch", relay_state);
+        int64_t due_ms = button_fsm_next_ms(&button->fsm);
+        if (due_ms < next_ms)
+            next_ms = due_ms;
+    }
+    return next_ms;
+}
 
-            last_interrupt_time = current_time;
+// Task to handle button gestures and relay commands
+void
+button_handler_task(void* pvParameters)
+{
+    event_t event;
+    int64_t settle_until_ms = 0;
+    bool remote_held = false;
+    bool remote_state = false;
+
+    for (;;)
+    {
+        bool toggled = false;
+        int64_t now_ms = esp_timer_get_time() / 1000;
+        int64_t button_due_ms = _buttons_run(now_ms, &toggled);
+        if (toggled)
+        {
+            // A local press supersedes whatever the stream sent before it
+            remote_held = false;
+            settle_until_ms = now_ms + ECHO_WINDOW_MS;
+        }
+
+        // While the local state is unconfirmed, the stream carries echoes of our own writes
+        // or values they are about to overwrite; only the last remote value counts afterwards
+        if (firebase_queue_is_pending(PC_SWITCH_PATH))
+            settle_until_ms = now_ms + ECHO_WINDOW_MS;
+        bool settling = now_ms < settle_until_ms;
+
+        if (!settling && remote_held)
+        {
+            remote_held = false;
+            _relay_apply_remote(remote_state);
+        }
+
+        int64_t wake_ms = settling ? now_ms + SYNC_POLL_MS : INT64_MAX;
+        if (button_due_ms < wake_ms)
+            wake_ms = button_due_ms;
+        // Rounded up so the task does not wake a tick before the deadline
+        TickType_t timeout = portMAX_DELAY;
+        if (wake_ms != INT64_MAX)
+            timeout = pdMS_TO_TICKS(wake_ms - now_ms + portTICK_PERIOD_MS - 1);
+
+        if (!events_wait(&button_reader, &event, timeout))
+            continue;
+
+        if (event.type == EVENT_BUTTON_EDGE)
+        {
+            if (event.button.button < BUTTON_COUNT)
+            {
+                button_t* button = &buttons[event.button.button];
+                if (button_fsm_edge(&button->fsm, events_time_ms(&event)))
+                    button->edge_us = event.button.time_us;
+            }
+        }
+        else if (settling)
+        {
+            remote_state = event.relay.state;
+            remote_held = true;
+            portENTER_CRITICAL(&relay_stats_lock);
+            relay_stats.echoes_suppressed++;
+            portEXIT_CRITICAL(&relay_stats_lock);
+        }
+        else
+        {
+            _relay_apply_remote(event.relay.state);
         }
     }
 }
@@ -0,0 +1,363 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "json_tok.h"
+
+static json_token_t*
+_json_alloc(json_token_t* tokens, int* count, int max_tokens, json_type_t type, int start,
+            int end, int parent)
+{
+    if (*count >= max_tokens)
+        return NULL;
+
+    json_token_t* token = &tokens[(*count)++];
+    token->type = type;
+    token->start = start;
+    token->end = end;
+    token->size = 0;
+    token->parent = parent;
+    return token;
+}
+
+// Attaching a value to the enclosing token; values directly inside an object must be keys
+static int
+_json_attach(json_token_t* tokens, int super, json_type_t type)
+{
+    if (super == -1)
+        return 0;
+
+    if (tokens[super].type == JSON_OBJECT && type != JSON_STRING)
+        return JSON_ERROR_INVAL;
+    if (tokens[super].type == JSON_STRING && tokens[super].size > 0)
+        return JSON_ERROR_INVAL;
+    if (tokens[super].type == JSON_PRIMITIVE)
+        return JSON_ERROR_INVAL;
+
+    tokens[super].size++;
+    return 0;
+}
+
+static bool
+_json_is_hex(char c)
+{
+    return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');
+}
+
+// Returns the offset of the closing quote of the string starting at js[pos] == '"'
+static int
+_json_scan_string(const char* js, size_t len, size_t pos)
+{
+    for (pos++; pos < len; pos++)
+    {
+        unsigned char c = (unsigned char)js[pos];
+        if (c == '"')
+            return (int)pos;
+        if (c < 0x20)
+            return JSON_ERROR_INVAL;
+        if (c != '\\')
+            continue;
+
+        if (++pos >= len)
+            return JSON_ERROR_PART;
+        switch (js[pos])
+        {
+        case '"':
+        case '/':
+        case '\\':
+        case 'b':
+        case 'f':
+        case 'n':
+        case 'r':
+        case 't':
+            break;
+        case 'u':
+            for (int i = 0; i < 4; i++)
+            {
+                if (++pos >= len)
+                    return JSON_ERROR_PART;
+                if (!_json_is_hex(js[pos]))
+                    return JSON_ERROR_INVAL;
+            }
+            break;
+        default:
+            return JSON_ERROR_INVAL;
+        }
+    }
+    return JSON_ERROR_PART;
+}
+
+// Returns the offset one past the primitive starting at js[pos]
+static int
+_json_scan_primitive(const char* js, size_t len, size_t pos)
+{
+    size_t start = pos;
+    for (; pos < len; pos++)
+    {
+        char c = js[pos];
+        if (c == ',' || c == ']' || c == '}' || c == ':' || c == ' ' || c == '\t' || c == '\r'
+            || c == '\n')
+            break;
+        if (!((c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || c == '-' || c == '+'
+              || c == '.' || c == 'E'))
+            return JSON_ERROR_INVAL;
+    }
+
+    size_t n = pos - start;
+    char first = js[start];
+    const char* literal = NULL;
+    if (first == 't')
+        literal = "true";
+    else if (first == 'f')
+        literal = "false";
+    else if (first == 'n')
+        literal = "null";
+
+    if (literal != NULL)
+    {
+        size_t literal_len = strlen(literal);
+        if (n > literal_len || memcmp(js + start, literal, n) != 0)
+            return JSON_ERROR_INVAL;
+        // A literal cut off by the end of the input may still be completed by more data
+        if (n < literal_len)
+            return pos == len ? JSON_ERROR_PART : JSON_ERROR_INVAL;
+    }
+    else if (first != '-' && !(first >= '0' && first <= '9'))
+        return JSON_ERROR_INVAL;
+
+    return (int)pos;
+}
+
+int
+json_parse(const char* js, size_t len, json_token_t* tokens, int max_tokens)
+{
+    int count = 0;
+    int super = -1;
+
+    for (size_t pos = 0; pos < len && js[pos] != '\0'; pos++)
+    {
+        char c = js[pos];
+        switch (c)
+        {
+        case '{':
+        case '[':
+        {
+            json_type_t type = (c == '{') ? JSON_OBJECT : JSON_ARRAY;
+            if (_json_attach(tokens, super, type) != 0)
+                return JSON_ERROR_INVAL;
+            if (_json_alloc(tokens, &count, max_tokens, type, (int)pos, -1, super) == NULL)
+                return JSON_ERROR_NOMEM;
+            super = count - 1;
+            break;
+        }
+        case '}':
+        case ']':
+        {
+            json_type_t type = (c == '}') ? JSON_OBJECT : JSON_ARRAY;
+            // A completed value leaves us on its key
+            if (super != -1 && tokens[super].type == JSON_STRING)
+            {
+                if (tokens[super].size == 0)
+                    return JSON_ERROR_INVAL;
+                super = tokens[super].parent;
+            }
+            if (super == -1 || tokens[super].type != type || tokens[super].end != -1)
+                return JSON_ERROR_INVAL;
+            tokens[super].end = (int)pos + 1;
+            super = tokens[super].parent;
+            break;
+        }
+        case '"':
+        {
+            int end = _json_scan_string(js, len, pos);
+            if (end < 0)
+                return end;
+            if (_json_attach(tokens, super, JSON_STRING) != 0)
+                return JSON_ERROR_INVAL;
+            if (_json_alloc(tokens, &count, max_tokens, JSON_STRING, (int)pos + 1, end, super)
+                == NULL)
+                return JSON_ERROR_NOMEM;
+            pos = (size_t)end;
+            break;
+        }
+        case ':':
+        {
+            // The previous token must be a key of the current object
+            int key = count - 1;
+            if (super == -1 || tokens[super].type != JSON_OBJECT || key < 0
+                || tokens[key].type != JSON_STRING || tokens[key].parent != super
+                || tokens[key].size != 0)
+                return JSON_ERROR_INVAL;
+            super = key;
+            break;
+        }
+        case ',':
+            if (super != -1 && tokens[super].type == JSON_STRING)
+            {
+                if (tokens[super].size == 0)
+                    return JSON_ERROR_INVAL;
+                super = tokens[super].parent;
+            }
+            break;
+        case ' ':
+        case '\t':
+        case '\r':
+        case '\n':
+            break;
+        default:
+        {
+            int end = _json_scan_primitive(js, len, pos);
+            if (end < 0)
+                return end;
+            if (_json_attach(tokens, super, JSON_PRIMITIVE) != 0)
+                return JSON_ERROR_INVAL;
+            if (_json_alloc(tokens, &count, max_tokens, JSON_PRIMITIVE, (int)pos, end, super)
+                == NULL)
+                return JSON_ERROR_NOMEM;
+            pos = (size_t)end - 1;
+            break;
+        }
+        }
+    }
+
+    for (int i = 0; i < count; i++)
+    {
+        if (tokens[i].end == -1)
+            return JSON_ERROR_PART;
+    }
+    if (super != -1 && tokens[super].type == JSON_STRING && tokens[super].size == 0)
+        return JSON_ERROR_PART;
+
+    return count;
+}
+
+int
+json_skip(const json_token_t* tokens, int count, int index)
+{
+    int next = index + 1;
+    if (tokens[index].type == JSON_OBJECT || tokens[index].type == JSON_ARRAY)
+    {
+        while (next < count && tokens[next].start < tokens[index].end)
+            next++;
+    }
+    return next;
+}
+
+int
+json_object_get(const char* js, const json_token_t* tokens, int count, int object,
+                const char* key, size_t key_len)
+{
+    if (object < 0 || object >= count || tokens[object].type != JSON_OBJECT)
+        return -1;
+
+    int i = object + 1;
+    for (int n = 0; n < tokens[object].size && i + 1 < count; n++)
+    {
+        const json_token_t* k = &tokens[i];
+        if ((size_t)(k->end - k->start) == key_len && memcmp(js + k->start, key, key_len) == 0)
+            return i + 1;
+        i = json_skip(tokens, count, i + 1);
+    }
+    return -1;
+}
+
+bool
+json_token_eq(const char* js, const json_token_t* token, const char* str)
+{
+    size_t len = strlen(str);
+    return (size_t)(token->end - token->start) == len
+           && memcmp(js + token->start, str, len) == 0;
+}
+
+int
+json_get_bool(const char* js, const json_token_t* token, bool* out)
+{
+    if (token->type != JSON_PRIMITIVE)
+        return -1;
+    if (json_token_eq(js, token, "true"))
+        *out = true;
+    else if (json_token_eq(js, token, "false"))
+        *out = false;
+    else
+        return -1;
+    return 0;
+}
+
+int
+json_get_number(const char* js, const json_token_t* token, double* out)
+{
+    char buf[32];
+    size_t len = (size_t)(token->end - token->start);
+
+    if (token->type != JSON_PRIMITIVE || len >= sizeof(buf))
+        return -1;
+    if (js[token->start] != '-' && !(js[token->start] >= '0' && js[token->start] <= '9'))
+        return -1;
+
+    memcpy(buf, js + token->start, len);
+    buf[len] = '\0';
+
+    char* end;
+    *out = strtod(buf, &end);
+    return (*end == '\0') ? 0 : -1;
+}
+
+int
+json_get_string(const char* js, const json_token_t* token, char* out, size_t out_len)
+{
+    if (token->type != JSON_STRING || out_len == 0)
+        return -1;
+
+    size_t o = 0;
+    for (int i = token->start; i < token->end; i++)
+    {
+        if (o + 1 >= out_len)
+        {
+            out[o] = '\0';
+            return -1;
+        }
+
+        char c = js[i];
+        if (c == '\\')
+        {
+            c = js[++i];
+            switch (c)
+            {
+            case 'b':
+                c = '\b';
+                break;
+            case 'f':
+                c = '\f';
+                break;
+            case 'n':
+                c = '\n';
+                break;
+            case 'r':
+                c = '\r';
+                break;
+            case 't':
+                c = '\t';
+                break;
+            case 'u':
+            {
+                char hex[5] = {js[i + 1], js[i + 2], js[i + 3], js[i + 4], '\0'};
+                long code = strtol(hex, NULL, 16);
+                c = (code < 0x80) ? (char)code : '?';
+                i += 4;
+                break;
+            }
+            default: // '"', '\\' and '/' stand for themselves
+                break;
+            }
+        }
+        out[o++] = c;
+    }
+
+    out[o] = '\0';
+    return 0;
+}
+
+bool
+json_is_null(const char* js, const json_token_t* token)
+{
+    return token->type == JSON_PRIMITIVE && json_token_eq(js, token, "null");
+}
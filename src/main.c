@@ -1,12 +1,44 @@
 #include "esp_log.h"
 #include "esp_wifi.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
 #include "nvs_flash.h"
 #include <stdio.h>
 
+#include "connectivity.h"
 #include "dht11.h"
+#include "firebase.h"
+#include "firebase_queue.h"
+#include "firebase_stream.h"
 #include "hardware.h"
+#include "metrics_export.h"
+#include "profiler.h"
+#include "sensor.h"
+#include "trace.h"
+#include "web_server.h"
 #include "wifi_provisioning.h"
 
+void
+start_application_tasks(void)
+{
+    xTaskCreate(sensor_task, "Sensors", 4096, NULL, 5, NULL);
+
+    xTaskCreate(firebase_queue_task, "FirebaseQueue", 8192, NULL, 6, NULL);
+
+    xTaskCreate(firebase_stream_task, "FirebaseStream", 8192, NULL, 7, NULL);
+
+    xTaskCreate(button_handler_task, "ButtonHandler", 4096, NULL, 10, NULL);
+
+#if METRICS_PUSH_INTERVAL_MS > 0
+    xTaskCreate(metrics_export_task, "MetricsPush", 4096, NULL, 2, NULL);
+#endif
+
+    // Serves /metrics; in AP mode the captive portal has started the server already
+    web_server_start();
+}
+
+// Unit tests (pio test) bring their own app_main and only link the modules
+#ifndef PIO_UNIT_TESTING
 static const char* TAG = "main";
 
 void
@@ -21,11 +53,28 @@ app_main(void)
     }
     ESP_ERROR_CHECK(ret);
 
+    connectivity_init();
     pc_switch_init();
     relay_init();
     dht11_init();
+    firebase_init();
+    firebase_queue_init();
+    metrics_export_init();
+    trace_init();
+    xTaskCreate(profiler_task, "Profiler", 3072, NULL, 1, NULL);
 
+#if CONFIG_IDF_TARGET_LINUX
+    // The host build provisions against a simulated radio if WIFI_SIM_NETWORKS describes one;
+    // otherwise the network is already up
+    if (!esp_wifi_sim_enabled())
+    {
+        connectivity_link_up();
+        start_application_tasks();
+        return;
+    }
+#endif
     wifi_provisioning_start();
 
     ESP_ERROR_CHECK(esp_wifi_set_ps(WIFI_PS_MAX_MODEM)); // making it more energy efficient
-}
\ No newline at end of file
+}
+#endif
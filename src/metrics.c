@@ -0,0 +1,255 @@
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "esp_log.h"
+#include "metrics.h"
+
+static const char* TAG = "metrics";
+
+static metric_t metrics[METRICS_MAX];
+static atomic_int metric_count;
+static atomic_flag create_lock = ATOMIC_FLAG_INIT;
+static atomic_flag full_logged = ATOMIC_FLAG_INIT;
+
+static bool
+_same_labels(const char* a, const char* b)
+{
+    if (a == NULL || b == NULL)
+        return a == b;
+    return strcmp(a, b) == 0;
+}
+
+// Creation is rare and may race between tasks at startup; updates never take this lock
+static metric_t*
+_metrics_create(const char* name, const char* labels, const char* help, metric_type_t type)
+{
+    while (atomic_flag_test_and_set_explicit(&create_lock, memory_order_acquire))
+    {
+    }
+
+    metric_t* metric = NULL;
+    int count = atomic_load_explicit(&metric_count, memory_order_relaxed);
+    bool conflict = false;
+    for (int i = 0; i < count && metric == NULL; i++)
+    {
+        if (strcmp(metrics[i].name, name) != 0)
+            continue;
+        if (metrics[i].type != type)
+            conflict = true;
+        else if (_same_labels(metrics[i].labels, labels))
+            metric = &metrics[i];
+    }
+
+    bool full = metric == NULL && !conflict && count == METRICS_MAX;
+    if (metric == NULL && !conflict && !full)
+    {
+        metric = &metrics[count];
+        metric->name = name;
+        metric->labels = labels;
+        metric->help = help;
+        metric->type = type;
+        // Readers only look at entries below the count, so the entry is complete first
+        atomic_store_explicit(&metric_count, count + 1, memory_order_release);
+    }
+
+    atomic_flag_clear_explicit(&create_lock, memory_order_release);
+
+    // Later metrics are missing too; the first one is enough to find the table size
+    if (full && !atomic_flag_test_and_set_explicit(&full_logged, memory_order_relaxed))
+        ESP_LOGW(TAG, "Table full (%d metrics), %s and later metrics are not recorded",
+                 METRICS_MAX, name);
+    return metric;
+}
+
+metric_t*
+metrics_counter(const char* name, const char* labels, const char* help)
+{
+    return _metrics_create(name, labels, help, METRIC_COUNTER);
+}
+
+metric_t*
+metrics_gauge(const char* name, const char* labels, const char* help)
+{
+    return _metrics_create(name, labels, help, METRIC_GAUGE);
+}
+
+metric_t*
+metrics_histogram(const char* name, const char* labels, const char* help)
+{
+    return _metrics_create(name, labels, help, METRIC_HISTOGRAM);
+}
+
+void
+metrics_add(metric_t* metric, int32_t delta)
+{
+    if (metric != NULL)
+        atomic_fetch_add_explicit(&metric->value, delta, memory_order_relaxed);
+}
+
+void
+metrics_inc(metric_t* metric)
+{
+    metrics_add(metric, 1);
+}
+
+void
+metrics_set(metric_t* metric, int32_t value)
+{
+    if (metric != NULL)
+        atomic_store_explicit(&metric->value, value, memory_order_relaxed);
+}
+
+uint32_t
+metrics_bucket_bound(int bucket)
+{
+    return (uint32_t)METRICS_HIST_MIN << bucket;
+}
+
+void
+metrics_observe(metric_t* metric, uint32_t value)
+{
+    if (metric == NULL)
+        return;
+
+    // Bucket b holds values up to METRICS_HIST_MIN << b
+    int bucket = 0;
+    if (value > METRICS_HIST_MIN)
+    {
+        bucket = 32 - __builtin_clz((value - 1) / METRICS_HIST_MIN);
+        if (bucket > METRICS_HIST_BUCKETS)
+            bucket = METRICS_HIST_BUCKETS;
+    }
+
+    atomic_fetch_add_explicit(&metric->buckets[bucket], 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&metric->sum, value, memory_order_relaxed);
+    atomic_fetch_add_explicit(&metric->value, 1, memory_order_relaxed);
+}
+
+int
+metrics_count(void)
+{
+    return atomic_load_explicit(&metric_count, memory_order_acquire);
+}
+
+metric_t*
+metrics_at(int index)
+{
+    return &metrics[index];
+}
+
+static const char*
+_type_name(metric_type_t type)
+{
+    switch (type)
+    {
+    case METRIC_COUNTER:
+        return "counter";
+    case METRIC_GAUGE:
+        return "gauge";
+    default:
+        return "histogram";
+    }
+}
+
+// Formats one sample line; extra is an additional label pair (e.g. le="16") or NULL
+static bool
+_write_sample(metrics_write_cb_t write, void* ctx, const metric_t* metric, const char* suffix,
+              const char* extra, const char* value)
+{
+    char line[160];
+    const char* labels = metric->labels;
+    int len;
+
+    if (labels != NULL && extra != NULL)
+        len = snprintf(line, sizeof(line), "%s%s{%s,%s} %s\n", metric->name, suffix, labels,
+                       extra, value);
+    else if (labels != NULL || extra != NULL)
+        len = snprintf(line, sizeof(line), "%s%s{%s} %s\n", metric->name, suffix,
+                       labels != NULL ? labels : extra, value);
+    else
+        len = snprintf(line, sizeof(line), "%s%s %s\n", metric->name, suffix, value);
+
+    if (len < 0 || (size_t)len >= sizeof(line))
+        return true; // A label set too long for the line buffer is skipped
+    return write(ctx, line, (size_t)len);
+}
+
+static bool
+_write_histogram(metrics_write_cb_t write, void* ctx, metric_t* metric)
+{
+    char value[24];
+    char extra[24];
+    uint32_t cumulative = 0;
+
+    // Buckets are read one by one while writers continue, so the count is derived from
+    // them to keep the exported buckets consistent with it
+    for (int b = 0; b <= METRICS_HIST_BUCKETS; b++)
+    {
+        cumulative += atomic_load_explicit(&metric->buckets[b], memory_order_relaxed);
+        if (b < METRICS_HIST_BUCKETS)
+            snprintf(extra, sizeof(extra), "le=\"%" PRIu32 "\"", metrics_bucket_bound(b));
+        else
+            snprintf(extra, sizeof(extra), "le=\"+Inf\"");
+        snprintf(value, sizeof(value), "%" PRIu32, cumulative);
+        if (!_write_sample(write, ctx, metric, "_bucket", extra, value))
+            return false;
+    }
+
+    snprintf(value, sizeof(value), "%" PRIu64,
+             (uint64_t)atomic_load_explicit(&metric->sum, memory_order_relaxed));
+    if (!_write_sample(write, ctx, metric, "_sum", NULL, value))
+        return false;
+    snprintf(value, sizeof(value), "%" PRIu32, cumulative);
+    return _write_sample(write, ctx, metric, "_count", NULL, value);
+}
+
+bool
+metrics_write_prometheus(metrics_write_cb_t write, void* ctx)
+{
+    int count = metrics_count();
+
+    for (int i = 0; i < count; i++)
+    {
+        // Each name is written once, at its first metric, together with all its label sets
+        bool seen = false;
+        for (int j = 0; j < i && !seen; j++)
+        {
+            seen = strcmp(metrics[j].name, metrics[i].name) == 0;
+        }
+        if (seen)
+            continue;
+
+        char header[192];
+        const char* suffix = metrics[i].type == METRIC_COUNTER ? "_total" : "";
+        int len = snprintf(header, sizeof(header), "# HELP %s%s %s\n# TYPE %s%s %s\n",
+                           metrics[i].name, suffix, metrics[i].help, metrics[i].name, suffix,
+                           _type_name(metrics[i].type));
+        if (len > 0 && (size_t)len < sizeof(header) && !write(ctx, header, (size_t)len))
+            return false;
+
+        for (int j = i; j < count; j++)
+        {
+            metric_t* metric = &metrics[j];
+            if (strcmp(metric->name, metrics[i].name) != 0)
+                continue;
+
+            if (metric->type == METRIC_HISTOGRAM)
+            {
+                if (!_write_histogram(write, ctx, metric))
+                    return false;
+                continue;
+            }
+
+            char value[16];
+            int32_t raw = atomic_load_explicit(&metric->value, memory_order_relaxed);
+            if (metric->type == METRIC_COUNTER)
+                snprintf(value, sizeof(value), "%" PRIu32, (uint32_t)raw);
+            else
+                snprintf(value, sizeof(value), "%" PRId32, raw);
+            if (!_write_sample(write, ctx, metric, suffix, NULL, value))
+                return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,267 @@
+#include "esp_log.h"
+#include "esp_system.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "connectivity.h"
+#include "firebase.h"
+#include "firebase_queue.h"
+#include "firebase_stream.h"
+#include "hardware.h"
+#include "metrics.h"
+#include "metrics_export.h"
+#include "sensor.h"
+#include "web_server.h"
+
+static const char* TAG = "metrics_export";
+
+#define CHUNK_SIZE 512
+#define PUSH_BATCH_ENTRIES 8
+
+// Gauges and mirrored counters refreshed before every export
+static metric_t* heap_free;
+static metric_t* heap_min_free;
+static metric_t* uptime;
+static metric_t* firebase_requests;
+static metric_t* firebase_failures;
+static metric_t* firebase_connects;
+static metric_t* queue_pending;
+static metric_t* queue_enqueued;
+static metric_t* queue_coalesced;
+static metric_t* queue_dropped;
+static metric_t* queue_sent;
+static metric_t* queue_failed_flushes;
+static metric_t* stream_connects;
+static metric_t* stream_failures;
+static metric_t* stream_events;
+static metric_t* stream_duplicates;
+static metric_t* sensor_reads;
+static metric_t* sensor_failures;
+static metric_t* sensor_sent;
+static metric_t* sensor_suppressed;
+static metric_t* relay_presses;
+static metric_t* relay_remote;
+static metric_t* relay_echoes;
+
+// Batches the small pieces of metrics_write_prometheus() into HTTP chunks
+typedef struct
+{
+    httpd_req_t* req;
+    size_t len;
+    char buf[CHUNK_SIZE];
+} chunk_writer_t;
+
+static void
+_metrics_export_collect(void)
+{
+    metrics_set(heap_free, (int32_t)esp_get_free_heap_size());
+    metrics_set(heap_min_free, (int32_t)esp_get_minimum_free_heap_size());
+    metrics_set(uptime, (int32_t)(esp_timer_get_time() / 1000000));
+
+    firebase_stats_t fb;
+    firebase_get_stats(&fb);
+    metrics_set(firebase_requests, (int32_t)fb.requests);
+    metrics_set(firebase_failures, (int32_t)fb.failures);
+    metrics_set(firebase_connects, (int32_t)fb.connects);
+
+    firebase_queue_stats_t queue;
+    firebase_queue_get_stats(&queue);
+    metrics_set(queue_pending, (int32_t)queue.pending);
+    metrics_set(queue_enqueued, (int32_t)queue.enqueued);
+    metrics_set(queue_coalesced, (int32_t)queue.coalesced);
+    metrics_set(queue_dropped, (int32_t)queue.dropped);
+    metrics_set(queue_sent, (int32_t)queue.sent);
+    metrics_set(queue_failed_flushes, (int32_t)queue.failed_flushes);
+
+    firebase_stream_stats_t stream;
+    firebase_stream_get_stats(&stream);
+    metrics_set(stream_connects, (int32_t)stream.connects);
+    metrics_set(stream_failures, (int32_t)stream.failures);
+    metrics_set(stream_events, (int32_t)stream.events);
+    metrics_set(stream_duplicates, (int32_t)stream.duplicates);
+
+    sensor_stats_t sensors;
+    sensor_get_stats(&sensors);
+    metrics_set(sensor_reads, (int32_t)sensors.reads);
+    metrics_set(sensor_failures, (int32_t)sensors.failures);
+    metrics_set(sensor_sent, (int32_t)sensors.sent);
+    metrics_set(sensor_suppressed, (int32_t)sensors.suppressed);
+
+    relay_stats_t relay;
+    relay_get_stats(&relay);
+    metrics_set(relay_presses, (int32_t)relay.presses);
+    metrics_set(relay_remote, (int32_t)relay.remote_actuations);
+    metrics_set(relay_echoes, (int32_t)relay.echoes_suppressed);
+}
+
+static bool
+_chunk_flush(chunk_writer_t* writer)
+{
+    if (writer->len == 0)
+        return true;
+    esp_err_t err = httpd_resp_send_chunk(writer->req, writer->buf, (ssize_t)writer->len);
+    writer->len = 0;
+    return err == ESP_OK;
+}
+
+static bool
+_chunk_write(void* ctx, const char* text, size_t len)
+{
+    chunk_writer_t* writer = ctx;
+
+    if (writer->len + len > sizeof(writer->buf) && !_chunk_flush(writer))
+        return false;
+    if (len > sizeof(writer->buf))
+        return httpd_resp_send_chunk(writer->req, text, (ssize_t)len) == ESP_OK;
+
+    memcpy(writer->buf + writer->len, text, len);
+    writer->len += len;
+    return true;
+}
+
+static esp_err_t
+_metrics_get_handler(httpd_req_t* req)
+{
+    _metrics_export_collect();
+
+    chunk_writer_t* writer = malloc(sizeof(chunk_writer_t));
+    if (writer == NULL)
+        return httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Out of memory");
+    writer->req = req;
+    writer->len = 0;
+
+    httpd_resp_set_type(req, "text/plain; version=0.0.4");
+    bool ok = metrics_write_prometheus(_chunk_write, writer) && _chunk_flush(writer);
+    free(writer);
+
+    if (!ok)
+    {
+        ESP_LOGW(TAG, "Scrape aborted by the client");
+        return ESP_FAIL;
+    }
+    return httpd_resp_send_chunk(req, NULL, 0);
+}
+
+void
+metrics_export_init(void)
+{
+    heap_free = metrics_gauge("heap_free_bytes", NULL, "Free heap in bytes");
+    heap_min_free = metrics_gauge("heap_min_free_bytes", NULL,
+                                  "Lowest free heap since boot in bytes");
+    uptime = metrics_gauge("uptime_seconds", NULL, "Time since boot in seconds");
+
+    firebase_requests = metrics_counter("firebase_requests", NULL,
+                                        "REST transactions including retries");
+    firebase_failures = metrics_counter("firebase_failures", NULL,
+                                        "REST transactions that failed");
+    firebase_connects = metrics_counter("firebase_connects", NULL,
+                                        "TCP/TLS sessions opened by the REST client");
+
+    queue_pending = metrics_gauge("queue_pending", NULL, "Values waiting to be sent");
+    queue_enqueued = metrics_counter("queue_enqueued", NULL, "Values accepted by the queue");
+    queue_coalesced = metrics_counter("queue_coalesced", NULL,
+                                      "Values that replaced an unsent value of the same path");
+    queue_dropped = metrics_counter("queue_dropped", NULL,
+                                    "Values evicted because the queue was full");
+    queue_sent = metrics_counter("queue_sent", NULL, "Values confirmed by Firebase");
+    queue_failed_flushes = metrics_counter("queue_failed_flushes", NULL,
+                                           "Queue PATCH requests that failed");
+
+    stream_connects = metrics_counter("stream_connects", NULL, "Streams established");
+    stream_failures = metrics_counter("stream_failures", NULL,
+                                      "Stream connection attempts that failed");
+    stream_events = metrics_counter("stream_events", NULL, "Put and patch events received");
+    stream_duplicates = metrics_counter("stream_duplicates", NULL,
+                                        "Stream deliveries skipped because the value was "
+                                        "unchanged");
+
+    sensor_reads = metrics_counter("sensor_reads", NULL, "Successful sensor samples");
+    sensor_failures = metrics_counter("sensor_failures", NULL, "Failed sensor reads");
+    sensor_sent = metrics_counter("sensor_sent", NULL, "Sensor values queued for upload");
+    sensor_suppressed = metrics_counter("sensor_suppressed", NULL,
+                                        "Sensor values held back by the reporting policies");
+
+    relay_presses = metrics_counter("relay_presses", NULL,
+                                    "Button presses that actuated the relay");
+    relay_remote = metrics_counter("relay_remote_actuations", NULL,
+                                   "Relay changes requested through the database");
+    relay_echoes = metrics_counter("relay_echoes_suppressed", NULL,
+                                   "Remote commands held back as echoes of local changes");
+
+    web_server_register("/metrics", HTTP_GET, _metrics_get_handler, NULL);
+}
+
+// Builds METRICS_PUSH_ROOT/<name>[/<labels>], keeping only characters valid in database keys
+static void
+_metrics_push_path(char* path, size_t size, const metric_t* metric)
+{
+    int len = snprintf(path, size, "%s/%s", METRICS_PUSH_ROOT, metric->name);
+    if (metric->labels == NULL || len < 0 || (size_t)len >= size - 1)
+        return;
+
+    size_t pos = (size_t)len;
+    path[pos++] = '/';
+    for (const char* c = metric->labels; *c != '\0' && pos < size - 1; c++)
+    {
+        if (*c == '"')
+            continue;
+        path[pos++] = (*c == '=' || *c == ',' || *c == '.' || *c == '/') ? '_' : *c;
+    }
+    path[pos] = '\0';
+}
+
+esp_err_t
+metrics_export_push(void)
+{
+    static firebase_batch_t batch;
+    esp_err_t result = ESP_OK;
+    char path[96];
+    char value[48];
+
+    _metrics_export_collect();
+    firebase_batch_init(&batch, PUSH_BATCH_ENTRIES, 0);
+
+    int count = metrics_count();
+    for (int i = 0; i < count; i++)
+    {
+        metric_t* metric = metrics_at(i);
+        int32_t raw = atomic_load_explicit(&metric->value, memory_order_relaxed);
+
+        if (metric->type == METRIC_HISTOGRAM)
+            snprintf(value, sizeof(value), "{\"count\":%" PRIu32 ",\"sum\":%" PRIu64 "}",
+                     (uint32_t)raw,
+                     (uint64_t)atomic_load_explicit(&metric->sum, memory_order_relaxed));
+        else if (metric->type == METRIC_COUNTER)
+            snprintf(value, sizeof(value), "%" PRIu32, (uint32_t)raw);
+        else
+            snprintf(value, sizeof(value), "%" PRId32, raw);
+
+        _metrics_push_path(path, sizeof(path), metric);
+        esp_err_t err = firebase_batch_add_json(&batch, path, value);
+        if (err != ESP_OK && result == ESP_OK)
+            result = err;
+    }
+
+    esp_err_t err = firebase_batch_flush(&batch);
+    return result != ESP_OK ? result : err;
+}
+
+void
+metrics_export_task(void* pvParameters)
+{
+    while (1)
+    {
+        vTaskDelay(pdMS_TO_TICKS(METRICS_PUSH_INTERVAL_MS));
+        // A push missed while offline goes out when the link returns
+        connectivity_wait(CONNECTIVITY_ONLINE, portMAX_DELAY);
+
+        esp_err_t err = metrics_export_push();
+        if (err != ESP_OK)
+            ESP_LOGW(TAG, "Metrics push failed: %s", esp_err_to_name(err));
+    }
+}
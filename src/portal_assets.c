@@ -0,0 +1,393 @@
+// Generated by tools/gen_assets.py from assets/portal; do not edit.
+#include "portal_assets.h"
+
+static const uint8_t portal_index_html_plain[] = {
+    0x3c, 0x21, 0x44, 0x4f, 0x43, 0x54, 0x59, 0x50, 0x45, 0x20, 0x68, 0x74,
+    0x6d, 0x6c, 0x3e, 0x3c, 0x68, 0x74, 0x6d, 0x6c, 0x3e, 0x3c, 0x68, 0x65,
+    0x61, 0x64, 0x3e, 0x3c, 0x74, 0x69, 0x74, 0x6c, 0x65, 0x3e, 0x45, 0x53,
+    0x50, 0x33, 0x32, 0x20, 0x57, 0x69, 0x2d, 0x46, 0x69, 0x20, 0x53, 0x65,
+    0x74, 0x75, 0x70, 0x3c, 0x2f, 0x74, 0x69, 0x74, 0x6c, 0x65, 0x3e, 0x3c,
+    0x73, 0x74, 0x79, 0x6c, 0x65, 0x3e, 0x62, 0x6f, 0x64, 0x79, 0x7b, 0x64,
+    0x69, 0x73, 0x70, 0x6c, 0x61, 0x79, 0x3a, 0x66, 0x6c, 0x65, 0x78, 0x3b,
+    0x66, 0x6c, 0x65, 0x78, 0x2d, 0x64, 0x69, 0x72, 0x65, 0x63, 0x74, 0x69,
+    0x6f, 0x6e, 0x3a, 0x63, 0x6f, 0x6c, 0x75, 0x6d, 0x6e, 0x3b, 0x6a, 0x75,
+    0x73, 0x74, 0x69, 0x66, 0x79, 0x2d, 0x63, 0x6f, 0x6e, 0x74, 0x65, 0x6e,
+    0x74, 0x3a, 0x66, 0x6c, 0x65, 0x78, 0x2d, 0x73, 0x74, 0x61, 0x72, 0x74,
+    0x3b, 0x61, 0x6c, 0x69, 0x67, 0x6e, 0x2d, 0x69, 0x74, 0x65, 0x6d, 0x73,
+    0x3a, 0x63, 0x65, 0x6e, 0x74, 0x65, 0x72, 0x3b, 0x6d, 0x69, 0x6e, 0x2d,
+    0x68, 0x65, 0x69, 0x67, 0x68, 0x74, 0x3a, 0x31, 0x30, 0x30, 0x76, 0x68,
+    0x3b, 0x6d, 0x61, 0x72, 0x67, 0x69, 0x6e, 0x3a, 0x30, 0x3b, 0x70, 0x61,
+    0x64, 0x64, 0x69, 0x6e, 0x67, 0x2d, 0x74, 0x6f, 0x70, 0x3a, 0x36, 0x76,
+    0x68, 0x3b, 0x66, 0x6f, 0x6e, 0x74, 0x2d, 0x66, 0x61, 0x6d, 0x69, 0x6c,
+    0x79, 0x3a, 0x27, 0x53, 0x65, 0x67, 0x6f, 0x65, 0x20, 0x55, 0x49, 0x27,
+    0x2c, 0x54, 0x61, 0x68, 0x6f, 0x6d, 0x61, 0x2c, 0x47, 0x65, 0x6e, 0x65,
+    0x76, 0x61, 0x2c, 0x56, 0x65, 0x72, 0x64, 0x61, 0x6e, 0x61, 0x2c, 0x73,
+    0x61, 0x6e, 0x73, 0x2d, 0x73, 0x65, 0x72, 0x69, 0x66, 0x3b, 0x62, 0x61,
+    0x63, 0x6b, 0x67, 0x72, 0x6f, 0x75, 0x6e, 0x64, 0x2d, 0x63, 0x6f, 0x6c,
+    0x6f, 0x72, 0x3a, 0x72, 0x67, 0x62, 0x28, 0x38, 0x31, 0x2c, 0x31, 0x33,
+    0x32, 0x2c, 0x31, 0x34, 0x36, 0x29, 0x3b, 0x74, 0x65, 0x78, 0x74, 0x2d,
+    0x61, 0x6c, 0x69, 0x67, 0x6e, 0x3a, 0x63, 0x65, 0x6e, 0x74, 0x65, 0x72,
+    0x7d, 0x68, 0x31, 0x7b, 0x6d, 0x61, 0x72, 0x67, 0x69, 0x6e, 0x3a, 0x30,
+    0x20, 0x30, 0x20, 0x31, 0x72, 0x65, 0x6d, 0x20, 0x30, 0x7d, 0x69, 0x6e,
+    0x70, 0x75, 0x74, 0x5b, 0x69, 0x64, 0x3d, 0x22, 0x69, 0x6e, 0x70, 0x75,
+    0x74, 0x57, 0x69, 0x6e, 0x64, 0x6f, 0x77, 0x22, 0x5d, 0x7b, 0x6d, 0x61,
+    0x72, 0x67, 0x69, 0x6e, 0x2d, 0x74, 0x6f, 0x70, 0x3a, 0x31, 0x30, 0x70,
+    0x78, 0x3b, 0x6d, 0x61, 0x72, 0x67, 0x69, 0x6e, 0x2d, 0x62, 0x6f, 0x74,
+    0x74, 0x6f, 0x6d, 0x3a, 0x31, 0x30, 0x70, 0x78, 0x3b, 0x62, 0x6f, 0x72,
+    0x64, 0x65, 0x72, 0x2d, 0x72, 0x61, 0x64, 0x69, 0x75, 0x73, 0x3a, 0x31,
+    0x72, 0x65, 0x6d, 0x7d, 0x66, 0x6f, 0x72, 0x6d, 0x5b, 0x69, 0x64, 0x3d,
+    0x22, 0x69, 0x6e, 0x70, 0x75, 0x74, 0x42, 0x6f, 0x78, 0x22, 0x5d, 0x7b,
+    0x62, 0x61, 0x63, 0x6b, 0x67, 0x72, 0x6f, 0x75, 0x6e, 0x64, 0x2d, 0x63,
+    0x6f, 0x6c, 0x6f, 0x72, 0x3a, 0x72, 0x67, 0x62, 0x28, 0x33, 0x32, 0x2c,
+    0x31, 0x31, 0x35, 0x2c, 0x31, 0x35, 0x34, 0x29, 0x3b, 0x77, 0x69, 0x64,
+    0x74, 0x68, 0x3a, 0x33, 0x30, 0x30, 0x70, 0x78, 0x3b, 0x70, 0x61, 0x64,
+    0x64, 0x69, 0x6e, 0x67, 0x3a, 0x32, 0x35, 0x70, 0x78, 0x3b, 0x62, 0x6f,
+    0x72, 0x64, 0x65, 0x72, 0x2d, 0x72, 0x61, 0x64, 0x69, 0x75, 0x73, 0x3a,
+    0x32, 0x72, 0x65, 0x6d, 0x3b, 0x62, 0x6f, 0x78, 0x2d, 0x73, 0x69, 0x7a,
+    0x69, 0x6e, 0x67, 0x3a, 0x62, 0x6f, 0x72, 0x64, 0x65, 0x72, 0x2d, 0x62,
+    0x6f, 0x78, 0x7d, 0x62, 0x75, 0x74, 0x74, 0x6f, 0x6e, 0x23, 0x63, 0x6f,
+    0x6e, 0x6e, 0x65, 0x63, 0x74, 0x42, 0x75, 0x74, 0x74, 0x6f, 0x6e, 0x7b,
+    0x64, 0x69, 0x73, 0x70, 0x6c, 0x61, 0x79, 0x3a, 0x62, 0x6c, 0x6f, 0x63,
+    0x6b, 0x3b, 0x77, 0x69, 0x64, 0x74, 0x68, 0x3a, 0x38, 0x30, 0x25, 0x3b,
+    0x70, 0x61, 0x64, 0x64, 0x69, 0x6e, 0x67, 0x3a, 0x30, 0x2e, 0x36, 0x72,
+    0x65, 0x6d, 0x20, 0x31, 0x72, 0x65, 0x6d, 0x3b, 0x6d, 0x61, 0x72, 0x67,
+    0x69, 0x6e, 0x3a, 0x30, 0x2e, 0x32, 0x35, 0x72, 0x65, 0x6d, 0x20, 0x61,
+    0x75, 0x74, 0x6f, 0x20, 0x30, 0x3b, 0x62, 0x6f, 0x72, 0x64, 0x65, 0x72,
+    0x3a, 0x6e, 0x6f, 0x6e, 0x65, 0x3b, 0x62, 0x6f, 0x72, 0x64, 0x65, 0x72,
+    0x2d, 0x72, 0x61, 0x64, 0x69, 0x75, 0x73, 0x3a, 0x30, 0x2e, 0x37, 0x35,
+    0x72, 0x65, 0x6d, 0x3b, 0x62, 0x61, 0x63, 0x6b, 0x67, 0x72, 0x6f, 0x75,
+    0x6e, 0x64, 0x2d, 0x63, 0x6f, 0x6c, 0x6f, 0x72, 0x3a, 0x72, 0x67, 0x62,
+    0x28, 0x31, 0x32, 0x2c, 0x38, 0x34, 0x2c, 0x31, 0x31, 0x35, 0x29, 0x3b,
+    0x63, 0x6f, 0x6c, 0x6f, 0x72, 0x3a, 0x23, 0x66, 0x66, 0x66, 0x3b, 0x66,
+    0x6f, 0x6e, 0x74, 0x2d, 0x77, 0x65, 0x69, 0x67, 0x68, 0x74, 0x3a, 0x36,
+    0x30, 0x30, 0x3b, 0x63, 0x75, 0x72, 0x73, 0x6f, 0x72, 0x3a, 0x70, 0x6f,
+    0x69, 0x6e, 0x74, 0x65, 0x72, 0x7d, 0x62, 0x75, 0x74, 0x74, 0x6f, 0x6e,
+    0x23, 0x63, 0x6f, 0x6e, 0x6e, 0x65, 0x63, 0x74, 0x42, 0x75, 0x74, 0x74,
+    0x6f, 0x6e, 0x3a, 0x68, 0x6f, 0x76, 0x65, 0x72, 0x7b, 0x6f, 0x70, 0x61,
+    0x63, 0x69, 0x74, 0x79, 0x3a, 0x30, 0x2e, 0x37, 0x30, 0x7d, 0x62, 0x75,
+    0x74, 0x74, 0x6f, 0x6e, 0x23, 0x63, 0x6f, 0x6e, 0x6e, 0x65, 0x63, 0x74,
+    0x42, 0x75, 0x74, 0x74, 0x6f, 0x6e, 0x3a, 0x61, 0x63, 0x74, 0x69, 0x76,
+    0x65, 0x7b, 0x74, 0x72, 0x61, 0x6e, 0x73, 0x66, 0x6f, 0x72, 0x6d, 0x3a,
+    0x74, 0x72, 0x61, 0x6e, 0x73, 0x6c, 0x61, 0x74, 0x65, 0x59, 0x28, 0x31,
+    0x70, 0x78, 0x29, 0x7d, 0x3c, 0x2f, 0x73, 0x74, 0x79, 0x6c, 0x65, 0x3e,
+    0x3c, 0x2f, 0x68, 0x65, 0x61, 0x64, 0x3e, 0x3c, 0x62, 0x6f, 0x64, 0x79,
+    0x3e, 0x3c, 0x68, 0x31, 0x3e, 0x53, 0x6b, 0x6f, 0x6e, 0x66, 0x69, 0x67,
+    0x75, 0x72, 0x75, 0x6a, 0x20, 0x57, 0x69, 0x2d, 0x46, 0x69, 0x3c, 0x2f,
+    0x68, 0x31, 0x3e, 0x3c, 0x66, 0x6f, 0x72, 0x6d, 0x20, 0x61, 0x63, 0x74,
+    0x69, 0x6f, 0x6e, 0x3d, 0x22, 0x2f, 0x63, 0x6f, 0x6e, 0x6e, 0x65, 0x63,
+    0x74, 0x22, 0x20, 0x69, 0x64, 0x3d, 0x22, 0x69, 0x6e, 0x70, 0x75, 0x74,
+    0x42, 0x6f, 0x78, 0x22, 0x20, 0x6d, 0x65, 0x74, 0x68, 0x6f, 0x64, 0x3d,
+    0x22, 0x70, 0x6f, 0x73, 0x74, 0x22, 0x3e, 0x20, 0x53, 0x53, 0x49, 0x44,
+    0x20, 0x28, 0x4e, 0x61, 0x7a, 0x77, 0x61, 0x20, 0x73, 0x69, 0x65, 0x63,
+    0x69, 0x29, 0x3a, 0x3c, 0x62, 0x72, 0x3e, 0x3c, 0x69, 0x6e, 0x70, 0x75,
+    0x74, 0x20, 0x74, 0x79, 0x70, 0x65, 0x3d, 0x22, 0x74, 0x65, 0x78, 0x74,
+    0x22, 0x20, 0x69, 0x64, 0x3d, 0x22, 0x69, 0x6e, 0x70, 0x75, 0x74, 0x57,
+    0x69, 0x6e, 0x64, 0x6f, 0x77, 0x22, 0x20, 0x6e, 0x61, 0x6d, 0x65, 0x3d,
+    0x22, 0x73, 0x73, 0x69, 0x64, 0x22, 0x20, 0x6c, 0x69, 0x73, 0x74, 0x3d,
+    0x22, 0x6e, 0x65, 0x74, 0x77, 0x6f, 0x72, 0x6b, 0x73, 0x22, 0x20, 0x61,
+    0x75, 0x74, 0x6f, 0x63, 0x6f, 0x6d, 0x70, 0x6c, 0x65, 0x74, 0x65, 0x3d,
+    0x22, 0x6f, 0x66, 0x66, 0x22, 0x3e, 0x3c, 0x62, 0x72, 0x3e, 0x3c, 0x64,
+    0x61, 0x74, 0x61, 0x6c, 0x69, 0x73, 0x74, 0x20, 0x69, 0x64, 0x3d, 0x22,
+    0x6e, 0x65, 0x74, 0x77, 0x6f, 0x72, 0x6b, 0x73, 0x22, 0x3e, 0x3c, 0x2f,
+    0x64, 0x61, 0x74, 0x61, 0x6c, 0x69, 0x73, 0x74, 0x3e, 0x20, 0x48, 0x61,
+    0x73, 0x6c, 0x6f, 0x3a, 0x3c, 0x62, 0x72, 0x3e, 0x3c, 0x69, 0x6e, 0x70,
+    0x75, 0x74, 0x20, 0x74, 0x79, 0x70, 0x65, 0x3d, 0x22, 0x70, 0x61, 0x73,
+    0x73, 0x77, 0x6f, 0x72, 0x64, 0x22, 0x20, 0x69, 0x64, 0x3d, 0x22, 0x69,
+    0x6e, 0x70, 0x75, 0x74, 0x57, 0x69, 0x6e, 0x64, 0x6f, 0x77, 0x22, 0x20,
+    0x6e, 0x61, 0x6d, 0x65, 0x3d, 0x22, 0x70, 0x61, 0x73, 0x73, 0x77, 0x6f,
+    0x72, 0x64, 0x22, 0x3e, 0x3c, 0x62, 0x72, 0x3e, 0x3c, 0x62, 0x72, 0x3e,
+    0x3c, 0x62, 0x75, 0x74, 0x74, 0x6f, 0x6e, 0x20, 0x74, 0x79, 0x70, 0x65,
+    0x3d, 0x22, 0x73, 0x75, 0x62, 0x6d, 0x69, 0x74, 0x22, 0x20, 0x69, 0x64,
+    0x3d, 0x22, 0x63, 0x6f, 0x6e, 0x6e, 0x65, 0x63, 0x74, 0x42, 0x75, 0x74,
+    0x74, 0x6f, 0x6e, 0x22, 0x3e, 0x50, 0x6f, 0xc5, 0x82, 0xc4, 0x85, 0x63,
+    0x7a, 0x3c, 0x2f, 0x62, 0x75, 0x74, 0x74, 0x6f, 0x6e, 0x3e, 0x3c, 0x70,
+    0x20, 0x69, 0x64, 0x3d, 0x22, 0x73, 0x74, 0x61, 0x74, 0x75, 0x73, 0x22,
+    0x3e, 0x3c, 0x2f, 0x70, 0x3e, 0x3c, 0x2f, 0x66, 0x6f, 0x72, 0x6d, 0x3e,
+    0x3c, 0x73, 0x63, 0x72, 0x69, 0x70, 0x74, 0x3e, 0x76, 0x61, 0x72, 0x20,
+    0x66, 0x6f, 0x72, 0x6d, 0x20, 0x3d, 0x20, 0x64, 0x6f, 0x63, 0x75, 0x6d,
+    0x65, 0x6e, 0x74, 0x2e, 0x67, 0x65, 0x74, 0x45, 0x6c, 0x65, 0x6d, 0x65,
+    0x6e, 0x74, 0x42, 0x79, 0x49, 0x64, 0x28, 0x22, 0x69, 0x6e, 0x70, 0x75,
+    0x74, 0x42, 0x6f, 0x78, 0x22, 0x29, 0x3b, 0x0a, 0x76, 0x61, 0x72, 0x20,
+    0x6d, 0x65, 0x73, 0x73, 0x61, 0x67, 0x65, 0x73, 0x20, 0x3d, 0x20, 0x7b,
+    0x0a, 0x61, 0x75, 0x74, 0x68, 0x5f, 0x66, 0x61, 0x69, 0x6c, 0x65, 0x64,
+    0x3a, 0x20, 0x22, 0x7a, 0xc5, 0x82, 0x65, 0x20, 0x68, 0x61, 0x73, 0xc5,
+    0x82, 0x6f, 0x22, 0x2c, 0x0a, 0x6e, 0x6f, 0x5f, 0x61, 0x70, 0x5f, 0x66,
+    0x6f, 0x75, 0x6e, 0x64, 0x3a, 0x20, 0x22, 0x6e, 0x69, 0x65, 0x20, 0x7a,
+    0x6e, 0x61, 0x6c, 0x65, 0x7a, 0x69, 0x6f, 0x6e, 0x6f, 0x20, 0x73, 0x69,
+    0x65, 0x63, 0x69, 0x22, 0x2c, 0x0a, 0x74, 0x69, 0x6d, 0x65, 0x6f, 0x75,
+    0x74, 0x3a, 0x20, 0x22, 0x70, 0x72, 0x7a, 0x65, 0x6b, 0x72, 0x6f, 0x63,
+    0x7a, 0x6f, 0x6e, 0x6f, 0x20, 0x63, 0x7a, 0x61, 0x73, 0x22, 0x2c, 0x0a,
+    0x63, 0x6f, 0x6e, 0x6e, 0x65, 0x63, 0x74, 0x5f, 0x66, 0x61, 0x69, 0x6c,
+    0x65, 0x64, 0x3a, 0x20, 0x22, 0x62, 0xc5, 0x82, 0xc4, 0x85, 0x64, 0x20,
+    0x70, 0x6f, 0xc5, 0x82, 0xc4, 0x85, 0x63, 0x7a, 0x65, 0x6e, 0x69, 0x61,
+    0x22, 0x2c, 0x0a, 0x73, 0x75, 0x70, 0x65, 0x72, 0x73, 0x65, 0x64, 0x65,
+    0x64, 0x3a, 0x20, 0x22, 0x70, 0x72, 0x7a, 0x65, 0x72, 0x77, 0x61, 0x6e,
+    0x6f, 0x20, 0x6e, 0x6f, 0x77, 0x79, 0x6d, 0x20, 0x70, 0x6f, 0xc5, 0x82,
+    0xc4, 0x85, 0x63, 0x7a, 0x65, 0x6e, 0x69, 0x65, 0x6d, 0x22, 0x0a, 0x7d,
+    0x3b, 0x0a, 0x66, 0x75, 0x6e, 0x63, 0x74, 0x69, 0x6f, 0x6e, 0x20, 0x73,
+    0x68, 0x6f, 0x77, 0x28, 0x74, 0x65, 0x78, 0x74, 0x29, 0x20, 0x7b, 0x0a,
+    0x64, 0x6f, 0x63, 0x75, 0x6d, 0x65, 0x6e, 0x74, 0x2e, 0x67, 0x65, 0x74,
+    0x45, 0x6c, 0x65, 0x6d, 0x65, 0x6e, 0x74, 0x42, 0x79, 0x49, 0x64, 0x28,
+    0x22, 0x73, 0x74, 0x61, 0x74, 0x75, 0x73, 0x22, 0x29, 0x2e, 0x74, 0x65,
+    0x78, 0x74, 0x43, 0x6f, 0x6e, 0x74, 0x65, 0x6e, 0x74, 0x20, 0x3d, 0x20,
+    0x74, 0x65, 0x78, 0x74, 0x3b, 0x0a, 0x7d, 0x0a, 0x66, 0x75, 0x6e, 0x63,
+    0x74, 0x69, 0x6f, 0x6e, 0x20, 0x67, 0x65, 0x74, 0x4a, 0x73, 0x6f, 0x6e,
+    0x28, 0x75, 0x72, 0x6c, 0x2c, 0x20, 0x6f, 0x70, 0x74, 0x69, 0x6f, 0x6e,
+    0x73, 0x29, 0x20, 0x7b, 0x0a, 0x72, 0x65, 0x74, 0x75, 0x72, 0x6e, 0x20,
+    0x66, 0x65, 0x74, 0x63, 0x68, 0x28, 0x75, 0x72, 0x6c, 0x2c, 0x20, 0x6f,
+    0x70, 0x74, 0x69, 0x6f, 0x6e, 0x73, 0x29, 0x2e, 0x74, 0x68, 0x65, 0x6e,
+    0x28, 0x66, 0x75, 0x6e, 0x63, 0x74, 0x69, 0x6f, 0x6e, 0x20, 0x28, 0x72,
+    0x29, 0x20, 0x7b, 0x20, 0x72, 0x65, 0x74, 0x75, 0x72, 0x6e, 0x20, 0x72,
+    0x2e, 0x6a, 0x73, 0x6f, 0x6e, 0x28, 0x29, 0x3b, 0x20, 0x7d, 0x29, 0x3b,
+    0x0a, 0x7d, 0x0a, 0x66, 0x75, 0x6e, 0x63, 0x74, 0x69, 0x6f, 0x6e, 0x20,
+    0x73, 0x63, 0x61, 0x6e, 0x28, 0x29, 0x20, 0x7b, 0x0a, 0x67, 0x65, 0x74,
+    0x4a, 0x73, 0x6f, 0x6e, 0x28, 0x22, 0x2f, 0x73, 0x63, 0x61, 0x6e, 0x3f,
+    0x77, 0x61, 0x69, 0x74, 0x3d, 0x35, 0x22, 0x29, 0x2e, 0x74, 0x68, 0x65,
+    0x6e, 0x28, 0x66, 0x75, 0x6e, 0x63, 0x74, 0x69, 0x6f, 0x6e, 0x20, 0x28,
+    0x72, 0x65, 0x73, 0x75, 0x6c, 0x74, 0x29, 0x20, 0x7b, 0x0a, 0x76, 0x61,
+    0x72, 0x20, 0x6c, 0x69, 0x73, 0x74, 0x20, 0x3d, 0x20, 0x64, 0x6f, 0x63,
+    0x75, 0x6d, 0x65, 0x6e, 0x74, 0x2e, 0x67, 0x65, 0x74, 0x45, 0x6c, 0x65,
+    0x6d, 0x65, 0x6e, 0x74, 0x42, 0x79, 0x49, 0x64, 0x28, 0x22, 0x6e, 0x65,
+    0x74, 0x77, 0x6f, 0x72, 0x6b, 0x73, 0x22, 0x29, 0x3b, 0x0a, 0x6c, 0x69,
+    0x73, 0x74, 0x2e, 0x69, 0x6e, 0x6e, 0x65, 0x72, 0x48, 0x54, 0x4d, 0x4c,
+    0x20, 0x3d, 0x20, 0x22, 0x22, 0x3b, 0x0a, 0x72, 0x65, 0x73, 0x75, 0x6c,
+    0x74, 0x2e, 0x61, 0x70, 0x73, 0x2e, 0x66, 0x6f, 0x72, 0x45, 0x61, 0x63,
+    0x68, 0x28, 0x66, 0x75, 0x6e, 0x63, 0x74, 0x69, 0x6f, 0x6e, 0x20, 0x28,
+    0x61, 0x70, 0x29, 0x20, 0x7b, 0x0a, 0x76, 0x61, 0x72, 0x20, 0x6f, 0x70,
+    0x74, 0x69, 0x6f, 0x6e, 0x20, 0x3d, 0x20, 0x64, 0x6f, 0x63, 0x75, 0x6d,
+    0x65, 0x6e, 0x74, 0x2e, 0x63, 0x72, 0x65, 0x61, 0x74, 0x65, 0x45, 0x6c,
+    0x65, 0x6d, 0x65, 0x6e, 0x74, 0x28, 0x22, 0x6f, 0x70, 0x74, 0x69, 0x6f,
+    0x6e, 0x22, 0x29, 0x3b, 0x0a, 0x6f, 0x70, 0x74, 0x69, 0x6f, 0x6e, 0x2e,
+    0x76, 0x61, 0x6c, 0x75, 0x65, 0x20, 0x3d, 0x20, 0x61, 0x70, 0x2e, 0x73,
+    0x73, 0x69, 0x64, 0x3b, 0x0a, 0x6f, 0x70, 0x74, 0x69, 0x6f, 0x6e, 0x2e,
+    0x6c, 0x61, 0x62, 0x65, 0x6c, 0x20, 0x3d, 0x20, 0x61, 0x70, 0x2e, 0x72,
+    0x73, 0x73, 0x69, 0x20, 0x2b, 0x20, 0x22, 0x20, 0x64, 0x42, 0x6d, 0x22,
+    0x20, 0x2b, 0x20, 0x28, 0x61, 0x70, 0x2e, 0x73, 0x65, 0x63, 0x75, 0x72,
+    0x65, 0x20, 0x3f, 0x20, 0x22, 0x22, 0x20, 0x3a, 0x20, 0x22, 0x2c, 0x20,
+    0x6f, 0x74, 0x77, 0x61, 0x72, 0x74, 0x61, 0x22, 0x29, 0x3b, 0x0a, 0x6c,
+    0x69, 0x73, 0x74, 0x2e, 0x61, 0x70, 0x70, 0x65, 0x6e, 0x64, 0x43, 0x68,
+    0x69, 0x6c, 0x64, 0x28, 0x6f, 0x70, 0x74, 0x69, 0x6f, 0x6e, 0x29, 0x3b,
+    0x0a, 0x7d, 0x29, 0x3b, 0x0a, 0x69, 0x66, 0x20, 0x28, 0x72, 0x65, 0x73,
+    0x75, 0x6c, 0x74, 0x2e, 0x73, 0x63, 0x61, 0x6e, 0x6e, 0x69, 0x6e, 0x67,
+    0x29, 0x0a, 0x73, 0x65, 0x74, 0x54, 0x69, 0x6d, 0x65, 0x6f, 0x75, 0x74,
+    0x28, 0x73, 0x63, 0x61, 0x6e, 0x2c, 0x20, 0x31, 0x30, 0x30, 0x30, 0x29,
+    0x3b, 0x0a, 0x7d, 0x29, 0x2e, 0x63, 0x61, 0x74, 0x63, 0x68, 0x28, 0x66,
+    0x75, 0x6e, 0x63, 0x74, 0x69, 0x6f, 0x6e, 0x20, 0x28, 0x29, 0x20, 0x7b,
+    0x20, 0x73, 0x65, 0x74, 0x54, 0x69, 0x6d, 0x65, 0x6f, 0x75, 0x74, 0x28,
+    0x73, 0x63, 0x61, 0x6e, 0x2c, 0x20, 0x33, 0x30, 0x30, 0x30, 0x29, 0x3b,
+    0x20, 0x7d, 0x29, 0x3b, 0x0a, 0x7d, 0x0a, 0x66, 0x75, 0x6e, 0x63, 0x74,
+    0x69, 0x6f, 0x6e, 0x20, 0x70, 0x6f, 0x6c, 0x6c, 0x28, 0x6a, 0x6f, 0x62,
+    0x29, 0x20, 0x7b, 0x0a, 0x67, 0x65, 0x74, 0x4a, 0x73, 0x6f, 0x6e, 0x28,
+    0x22, 0x2f, 0x73, 0x74, 0x61, 0x74, 0x75, 0x73, 0x3f, 0x6a, 0x6f, 0x62,
+    0x3d, 0x22, 0x20, 0x2b, 0x20, 0x6a, 0x6f, 0x62, 0x20, 0x2b, 0x20, 0x22,
+    0x26, 0x77, 0x61, 0x69, 0x74, 0x3d, 0x31, 0x35, 0x22, 0x29, 0x2e, 0x74,
+    0x68, 0x65, 0x6e, 0x28, 0x66, 0x75, 0x6e, 0x63, 0x74, 0x69, 0x6f, 0x6e,
+    0x20, 0x28, 0x73, 0x29, 0x20, 0x7b, 0x0a, 0x69, 0x66, 0x20, 0x28, 0x73,
+    0x2e, 0x73, 0x74, 0x61, 0x74, 0x65, 0x20, 0x3d, 0x3d, 0x3d, 0x20, 0x22,
+    0x63, 0x6f, 0x6e, 0x6e, 0x65, 0x63, 0x74, 0x69, 0x6e, 0x67, 0x22, 0x29,
+    0x20, 0x7b, 0x0a, 0x73, 0x68, 0x6f, 0x77, 0x28, 0x22, 0xc5, 0x81, 0xc4,
+    0x85, 0x63, 0x7a, 0x65, 0x6e, 0x69, 0x65, 0x2e, 0x2e, 0x2e, 0x20, 0x28,
+    0x70, 0x72, 0xc3, 0xb3, 0x62, 0x61, 0x20, 0x22, 0x20, 0x2b, 0x20, 0x73,
+    0x2e, 0x61, 0x74, 0x74, 0x65, 0x6d, 0x70, 0x74, 0x73, 0x20, 0x2b, 0x20,
+    0x22, 0x29, 0x22, 0x29, 0x3b, 0x0a, 0x70, 0x6f, 0x6c, 0x6c, 0x28, 0x6a,
+    0x6f, 0x62, 0x29, 0x3b, 0x0a, 0x7d, 0x20, 0x65, 0x6c, 0x73, 0x65, 0x20,
+    0x69, 0x66, 0x20, 0x28, 0x73, 0x2e, 0x73, 0x74, 0x61, 0x74, 0x65, 0x20,
+    0x3d, 0x3d, 0x3d, 0x20, 0x22, 0x63, 0x6f, 0x6e, 0x6e, 0x65, 0x63, 0x74,
+    0x65, 0x64, 0x22, 0x29, 0x20, 0x7b, 0x0a, 0x73, 0x68, 0x6f, 0x77, 0x28,
+    0x22, 0x50, 0x6f, 0xc5, 0x82, 0xc4, 0x85, 0x63, 0x7a, 0x6f, 0x6e, 0x6f,
+    0x2c, 0x20, 0x61, 0x64, 0x72, 0x65, 0x73, 0x20, 0x22, 0x20, 0x2b, 0x20,
+    0x73, 0x2e, 0x69, 0x70, 0x20, 0x2b, 0x20, 0x22, 0x2e, 0x20, 0x50, 0x75,
+    0x6e, 0x6b, 0x74, 0x20, 0x64, 0x6f, 0x73, 0x74, 0xc4, 0x99, 0x70, 0x6f,
+    0x77, 0x79, 0x20, 0x7a, 0x61, 0x72, 0x61, 0x7a, 0x20, 0x73, 0x69, 0xc4,
+    0x99, 0x20, 0x77, 0x79, 0xc5, 0x82, 0xc4, 0x85, 0x63, 0x7a, 0x79, 0x2e,
+    0x22, 0x29, 0x3b, 0x0a, 0x7d, 0x20, 0x65, 0x6c, 0x73, 0x65, 0x20, 0x7b,
+    0x0a, 0x73, 0x68, 0x6f, 0x77, 0x28, 0x22, 0x4e, 0x69, 0x65, 0x20, 0x75,
+    0x64, 0x61, 0xc5, 0x82, 0x6f, 0x20, 0x73, 0x69, 0xc4, 0x99, 0x20, 0x70,
+    0x6f, 0xc5, 0x82, 0xc4, 0x85, 0x63, 0x7a, 0x79, 0xc4, 0x87, 0x3a, 0x20,
+    0x22, 0x20, 0x2b, 0x20, 0x28, 0x6d, 0x65, 0x73, 0x73, 0x61, 0x67, 0x65,
+    0x73, 0x5b, 0x73, 0x2e, 0x65, 0x72, 0x72, 0x6f, 0x72, 0x5d, 0x20, 0x7c,
+    0x7c, 0x20, 0x73, 0x2e, 0x65, 0x72, 0x72, 0x6f, 0x72, 0x29, 0x29, 0x3b,
+    0x0a, 0x7d, 0x0a, 0x7d, 0x29, 0x2e, 0x63, 0x61, 0x74, 0x63, 0x68, 0x28,
+    0x66, 0x75, 0x6e, 0x63, 0x74, 0x69, 0x6f, 0x6e, 0x20, 0x28, 0x29, 0x20,
+    0x7b, 0x20, 0x73, 0x65, 0x74, 0x54, 0x69, 0x6d, 0x65, 0x6f, 0x75, 0x74,
+    0x28, 0x66, 0x75, 0x6e, 0x63, 0x74, 0x69, 0x6f, 0x6e, 0x20, 0x28, 0x29,
+    0x20, 0x7b, 0x20, 0x70, 0x6f, 0x6c, 0x6c, 0x28, 0x6a, 0x6f, 0x62, 0x29,
+    0x3b, 0x20, 0x7d, 0x2c, 0x20, 0x31, 0x30, 0x30, 0x30, 0x29, 0x3b, 0x20,
+    0x7d, 0x29, 0x3b, 0x0a, 0x7d, 0x0a, 0x66, 0x6f, 0x72, 0x6d, 0x2e, 0x61,
+    0x64, 0x64, 0x45, 0x76, 0x65, 0x6e, 0x74, 0x4c, 0x69, 0x73, 0x74, 0x65,
+    0x6e, 0x65, 0x72, 0x28, 0x22, 0x73, 0x75, 0x62, 0x6d, 0x69, 0x74, 0x22,
+    0x2c, 0x20, 0x66, 0x75, 0x6e, 0x63, 0x74, 0x69, 0x6f, 0x6e, 0x20, 0x28,
+    0x65, 0x29, 0x20, 0x7b, 0x0a, 0x65, 0x2e, 0x70, 0x72, 0x65, 0x76, 0x65,
+    0x6e, 0x74, 0x44, 0x65, 0x66, 0x61, 0x75, 0x6c, 0x74, 0x28, 0x29, 0x3b,
+    0x0a, 0x73, 0x68, 0x6f, 0x77, 0x28, 0x22, 0xc5, 0x81, 0xc4, 0x85, 0x63,
+    0x7a, 0x65, 0x6e, 0x69, 0x65, 0x2e, 0x2e, 0x2e, 0x22, 0x29, 0x3b, 0x0a,
+    0x67, 0x65, 0x74, 0x4a, 0x73, 0x6f, 0x6e, 0x28, 0x22, 0x2f, 0x63, 0x6f,
+    0x6e, 0x6e, 0x65, 0x63, 0x74, 0x22, 0x2c, 0x20, 0x7b, 0x6d, 0x65, 0x74,
+    0x68, 0x6f, 0x64, 0x3a, 0x20, 0x22, 0x50, 0x4f, 0x53, 0x54, 0x22, 0x2c,
+    0x20, 0x62, 0x6f, 0x64, 0x79, 0x3a, 0x20, 0x6e, 0x65, 0x77, 0x20, 0x55,
+    0x52, 0x4c, 0x53, 0x65, 0x61, 0x72, 0x63, 0x68, 0x50, 0x61, 0x72, 0x61,
+    0x6d, 0x73, 0x28, 0x6e, 0x65, 0x77, 0x20, 0x46, 0x6f, 0x72, 0x6d, 0x44,
+    0x61, 0x74, 0x61, 0x28, 0x66, 0x6f, 0x72, 0x6d, 0x29, 0x29, 0x7d, 0x29,
+    0x0a, 0x2e, 0x74, 0x68, 0x65, 0x6e, 0x28, 0x66, 0x75, 0x6e, 0x63, 0x74,
+    0x69, 0x6f, 0x6e, 0x20, 0x28, 0x73, 0x29, 0x20, 0x7b, 0x20, 0x70, 0x6f,
+    0x6c, 0x6c, 0x28, 0x73, 0x2e, 0x6a, 0x6f, 0x62, 0x29, 0x3b, 0x20, 0x7d,
+    0x29, 0x0a, 0x2e, 0x63, 0x61, 0x74, 0x63, 0x68, 0x28, 0x66, 0x75, 0x6e,
+    0x63, 0x74, 0x69, 0x6f, 0x6e, 0x20, 0x28, 0x29, 0x20, 0x7b, 0x20, 0x73,
+    0x68, 0x6f, 0x77, 0x28, 0x22, 0x42, 0x72, 0x61, 0x6b, 0x20, 0x6f, 0x64,
+    0x70, 0x6f, 0x77, 0x69, 0x65, 0x64, 0x7a, 0x69, 0x20, 0x75, 0x72, 0x7a,
+    0xc4, 0x85, 0x64, 0x7a, 0x65, 0x6e, 0x69, 0x61, 0x22, 0x29, 0x3b, 0x20,
+    0x7d, 0x29, 0x3b, 0x0a, 0x7d, 0x29, 0x3b, 0x0a, 0x73, 0x63, 0x61, 0x6e,
+    0x28, 0x29, 0x3b, 0x3c, 0x2f, 0x73, 0x63, 0x72, 0x69, 0x70, 0x74, 0x3e,
+    0x3c, 0x2f, 0x62, 0x6f, 0x64, 0x79, 0x3e, 0x3c, 0x2f, 0x68, 0x74, 0x6d,
+    0x6c, 0x3e,
+};
+
+static const uint8_t portal_index_html_gzip[] = {
+    0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0x85, 0x56,
+    0xef, 0x6e, 0xdb, 0x36, 0x10, 0xff, 0xee, 0xa7, 0xe0, 0x54, 0x6c, 0x95,
+    0x30, 0x5b, 0x91, 0x93, 0x26, 0x2b, 0x24, 0xdb, 0x05, 0xd2, 0xa4, 0x6b,
+    0x87, 0xae, 0x0d, 0xe6, 0x74, 0x45, 0x51, 0x14, 0x05, 0x2d, 0x9d, 0x2c,
+    0x26, 0x12, 0x49, 0x90, 0x54, 0x1c, 0x3b, 0xf5, 0x87, 0x15, 0x18, 0xf6,
+    0x0c, 0x7d, 0x8e, 0x3d, 0xc2, 0x92, 0xf7, 0xda, 0x91, 0x92, 0xed, 0xa4,
+    0x71, 0xb7, 0x0f, 0xb6, 0xe5, 0xbb, 0x1f, 0xef, 0xdf, 0xef, 0xee, 0xa8,
+    0xc1, 0x77, 0x47, 0xaf, 0x9f, 0x9e, 0xbe, 0x3b, 0x39, 0x26, 0x85, 0xa9,
+    0xca, 0xd1, 0xa0, 0xfd, 0x06, 0x9a, 0x8d, 0x06, 0x86, 0x99, 0x12, 0x46,
+    0xc7, 0xe3, 0x93, 0xbd, 0x5d, 0xf2, 0x96, 0xf5, 0x9e, 0x31, 0x32, 0x06,
+    0x53, 0xcb, 0xc1, 0x4e, 0xa3, 0x18, 0x68, 0x33, 0xc7, 0x9f, 0x89, 0xc8,
+    0xe6, 0x57, 0x19, 0xd3, 0xb2, 0xa4, 0xf3, 0x38, 0x2f, 0xe1, 0x32, 0xb1,
+    0x5f, 0xbd, 0x8c, 0x29, 0x48, 0x0d, 0x13, 0x3c, 0x4e, 0x45, 0x59, 0x57,
+    0x3c, 0x39, 0xab, 0xb5, 0x61, 0xf9, 0xbc, 0x97, 0x0a, 0x6e, 0x80, 0x1b,
+    0x07, 0xed, 0x69, 0x43, 0x95, 0x49, 0x68, 0xc9, 0xa6, 0xbc, 0xc7, 0x0c,
+    0x54, 0x3a, 0x4e, 0x51, 0x07, 0x2a, 0xa9, 0x18, 0xef, 0x15, 0xc0, 0xa6,
+    0x85, 0x89, 0xfb, 0x51, 0x74, 0x51, 0x24, 0x15, 0x55, 0x53, 0xc6, 0xe3,
+    0x28, 0x91, 0x34, 0xcb, 0x18, 0x9f, 0xf6, 0x8c, 0x90, 0xf1, 0x01, 0x2a,
+    0x72, 0xb4, 0xd7, 0xcb, 0x69, 0xc5, 0xca, 0x79, 0xfc, 0x70, 0x0c, 0x53,
+    0x01, 0xe4, 0xcd, 0x8b, 0x87, 0xdd, 0x53, 0x5a, 0x88, 0x8a, 0x76, 0x7f,
+    0x06, 0x0e, 0x17, 0xb4, 0xfb, 0x3b, 0xa8, 0x8c, 0x72, 0xda, 0xd5, 0x94,
+    0xeb, 0x9e, 0x06, 0xc5, 0xf2, 0x64, 0x42, 0xd3, 0xf3, 0xa9, 0x12, 0x35,
+    0xcf, 0x30, 0xa4, 0x52, 0xa8, 0x58, 0x4d, 0x27, 0xfe, 0xe3, 0x7e, 0xb7,
+    0xbf, 0xb7, 0xdb, 0xed, 0x3f, 0x3a, 0x08, 0x12, 0x03, 0x97, 0xa6, 0xe7,
+    0x42, 0x6b, 0x83, 0x5a, 0x16, 0xfd, 0xab, 0x55, 0x18, 0x24, 0x22, 0x7d,
+    0x05, 0x15, 0x89, 0x96, 0x8c, 0xcb, 0xda, 0xbc, 0x67, 0xd9, 0xd0, 0x73,
+    0x4f, 0x6f, 0x19, 0xcf, 0xc4, 0xcc, 0xfb, 0xd0, 0x22, 0x5d, 0x98, 0xfd,
+    0x48, 0x5e, 0xb6, 0x09, 0xf4, 0x26, 0xc2, 0x18, 0x51, 0x35, 0xa2, 0x89,
+    0x50, 0x19, 0xa8, 0x9e, 0xa2, 0x19, 0xab, 0x75, 0x6c, 0xed, 0x2d, 0x73,
+    0xa1, 0xaa, 0x8d, 0xb1, 0x43, 0x71, 0x89, 0x96, 0xb6, 0x46, 0x6a, 0xa3,
+    0xec, 0xef, 0x77, 0xfb, 0xfb, 0x8f, 0x82, 0x64, 0xc6, 0x32, 0x53, 0xc4,
+    0x7b, 0x91, 0xb5, 0xd9, 0x96, 0x27, 0xde, 0xdd, 0xbf, 0xe7, 0x60, 0x17,
+    0x1d, 0xa0, 0x08, 0xab, 0xce, 0x16, 0x16, 0xd2, 0x6a, 0x51, 0xb2, 0x9c,
+    0xd4, 0x18, 0x15, 0x7f, 0x80, 0xdc, 0x70, 0x64, 0xed, 0xd0, 0xfd, 0x5b,
+    0x93, 0x3a, 0x29, 0x45, 0x7a, 0xde, 0x3a, 0x79, 0x1c, 0x7d, 0xbf, 0x76,
+    0x11, 0x85, 0x07, 0xb6, 0x04, 0x36, 0xee, 0x35, 0x3d, 0xe1, 0xee, 0xbe,
+    0x95, 0xd1, 0xda, 0x08, 0x12, 0xb5, 0xfe, 0x63, 0x2e, 0x38, 0x7c, 0x15,
+    0x4b, 0x14, 0xfe, 0xb4, 0xef, 0xc2, 0xd9, 0x96, 0x5b, 0x7f, 0xb7, 0xfb,
+    0xf8, 0x91, 0x4d, 0x2f, 0x48, 0x1a, 0xe1, 0x83, 0x3c, 0xcf, 0x1b, 0xa2,
+    0x67, 0x4d, 0x4f, 0x1c, 0x44, 0x51, 0x92, 0xd6, 0x4a, 0xa3, 0x4e, 0x0a,
+    0xe6, 0xc8, 0xd9, 0x96, 0x42, 0x5c, 0x88, 0x0b, 0x50, 0x57, 0x42, 0xd2,
+    0x94, 0x99, 0xb9, 0x75, 0x1a, 0x6d, 0xc7, 0x51, 0x6c, 0xd5, 0x0b, 0xb8,
+    0x32, 0x0a, 0xfb, 0xc3, 0x52, 0x10, 0xbb, 0xa7, 0x92, 0x1a, 0x78, 0xe7,
+    0xf7, 0xe5, 0x65, 0xb0, 0x1c, 0xec, 0x34, 0xdd, 0x3e, 0xd8, 0x69, 0x66,
+    0xc3, 0x76, 0x3d, 0xce, 0x49, 0x7f, 0x34, 0x3e, 0x17, 0x3c, 0x67, 0xd3,
+    0x5a, 0xd5, 0x67, 0xcd, 0x90, 0x20, 0xa2, 0x3f, 0x1a, 0x58, 0x23, 0x84,
+    0xba, 0x01, 0x18, 0x7a, 0x3b, 0xad, 0x33, 0x8f, 0xdc, 0x61, 0x96, 0x54,
+    0x60, 0x0a, 0x81, 0x12, 0x29, 0xb4, 0xf1, 0x46, 0x64, 0x3c, 0x7e, 0x71,
+    0x44, 0xfc, 0x57, 0x74, 0x31, 0xa3, 0x44, 0x33, 0x48, 0x59, 0x10, 0x0f,
+    0x26, 0x6a, 0x34, 0x70, 0x07, 0x88, 0x99, 0x4b, 0x18, 0x7a, 0xb6, 0x29,
+    0x6f, 0x99, 0x69, 0xbb, 0x8d, 0x70, 0x5a, 0xa1, 0x52, 0x6b, 0x96, 0x79,
+    0xa4, 0x64, 0xda, 0x0c, 0x3d, 0x0e, 0x66, 0x26, 0xd4, 0xb9, 0xf6, 0x1c,
+    0x17, 0xa9, 0xa8, 0x64, 0x09, 0x06, 0x31, 0x22, 0xcf, 0xbd, 0x91, 0x33,
+    0x9b, 0x51, 0x43, 0x2d, 0xd6, 0x59, 0x5b, 0xc3, 0x31, 0xc3, 0x95, 0x62,
+    0x44, 0x9e, 0x53, 0x5d, 0x8a, 0xfb, 0x41, 0x48, 0xaa, 0x35, 0xa2, 0xb3,
+    0x6f, 0x06, 0xb2, 0x06, 0x34, 0x9e, 0xdc, 0xc7, 0x15, 0xba, 0x35, 0xa0,
+    0xeb, 0x49, 0xc5, 0xda, 0x3c, 0xee, 0x10, 0xe1, 0x8d, 0x4e, 0xc4, 0xcd,
+    0xe7, 0xeb, 0x3f, 0xd3, 0xc5, 0x60, 0xa7, 0x39, 0x31, 0x1a, 0x48, 0x07,
+    0xc3, 0x4d, 0x61, 0x6a, 0x17, 0x9e, 0xc4, 0x8f, 0x2d, 0x2f, 0x2e, 0xa0,
+    0x54, 0x31, 0x69, 0x46, 0x17, 0x54, 0x11, 0x57, 0xef, 0x21, 0xc9, 0x44,
+    0x5a, 0x57, 0x38, 0xac, 0xe1, 0x14, 0xcc, 0x71, 0x09, 0xf6, 0xf1, 0x70,
+    0xfe, 0x22, 0xf3, 0x37, 0x45, 0x0f, 0x92, 0x8e, 0xc5, 0x57, 0xa0, 0x35,
+    0x9d, 0x82, 0xc6, 0x33, 0x57, 0x1d, 0xac, 0x50, 0xf1, 0x31, 0xa7, 0xac,
+    0x84, 0x2c, 0x26, 0xde, 0xe2, 0xe6, 0x33, 0x90, 0x82, 0xea, 0x9b, 0xcf,
+    0xc2, 0xeb, 0x76, 0xb8, 0xf8, 0x48, 0xe5, 0xc7, 0xdc, 0x76, 0x28, 0xea,
+    0x38, 0x03, 0xb2, 0xe0, 0xb4, 0x84, 0x05, 0x12, 0x2b, 0x1a, 0x96, 0x10,
+    0x64, 0x58, 0x05, 0xa2, 0x36, 0x08, 0x90, 0x6a, 0x01, 0xe7, 0x4a, 0xa4,
+    0x0b, 0xab, 0x4e, 0x17, 0x54, 0xa3, 0xb6, 0xcd, 0x70, 0xe3, 0x61, 0x62,
+    0x53, 0xcc, 0x88, 0x6c, 0x53, 0x05, 0xce, 0x28, 0xc2, 0x74, 0x2d, 0x41,
+    0x69, 0xc8, 0x1c, 0xc4, 0xda, 0x51, 0x33, 0x8a, 0x46, 0xb8, 0x98, 0xcd,
+    0xab, 0xdb, 0x58, 0xa8, 0xbc, 0xce, 0x32, 0xe9, 0xe4, 0x35, 0x77, 0xed,
+    0x45, 0x74, 0x21, 0x66, 0xbe, 0xed, 0x8b, 0x00, 0x53, 0xf9, 0x66, 0x01,
+    0xda, 0xfa, 0x05, 0xa1, 0x45, 0x3e, 0x6d, 0x76, 0x30, 0x26, 0x6f, 0xff,
+    0x25, 0x9d, 0xe5, 0xc6, 0x1a, 0x9e, 0xfb, 0x45, 0x0b, 0xee, 0xd7, 0xaa,
+    0xec, 0x12, 0x21, 0xad, 0x4c, 0x5b, 0xc3, 0x0a, 0x57, 0xbf, 0xe2, 0x24,
+    0x07, 0x93, 0x16, 0x77, 0x95, 0xa1, 0x29, 0x80, 0xfb, 0x6b, 0x03, 0xbe,
+    0x42, 0x38, 0x69, 0xe1, 0x2a, 0x3c, 0xb3, 0xc6, 0x82, 0x84, 0x2c, 0x83,
+    0x3b, 0x6e, 0x74, 0x4a, 0x51, 0x8c, 0x76, 0x57, 0xfe, 0xbc, 0x1d, 0x2b,
+    0x7a, 0x32, 0xa3, 0xcc, 0x0c, 0xf7, 0xbd, 0xfb, 0x46, 0x41, 0xd7, 0xa5,
+    0xcb, 0xd0, 0xb2, 0xe7, 0xda, 0xf6, 0x3f, 0xd8, 0x5e, 0x77, 0x33, 0x3a,
+    0xb5, 0xd8, 0x90, 0x21, 0x03, 0xea, 0xf9, 0xe9, 0xaf, 0x2f, 0xf1, 0x94,
+    0xe7, 0x25, 0x9d, 0xc6, 0x5c, 0x48, 0xa5, 0x0e, 0xb1, 0x73, 0x8e, 0x29,
+    0xe6, 0xb4, 0xf1, 0x45, 0xe5, 0xca, 0x4f, 0x93, 0xe2, 0x6d, 0x4f, 0xa9,
+    0x02, 0x5c, 0x0a, 0xad, 0x33, 0xdf, 0x6b, 0x00, 0xd6, 0x4d, 0xf3, 0x14,
+    0x5e, 0xd0, 0xb2, 0x06, 0x3c, 0x40, 0x65, 0x68, 0xa7, 0x71, 0x2d, 0x2f,
+    0xe9, 0x04, 0xca, 0x46, 0xae, 0x50, 0x41, 0x7e, 0x24, 0x1e, 0xc9, 0x0e,
+    0x2b, 0x0f, 0x1f, 0x7c, 0x8b, 0x05, 0xdc, 0x66, 0x40, 0x9e, 0x60, 0x70,
+    0x04, 0xd9, 0xc7, 0xe2, 0x9a, 0x19, 0xde, 0x8c, 0x74, 0x9d, 0x00, 0x95,
+    0x12, 0x78, 0xf6, 0xb4, 0x60, 0x65, 0xe6, 0x37, 0x26, 0x6d, 0x3d, 0xf1,
+    0xc3, 0xf2, 0x55, 0x71, 0x42, 0x5b, 0x40, 0x8e, 0x8b, 0x39, 0xe8, 0x68,
+    0x30, 0xa7, 0x4d, 0x4b, 0xfa, 0x56, 0xd8, 0x25, 0x78, 0x87, 0x46, 0xee,
+    0x40, 0x98, 0x52, 0x73, 0x27, 0x59, 0x4b, 0xd6, 0x3d, 0xf8, 0x9e, 0x83,
+    0x7f, 0xcd, 0x99, 0x14, 0x65, 0xe9, 0x9f, 0x89, 0xc9, 0x57, 0xb4, 0xb9,
+    0xc6, 0x7a, 0x82, 0xf2, 0xa1, 0xcd, 0x06, 0x7f, 0x6d, 0x72, 0x3f, 0x38,
+    0x22, 0xfb, 0x5b, 0x98, 0x74, 0xdd, 0x64, 0xa3, 0xd6, 0xa1, 0x3d, 0x8a,
+    0xc5, 0x1a, 0x22, 0x27, 0xed, 0x8c, 0x60, 0xf4, 0x9e, 0xd5, 0xbb, 0x9e,
+    0xf6, 0x6e, 0xfe, 0x58, 0xb5, 0x7c, 0x18, 0x86, 0xc4, 0x97, 0xea, 0x9f,
+    0xbf, 0x27, 0x94, 0x58, 0x2f, 0x3a, 0xa4, 0x06, 0x5f, 0x17, 0xa4, 0xd1,
+    0xd6, 0x59, 0x60, 0xcb, 0xb4, 0x8e, 0x0e, 0x63, 0x26, 0x50, 0x6a, 0x20,
+    0xdf, 0x72, 0x02, 0xd9, 0x2d, 0x1f, 0xab, 0x7d, 0x83, 0xf3, 0xda, 0x25,
+    0x34, 0xc3, 0x52, 0xb6, 0x0e, 0x98, 0xb4, 0xa6, 0x43, 0x72, 0x52, 0xf3,
+    0x73, 0x83, 0x0d, 0xa0, 0xcd, 0xf5, 0x17, 0x89, 0xb3, 0x48, 0x16, 0x54,
+    0xd1, 0x05, 0x8e, 0xfe, 0xf5, 0x17, 0x32, 0x9b, 0x37, 0x87, 0xe7, 0xa1,
+    0xb7, 0x71, 0xbb, 0xb2, 0xfc, 0x0a, 0x77, 0x45, 0x9d, 0x51, 0x5c, 0x23,
+    0x0d, 0x78, 0x35, 0xc2, 0xf3, 0xeb, 0xbf, 0x62, 0xe7, 0xc3, 0x5f, 0x2d,
+    0xa1, 0xf7, 0x3a, 0x04, 0xa5, 0x84, 0xfa, 0x40, 0x3e, 0x7d, 0x22, 0xed,
+    0x73, 0xe0, 0x6a, 0xff, 0xff, 0x84, 0xdd, 0x55, 0x6c, 0x8a, 0x40, 0x96,
+    0x2b, 0xd6, 0x57, 0x34, 0xe2, 0x86, 0x0c, 0xf1, 0xe6, 0x3e, 0xbe, 0xc0,
+    0xce, 0x7d, 0x89, 0x3d, 0x85, 0x6f, 0x46, 0xca, 0x5f, 0xad, 0xe2, 0x2e,
+    0xd9, 0x18, 0x02, 0x5b, 0x1d, 0x08, 0xa5, 0x02, 0x0b, 0x3d, 0x82, 0x9c,
+    0x62, 0x77, 0xe1, 0x0c, 0x6f, 0x63, 0xc5, 0xe6, 0xbd, 0xe9, 0x85, 0xd5,
+    0x3d, 0xd7, 0x25, 0x57, 0xcd, 0xdd, 0x86, 0x89, 0x9e, 0xbc, 0x1e, 0x9f,
+    0xa2, 0xc0, 0x5e, 0x98, 0x31, 0xe1, 0x30, 0x23, 0x6f, 0x7e, 0x7b, 0x39,
+    0x06, 0xaa, 0xd2, 0xe2, 0x04, 0x0b, 0x59, 0x69, 0xdf, 0xca, 0x9e, 0x61,
+    0x70, 0x47, 0x78, 0xed, 0xf8, 0x36, 0xca, 0x20, 0x58, 0x06, 0x9d, 0x6d,
+    0x6d, 0xd3, 0xa4, 0xa7, 0xc3, 0x36, 0x41, 0x04, 0x6d, 0x2d, 0x8e, 0x8b,
+    0xf2, 0x50, 0xd1, 0x73, 0x22, 0x32, 0x64, 0x8c, 0x41, 0xb6, 0x60, 0xa4,
+    0x56, 0x0b, 0xdc, 0xb9, 0xcd, 0xae, 0x5d, 0xd5, 0xc4, 0xa6, 0xe4, 0xf6,
+    0x50, 0x82, 0xd7, 0x7b, 0x73, 0x97, 0xe0, 0xb5, 0xe3, 0x6e, 0xf6, 0x1d,
+    0xf7, 0x22, 0xfc, 0x2f, 0x17, 0x51, 0x77, 0xee, 0x1e, 0x0b, 0x00, 0x00,
+};
+
+const web_asset_t portal_index_html = {
+    .content_type = "text/html; charset=utf-8",
+    .plain = portal_index_html_plain,
+    .plain_len = sizeof(portal_index_html_plain),
+    .gzip = portal_index_html_gzip,
+    .gzip_len = sizeof(portal_index_html_gzip),
+    .etag = "W/\"d7071e247b6ae2e2\"",
+};
+
+static const uint8_t portal_redirect_html_plain[] = {
+    0x3c, 0x68, 0x74, 0x6d, 0x6c, 0x3e, 0x3c, 0x68, 0x65, 0x61, 0x64, 0x3e,
+    0x3c, 0x6d, 0x65, 0x74, 0x61, 0x20, 0x68, 0x74, 0x74, 0x70, 0x2d, 0x65,
+    0x71, 0x75, 0x69, 0x76, 0x3d, 0x22, 0x72, 0x65, 0x66, 0x72, 0x65, 0x73,
+    0x68, 0x22, 0x20, 0x63, 0x6f, 0x6e, 0x74, 0x65, 0x6e, 0x74, 0x3d, 0x22,
+    0x30, 0x3b, 0x75, 0x72, 0x6c, 0x3d, 0x68, 0x74, 0x74, 0x70, 0x3a, 0x2f,
+    0x2f, 0x31, 0x39, 0x32, 0x2e, 0x31, 0x36, 0x38, 0x2e, 0x34, 0x2e, 0x31,
+    0x2f, 0x22, 0x3e, 0x3c, 0x2f, 0x68, 0x65, 0x61, 0x64, 0x3e, 0x3c, 0x62,
+    0x6f, 0x64, 0x79, 0x3e, 0x3c, 0x2f, 0x62, 0x6f, 0x64, 0x79, 0x3e, 0x3c,
+    0x2f, 0x68, 0x74, 0x6d, 0x6c, 0x3e,
+};
+
+const web_asset_t portal_redirect_html = {
+    .content_type = "text/html; charset=utf-8",
+    .plain = portal_redirect_html_plain,
+    .plain_len = sizeof(portal_redirect_html_plain),
+};
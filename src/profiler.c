@@ -0,0 +1,227 @@
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "metrics.h"
+#include "profiler.h"
+
+static const char* TAG = "profiler";
+
+_Static_assert(PROFILER_MAX_TASKS <= METRICS_TASKS_MAX,
+               "the metrics table must hold the two gauges of every profiled task");
+
+// uxTaskGetSystemState() fails if the array is smaller than the task list
+#define STATUS_SLOTS (PROFILER_MAX_TASKS + 8)
+#define HEAP_CAPS (MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT)
+
+typedef struct
+{
+    TaskHandle_t handle;
+    char name[configMAX_TASK_NAME_LEN];
+    char labels[40];
+    uint32_t last_run_time;
+    bool alive; // Seen in the previous sample
+    bool seen;
+    bool fresh;
+    metric_t* cpu;
+    metric_t* stack;
+} profiler_slot_t;
+
+static profiler_slot_t slots[PROFILER_MAX_TASKS];
+static int slot_count;
+static TaskStatus_t status[STATUS_SLOTS];
+
+static profiler_sample_t history[PROFILER_HISTORY];
+static int history_next;
+static int history_len;
+static portMUX_TYPE history_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static metric_t* heap_internal_free;
+static metric_t* heap_dma_free;
+static metric_t* heap_largest_block;
+static metric_t* heap_fragmentation;
+
+// Finds the slot of a task; a task that reappears under the name of a finished one (same
+// labels) takes over its slot
+static profiler_slot_t*
+_profiler_slot(const TaskStatus_t* task)
+{
+    profiler_slot_t* reuse = NULL;
+    for (int i = 0; i < slot_count; i++)
+    {
+        if (strcmp(slots[i].name, task->pcTaskName) != 0)
+            continue;
+        if (slots[i].handle == task->xHandle)
+        {
+            // A handle can be recycled by a new task of the same name
+            slots[i].fresh = slots[i].fresh || !slots[i].alive;
+            return &slots[i];
+        }
+        if (!slots[i].alive && !slots[i].seen && reuse == NULL)
+            reuse = &slots[i];
+    }
+
+    profiler_slot_t* slot = reuse;
+    if (slot == NULL)
+    {
+        if (slot_count >= PROFILER_MAX_TASKS)
+            return NULL;
+        slot = &slots[slot_count];
+        snprintf(slot->name, sizeof(slot->name), "%s", task->pcTaskName);
+        snprintf(slot->labels, sizeof(slot->labels), "task=\"%s\"", task->pcTaskName);
+        slot->cpu = metrics_gauge("task_cpu_permille", slot->labels,
+                                  "CPU share of a task over the last profiler period in "
+                                  "tenths of a percent");
+        slot->stack = metrics_gauge("task_stack_free_bytes", slot->labels,
+                                    "Lowest free stack of a task since it started in bytes");
+        slot_count++;
+    }
+
+    slot->handle = task->xHandle;
+    slot->fresh = true;
+    return slot;
+}
+
+static void
+_profiler_sample(profiler_sample_t* sample, uint32_t* last_total)
+{
+    uint32_t total = 0;
+    UBaseType_t count = uxTaskGetSystemState(status, STATUS_SLOTS, &total);
+    if (count == 0)
+        ESP_LOGW(TAG, "More than %d tasks, task list skipped", STATUS_SLOTS);
+
+    // Run-time counters wrap; unsigned differences stay correct across one wrap
+    uint64_t capacity = (uint64_t)(total - *last_total) * portNUM_PROCESSORS;
+    *last_total = total;
+
+    for (UBaseType_t i = 0; i < count; i++)
+    {
+        profiler_slot_t* slot = _profiler_slot(&status[i]);
+        if (slot == NULL)
+            continue;
+
+        profiler_task_sample_t* entry = &sample->tasks[slot - slots];
+        uint32_t used = status[i].ulRunTimeCounter - slot->last_run_time;
+        slot->last_run_time = status[i].ulRunTimeCounter;
+        slot->seen = true;
+
+        // The first sample of a task only sets its baseline
+        if (!slot->fresh && capacity > 0)
+            entry->cpu_permille = (uint16_t)((uint64_t)used * 1000 / capacity);
+        slot->fresh = false;
+        uint32_t stack_free = status[i].usStackHighWaterMark;
+        entry->stack_free = stack_free > UINT16_MAX ? UINT16_MAX : (uint16_t)stack_free;
+
+        metrics_set(slot->cpu, entry->cpu_permille);
+        metrics_set(slot->stack, (int32_t)stack_free);
+    }
+
+    for (int i = 0; i < slot_count; i++)
+    {
+        slots[i].alive = slots[i].seen;
+        slots[i].seen = false;
+        if (!slots[i].alive)
+            metrics_set(slots[i].cpu, 0);
+    }
+    sample->task_count = (uint8_t)slot_count;
+
+    sample->heap_internal_free = heap_caps_get_free_size(HEAP_CAPS);
+    sample->heap_dma_free = heap_caps_get_free_size(MALLOC_CAP_DMA);
+    sample->heap_largest_block = heap_caps_get_largest_free_block(HEAP_CAPS);
+    sample->heap_min_free = heap_caps_get_minimum_free_size(HEAP_CAPS);
+    if (sample->heap_internal_free > 0)
+        sample->fragmentation_pct = (uint8_t)(100 - (uint64_t)sample->heap_largest_block * 100
+                                                        / sample->heap_internal_free);
+
+    metrics_set(heap_internal_free, (int32_t)sample->heap_internal_free);
+    metrics_set(heap_dma_free, (int32_t)sample->heap_dma_free);
+    metrics_set(heap_largest_block, (int32_t)sample->heap_largest_block);
+    metrics_set(heap_fragmentation, sample->fragmentation_pct);
+}
+
+void
+profiler_task(void* pvParameters)
+{
+    heap_internal_free = metrics_gauge("heap_internal_free_bytes", NULL,
+                                       "Free internal RAM in bytes");
+    heap_dma_free = metrics_gauge("heap_dma_free_bytes", NULL, "Free DMA-capable RAM in bytes");
+    heap_largest_block = metrics_gauge("heap_largest_free_block_bytes", NULL,
+                                       "Largest free block of internal RAM in bytes");
+    heap_fragmentation = metrics_gauge("heap_fragmentation_percent", NULL,
+                                       "Share of free internal RAM outside the largest block");
+
+    uint32_t last_total = 0;
+    int64_t last_us = esp_timer_get_time();
+    int samples = 0;
+    TickType_t last_wake = xTaskGetTickCount();
+
+    // The first pass only records the run-time baselines
+    profiler_sample_t sample = {0};
+    _profiler_sample(&sample, &last_total);
+
+    while (1)
+    {
+        vTaskDelayUntil(&last_wake, pdMS_TO_TICKS(PROFILER_INTERVAL_MS));
+
+        memset(&sample, 0, sizeof(sample));
+        sample.time_us = esp_timer_get_time();
+        sample.period_us = (uint32_t)(sample.time_us - last_us);
+        last_us = sample.time_us;
+        _profiler_sample(&sample, &last_total);
+
+        portENTER_CRITICAL(&history_lock);
+        history[history_next] = sample;
+        history_next = (history_next + 1) % PROFILER_HISTORY;
+        if (history_len < PROFILER_HISTORY)
+            history_len++;
+        portEXIT_CRITICAL(&history_lock);
+
+        if (PROFILER_LOG_EVERY > 0 && ++samples % PROFILER_LOG_EVERY == 0)
+            profiler_log_report();
+    }
+}
+
+int
+profiler_get_history(profiler_sample_t* out, int max)
+{
+    portENTER_CRITICAL(&history_lock);
+    int count = history_len < max ? history_len : max;
+    for (int i = 0; i < count; i++)
+    {
+        out[i] = history[(history_next - 1 - i + PROFILER_HISTORY) % PROFILER_HISTORY];
+    }
+    portEXIT_CRITICAL(&history_lock);
+    return count;
+}
+
+const char*
+profiler_task_name(int slot)
+{
+    return slots[slot].name;
+}
+
+void
+profiler_log_report(void)
+{
+    profiler_sample_t sample;
+    if (profiler_get_history(&sample, 1) == 0)
+        return;
+
+    ESP_LOGI(TAG, "Heap: %u free (min %u), DMA %u, largest block %u, %u%% fragmented",
+             (unsigned)sample.heap_internal_free, (unsigned)sample.heap_min_free,
+             (unsigned)sample.heap_dma_free, (unsigned)sample.heap_largest_block,
+             sample.fragmentation_pct);
+    for (int i = 0; i < sample.task_count; i++)
+    {
+        const profiler_task_sample_t* task = &sample.tasks[i];
+        if (task->cpu_permille == 0 && task->stack_free == 0)
+            continue;
+        ESP_LOGI(TAG, "%-16s %3u.%u%% cpu %6u B stack free", slots[i].name,
+                 task->cpu_permille / 10, task->cpu_permille % 10, task->stack_free);
+    }
+}
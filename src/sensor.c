@@ -0,0 +1,96 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "events.h"
+#include "firebase_queue.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "sensor.h"
+
+static const char* TAG = "sensor";
+
+static sensor_sched_t sched;
+static bool sched_ready = false;
+
+static int64_t
+_now_ms(void)
+{
+    return esp_timer_get_time() / 1000;
+}
+
+static void
+_sensor_publish(const sensor_t* sensor, int index, const sensor_value_t* value, void* user_ctx)
+{
+    (void)user_ctx;
+    char path[FIREBASE_QUEUE_PATH_MAX];
+    event_t event = {
+        .type = EVENT_SENSOR_VALUE,
+        .sensor = {.sensor = (uint8_t)(sensor - sched.sensors), .index = (uint8_t)index,
+                   .value = value->value},
+    };
+
+    events_publish(EVENTS_CH_SENSOR, &event);
+
+    ESP_LOGI(TAG, "%s/%s = %.2f", sensor->path, value->name, value->value);
+    snprintf(path, sizeof(path), "%s/%s", sensor->path, value->name);
+    if (firebase_queue_put(path, value->value) != ESP_OK)
+        ESP_LOGW(TAG, "Failed to queue %s", path);
+}
+
+static void
+_sensor_flush(void* user_ctx)
+{
+    (void)user_ctx;
+    firebase_queue_flush();
+}
+
+esp_err_t
+sensor_register(const sensor_driver_t* driver, void* ctx, const char* path, uint32_t interval_ms,
+                const sensor_report_cfg_t* report)
+{
+    if (!sched_ready)
+    {
+        sensor_sched_init(&sched, _now_ms(), _sensor_publish, _sensor_flush, NULL);
+        sched_ready = true;
+    }
+
+    if (sensor_sched_add(&sched, driver, ctx, path, interval_ms, report, _now_ms()) < 0)
+    {
+        ESP_LOGE(TAG, "Failed to register %s sensor at '%s'", driver->name, path);
+        return ESP_FAIL;
+    }
+    return ESP_OK;
+}
+
+void
+sensor_get_stats(sensor_stats_t* out)
+{
+    memset(out, 0, sizeof(*out));
+    for (int i = 0; i < sched.count; i++)
+    {
+        out->reads += sched.sensors[i].reads;
+        out->failures += sched.sensors[i].failures;
+        out->sent += sched.sensors[i].sent;
+        out->suppressed += sched.sensors[i].suppressed;
+    }
+}
+
+void
+sensor_task(void* pvParameters)
+{
+    while (true)
+    {
+        int64_t next_due = sensor_sched_run(&sched, _now_ms());
+        if (next_due == INT64_MAX)
+        {
+            ESP_LOGW(TAG, "No sensors registered");
+            vTaskDelete(NULL);
+        }
+
+        int64_t wait_ms = next_due - _now_ms();
+        TickType_t ticks = (wait_ms > 0) ? pdMS_TO_TICKS(wait_ms) : 0;
+        vTaskDelay(ticks > 0 ? ticks : 1);
+    }
+}
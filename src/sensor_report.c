@@ -0,0 +1,86 @@
+#include <math.h>
+#include <string.h>
+
+#include "sensor_report.h"
+
+void
+sensor_channel_reset(sensor_channel_t* channel)
+{
+    memset(channel, 0, sizeof(*channel));
+}
+
+static float
+_filter_mean(const float* window, int len)
+{
+    float sum = 0;
+    for (int i = 0; i < len; i++)
+        sum += window[i];
+    return sum / len;
+}
+
+static float
+_filter_median(const float* window, int len)
+{
+    float sorted[SENSOR_FILTER_MAX_LEN];
+    memcpy(sorted, window, len * sizeof(float));
+
+    for (int i = 1; i < len; i++)
+    {
+        float v = sorted[i];
+        int j = i - 1;
+        for (; j >= 0 && sorted[j] > v; j--)
+            sorted[j + 1] = sorted[j];
+        sorted[j + 1] = v;
+    }
+
+    if (len % 2 == 1)
+        return sorted[len / 2];
+    return (sorted[len / 2 - 1] + sorted[len / 2]) / 2;
+}
+
+bool
+sensor_channel_update(sensor_channel_t* channel, const sensor_report_cfg_t* cfg, int index,
+                      float sample, int64_t now_ms, float* out)
+{
+    int len = cfg->filter_len;
+    if (len < 1)
+        len = 1;
+    if (len > SENSOR_FILTER_MAX_LEN)
+        len = SENSOR_FILTER_MAX_LEN;
+
+    // Until the window is full the filter runs over the samples seen so far
+    channel->window[channel->next] = sample;
+    channel->next = (channel->next + 1) % len;
+    if (channel->filled < len)
+        channel->filled++;
+
+    float value = sample;
+    if (cfg->filter == SENSOR_FILTER_MEAN)
+        value = _filter_mean(channel->window, channel->filled);
+    else if (cfg->filter == SENSOR_FILTER_MEDIAN)
+        value = _filter_median(channel->window, channel->filled);
+
+    bool report = !channel->reported;
+    if (!report)
+    {
+        float change = fabsf(value - channel->last_value);
+        float deadband = (index >= 0 && index < SENSOR_REPORT_MAX_CHANNELS) ? cfg->deadband[index]
+                                                                           : 0;
+        report = change > 0 && change >= deadband;
+    }
+    if (!report && cfg->heartbeat_ms > 0)
+        report = now_ms - channel->last_report_ms >= cfg->heartbeat_ms;
+
+    if (!report)
+    {
+        channel->suppressed++;
+        return false;
+    }
+
+    channel->reported = true;
+    channel->last_value = value;
+    channel->last_report_ms = now_ms;
+    channel->sent++;
+    *out = value;
+    return true;
+}
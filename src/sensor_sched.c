@@ -0,0 +1,176 @@
+#include <string.h>
+
+#include "sensor_sched.h"
+
+static int64_t
+_due(const sensor_sched_t* sched, int heap_index)
+{
+    return sched->sensors[sched->heap[heap_index]].next_due_ms;
+}
+
+static void
+_swap(sensor_sched_t* sched, int a, int b)
+{
+    int tmp = sched->heap[a];
+    sched->heap[a] = sched->heap[b];
+    sched->heap[b] = tmp;
+}
+
+static void
+_sift_up(sensor_sched_t* sched, int i)
+{
+    while (i > 0)
+    {
+        int parent = (i - 1) / 2;
+        if (_due(sched, parent) <= _due(sched, i))
+            break;
+        _swap(sched, parent, i);
+        i = parent;
+    }
+}
+
+static void
+_sift_down(sensor_sched_t* sched, int len, int i)
+{
+    while (true)
+    {
+        int smallest = i;
+        int left = 2 * i + 1;
+        int right = left + 1;
+        if (left < len && _due(sched, left) < _due(sched, smallest))
+            smallest = left;
+        if (right < len && _due(sched, right) < _due(sched, smallest))
+            smallest = right;
+        if (smallest == i)
+            return;
+        _swap(sched, smallest, i);
+        i = smallest;
+    }
+}
+
+void
+sensor_sched_init(sensor_sched_t* sched, int64_t epoch_ms, sensor_publish_cb_t publish,
+                  sensor_flush_cb_t flush, void* user_ctx)
+{
+    memset(sched, 0, sizeof(*sched));
+    sched->epoch_ms = epoch_ms;
+    sched->publish = publish;
+    sched->flush = flush;
+    sched->user_ctx = user_ctx;
+}
+
+// First point of the sensor's grid (epoch + k * interval) that is not in the past
+static int64_t
+_next_slot(int64_t from_ms, uint32_t interval_ms, int64_t now_ms)
+{
+    if (from_ms >= now_ms)
+        return from_ms;
+    int64_t missed = (now_ms - from_ms + interval_ms - 1) / interval_ms;
+    return from_ms + missed * interval_ms;
+}
+
+int
+sensor_sched_add(sensor_sched_t* sched, const sensor_driver_t* driver, void* ctx,
+                 const char* path, uint32_t interval_ms, const sensor_report_cfg_t* report,
+                 int64_t now_ms)
+{
+    if (sched->count >= SENSOR_MAX || interval_ms == 0)
+        return -1;
+    if (driver->init != NULL && driver->init(ctx) < 0)
+        return -1;
+
+    int index = sched->count++;
+    sensor_t* sensor = &sched->sensors[index];
+    memset(sensor, 0, sizeof(*sensor));
+    sensor->driver = driver;
+    sensor->ctx = ctx;
+    sensor->path = path;
+    sensor->interval_ms = interval_ms;
+    if (report != NULL)
+    {
+        sensor->report = *report;
+        sensor->has_report = true;
+    }
+    // A sensor added shortly after the epoch still joins the first pass
+    sensor->next_due_ms =
+        _next_slot(sched->epoch_ms, interval_ms, now_ms - SENSOR_ALIGN_WINDOW_MS);
+
+    sched->heap[index] = index;
+    _sift_up(sched, index);
+    return index;
+}
+
+static bool
+_sample(sensor_sched_t* sched, sensor_t* sensor)
+{
+    sensor_value_t values[SENSOR_MAX_VALUES];
+
+    if (sensor->driver->read(sensor->ctx) < 0)
+    {
+        sensor->failures++;
+        return false;
+    }
+
+    int count = sensor->driver->decode(sensor->ctx, values, SENSOR_MAX_VALUES);
+    if (count < 0)
+    {
+        sensor->failures++;
+        return false;
+    }
+
+    sensor->reads++;
+    bool published = false;
+    for (int i = 0; i < count && i < SENSOR_MAX_VALUES; i++)
+    {
+        // Samples are stamped with their slot time so heartbeats stay on the schedule grid
+        if (sensor->has_report
+            && !sensor_channel_update(&sensor->channels[i], &sensor->report, i, values[i].value,
+                                      sensor->next_due_ms, &values[i].value))
+        {
+            sensor->suppressed++;
+            continue;
+        }
+
+        sched->publish(sensor, i, &values[i], sched->user_ctx);
+        sensor->sent++;
+        published = true;
+    }
+    return published;
+}
+
+int64_t
+sensor_sched_run(sensor_sched_t* sched, int64_t now_ms)
+{
+    if (sched->count == 0)
+        return INT64_MAX;
+
+    // Pop everything due within the window to the end of the heap array, then sample it
+    int len = sched->count;
+    while (len > 0 && _due(sched, 0) <= now_ms + SENSOR_ALIGN_WINDOW_MS)
+    {
+        len--;
+        _swap(sched, 0, len);
+        _sift_down(sched, len, 0);
+    }
+
+    bool published = false;
+    for (int i = len; i < sched->count; i++)
+    {
+        sensor_t* sensor = &sched->sensors[sched->heap[i]];
+        if (_sample(sched, sensor))
+            published = true;
+    }
+    if (published && sched->flush != NULL)
+        sched->flush(sched->user_ctx);
+
+    // Slots missed during a long pass are skipped rather than run back to back
+    for (int i = len; i < sched->count; i++)
+    {
+        sensor_t* sensor = &sched->sensors[sched->heap[i]];
+        sensor->next_due_ms = _next_slot(sensor->next_due_ms + sensor->interval_ms,
+                                         sensor->interval_ms, now_ms);
+        _sift_up(sched, i);
+    }
+
+    return _due(sched, 0);
+}
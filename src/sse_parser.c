@@ -0,0 +1,215 @@
+#include <string.h>
+
+#include "sse_parser.h"
+
+static void
+_sse_clear_event(sse_parser_t* parser)
+{
+    parser->has_data = false;
+    parser->data_start = 0;
+    parser->data_len = 0;
+    parser->discarding = false;
+    parser->event[0] = '\0';
+}
+
+void
+sse_parser_init(sse_parser_t* parser, char* buf, size_t cap, sse_event_cb_t cb, void* user_ctx)
+{
+    memset(parser, 0, sizeof(*parser));
+    parser->buf = buf;
+    parser->cap = cap;
+    parser->cb = cb;
+    parser->user_ctx = user_ctx;
+}
+
+void
+sse_parser_reset(sse_parser_t* parser)
+{
+    parser->len = 0;
+    parser->line_start = 0;
+    parser->scan_pos = 0;
+    parser->skip_line = false;
+    _sse_clear_event(parser);
+}
+
+static int
+_sse_dispatch(sse_parser_t* parser)
+{
+    static char empty_data[1];
+    sse_event_t event = {
+        .event = (parser->event[0] != '\0') ? parser->event : "message",
+        .data = empty_data,
+        .data_len = 0,
+        .truncated = parser->discarding,
+    };
+
+    if (parser->discarding)
+    {
+        parser->overflows++;
+    }
+    else if (parser->has_data)
+    {
+        // The byte after the data is its old line terminator, which is no longer needed
+        parser->buf[parser->data_start + parser->data_len] = '\0';
+        event.data = parser->buf + parser->data_start;
+        event.data_len = parser->data_len;
+    }
+    else
+    {
+        // Per the SSE spec an event without data is not dispatched
+        _sse_clear_event(parser);
+        return 0;
+    }
+
+    parser->events++;
+    if (parser->cb != NULL)
+    {
+        parser->cb(&event, parser->user_ctx);
+    }
+
+    _sse_clear_event(parser);
+    return 1;
+}
+
+// Handles one complete line located at buf[start, start + len)
+static int
+_sse_process_line(sse_parser_t* parser, size_t start, size_t len)
+{
+    char* line = parser->buf + start;
+
+    if (len == 0)
+        return _sse_dispatch(parser);
+
+    if (parser->discarding || line[0] == ':')
+        return 0;
+
+    const char* colon = memchr(line, ':', len);
+    size_t field_len = (colon != NULL) ? (size_t)(colon - line) : len;
+    size_t value_off = (colon != NULL) ? field_len + 1 : len;
+    if (value_off < len && line[value_off] == ' ')
+        value_off++;
+    size_t value_len = len - value_off;
+
+    if (field_len == 5 && memcmp(line, "event", 5) == 0)
+    {
+        if (value_len >= SSE_EVENT_NAME_MAX)
+            value_len = SSE_EVENT_NAME_MAX - 1;
+        memcpy(parser->event, line + value_off, value_len);
+        parser->event[value_len] = '\0';
+    }
+    else if (field_len == 4 && memcmp(line, "data", 4) == 0)
+    {
+        if (!parser->has_data)
+        {
+            parser->has_data = true;
+            parser->data_start = start + value_off;
+            parser->data_len = value_len;
+        }
+        else
+        {
+            // Slide this line's value down so all data stays contiguous
+            char* end = parser->buf + parser->data_start + parser->data_len;
+            *end = '\n';
+            memmove(end + 1, line + value_off, value_len);
+            parser->data_len += value_len + 1;
+        }
+    }
+    // "id", "retry" and unknown fields are ignored
+
+    return 0;
+}
+
+char*
+sse_parser_write_ptr(sse_parser_t* parser, size_t* avail)
+{
+    if (parser->len > parser->cap / 2)
+    {
+        size_t keep_from = parser->has_data ? parser->data_start : parser->line_start;
+        if (keep_from > 0)
+        {
+            memmove(parser->buf, parser->buf + keep_from, parser->len - keep_from);
+            parser->len -= keep_from;
+            parser->line_start -= keep_from;
+            parser->scan_pos -= keep_from;
+            if (parser->has_data)
+                parser->data_start -= keep_from;
+        }
+    }
+
+    if (parser->len == parser->cap)
+    {
+        // The pending event fills the buffer: drop it and skip to the end of the event
+        parser->has_data = false;
+        parser->data_len = 0;
+        parser->discarding = true;
+        parser->skip_line = (parser->line_start < parser->len);
+        parser->len = 0;
+        parser->line_start = 0;
+        parser->scan_pos = 0;
+    }
+
+    *avail = parser->cap - parser->len;
+    return parser->buf + parser->len;
+}
+
+int
+sse_parser_commit(sse_parser_t* parser, size_t len)
+{
+    int dispatched = 0;
+
+    parser->len += len;
+    parser->bytes += len;
+
+    while (parser->scan_pos < parser->len)
+    {
+        char* nl = memchr(parser->buf + parser->scan_pos, '\n', parser->len - parser->scan_pos);
+        if (nl == NULL)
+        {
+            parser->scan_pos = parser->len;
+            break;
+        }
+
+        size_t nl_pos = (size_t)(nl - parser->buf);
+        size_t line_len = nl_pos - parser->line_start;
+        if (line_len > 0 && parser->buf[nl_pos - 1] == '\r')
+            line_len--;
+
+        if (parser->skip_line)
+            parser->skip_line = false;
+        else
+            dispatched += _sse_process_line(parser, parser->line_start, line_len);
+
+        parser->line_start = nl_pos + 1;
+        parser->scan_pos = nl_pos + 1;
+    }
+
+    // Nothing retained: start over at the beginning of the buffer without copying
+    if (!parser->has_data && parser->line_start == parser->len)
+    {
+        parser->len = 0;
+        parser->line_start = 0;
+        parser->scan_pos = 0;
+    }
+
+    return dispatched;
+}
+
+int
+sse_parser_feed(sse_parser_t* parser, const char* data, size_t len)
+{
+    int dispatched = 0;
+
+    while (len > 0)
+    {
+        size_t avail;
+        char* dst = sse_parser_write_ptr(parser, &avail);
+        size_t chunk = (len < avail) ? len : avail;
+
+        memcpy(dst, data, chunk);
+        dispatched += sse_parser_commit(parser, chunk);
+        data += chunk;
+        len -= chunk;
+    }
+
+    return dispatched;
+}
@@ -0,0 +1,192 @@
+#include "esp_attr.h"
+#include "esp_cpu.h"
+#include "esp_log.h"
+#include "esp_rom_sys.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <stdatomic.h>
+#include <string.h>
+
+#include "trace.h"
+#include "web_server.h"
+
+#if TRACE_ENABLE && portNUM_PROCESSORS > 1
+#include "esp_ipc.h"
+#endif
+
+#define TRACE_VERSION 1
+
+_Static_assert((TRACE_RING_LEN & (TRACE_RING_LEN - 1)) == 0, "TRACE_RING_LEN must be 2^n");
+_Static_assert(sizeof(trace_record_t) == 16, "trace_record_t is part of the dump format");
+
+static const char* const event_names[TRACE_EVENT_COUNT] = {
+    [TRACE_STREAM_READ] = "stream_read",   [TRACE_SSE_PARSE] = "sse_parse",
+    [TRACE_STREAM_DISPATCH] = "dispatch",  [TRACE_RELAY_SET] = "set_relay_state",
+    [TRACE_RELAY_APPLY] = "relay_apply",   [TRACE_GPIO_WRITE] = "gpio_write",
+    [TRACE_BUTTON_EDGE] = "button_edge",   [TRACE_HTTP_REQUEST] = "http_request",
+};
+
+typedef struct
+{
+    uint32_t cycles;
+    int64_t time_us;
+} trace_anchor_t;
+
+#if TRACE_ENABLE
+#define TRACE_CORES portNUM_PROCESSORS
+
+static const char* TAG = "trace";
+
+typedef struct
+{
+    atomic_uint head;
+    trace_record_t records[TRACE_RING_LEN];
+} trace_ring_t;
+
+static trace_ring_t rings[TRACE_CORES];
+static atomic_bool paused;
+#else
+#define TRACE_CORES 0
+#endif
+
+void IRAM_ATTR
+trace_record(uint16_t event, uint8_t phase, uint32_t arg)
+{
+#if TRACE_ENABLE
+    if (atomic_load_explicit(&paused, memory_order_relaxed))
+        return;
+
+    // A task that migrates after reading the core number still gets a slot of its own
+    trace_ring_t* ring = &rings[esp_cpu_get_core_id()];
+    unsigned slot = atomic_fetch_add_explicit(&ring->head, 1, memory_order_relaxed);
+    trace_record_t* rec = &ring->records[slot & (TRACE_RING_LEN - 1)];
+
+    rec->cycles = esp_cpu_get_cycle_count();
+    rec->arg = arg;
+    rec->event = event;
+    rec->phase = phase;
+    rec->task = (uint32_t)(uintptr_t)xTaskGetCurrentTaskHandle();
+#endif
+}
+
+#if TRACE_ENABLE
+// Cycle counters are per core and not synchronized, so each core is anchored on itself
+static void
+_trace_anchor(void* arg)
+{
+    trace_anchor_t* anchor = &((trace_anchor_t*)arg)[esp_cpu_get_core_id()];
+    anchor->time_us = esp_timer_get_time();
+    anchor->cycles = esp_cpu_get_cycle_count();
+}
+
+static bool
+_trace_dump_ring(trace_write_cb_t write, void* ctx, const trace_ring_t* ring,
+                 const trace_anchor_t* anchor)
+{
+    unsigned head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    uint32_t count = head < TRACE_RING_LEN ? head : TRACE_RING_LEN;
+    unsigned first = (head - count) & (TRACE_RING_LEN - 1);
+
+    if (!write(ctx, &anchor->cycles, sizeof(anchor->cycles))
+        || !write(ctx, &anchor->time_us, sizeof(anchor->time_us))
+        || !write(ctx, &count, sizeof(count)))
+        return false;
+
+    // Oldest first: from the slot after the newest to the end, then from the start
+    uint32_t tail = TRACE_RING_LEN - first < count ? TRACE_RING_LEN - first : count;
+    if (!write(ctx, &ring->records[first], tail * sizeof(trace_record_t)))
+        return false;
+    return write(ctx, ring->records, (count - tail) * sizeof(trace_record_t));
+}
+#endif
+
+bool
+trace_dump(trace_write_cb_t write, void* ctx)
+{
+    struct __attribute__((packed))
+    {
+        char magic[4];
+        uint16_t version;
+        uint16_t record_size;
+        uint32_t ticks_per_us;
+        uint16_t cores;
+        uint16_t events;
+    } header = {
+        .magic = {'T', 'R', 'C', '1'},
+        .version = TRACE_VERSION,
+        .record_size = sizeof(trace_record_t),
+        .ticks_per_us = esp_rom_get_cpu_ticks_per_us(),
+        .cores = TRACE_CORES,
+        .events = TRACE_EVENT_COUNT,
+    };
+
+    if (!write(ctx, &header, sizeof(header)))
+        return false;
+    for (int i = 0; i < TRACE_EVENT_COUNT; i++)
+    {
+        uint8_t len = (uint8_t)strlen(event_names[i]);
+        if (!write(ctx, &len, 1) || !write(ctx, event_names[i], len))
+            return false;
+    }
+
+#if TRACE_ENABLE
+    // Let writers that were mid-record finish before their slots are read
+    atomic_store_explicit(&paused, true, memory_order_relaxed);
+    vTaskDelay(1);
+
+    trace_anchor_t anchors[TRACE_CORES];
+#if TRACE_CORES > 1
+    for (int core = 0; core < TRACE_CORES; core++)
+    {
+        esp_ipc_call_blocking(core, _trace_anchor, anchors);
+    }
+#else
+    _trace_anchor(anchors);
+#endif
+
+    bool ok = true;
+    for (int core = 0; core < TRACE_CORES && ok; core++)
+    {
+        ok = _trace_dump_ring(write, ctx, &rings[core], &anchors[core]);
+    }
+
+    atomic_store_explicit(&paused, false, memory_order_relaxed);
+    return ok;
+#else
+    return true;
+#endif
+}
+
+#if TRACE_ENABLE
+static bool
+_trace_send_chunk(void* ctx, const void* data, size_t len)
+{
+    if (len == 0)
+        return true;
+    return httpd_resp_send_chunk((httpd_req_t*)ctx, data, (ssize_t)len) == ESP_OK;
+}
+
+static esp_err_t
+_trace_get_handler(httpd_req_t* req)
+{
+    httpd_resp_set_type(req, "application/octet-stream");
+    httpd_resp_set_hdr(req, "Content-Disposition", "attachment; filename=\"trace.bin\"");
+
+    if (!trace_dump(_trace_send_chunk, req))
+    {
+        ESP_LOGW(TAG, "Trace download aborted by the client");
+        return ESP_FAIL;
+    }
+    return httpd_resp_send_chunk(req, NULL, 0);
+}
+#endif
+
+void
+trace_init(void)
+{
+#if TRACE_ENABLE
+    web_server_register("/trace.bin", HTTP_GET, _trace_get_handler, NULL);
+    ESP_LOGI(TAG, "Tracing %d records per core", TRACE_RING_LEN);
+#endif
+}
@@ -0,0 +1,96 @@
+#include "esp_log.h"
+#include <stdbool.h>
+#include <string.h>
+
+#include "web_server.h"
+
+static const char* TAG = "web_server";
+
+static httpd_handle_t server;
+static httpd_uri_t handlers[WEB_SERVER_MAX_HANDLERS];
+static int handler_count;
+
+esp_err_t
+web_server_start(void)
+{
+    if (server != NULL)
+        return ESP_OK;
+
+    httpd_config_t config = HTTPD_DEFAULT_CONFIG();
+    config.max_req_hdr_len = 2048;
+    config.max_uri_handlers = WEB_SERVER_MAX_HANDLERS;
+    config.uri_match_fn = httpd_uri_match_wildcard;
+
+    esp_err_t err = httpd_start(&server, &config);
+    if (err != ESP_OK)
+    {
+        ESP_LOGE(TAG, "Server start failed: %s", esp_err_to_name(err));
+        server = NULL;
+        return err;
+    }
+
+    for (int i = 0; i < handler_count; i++)
+    {
+        httpd_register_uri_handler(server, &handlers[i]);
+    }
+    ESP_LOGI(TAG, "Server started with %d handlers", handler_count);
+    return ESP_OK;
+}
+
+esp_err_t
+web_server_register(const char* uri, httpd_method_t method,
+                    esp_err_t (*handler)(httpd_req_t* req), void* ctx)
+{
+    if (handler_count >= WEB_SERVER_MAX_HANDLERS)
+    {
+        ESP_LOGE(TAG, "No room for %s", uri);
+        return ESP_ERR_NO_MEM;
+    }
+
+    httpd_uri_t* entry = &handlers[handler_count++];
+    *entry = (httpd_uri_t){.uri = uri, .method = method, .handler = handler, .user_ctx = ctx};
+
+    if (server == NULL)
+        return ESP_OK;
+    return httpd_register_uri_handler(server, entry);
+}
+
+// Tells whether a request header contains a token; a value too long for the buffer is
+// checked as far as it was read
+static bool
+_header_has(httpd_req_t* req, const char* field, const char* token)
+{
+    char value[128];
+    esp_err_t err = httpd_req_get_hdr_value_str(req, field, value, sizeof(value));
+    if (err != ESP_OK && err != ESP_ERR_HTTPD_RESULT_TRUNC)
+        return false;
+    return strstr(value, token) != NULL;
+}
+
+esp_err_t
+web_server_send_asset(httpd_req_t* req, const web_asset_t* asset)
+{
+    httpd_resp_set_type(req, asset->content_type);
+
+    if (asset->etag != NULL)
+    {
+        httpd_resp_set_hdr(req, "ETag", asset->etag);
+        httpd_resp_set_hdr(req, "Cache-Control", "no-cache");
+        if (_header_has(req, "If-None-Match", asset->etag))
+        {
+            httpd_resp_set_status(req, "304 Not Modified");
+            return httpd_resp_send(req, NULL, 0);
+        }
+    }
+
+    if (asset->gzip != NULL)
+    {
+        httpd_resp_set_hdr(req, "Vary", "Accept-Encoding");
+        if (_header_has(req, "Accept-Encoding", "gzip"))
+        {
+            httpd_resp_set_hdr(req, "Content-Encoding", "gzip");
+            return httpd_resp_send(req, (const char*)asset->gzip, (ssize_t)asset->gzip_len);
+        }
+    }
+    return httpd_resp_send(req, (const char*)asset->plain, (ssize_t)asset->plain_len);
+}
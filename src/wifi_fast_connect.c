@@ -0,0 +1,164 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "metrics.h"
+#include "nvs.h"
+#include "wifi_fast_connect.h"
+
+#ifndef WIFI_STATIC_NETMASK
+#define WIFI_STATIC_NETMASK "255.255.255.0"
+#endif
+#if defined(WIFI_STATIC_IP) && !defined(WIFI_STATIC_DNS)
+#define WIFI_STATIC_DNS WIFI_STATIC_GW
+#endif
+
+#define RECORD_KEY "ap"
+static const char* TAG = "wifi_fast";
+
+// The access point of the last connection that got an address
+typedef struct
+{
+    char ssid[33];
+    uint8_t bssid[6];
+    uint8_t channel;
+} fast_record_t;
+
+static fast_record_t cached;
+static bool cached_valid = false;
+static fast_record_t current;
+static bool hints_applied = false;
+static bool online_once = false;
+
+static metric_t* misses;
+
+static void
+_save_record(void)
+{
+    nvs_handle_t handle;
+    esp_err_t err = nvs_open(WIFI_FAST_CONNECT_NVS_NAMESPACE, NVS_READWRITE, &handle);
+    if (err == ESP_OK)
+    {
+        err = nvs_set_blob(handle, RECORD_KEY, &cached, sizeof(cached));
+        if (err == ESP_OK)
+            err = nvs_commit(handle);
+        nvs_close(handle);
+    }
+    if (err != ESP_OK)
+        ESP_LOGW(TAG, "Failed to save the access point: %s", esp_err_to_name(err));
+}
+
+static void
+_load_record(void)
+{
+    nvs_handle_t handle;
+    if (nvs_open(WIFI_FAST_CONNECT_NVS_NAMESPACE, NVS_READONLY, &handle) != ESP_OK)
+        return;
+
+    size_t len = sizeof(cached);
+    cached_valid = nvs_get_blob(handle, RECORD_KEY, &cached, &len) == ESP_OK
+                   && len == sizeof(cached) && cached.channel != 0;
+    cached.ssid[sizeof(cached.ssid) - 1] = '\0';
+    nvs_close(handle);
+}
+
+#ifdef WIFI_STATIC_IP
+static void
+_use_static_ip(esp_netif_t* sta_netif)
+{
+    esp_netif_ip_info_t ip_info = {0};
+    esp_netif_dns_info_t dns = {.ip.type = ESP_IPADDR_TYPE_V4};
+    if (esp_netif_str_to_ip4(WIFI_STATIC_IP, &ip_info.ip) != ESP_OK
+        || esp_netif_str_to_ip4(WIFI_STATIC_GW, &ip_info.gw) != ESP_OK
+        || esp_netif_str_to_ip4(WIFI_STATIC_NETMASK, &ip_info.netmask) != ESP_OK
+        || esp_netif_str_to_ip4(WIFI_STATIC_DNS, &dns.ip.u_addr.ip4) != ESP_OK)
+    {
+        ESP_LOGE(TAG, "Invalid static address, using DHCP");
+        return;
+    }
+
+    esp_netif_dhcpc_stop(sta_netif);
+    ESP_ERROR_CHECK(esp_netif_set_ip_info(sta_netif, &ip_info));
+    esp_netif_set_dns_info(sta_netif, ESP_NETIF_DNS_MAIN, &dns);
+    ESP_LOGI(TAG, "Static address " IPSTR, IP2STR(&ip_info.ip));
+}
+#endif
+
+void
+wifi_fast_connect_init(esp_netif_t* sta_netif)
+{
+    misses = metrics_counter("wifi_fast_connect_misses", NULL,
+                             "Directed connects to the cached access point that failed");
+    _load_record();
+#ifdef WIFI_STATIC_IP
+    _use_static_ip(sta_netif);
+#else
+    (void)sta_netif;
+#endif
+}
+
+bool
+wifi_fast_connect_apply(wifi_config_t* config)
+{
+    if (!cached_valid || strncmp(cached.ssid, (const char*)config->sta.ssid,
+                                 sizeof(config->sta.ssid)) != 0)
+        return false;
+
+    config->sta.bssid_set = true;
+    memcpy(config->sta.bssid, cached.bssid, sizeof(cached.bssid));
+    config->sta.channel = cached.channel;
+    hints_applied = true;
+    ESP_LOGI(TAG, "Connecting to %02x:%02x:%02x:%02x:%02x:%02x on channel %d", cached.bssid[0],
+             cached.bssid[1], cached.bssid[2], cached.bssid[3], cached.bssid[4],
+             cached.bssid[5], cached.channel);
+    return true;
+}
+
+void
+wifi_fast_connect_clear(wifi_config_t* config)
+{
+    if (hints_applied)
+        metrics_inc(misses);
+    config->sta.bssid_set = false;
+    memset(config->sta.bssid, 0, sizeof(config->sta.bssid));
+    config->sta.channel = 0;
+    hints_applied = false;
+}
+
+void
+wifi_fast_connect_on_connected(const wifi_event_sta_connected_t* event)
+{
+    size_t ssid_len = event->ssid_len;
+    if (ssid_len > sizeof(event->ssid))
+        ssid_len = sizeof(event->ssid);
+    memset(&current, 0, sizeof(current));
+    memcpy(current.ssid, event->ssid, ssid_len);
+    memcpy(current.bssid, event->bssid, sizeof(current.bssid));
+    current.channel = event->channel;
+}
+
+void
+wifi_fast_connect_on_got_ip(void)
+{
+    if (!online_once)
+    {
+        // esp_timer counts from boot
+        int64_t boot_to_ip_ms = esp_timer_get_time() / 1000;
+        const char* path = hints_applied ? "cached" : "scan";
+        static char labels[24];
+        snprintf(labels, sizeof(labels), "path=\"%s\"", path);
+        metric_t* gauge = metrics_gauge("wifi_boot_to_ip_ms", labels,
+                                        "Time from boot to the first station address in ms");
+        metrics_set(gauge, (int32_t)boot_to_ip_ms);
+        ESP_LOGI(TAG, "Online %lld ms after boot (%s)", (long long)boot_to_ip_ms, path);
+        online_once = true;
+    }
+
+    // Flash is only written when the access point changes
+    if (current.channel == 0 || (cached_valid && memcmp(&cached, &current, sizeof(cached)) == 0))
+        return;
+    cached = current;
+    cached_valid = true;
+    _save_record();
+}
@@ -0,0 +1,589 @@
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_wifi.h"
+#include "firebase.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "web_server.h"
+#include "wifi_prov_api.h"
+
+static const char* TAG = "wifi_prov_api";
+
+// How often the task checks job timeouts and waiting requests without being woken
+#define WIFI_PROV_TICK_MS 250
+// Room for the raw (URL-encoded) request parameters
+#define WIFI_PROV_PARAMS_MAX 320
+
+typedef enum
+{
+    JOB_CONNECTING,
+    JOB_CONNECTED,
+    JOB_FAILED,
+} job_state_t;
+
+static const char* const job_state_names[] = {
+    [JOB_CONNECTING] = "connecting",
+    [JOB_CONNECTED] = "connected",
+    [JOB_FAILED] = "failed",
+};
+
+typedef struct
+{
+    uint32_t id; // 0 for an unused slot
+    job_state_t state;
+    const char* error;
+    char ssid[33];
+    int attempts;
+    esp_ip4_addr_t ip;
+    int64_t started_us;
+    int64_t finished_us;
+} prov_job_t;
+
+typedef struct
+{
+    char ssid[33];
+    int8_t rssi;
+    uint8_t channel;
+    bool secure;
+} prov_ap_t;
+
+typedef struct
+{
+    httpd_req_t* req; // Async copy of the request, NULL for a free slot
+    uint32_t job;     // Job waited for, 0 when waiting for a scan
+    int64_t deadline_us;
+} prov_waiter_t;
+
+static SemaphoreHandle_t prov_lock;
+static TaskHandle_t prov_task_handle;
+
+// The current job and the one it replaced, in slot id % 2
+static prov_job_t jobs[2];
+static uint32_t last_job_id;
+
+static prov_ap_t aps[WIFI_PROV_SCAN_MAX];
+static int ap_count;
+static int64_t scanned_us;
+static bool scanning;
+
+static prov_waiter_t waiters[WIFI_PROV_MAX_WAITERS];
+
+// Filled on the event task, whose stack is too small for the records
+static wifi_ap_record_t records[WIFI_PROV_SCAN_MAX];
+
+static prov_job_t*
+_job(uint32_t id)
+{
+    prov_job_t* job = &jobs[id % 2];
+    return (id != 0 && job->id == id) ? job : NULL;
+}
+
+static prov_job_t*
+_current_job(void)
+{
+    return _job(last_job_id);
+}
+
+static void
+_finish_job(prov_job_t* job, job_state_t state, const char* error)
+{
+    job->state = state;
+    job->error = error;
+    job->finished_us = esp_timer_get_time();
+}
+
+static void
+_wake_task(void)
+{
+    xTaskNotifyGive(prov_task_handle);
+}
+
+// Starts a background scan unless one runs; called with prov_lock held
+static void
+_scan_start(void)
+{
+    if (scanning)
+        return;
+    wifi_scan_config_t config = {.show_hidden = false};
+    esp_err_t err = esp_wifi_scan_start(&config, false);
+    scanning = err == ESP_OK;
+    if (err != ESP_OK)
+        ESP_LOGW(TAG, "Scan not started: %s", esp_err_to_name(err));
+}
+
+// Writes an SSID as a JSON string; SSIDs are arbitrary bytes, and the buffer holds 32 of
+// them even if every one needs a \u escape
+static void
+_json_ssid(char* out, size_t out_len, const char* ssid)
+{
+    if (firebase_json_quote(out, out_len, ssid) != ESP_OK)
+        snprintf(out, out_len, "\"\"");
+}
+
+static esp_err_t
+_send_json(httpd_req_t* req, const char* status, const char* json)
+{
+    httpd_resp_set_status(req, status);
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_set_hdr(req, "Cache-Control", "no-store");
+    return httpd_resp_send(req, json, HTTPD_RESP_USE_STRLEN);
+}
+
+static esp_err_t
+_send_scan(httpd_req_t* req)
+{
+    // Copied out so the lock is not held while sending
+    prov_ap_t list[WIFI_PROV_SCAN_MAX];
+    xSemaphoreTake(prov_lock, portMAX_DELAY);
+    int count = ap_count;
+    memcpy(list, aps, (size_t)count * sizeof(prov_ap_t));
+    bool busy = scanning;
+    int64_t age_ms = scanned_us != 0 ? (esp_timer_get_time() - scanned_us) / 1000 : -1;
+    xSemaphoreGive(prov_lock);
+
+    char chunk[256];
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_set_hdr(req, "Cache-Control", "no-store");
+    snprintf(chunk, sizeof(chunk), "{\"scanning\":%s,\"age_ms\":%lld,\"aps\":[",
+             busy ? "true" : "false", (long long)age_ms);
+    esp_err_t err = httpd_resp_send_chunk(req, chunk, HTTPD_RESP_USE_STRLEN);
+
+    for (int i = 0; i < count && err == ESP_OK; i++)
+    {
+        char ssid[200];
+        _json_ssid(ssid, sizeof(ssid), list[i].ssid);
+        snprintf(chunk, sizeof(chunk), "%s{\"ssid\":%s,\"rssi\":%d,\"channel\":%u,\"secure\":%s}",
+                 i > 0 ? "," : "", ssid, list[i].rssi, list[i].channel,
+                 list[i].secure ? "true" : "false");
+        err = httpd_resp_send_chunk(req, chunk, HTTPD_RESP_USE_STRLEN);
+    }
+
+    if (err == ESP_OK)
+        err = httpd_resp_send_chunk(req, "]}", 2);
+    if (err == ESP_OK)
+        err = httpd_resp_send_chunk(req, NULL, 0);
+    return err;
+}
+
+static esp_err_t
+_send_status(httpd_req_t* req, uint32_t id)
+{
+    char json[320];
+    char ssid[200];
+
+    xSemaphoreTake(prov_lock, portMAX_DELAY);
+    prov_job_t* job = _job(id);
+    if (job == NULL)
+    {
+        xSemaphoreGive(prov_lock);
+        return _send_json(req, "404 Not Found", "{\"error\":\"unknown job\"}");
+    }
+
+    int64_t end_us = job->state == JOB_CONNECTING ? esp_timer_get_time() : job->finished_us;
+    _json_ssid(ssid, sizeof(ssid), job->ssid);
+    int len = snprintf(json, sizeof(json),
+                       "{\"job\":%lu,\"state\":\"%s\",\"ssid\":%s,\"attempts\":%d,"
+                       "\"elapsed_ms\":%lld",
+                       (unsigned long)job->id, job_state_names[job->state], ssid, job->attempts,
+                       (long long)((end_us - job->started_us) / 1000));
+    if (job->state == JOB_CONNECTED)
+        snprintf(json + len, sizeof(json) - len, ",\"ip\":\"" IPSTR "\"}", IP2STR(&job->ip));
+    else if (job->state == JOB_FAILED)
+        snprintf(json + len, sizeof(json) - len, ",\"error\":\"%s\"}", job->error);
+    else
+        snprintf(json + len, sizeof(json) - len, "}");
+    xSemaphoreGive(prov_lock);
+
+    return _send_json(req, "200 OK", json);
+}
+
+// Tells whether a waiter can be answered; called with prov_lock held
+static bool
+_waiter_ready(uint32_t job_id)
+{
+    if (job_id == 0)
+        return !scanning;
+    prov_job_t* job = _job(job_id);
+    return job == NULL || job->state != JOB_CONNECTING;
+}
+
+// Hands the request to the task unless it can be answered now; returns whether it waits
+static bool
+_park(httpd_req_t* req, uint32_t job_id, int wait_ms)
+{
+    bool parked = false;
+
+    xSemaphoreTake(prov_lock, portMAX_DELAY);
+    for (int i = 0; i < WIFI_PROV_MAX_WAITERS && !parked && !_waiter_ready(job_id); i++)
+    {
+        if (waiters[i].req != NULL || httpd_req_async_handler_begin(req, &waiters[i].req) != ESP_OK)
+            continue;
+        waiters[i].job = job_id;
+        waiters[i].deadline_us = esp_timer_get_time() + (int64_t)wait_ms * 1000;
+        parked = true;
+    }
+    xSemaphoreGive(prov_lock);
+    return parked;
+}
+
+// Reads the seconds of ?wait=, capped at WIFI_PROV_WAIT_MAX_MS
+static int
+_wait_ms(const char* query)
+{
+    char value[8];
+    if (query == NULL || httpd_query_key_value(query, "wait", value, sizeof(value)) != ESP_OK)
+        return 0;
+    int wait_ms = atoi(value) * 1000;
+    if (wait_ms < 0)
+        return 0;
+    return wait_ms < WIFI_PROV_WAIT_MAX_MS ? wait_ms : WIFI_PROV_WAIT_MAX_MS;
+}
+
+static bool
+_get_query(httpd_req_t* req, char* buf, size_t buf_len)
+{
+    size_t len = httpd_req_get_url_query_len(req);
+    return len > 0 && len < buf_len && httpd_req_get_url_query_str(req, buf, buf_len) == ESP_OK;
+}
+
+static esp_err_t
+_scan_handler(httpd_req_t* req)
+{
+    char query[32];
+    bool has_query = _get_query(req, query, sizeof(query));
+
+    xSemaphoreTake(prov_lock, portMAX_DELAY);
+    if (scanned_us == 0 || esp_timer_get_time() - scanned_us > WIFI_PROV_SCAN_MAX_AGE_MS * 1000LL)
+        _scan_start();
+    xSemaphoreGive(prov_lock);
+
+    int wait_ms = _wait_ms(has_query ? query : NULL);
+    if (wait_ms > 0 && _park(req, 0, wait_ms))
+        return ESP_OK;
+    return _send_scan(req);
+}
+
+// Decodes %XX and '+' in place
+static void
+_url_decode(char* value)
+{
+    char* out = value;
+    for (const char* in = value; *in != '\0'; in++)
+    {
+        if (*in == '+')
+        {
+            *out++ = ' ';
+        }
+        else if (*in == '%' && in[1] != '\0' && in[2] != '\0')
+        {
+            char hex[3] = {in[1], in[2], '\0'};
+            *out++ = (char)strtol(hex, NULL, 16);
+            in += 2;
+        }
+        else
+        {
+            *out++ = *in;
+        }
+    }
+    *out = '\0';
+}
+
+// Reads a form parameter; returns false if it is missing (and required) or too long
+static bool
+_get_param(const char* params, const char* key, char* out, size_t out_len, bool required)
+{
+    char raw[WIFI_PROV_PARAMS_MAX];
+    esp_err_t err = httpd_query_key_value(params, key, raw, sizeof(raw));
+    if (err == ESP_ERR_NOT_FOUND && !required)
+    {
+        out[0] = '\0';
+        return true;
+    }
+    if (err != ESP_OK)
+        return false;
+    _url_decode(raw);
+    if (strlen(raw) >= out_len)
+        return false;
+    strcpy(out, raw);
+    return true;
+}
+
+static esp_err_t
+_connect_handler(httpd_req_t* req)
+{
+    char params[WIFI_PROV_PARAMS_MAX] = "";
+
+    // A form post carries the parameters in the body, a GET in the query string
+    if (req->method == HTTP_POST)
+    {
+        if (req->content_len >= sizeof(params))
+            return _send_json(req, "400 Bad Request", "{\"error\":\"body too large\"}");
+        size_t received = 0;
+        while (received < req->content_len)
+        {
+            int n = httpd_req_recv(req, params + received, req->content_len - received);
+            if (n <= 0)
+                return ESP_FAIL;
+            received += (size_t)n;
+        }
+        params[received] = '\0';
+    }
+    else
+    {
+        _get_query(req, params, sizeof(params));
+    }
+
+    char ssid[33];
+    char password[65];
+    if (!_get_param(params, "ssid", ssid, sizeof(ssid), true) || ssid[0] == '\0'
+        || !_get_param(params, "password", password, sizeof(password), false))
+    {
+        return _send_json(req, "400 Bad Request", "{\"error\":\"invalid ssid or password\"}");
+    }
+
+    xSemaphoreTake(prov_lock, portMAX_DELAY);
+    prov_job_t* previous = _current_job();
+    if (previous != NULL && previous->state == JOB_CONNECTING)
+        _finish_job(previous, JOB_FAILED, "superseded");
+    uint32_t id = ++last_job_id;
+    if (id == 0)
+        id = ++last_job_id;
+    prov_job_t* job = &jobs[id % 2];
+    *job = (prov_job_t){.id = id, .state = JOB_CONNECTING, .attempts = 1};
+    snprintf(job->ssid, sizeof(job->ssid), "%s", ssid);
+    job->started_us = esp_timer_get_time();
+    xSemaphoreGive(prov_lock);
+    _wake_task();
+
+    ESP_LOGI(TAG, "Job %lu: connecting to '%s'", (unsigned long)id, ssid);
+    wifi_config_t config = {0};
+    memcpy(config.sta.ssid, ssid, strlen(ssid));
+    memcpy(config.sta.password, password, strlen(password));
+    esp_wifi_disconnect();
+    esp_err_t err = esp_wifi_set_config(WIFI_IF_STA, &config);
+    if (err == ESP_OK)
+        err = esp_wifi_connect();
+    if (err != ESP_OK)
+    {
+        ESP_LOGE(TAG, "Job %lu: connect failed: %s", (unsigned long)id, esp_err_to_name(err));
+        xSemaphoreTake(prov_lock, portMAX_DELAY);
+        if (job->id == id)
+            _finish_job(job, JOB_FAILED, "connect_failed");
+        xSemaphoreGive(prov_lock);
+    }
+
+    char json[64];
+    snprintf(json, sizeof(json), "{\"job\":%lu,\"state\":\"connecting\"}", (unsigned long)id);
+    return _send_json(req, "202 Accepted", json);
+}
+
+static esp_err_t
+_status_handler(httpd_req_t* req)
+{
+    char query[48];
+    char value[12];
+    if (!_get_query(req, query, sizeof(query))
+        || httpd_query_key_value(query, "job", value, sizeof(value)) != ESP_OK)
+    {
+        return _send_json(req, "400 Bad Request", "{\"error\":\"job required\"}");
+    }
+
+    uint32_t id = (uint32_t)strtoul(value, NULL, 10);
+    int wait_ms = _wait_ms(query);
+    if (wait_ms > 0 && _park(req, id, wait_ms))
+        return ESP_OK;
+    return _send_status(req, id);
+}
+
+// Answers waiting requests and fails jobs that ran out of time
+static void
+_prov_task(void* arg)
+{
+    (void)arg;
+
+    while (true)
+    {
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(WIFI_PROV_TICK_MS));
+        int64_t now = esp_timer_get_time();
+
+        xSemaphoreTake(prov_lock, portMAX_DELAY);
+        prov_job_t* job = _current_job();
+        bool timed_out = job != NULL && job->state == JOB_CONNECTING
+                         && now - job->started_us > WIFI_PROV_CONNECT_TIMEOUT_MS * 1000LL;
+        uint32_t id = timed_out ? job->id : 0;
+        if (timed_out)
+            _finish_job(job, JOB_FAILED, "timeout");
+        xSemaphoreGive(prov_lock);
+        if (timed_out)
+        {
+            ESP_LOGW(TAG, "Job %lu timed out", (unsigned long)id);
+            esp_wifi_disconnect();
+        }
+
+        for (int i = 0; i < WIFI_PROV_MAX_WAITERS; i++)
+        {
+            xSemaphoreTake(prov_lock, portMAX_DELAY);
+            prov_waiter_t waiter = waiters[i];
+            bool ready = waiter.req != NULL
+                         && (now >= waiter.deadline_us || _waiter_ready(waiter.job));
+            if (ready)
+                waiters[i].req = NULL;
+            xSemaphoreGive(prov_lock);
+            if (!ready)
+                continue;
+
+            if (waiter.job == 0)
+                _send_scan(waiter.req);
+            else
+                _send_status(waiter.req, waiter.job);
+            httpd_req_async_handler_complete(waiter.req);
+        }
+    }
+}
+
+void
+wifi_prov_api_init(void)
+{
+    if (prov_lock != NULL)
+        return;
+    prov_lock = xSemaphoreCreateMutex();
+    xTaskCreate(_prov_task, "ProvApi", 4096, NULL, 4, &prov_task_handle);
+}
+
+void
+wifi_prov_api_start(void)
+{
+    static bool registered = false;
+
+    if (!registered)
+    {
+        web_server_register("/scan", HTTP_GET, _scan_handler, NULL);
+        web_server_register("/connect", HTTP_GET, _connect_handler, NULL);
+        web_server_register("/connect", HTTP_POST, _connect_handler, NULL);
+        web_server_register("/status", HTTP_GET, _status_handler, NULL);
+        registered = true;
+    }
+
+    // Scanning while the user opens the page means the list is usually ready on arrival
+    xSemaphoreTake(prov_lock, portMAX_DELAY);
+    _scan_start();
+    xSemaphoreGive(prov_lock);
+}
+
+void
+wifi_prov_api_on_scan_done(void)
+{
+    uint16_t count = WIFI_PROV_SCAN_MAX;
+    if (esp_wifi_scan_get_ap_records(&count, records) != ESP_OK)
+        count = 0;
+
+    xSemaphoreTake(prov_lock, portMAX_DELAY);
+    ap_count = 0;
+    for (int i = 0; i < count; i++)
+    {
+        const char* ssid = (const char*)records[i].ssid;
+        if (ssid[0] == '\0')
+            continue;
+
+        // An SSID with several access points is listed once, with its strongest signal
+        int slot = 0;
+        while (slot < ap_count && strcmp(aps[slot].ssid, ssid) != 0)
+            slot++;
+        if (slot < ap_count && aps[slot].rssi >= records[i].rssi)
+            continue;
+        if (slot == ap_count)
+            ap_count++;
+
+        // Keep the list sorted by signal, strongest first
+        while (slot > 0 && aps[slot - 1].rssi < records[i].rssi)
+        {
+            aps[slot] = aps[slot - 1];
+            slot--;
+        }
+        prov_ap_t* ap = &aps[slot];
+        snprintf(ap->ssid, sizeof(ap->ssid), "%s", ssid);
+        ap->rssi = records[i].rssi;
+        ap->channel = records[i].primary;
+        ap->secure = records[i].authmode != WIFI_AUTH_OPEN;
+    }
+    int found = ap_count;
+    scanned_us = esp_timer_get_time();
+    scanning = false;
+    xSemaphoreGive(prov_lock);
+
+    ESP_LOGI(TAG, "Scan found %d networks", found);
+    _wake_task();
+}
+
+bool
+wifi_prov_api_on_disconnected(uint16_t reason)
+{
+    xSemaphoreTake(prov_lock, portMAX_DELAY);
+    prov_job_t* job = _current_job();
+    bool active = job != NULL && job->state == JOB_CONNECTING;
+    bool retry = false;
+    uint32_t id = active ? job->id : 0;
+
+    // ASSOC_LEAVE is the disconnect the job itself asked for before connecting
+    if (active && reason != WIFI_REASON_ASSOC_LEAVE)
+    {
+        if (reason == WIFI_REASON_4WAY_HANDSHAKE_TIMEOUT || reason == WIFI_REASON_AUTH_FAIL
+            || reason == WIFI_REASON_HANDSHAKE_TIMEOUT)
+        {
+            _finish_job(job, JOB_FAILED, "auth_failed");
+        }
+        else if (job->attempts >= WIFI_PROV_CONNECT_ATTEMPTS)
+        {
+            _finish_job(job, JOB_FAILED,
+                        reason == WIFI_REASON_NO_AP_FOUND ? "no_ap_found" : "connect_failed");
+        }
+        else
+        {
+            job->attempts++;
+            retry = true;
+        }
+    }
+    xSemaphoreGive(prov_lock);
+
+    if (active && reason != WIFI_REASON_ASSOC_LEAVE)
+        ESP_LOGW(TAG, "Job %lu: disconnected, reason %u%s", (unsigned long)id, reason,
+                 retry ? ", retrying" : "");
+    if (retry)
+        esp_wifi_connect();
+    _wake_task();
+    return active;
+}
+
+bool
+wifi_prov_api_on_got_ip(const esp_ip4_addr_t* ip)
+{
+    xSemaphoreTake(prov_lock, portMAX_DELAY);
+    prov_job_t* job = _current_job();
+    bool completed = job != NULL && job->state == JOB_CONNECTING;
+    if (completed)
+    {
+        job->ip = *ip;
+        _finish_job(job, JOB_CONNECTED, NULL);
+        ESP_LOGI(TAG, "Job %lu: connected in %lld ms", (unsigned long)job->id,
+                 (long long)((job->finished_us - job->started_us) / 1000));
+    }
+    xSemaphoreGive(prov_lock);
+
+    _wake_task();
+    return completed;
+}
+
+bool
+wifi_prov_api_busy(void)
+{
+    xSemaphoreTake(prov_lock, portMAX_DELAY);
+    prov_job_t* job = _current_job();
+    bool busy = scanning || (job != NULL && job->state == JOB_CONNECTING);
+    xSemaphoreGive(prov_lock);
+    return busy;
+}
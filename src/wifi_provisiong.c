@@ -4,82 +4,196 @@
 #include "esp_http_server.h"
 #include "esp_log.h"
 #include "esp_netif.h"
+#include "esp_random.h"
+#include "esp_timer.h"
 #include "esp_wifi.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include <string.h>
 
-#include "dht11.h"
-#include "firebase.h"
-#include "hardware.h"
-#include "provisionig_html.h"
+#include "connectivity.h"
+#include "portal_assets.h"
+#include "web_server.h"
+#include "wifi_fast_connect.h"
+#include "wifi_prov_api.h"
 #include "wifi_provisioning.h"
 
 static const char* TAG = "wifi_prov";
 
 #define MAX_LISTEN_INTERVAL 10
-#define MAX_RETRY_NUM 5
+// Reconnect backoff: doubles per failed attempt, with equal jitter
+#define RECONNECT_MIN_MS 1000
+#define RECONNECT_MAX_MS 60000
+// Failed attempts after which a device that has not been online since boot opens the portal
+#define PORTAL_AFTER_FAILURES 7
+// How long the portal stays up after provisioning, so the phone can fetch the outcome
+#define AP_LINGER_MS 15000
 static const char* AP_SSID = "ESP32_Setup";
 static const char* AP_PASS = "";
 bool tasks_started = false;
 
+// The timers only post these; the work runs in the handler on the event loop, so the state
+// below is only touched from that one task and needs no lock
+ESP_EVENT_DEFINE_BASE(WIFI_PROV_TIMER_EVENT);
+enum
+{
+    WIFI_PROV_TIMER_RECONNECT,
+    WIFI_PROV_TIMER_STOP_PORTAL,
+};
+// How soon a timer tries again when the event queue is full
+#define TIMER_REPOST_MS 100
+
+static bool portal_active = false;
+// Whether the station has a network to retry; without one it only connects when a
+// provisioning job asks it to
+static bool has_credentials = false;
+static int retry_count = 0;
+static esp_timer_handle_t portal_stop_timer;
+static esp_timer_handle_t reconnect_timer;
+// Whether the current attempt targets the cached access point (wifi_fast_connect.h)
+static bool fast_attempt = false;
+
 // Forward declarations
-static httpd_handle_t start_webserver(void);
+static void start_webserver(void);
+static void start_portal(void);
 static void wifi_event_handler(void* event_handler_arg, esp_event_base_t event_base,
                                int32_t event_id, void* event_data);
+static void timer_event_handler(void* event_handler_arg, esp_event_base_t event_base,
+                                int32_t event_id, void* event_data);
 
 static esp_err_t root_get_handler(httpd_req_t* req);
-static esp_err_t connect_get_handler(httpd_req_t* req);
 static esp_err_t wildcard_get_handler(httpd_req_t* req);
 static esp_err_t redirect_to_root(httpd_req_t* req);
 
-// Start application tasks (Firebase + DHT11 + button)
+// Start the web server (captive portal)
 static void
-start_application_tasks()
+start_webserver(void)
 {
-    xTaskCreate(firebase_dht11_task, "DHT11_Firebase", 8192, NULL, 5, NULL);
+    static bool registered = false;
 
-    xTaskCreate(firebase_switch_stream_task, "FirebaseStream", 8192, NULL, 7, NULL);
-
-    xTaskCreate(button_handler_task, "ButtonHandler", 4096, NULL, 10, NULL);
+    if (!registered)
+    {
+        // Register HTTP endpoints; the wildcard goes last so it only catches unknown URIs
+        web_server_register("/", HTTP_GET, root_get_handler, NULL);
+        wifi_prov_api_start();
+        web_server_register("/generate_204", HTTP_GET, redirect_to_root, NULL);
+        web_server_register("/hotspot-detect.html", HTTP_GET, redirect_to_root, NULL);
+        web_server_register("/ncsi.txt", HTTP_GET, redirect_to_root, NULL);
+        web_server_register("/*", HTTP_GET, wildcard_get_handler, NULL);
+        registered = true;
+    }
+    else
+    {
+        wifi_prov_api_start();
+    }
+    web_server_start();
 }
 
-// Start the web server (captive portal)
-static httpd_handle_t
-start_webserver(void)
+static void
+connect_station(void)
 {
-    httpd_handle_t server = NULL;
-    httpd_config_t config = HTTPD_DEFAULT_CONFIG();
-    config.max_req_hdr_len = 2048;
-    config.uri_match_fn = httpd_uri_match_wildcard;
+    connectivity_link_connecting();
+    esp_wifi_connect();
+}
 
-    if (httpd_start(&server, &config) == ESP_OK)
+static void
+reconnect(void)
+{
+    // A job or scan of the portal has the station for now; try again once it is done
+    if (portal_active && wifi_prov_api_busy())
     {
-        // Register HTTP endpoints
-        httpd_uri_t root_uri = {.uri = "/", .method = HTTP_GET, .handler = root_get_handler};
-        httpd_register_uri_handler(server, &root_uri);
+        esp_timer_start_once(reconnect_timer, RECONNECT_MIN_MS * 1000ULL);
+        return;
+    }
+    connect_station();
+}
 
-        httpd_uri_t connect_uri
-            = {.uri = "/connect", .method = HTTP_GET, .handler = connect_get_handler};
-        httpd_register_uri_handler(server, &connect_uri);
+// Equal jitter: half the delay is fixed, the other half random, so a fleet spreads out after
+// an access point comes back
+static uint32_t
+reconnect_delay_ms(int failures)
+{
+    uint32_t delay_ms = RECONNECT_MIN_MS;
+    for (int i = 1; i < failures && delay_ms < RECONNECT_MAX_MS; i++)
+        delay_ms *= 2;
+    if (delay_ms > RECONNECT_MAX_MS)
+        delay_ms = RECONNECT_MAX_MS;
+    return delay_ms / 2 + esp_random() % (delay_ms / 2 + 1);
+}
 
-        httpd_uri_t gen_uri
-            = {.uri = "/generate_204", .method = HTTP_GET, .handler = redirect_to_root};
-        httpd_register_uri_handler(server, &gen_uri);
+// Drops the cached access point from the station config after a failed directed attempt
+static void
+fall_back_to_scan(uint16_t reason)
+{
+    wifi_config_t config;
+    fast_attempt = false;
+    if (esp_wifi_get_config(WIFI_IF_STA, &config) != ESP_OK)
+        return;
+    ESP_LOGW(TAG, "Cached access point failed (reason %d), scanning", reason);
+    wifi_fast_connect_clear(&config);
+    esp_wifi_set_config(WIFI_IF_STA, &config);
+}
 
-        httpd_uri_t hotspot_uri
-            = {.uri = "/hotspot-detect.html", .method = HTTP_GET, .handler = redirect_to_root};
-        httpd_register_uri_handler(server, &hotspot_uri);
+// Ends the portal once the station is online: AP, DNS and scanning stop
+static void
+stop_portal(void)
+{
+    if (!portal_active)
+        return;
+    ESP_LOGI(TAG, "Station online, stopping the access point");
+    portal_active = false;
+    dns_server_stop();
+    esp_wifi_set_mode(WIFI_MODE_STA);
+}
 
-        httpd_uri_t ncsi_uri
-            = {.uri = "/ncsi.txt", .method = HTTP_GET, .handler = redirect_to_root};
-        httpd_register_uri_handler(server, &ncsi_uri);
+// Runs the access point, DNS server and portal next to the station (APSTA), so the station
+// can scan and try credentials while the phone stays connected to the portal. A station with
+// saved credentials keeps retrying them with backoff meanwhile.
+static void
+start_portal(void)
+{
+    portal_active = true;
+    ESP_ERROR_CHECK(esp_wifi_set_mode(WIFI_MODE_APSTA));
+
+    wifi_config_t ap_config = {0};
+    strncpy((char*)ap_config.ap.ssid, AP_SSID, sizeof(ap_config.ap.ssid) - 1);
+    ap_config.ap.ssid_len = strlen(AP_SSID);
+    strncpy((char*)ap_config.ap.password, AP_PASS, sizeof(ap_config.ap.password) - 1);
+    ap_config.ap.authmode = WIFI_AUTH_OPEN;
+    ap_config.ap.max_connection = 1;
+    ESP_ERROR_CHECK(esp_wifi_set_config(WIFI_IF_AP, &ap_config));
+    ESP_ERROR_CHECK(esp_wifi_start());
+
+    dns_server_start();
+    // start the webserver that serves the provisioning HTML and API
+    start_webserver();
+    ESP_LOGI(TAG, "Captive portal started at 192.168.4.1");
+}
 
-        httpd_uri_t wildcard_uri
-            = {.uri = "/*", .method = HTTP_GET, .handler = wildcard_get_handler};
-        httpd_register_uri_handler(server, &wildcard_uri);
-    }
-    return server;
+// Runs on the esp_timer task: hands the timer over to the event loop
+static void
+post_timer_event(void* arg)
+{
+    int32_t event_id = (int32_t)(intptr_t)arg;
+    if (esp_event_post(WIFI_PROV_TIMER_EVENT, event_id, NULL, 0, 0) == ESP_OK)
+        return;
+    // Blocking here would hold up every other timer; try again shortly instead
+    esp_timer_handle_t timer =
+        event_id == WIFI_PROV_TIMER_RECONNECT ? reconnect_timer : portal_stop_timer;
+    esp_timer_start_once(timer, TIMER_REPOST_MS * 1000ULL);
+}
+
+static void
+timer_event_handler(void* event_handler_arg, esp_event_base_t event_base, int32_t event_id,
+                    void* event_data)
+{
+    (void)event_handler_arg;
+    (void)event_base;
+    (void)event_data;
+    if (event_id == WIFI_PROV_TIMER_RECONNECT)
+        reconnect();
+    else if (event_id == WIFI_PROV_TIMER_STOP_PORTAL)
+        stop_portal();
 }
 
 // WiFi and IP event handler
@@ -87,40 +201,49 @@ static void
 wifi_event_handler(void* event_handler_arg, esp_event_base_t event_base, int32_t event_id,
                    void* event_data)
 {
-    static int retry_cnt = 0;
     if (event_base == WIFI_EVENT)
     {
         switch (event_id)
         {
         case WIFI_EVENT_STA_START:
-            esp_wifi_connect();
+            if (!portal_active)
+                connect_station();
+            break;
+        case WIFI_EVENT_SCAN_DONE:
+            wifi_prov_api_on_scan_done();
             break;
         case WIFI_EVENT_STA_DISCONNECTED:
-            ESP_LOGE(TAG, "ESP32 Disconnected, retrying");
-            retry_cnt++;
-            if (retry_cnt < MAX_RETRY_NUM)
+        {
+            wifi_event_sta_disconnected_t* event = (wifi_event_sta_disconnected_t*)event_data;
+            connectivity_link_down();
+            // A provisioning job retries by itself; a station without credentials stays idle
+            if (wifi_prov_api_on_disconnected(event->reason) || !has_credentials)
+                break;
+
+            // A stale BSSID or channel is retried at once with a full scan
+            if (fast_attempt)
             {
-                esp_wifi_connect();
+                fall_back_to_scan(event->reason);
+                connect_station();
+                break;
             }
-            else
+
+            retry_count++;
+            if (!tasks_started && !portal_active && retry_count == PORTAL_AFTER_FAILURES)
             {
                 ESP_LOGE(TAG, "Connection error, starting AP");
-                ESP_ERROR_CHECK(esp_wifi_set_mode(WIFI_MODE_AP));
-                wifi_config_t empty = {0};
-                esp_wifi_set_config(WIFI_IF_STA, &empty);
-
-                wifi_config_t ap_config = {0};
-                strncpy((char*)ap_config.ap.ssid, AP_SSID, sizeof(ap_config.ap.ssid) - 1);
-                ap_config.ap.ssid_len = strlen(AP_SSID);
-                strncpy((char*)ap_config.ap.password, AP_PASS, sizeof(ap_config.ap.password) - 1);
-                ap_config.ap.authmode = WIFI_AUTH_OPEN;
-                ap_config.ap.max_connection = 1;
-
-                ESP_ERROR_CHECK(esp_wifi_set_config(WIFI_IF_AP, &ap_config));
-                ESP_ERROR_CHECK(esp_wifi_start());
-                dns_server_start();
-                start_webserver();
+                start_portal();
             }
+            uint32_t delay_ms = reconnect_delay_ms(retry_count);
+            ESP_LOGW(TAG, "Disconnected (reason %d), retrying in %lu ms", event->reason,
+                     (unsigned long)delay_ms);
+            esp_timer_start_once(reconnect_timer, delay_ms * 1000ULL);
+            break;
+        }
+        case WIFI_EVENT_STA_CONNECTED:
+            // Also covers the attempts of provisioning jobs; the address is still to come
+            connectivity_link_connecting();
+            wifi_fast_connect_on_connected((wifi_event_sta_connected_t*)event_data);
             break;
         default:
             break;
@@ -132,6 +255,19 @@ wifi_event_handler(void* event_handler_arg, esp_event_base_t event_base, int32_t
         {
             ip_event_got_ip_t* event = (ip_event_got_ip_t*)event_data;
             ESP_LOGI(TAG, "station ip :" IPSTR, IP2STR(&event->ip_info.ip));
+            retry_count = 0;
+            fast_attempt = false;
+            has_credentials = true;
+            esp_timer_stop(reconnect_timer);
+            connectivity_link_up();
+            wifi_fast_connect_on_got_ip();
+
+            // A job's phone waits for the outcome; a saved network that came back needs no
+            // portal any more
+            if (wifi_prov_api_on_got_ip(&event->ip_info.ip))
+                esp_timer_start_once(portal_stop_timer, AP_LINGER_MS * 1000ULL);
+            else if (portal_active)
+                stop_portal();
 
             if (!tasks_started)
             {
@@ -148,11 +284,26 @@ wifi_provisioning_start(void)
     ESP_LOGI(TAG, "Initializing WiFi stack for provisioning");
     ESP_ERROR_CHECK(esp_netif_init());
     ESP_ERROR_CHECK(esp_event_loop_create_default());
-    esp_netif_create_default_wifi_sta();
+    esp_netif_t* sta_netif = esp_netif_create_default_wifi_sta();
     esp_netif_create_default_wifi_ap();
 
     wifi_init_config_t cfg = WIFI_INIT_CONFIG_DEFAULT();
     ESP_ERROR_CHECK(esp_wifi_init(&cfg));
+    wifi_fast_connect_init(sta_netif);
+    wifi_prov_api_init();
+
+    esp_timer_create_args_t timer_args = {
+        .callback = post_timer_event,
+        .arg = (void*)(intptr_t)WIFI_PROV_TIMER_STOP_PORTAL,
+        .name = "portal_stop",
+    };
+    ESP_ERROR_CHECK(esp_timer_create(&timer_args, &portal_stop_timer));
+    esp_timer_create_args_t reconnect_args = {
+        .callback = post_timer_event,
+        .arg = (void*)(intptr_t)WIFI_PROV_TIMER_RECONNECT,
+        .name = "wifi_reconnect",
+    };
+    ESP_ERROR_CHECK(esp_timer_create(&reconnect_args, &reconnect_timer));
 
     esp_event_handler_instance_t instance_any_id;
     esp_event_handler_instance_t instance_got_ip;
@@ -160,6 +311,8 @@ wifi_provisioning_start(void)
         WIFI_EVENT, ESP_EVENT_ANY_ID, &wifi_event_handler, NULL, &instance_any_id));
     ESP_ERROR_CHECK(esp_event_handler_instance_register(
         IP_EVENT, IP_EVENT_STA_GOT_IP, &wifi_event_handler, NULL, &instance_got_ip));
+    ESP_ERROR_CHECK(esp_event_handler_register(WIFI_PROV_TIMER_EVENT, ESP_EVENT_ANY_ID,
+                                               &timer_event_handler, NULL));
 
     // Check if wifi config is already saved
     wifi_config_t saved_config;
@@ -170,73 +323,30 @@ wifi_provisioning_start(void)
         is_provisioned = true;
     }
 
+    has_credentials = is_provisioned;
     if (is_provisioned)
     {
         ESP_LOGI(TAG, "Device already provisioned. Connecting to '%s'", saved_config.sta.ssid);
         saved_config.sta.listen_interval = MAX_LISTEN_INTERVAL;
+        // Hints from an earlier boot are dropped unless the cache still vouches for them
+        wifi_fast_connect_clear(&saved_config);
+        fast_attempt = wifi_fast_connect_apply(&saved_config);
         ESP_ERROR_CHECK(esp_wifi_set_mode(WIFI_MODE_STA));
+        ESP_ERROR_CHECK(esp_wifi_set_config(WIFI_IF_STA, &saved_config));
         dns_server_stop();
         ESP_ERROR_CHECK(esp_wifi_start());
     }
     else
     {
         ESP_LOGI(TAG, "Device not provisioned. Starting SoftAP and captive portal");
-        ESP_ERROR_CHECK(esp_wifi_set_mode(WIFI_MODE_AP));
-
-        wifi_config_t ap_config = {0};
-        strncpy((char*)ap_config.ap.ssid, AP_SSID, sizeof(ap_config.ap.ssid) - 1);
-        ap_config.ap.ssid_len = strlen(AP_SSID);
-        strncpy((char*)ap_config.ap.password, AP_PASS, sizeof(ap_config.ap.password) - 1);
-        ap_config.ap.authmode = WIFI_AUTH_OPEN;
-        ap_config.ap.max_connection = 1;
-        ESP_ERROR_CHECK(esp_wifi_set_config(WIFI_IF_AP, &ap_config));
-        ESP_ERROR_CHECK(esp_wifi_start());
-
-        dns_server_start();
-        // start the webserver that serves the provisioning HTML
-        start_webserver();
-        ESP_LOGI(TAG, "Captive portal started at 192.168.4.1");
+        start_portal();
     }
 }
 
 static esp_err_t
 root_get_handler(httpd_req_t* req)
 {
-    httpd_resp_send(req, html_form, HTTPD_RESP_USE_STRLEN);
-    return ESP_OK;
-}
-
-static esp_err_t
-connect_get_handler(httpd_req_t* req)
-{
-    char ssid[32] = {0};
-    char password[64] = {0};
-    char buf[100];
-    size_t buf_len = httpd_req_get_url_query_len(req) + 1;
-    if (buf_len > 1)
-    {
-        if (httpd_req_get_url_query_str(req, buf, buf_len) == ESP_OK)
-        {
-            if (httpd_query_key_value(buf, "ssid", ssid, sizeof(ssid)) != ESP_OK
-                || httpd_query_key_value(buf, "password", password, sizeof(password)) != ESP_OK)
-            {
-                httpd_resp_send_404(req);
-                return ESP_FAIL;
-            }
-        }
-    }
-
-    ESP_LOGI(TAG, "Otrzymano SSID: %s, Haslo: %s", ssid, password);
-
-    wifi_config_t wifi_config = {};
-    strcpy((char*)wifi_config.sta.ssid, ssid);
-    strcpy((char*)wifi_config.sta.password, password);
-    ESP_ERROR_CHECK(esp_wifi_set_mode(WIFI_MODE_STA));
-    ESP_ERROR_CHECK(esp_wifi_set_config(WIFI_IF_STA, &wifi_config));
-    ESP_ERROR_CHECK(esp_wifi_connect());
-
-    httpd_resp_send(req, "<h1>Probuje polaczyc...</h1><p>Restart urzadzenia po sukcesie.</p>",
-                    HTTPD_RESP_USE_STRLEN);
+    web_server_send_asset(req, &portal_index_html);
     return ESP_OK;
 }
 
@@ -250,12 +360,8 @@ redirect_to_root(httpd_req_t* req)
     httpd_resp_set_hdr(req, "Pragma", "no-cache");
     httpd_resp_set_hdr(req, "Expires", "0");
 
-    // Send a tiny HTML page with meta-refresh as a fallback for user agents
-    const char* body = "<html><head>"
-                       "<meta http-equiv=\"refresh\" content=\"0;url=http://192.168.4.1/\">"
-                       "</head><body></body></html>";
-    httpd_resp_set_type(req, "text/html");
-    httpd_resp_send(req, body, HTTPD_RESP_USE_STRLEN);
+    // A tiny page with meta-refresh as a fallback for user agents, shared by all probe URLs
+    web_server_send_asset(req, &portal_redirect_html);
     return ESP_OK;
 }
 
@@ -266,6 +372,6 @@ wildcard_get_handler(httpd_req_t* req)
     {
         return httpd_resp_send_404(req);
     }
-    httpd_resp_send(req, html_form, HTTPD_RESP_USE_STRLEN);
+    web_server_send_asset(req, &portal_index_html);
     return ESP_OK;
 }
@@ -0,0 +1,237 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unity.h>
+
+#include "actuator.h"
+#include "driver/gpio.h"
+#include "esp_timer.h"
+#include "events.h"
+
+// The clock is frozen, so every edge lands exactly on its millisecond
+#define RELAY_GPIO 5
+#define PULSE_GPIO 6
+#define IMPULSE_MS 100
+#define MAX_EDGES 16
+#define LONG_PULSE_MS 500
+// Real time a call may take; waiting for the pulse would hang on the frozen clock instead
+#define CALL_BUDGET_US 5000
+
+static int relay_channel = -1;
+static int pulse_channel = -1;
+static events_reader_t idle_reader;
+
+// Rising and falling edges seen while stepping the clock by 1 ms, in ms from the start
+static int edge_ms[MAX_EDGES];
+static int edge_count;
+
+void
+setUp(void)
+{
+    if (relay_channel < 0)
+    {
+        esp_timer_host_freeze();
+        TEST_ASSERT_EQUAL_INT(ESP_OK, actuator_register(RELAY_GPIO, IMPULSE_MS, &relay_channel));
+        TEST_ASSERT_EQUAL_INT(ESP_OK, actuator_register(PULSE_GPIO, 0, &pulse_channel));
+        TEST_ASSERT_EQUAL_INT(ESP_OK,
+                              events_subscribe(&idle_reader, EVENT_MASK(EVENT_ACTUATOR_IDLE)));
+    }
+    edge_count = 0;
+}
+
+void
+tearDown(void)
+{
+    // Let every channel finish and its gap run out, and drop the idle events
+    esp_timer_host_advance(10 * 1000 * 1000);
+    event_t event;
+    while (events_wait(&idle_reader, &event, 0))
+    {
+    }
+}
+
+static void
+_run(gpio_num_t gpio, int ms)
+{
+    int level = gpio_host_get_output(gpio);
+    for (int t = 0; t <= ms; t++)
+    {
+        if (t > 0)
+            esp_timer_host_advance(1000);
+        else
+            esp_timer_host_advance(0);
+        int now = gpio_host_get_output(gpio);
+        if (now != level && edge_count < MAX_EDGES)
+            edge_ms[edge_count++] = t;
+        level = now;
+    }
+}
+
+static void
+test_state_change_is_one_impulse(void)
+{
+    bool state = !actuator_get_state(relay_channel);
+    TEST_ASSERT_EQUAL_INT(ESP_OK, actuator_set_state(relay_channel, state));
+    TEST_ASSERT_TRUE(actuator_is_busy(relay_channel));
+    _run(RELAY_GPIO, 300);
+
+    TEST_ASSERT_EQUAL_INT(2, edge_count);
+    TEST_ASSERT_EQUAL_INT(0, edge_ms[0]);
+    TEST_ASSERT_EQUAL_INT(IMPULSE_MS, edge_ms[1]);
+    TEST_ASSERT_FALSE(actuator_is_busy(relay_channel));
+    TEST_ASSERT_EQUAL(state, actuator_get_state(relay_channel));
+
+    event_t event;
+    TEST_ASSERT_TRUE(events_wait(&idle_reader, &event, 0));
+    TEST_ASSERT_EQUAL_INT(EVENT_ACTUATOR_IDLE, event.type);
+    TEST_ASSERT_EQUAL_INT(relay_channel, event.actuator.channel);
+    TEST_ASSERT_EQUAL(state, event.actuator.state);
+}
+
+static void
+test_requesting_the_same_state_does_nothing(void)
+{
+    TEST_ASSERT_EQUAL_INT(ESP_OK, actuator_set_state(relay_channel,
+                                                     actuator_get_state(relay_channel)));
+    TEST_ASSERT_FALSE(actuator_is_busy(relay_channel));
+    _run(RELAY_GPIO, 50);
+    TEST_ASSERT_EQUAL_INT(0, edge_count);
+}
+
+static void
+test_going_back_cancels_a_pending_toggle(void)
+{
+    bool state = actuator_get_state(relay_channel);
+    actuator_set_state(relay_channel, !state);
+    actuator_set_state(relay_channel, state);
+    _run(RELAY_GPIO, 300);
+
+    TEST_ASSERT_EQUAL_INT(0, edge_count);
+    TEST_ASSERT_EQUAL(state, actuator_get_state(relay_channel));
+    TEST_ASSERT_FALSE(actuator_is_busy(relay_channel));
+}
+
+static void
+test_pulse_train_timing(void)
+{
+    TEST_ASSERT_EQUAL_INT(ESP_OK, actuator_pulse(pulse_channel, 3, 10, 20));
+    _run(PULSE_GPIO, 200);
+
+    static const int expected[] = {0, 10, 30, 40, 60, 70};
+    TEST_ASSERT_EQUAL_INT(6, edge_count);
+    for (int i = 0; i < 6; i++)
+        TEST_ASSERT_EQUAL_INT(expected[i], edge_ms[i]);
+}
+
+static void
+test_identical_queued_trains_coalesce(void)
+{
+    TEST_ASSERT_EQUAL_INT(ESP_OK, actuator_pulse(pulse_channel, 1, 10, 10));
+    TEST_ASSERT_EQUAL_INT(ESP_OK, actuator_pulse(pulse_channel, 2, 10, 10));
+    TEST_ASSERT_EQUAL_INT(ESP_OK, actuator_pulse(pulse_channel, 2, 10, 10));
+    _run(PULSE_GPIO, 200);
+
+    // One pulse, then the two-pulse train once
+    TEST_ASSERT_EQUAL_INT(6, edge_count);
+    TEST_ASSERT_EQUAL_INT(20, edge_ms[2]);
+    TEST_ASSERT_EQUAL_INT(50, edge_ms[5]);
+}
+
+static void
+test_gap_is_kept_after_the_channel_went_idle(void)
+{
+    TEST_ASSERT_EQUAL_INT(ESP_OK, actuator_pulse(pulse_channel, 1, 10, 50));
+    _run(PULSE_GPIO, 15);
+    TEST_ASSERT_FALSE(actuator_is_busy(pulse_channel));
+
+    // The channel is idle 5 ms after the falling edge; the next pulse still waits out the gap
+    TEST_ASSERT_EQUAL_INT(ESP_OK, actuator_pulse(pulse_channel, 1, 10, 50));
+    TEST_ASSERT_TRUE(actuator_is_busy(pulse_channel));
+    edge_count = 0;
+    _run(PULSE_GPIO, 100);
+
+    TEST_ASSERT_EQUAL_INT(2, edge_count);
+    TEST_ASSERT_EQUAL_INT(45, edge_ms[0]);
+    TEST_ASSERT_EQUAL_INT(55, edge_ms[1]);
+}
+
+static void
+test_command_after_the_gap_starts_at_once(void)
+{
+    TEST_ASSERT_EQUAL_INT(ESP_OK, actuator_pulse(pulse_channel, 1, 10, 50));
+    _run(PULSE_GPIO, 80);
+
+    TEST_ASSERT_EQUAL_INT(ESP_OK, actuator_pulse(pulse_channel, 1, 10, 50));
+    edge_count = 0;
+    _run(PULSE_GPIO, 20);
+    TEST_ASSERT_EQUAL_INT(2, edge_count);
+    TEST_ASSERT_EQUAL_INT(0, edge_ms[0]);
+}
+
+static void
+test_full_queue_rejects_commands(void)
+{
+    // The first command leaves the queue as soon as the timer starts it
+    for (int i = 0; i < ACTUATOR_QUEUE_LEN; i++)
+        TEST_ASSERT_EQUAL_INT(ESP_OK, actuator_pulse(pulse_channel, 1 + (i % 2), 1, 1));
+    esp_timer_host_advance(0);
+    TEST_ASSERT_EQUAL_INT(ESP_OK, actuator_pulse(pulse_channel, 3, 1, 1));
+    TEST_ASSERT_EQUAL_INT(ESP_ERR_NO_MEM, actuator_pulse(pulse_channel, 4, 1, 1));
+    TEST_ASSERT_EQUAL_INT(ESP_ERR_INVALID_ARG, actuator_pulse(pulse_channel, 0, 1, 1));
+    TEST_ASSERT_EQUAL_INT(ESP_ERR_INVALID_ARG, actuator_pulse(ACTUATOR_MAX_CHANNELS, 1, 1, 1));
+}
+
+static int64_t
+_real_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static void
+test_commands_return_during_a_pulse(void)
+{
+    TEST_ASSERT_EQUAL_INT(ESP_OK, actuator_pulse(pulse_channel, 1, LONG_PULSE_MS, 10));
+    esp_timer_host_advance(0);
+    TEST_ASSERT_EQUAL_INT(1, gpio_host_get_output(PULSE_GPIO));
+
+    // What the stream callback does on a switch update, and a second command on the same
+    // channel; neither may wait for the running pulse
+    bool state = !actuator_get_state(relay_channel);
+    int64_t start_us = _real_us();
+    TEST_ASSERT_EQUAL_INT(ESP_OK, actuator_set_state(relay_channel, state));
+    TEST_ASSERT_EQUAL_INT(ESP_OK, actuator_pulse(pulse_channel, 1, 10, 10));
+    int64_t elapsed_us = _real_us() - start_us;
+
+    char msg[64];
+    snprintf(msg, sizeof(msg), "two commands during a pulse took %lld us", (long long)elapsed_us);
+    TEST_MESSAGE(msg);
+    TEST_ASSERT_LESS_THAN_INT(CALL_BUDGET_US, (int)elapsed_us);
+    TEST_ASSERT_EQUAL_INT(1, gpio_host_get_output(PULSE_GPIO));
+
+    // The pulse still runs its full length and the queued one follows after the gap
+    _run(PULSE_GPIO, LONG_PULSE_MS + 100);
+    TEST_ASSERT_EQUAL_INT(3, edge_count);
+    TEST_ASSERT_EQUAL_INT(LONG_PULSE_MS, edge_ms[0]);
+    TEST_ASSERT_EQUAL_INT(LONG_PULSE_MS + 10, edge_ms[1]);
+    TEST_ASSERT_EQUAL_INT(LONG_PULSE_MS + 20, edge_ms[2]);
+    TEST_ASSERT_EQUAL(state, actuator_get_state(relay_channel));
+}
+
+void
+app_main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_state_change_is_one_impulse);
+    RUN_TEST(test_requesting_the_same_state_does_nothing);
+    RUN_TEST(test_going_back_cancels_a_pending_toggle);
+    RUN_TEST(test_pulse_train_timing);
+    RUN_TEST(test_identical_queued_trains_coalesce);
+    RUN_TEST(test_gap_is_kept_after_the_channel_went_idle);
+    RUN_TEST(test_command_after_the_gap_starts_at_once);
+    RUN_TEST(test_full_queue_rejects_commands);
+    RUN_TEST(test_commands_return_during_a_pulse);
+    exit(UNITY_END());
+}
@@ -0,0 +1,213 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <unity.h>
+
+#include "button_fsm.h"
+#include "esp_timer.h"
+#include "events.h"
+
+#define MAX_SEEN 16
+// One millisecond short of the wrap of a 32-bit millisecond clock, about 49.7 days
+#define WRAP_MS ((int64_t)UINT32_MAX)
+
+// An edge of a recorded trace: microseconds from the start and the level after it
+typedef struct
+{
+    uint32_t t_us;
+    bool pressed;
+} trace_edge_t;
+
+typedef struct
+{
+    int64_t t_ms;
+    uint32_t events;
+} seen_t;
+
+static const button_cfg_t cfg = {.debounce_ms = 30, .long_press_ms = 1500, .double_click_ms = 300};
+static button_fsm_t fsm;
+static seen_t seen[MAX_SEEN];
+static int seen_count;
+
+// Tactile switch: 2.3 ms of press bounce, 1.9 ms of release bounce
+static const trace_edge_t click_trace[] = {
+    {0, true}, {180, false}, {420, true}, {650, false}, {1100, true}, {1900, false}, {2300, true},
+    {121000, false}, {121150, true}, {121600, false}, {122400, true}, {122900, false},
+};
+
+static const trace_edge_t double_click_trace[] = {
+    {0, true}, {300, false}, {700, true}, {90000, false}, {90400, true}, {91000, false},
+    {200000, true}, {200250, false}, {200900, true}, {280000, false}, {280500, true},
+    {281200, false},
+};
+
+static const trace_edge_t long_press_trace[] = {
+    {0, true}, {500, false}, {1200, true}, {2000000, false}, {2000300, true}, {2001000, false},
+};
+
+// Worn contact: the press keeps bouncing after the settle window
+static const trace_edge_t slow_bounce_trace[] = {
+    {0, true}, {10000, false}, {25000, true}, {34000, false}, {38000, true}, {300000, false},
+};
+
+// Interference on the line: short spikes that end released
+static const trace_edge_t glitch_trace[] = {
+    {0, true}, {40, false}, {5000, true}, {5100, false},
+};
+
+#define REPLAY(trace, base_ms) _replay(trace, sizeof(trace) / sizeof(trace[0]), base_ms)
+
+void
+setUp(void)
+{
+    seen_count = 0;
+}
+
+void
+tearDown(void)
+{
+}
+
+// Replays a trace the way the button task drives the machine: an edge only interrupts
+// while no settle window runs (the pin is masked meanwhile), the pin is sampled when a
+// deadline is due, and a level change missed while masked starts a new window at once
+static void
+_replay(const trace_edge_t* trace, int count, int64_t base_ms)
+{
+    int64_t base_us = base_ms * 1000;
+    bool level = false;
+    int next_edge = 0;
+
+    button_fsm_init(&fsm, &cfg, false);
+    while (true)
+    {
+        int64_t edge_us = (next_edge < count) ? base_us + trace[next_edge].t_us : INT64_MAX;
+        int64_t due_ms = button_fsm_next_ms(&fsm);
+        int64_t due_us = (due_ms == INT64_MAX) ? INT64_MAX : due_ms * 1000;
+        if (edge_us == INT64_MAX && due_us == INT64_MAX)
+            return;
+
+        if (edge_us <= due_us)
+        {
+            level = trace[next_edge++].pressed;
+            if (!button_fsm_settling(&fsm))
+                button_fsm_edge(&fsm, edge_us / 1000);
+            continue;
+        }
+
+        bool was_settling = button_fsm_settling(&fsm);
+        uint32_t events = button_fsm_update(&fsm, level, due_ms);
+        if (was_settling && !button_fsm_settling(&fsm) && level != fsm.pressed)
+            button_fsm_edge(&fsm, due_ms);
+        if (events != 0 && seen_count < MAX_SEEN)
+            seen[seen_count++] = (seen_t){due_ms - base_ms, events};
+    }
+}
+
+static void
+_assert_seen(const seen_t* expected, int count)
+{
+    TEST_ASSERT_EQUAL_INT(count, seen_count);
+    for (int i = 0; i < count; i++)
+    {
+        TEST_ASSERT_EQUAL_INT64(expected[i].t_ms, seen[i].t_ms);
+        TEST_ASSERT_EQUAL_HEX32(expected[i].events, seen[i].events);
+    }
+}
+
+static void
+test_bouncing_click(void)
+{
+    static const seen_t expected[] = {
+        {30, BUTTON_EVENT_PRESS},
+        {151, BUTTON_EVENT_RELEASE},
+        {421, BUTTON_EVENT_CLICK},
+    };
+    REPLAY(click_trace, 1000);
+    _assert_seen(expected, 3);
+}
+
+static void
+test_bouncing_double_click(void)
+{
+    static const seen_t expected[] = {
+        {30, BUTTON_EVENT_PRESS},
+        {120, BUTTON_EVENT_RELEASE},
+        {230, BUTTON_EVENT_PRESS},
+        {310, BUTTON_EVENT_RELEASE | BUTTON_EVENT_DOUBLE_CLICK},
+    };
+    REPLAY(double_click_trace, 1000);
+    _assert_seen(expected, 4);
+}
+
+static void
+test_long_press_release_is_not_a_click(void)
+{
+    static const seen_t expected[] = {
+        {30, BUTTON_EVENT_PRESS},
+        {1500, BUTTON_EVENT_LONG_PRESS},
+        {2030, BUTTON_EVENT_RELEASE},
+    };
+    REPLAY(long_press_trace, 1000);
+    _assert_seen(expected, 3);
+}
+
+static void
+test_bounce_past_the_window_is_one_press(void)
+{
+    static const seen_t expected[] = {
+        {30, BUTTON_EVENT_PRESS},
+        {330, BUTTON_EVENT_RELEASE},
+        {600, BUTTON_EVENT_CLICK},
+    };
+    REPLAY(slow_bounce_trace, 1000);
+    _assert_seen(expected, 3);
+}
+
+static void
+test_glitch_is_ignored(void)
+{
+    REPLAY(glitch_trace, 1000);
+    TEST_ASSERT_EQUAL_INT(0, seen_count);
+}
+
+static void
+test_gestures_across_32_bit_wrap(void)
+{
+    static const seen_t expected[] = {
+        {30, BUTTON_EVENT_PRESS},
+        {120, BUTTON_EVENT_RELEASE},
+        {230, BUTTON_EVENT_PRESS},
+        {310, BUTTON_EVENT_RELEASE | BUTTON_EVENT_DOUBLE_CLICK},
+    };
+    // The second click straddles the point where a 32-bit millisecond time wraps
+    REPLAY(double_click_trace, WRAP_MS - 250);
+    _assert_seen(expected, 4);
+}
+
+static void
+test_event_time_extends_past_wrap(void)
+{
+    esp_timer_host_freeze();
+    esp_timer_host_advance((WRAP_MS + 5) * 1000 - esp_timer_get_time());
+
+    // Stamped 8 ms earlier, before the low 32 bits wrapped
+    event_t event = {.type = EVENT_BUTTON_EDGE, .time_ms = (uint32_t)(WRAP_MS - 3)};
+    TEST_ASSERT_EQUAL_INT64(WRAP_MS - 3, events_time_ms(&event));
+    event.time_ms = 2;
+    TEST_ASSERT_EQUAL_INT64(WRAP_MS + 3, events_time_ms(&event));
+}
+
+void
+app_main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_bouncing_click);
+    RUN_TEST(test_bouncing_double_click);
+    RUN_TEST(test_long_press_release_is_not_a_click);
+    RUN_TEST(test_bounce_past_the_window_is_one_press);
+    RUN_TEST(test_glitch_is_ignored);
+    RUN_TEST(test_gestures_across_32_bit_wrap);
+    RUN_TEST(test_event_time_extends_past_wrap);
+    exit(UNITY_END());
+}
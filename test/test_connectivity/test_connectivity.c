@@ -0,0 +1,113 @@
+#include <stdlib.h>
+#include <unity.h>
+
+#include "connectivity.h"
+#include "esp_timer.h"
+#include "freertos/task.h"
+
+#define LONG_BACKOFF_MS 5000
+
+static volatile bool backoff_done;
+static volatile bool backoff_woken;
+static volatile int64_t backoff_end_us;
+
+void
+setUp(void)
+{
+    connectivity_init();
+    connectivity_link_down();
+}
+
+void
+tearDown(void)
+{
+}
+
+static void
+test_states_are_ordered(void)
+{
+    TEST_ASSERT_EQUAL_INT(CONNECTIVITY_OFFLINE, connectivity_state());
+    TEST_ASSERT_FALSE(connectivity_wait(CONNECTIVITY_CONNECTING, 0));
+
+    connectivity_link_connecting();
+    connectivity_link_up();
+    connectivity_cloud_ready(true);
+    TEST_ASSERT_EQUAL_INT(CONNECTIVITY_CLOUD_READY, connectivity_state());
+    TEST_ASSERT_TRUE(connectivity_wait(CONNECTIVITY_ONLINE, 0));
+
+    // A late "connecting" report does not take a live link down
+    connectivity_link_connecting();
+    TEST_ASSERT_EQUAL_INT(CONNECTIVITY_CLOUD_READY, connectivity_state());
+    connectivity_cloud_ready(false);
+    TEST_ASSERT_EQUAL_INT(CONNECTIVITY_ONLINE, connectivity_state());
+
+    connectivity_link_down();
+    TEST_ASSERT_FALSE(connectivity_wait(CONNECTIVITY_ONLINE, 0));
+    connectivity_cloud_ready(true);
+    TEST_ASSERT_EQUAL_INT(CONNECTIVITY_OFFLINE, connectivity_state());
+}
+
+static void
+test_epoch_changes_once_per_link(void)
+{
+    uint32_t epoch = connectivity_link_epoch();
+    connectivity_link_up();
+    connectivity_link_up();
+    connectivity_cloud_ready(true);
+    TEST_ASSERT_EQUAL_UINT32(epoch + 1, connectivity_link_epoch());
+
+    connectivity_link_down();
+    connectivity_link_up();
+    TEST_ASSERT_EQUAL_UINT32(epoch + 2, connectivity_link_epoch());
+}
+
+static void
+test_backoff_runs_out_without_a_new_link(void)
+{
+    int64_t start_us = esp_timer_get_time();
+    TEST_ASSERT_FALSE(connectivity_backoff(pdMS_TO_TICKS(50)));
+    TEST_ASSERT_GREATER_OR_EQUAL(40 * 1000, esp_timer_get_time() - start_us);
+}
+
+static void
+_backoff_task(void* arg)
+{
+    (void)arg;
+    backoff_woken = connectivity_backoff(pdMS_TO_TICKS(LONG_BACKOFF_MS));
+    backoff_end_us = esp_timer_get_time();
+    backoff_done = true;
+    vTaskDelete(NULL);
+}
+
+static void
+test_new_link_ends_the_backoff(void)
+{
+    backoff_done = false;
+    xTaskCreate(_backoff_task, "backoff", 4096, NULL, 5, NULL);
+    vTaskDelay(pdMS_TO_TICKS(50));
+
+    // Other transitions keep it sleeping
+    connectivity_link_connecting();
+    vTaskDelay(pdMS_TO_TICKS(50));
+    TEST_ASSERT_FALSE(backoff_done);
+
+    int64_t up_us = esp_timer_get_time();
+    connectivity_link_up();
+    for (int i = 0; i < 100 && !backoff_done; i++)
+        vTaskDelay(pdMS_TO_TICKS(10));
+
+    TEST_ASSERT_TRUE(backoff_done);
+    TEST_ASSERT_TRUE(backoff_woken);
+    TEST_ASSERT_LESS_THAN(LONG_BACKOFF_MS * 1000 / 10, backoff_end_us - up_us);
+}
+
+void
+app_main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_states_are_ordered);
+    RUN_TEST(test_epoch_changes_once_per_link);
+    RUN_TEST(test_backoff_runs_out_without_a_new_link);
+    RUN_TEST(test_new_link_ends_the_backoff);
+    exit(UNITY_END());
+}
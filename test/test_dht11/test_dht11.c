@@ -0,0 +1,201 @@
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unity.h>
+
+#include "dht11_decode.h"
+
+#define JITTER_ROUNDS 1000
+
+// 45.0 % and 23.4 C, with its checksum
+static const uint8_t frame[5] = {45, 0, 23, 4, 72};
+
+static dht11_edge_t edges[DHT11_FRAME_EDGES + 8];
+static uint32_t seed;
+
+void
+setUp(void)
+{
+    seed = 12345;
+}
+
+void
+tearDown(void)
+{
+}
+
+static int
+_jitter(int max_us)
+{
+    if (max_us == 0)
+        return 0;
+    seed = seed * 1664525u + 1013904223u;
+    return (int)((seed >> 8) % (2 * max_us + 1)) - max_us;
+}
+
+static void
+_edge(int* n, uint32_t* t_us, uint32_t width_us, uint8_t level)
+{
+    *t_us += width_us;
+    edges[*n].t_us = *t_us;
+    edges[*n].level = level;
+    (*n)++;
+}
+
+// Builds the edges of a frame as the capture ISR records them, each pulse off by up to
+// jitter_us; returns the edge count
+static int
+_build_trace(const uint8_t data[5], uint32_t start_us, int jitter_us)
+{
+    int n = 0;
+    uint32_t t_us = start_us;
+
+    _edge(&n, &t_us, 0, 1); // host releases the line
+    _edge(&n, &t_us, 30 + _jitter(jitter_us), 0);
+    _edge(&n, &t_us, 80 + _jitter(jitter_us), 1);
+    _edge(&n, &t_us, 80 + _jitter(jitter_us), 0);
+    for (int bit = 0; bit < 40; bit++)
+    {
+        bool one = data[bit / 8] & (0x80 >> (bit % 8));
+        _edge(&n, &t_us, 50 + _jitter(jitter_us), 1);
+        _edge(&n, &t_us, (one ? 70 : 27) + _jitter(jitter_us), 0);
+    }
+    _edge(&n, &t_us, 50 + _jitter(jitter_us), 1);
+    return n;
+}
+
+static void
+test_clean_frame(void)
+{
+    int count = _build_trace(frame, 1000, 0);
+    TEST_ASSERT_EQUAL_INT(DHT11_FRAME_EDGES, count);
+
+    uint8_t data[5];
+    TEST_ASSERT_EQUAL_INT(DHT11_DECODE_OK, dht11_decode(edges, count, data));
+    TEST_ASSERT_EQUAL_MEMORY(frame, data, 5);
+}
+
+static void
+test_timestamps_that_wrap(void)
+{
+    int count = _build_trace(frame, UINT32_MAX - 2000, 0);
+    uint8_t data[5];
+    TEST_ASSERT_EQUAL_INT(DHT11_DECODE_OK, dht11_decode(edges, count, data));
+    TEST_ASSERT_EQUAL_MEMORY(frame, data, 5);
+}
+
+static void
+test_jittered_frames(void)
+{
+    // ISR latency moves each edge by a few microseconds; +-15 us keeps 27 and 70 us apart
+    for (int round = 0; round < JITTER_ROUNDS; round++)
+    {
+        uint8_t sent[5] = {(uint8_t)round, 0, (uint8_t)(round >> 3), (uint8_t)(round % 10)};
+        sent[4] = (uint8_t)(sent[0] + sent[1] + sent[2] + sent[3]);
+        int count = _build_trace(sent, (uint32_t)round * 7919u, 15);
+
+        uint8_t data[5];
+        TEST_ASSERT_EQUAL_INT(DHT11_DECODE_OK, dht11_decode(edges, count, data));
+        TEST_ASSERT_EQUAL_MEMORY(sent, data, 5);
+    }
+}
+
+static void
+test_noise_before_the_response_is_skipped(void)
+{
+    int count = _build_trace(frame, 1000, 0);
+
+    // A short glitch right after the host released the line
+    memmove(edges + 3, edges + 1, (size_t)(count - 1) * sizeof(edges[0]));
+    edges[1] = (dht11_edge_t){.t_us = edges[0].t_us + 5, .level = 0};
+    edges[2] = (dht11_edge_t){.t_us = edges[0].t_us + 8, .level = 1};
+
+    uint8_t data[5];
+    TEST_ASSERT_EQUAL_INT(DHT11_DECODE_OK, dht11_decode(edges, count + 2, data));
+    TEST_ASSERT_EQUAL_MEMORY(frame, data, 5);
+}
+
+static void
+test_wrong_checksum(void)
+{
+    uint8_t sent[5];
+    memcpy(sent, frame, 5);
+    sent[4] ^= 0x01;
+    int count = _build_trace(sent, 1000, 0);
+
+    uint8_t data[5];
+    TEST_ASSERT_EQUAL_INT(DHT11_ERROR_CHECKSUM, dht11_decode(edges, count, data));
+}
+
+static void
+test_no_response(void)
+{
+    uint8_t data[5];
+    TEST_ASSERT_EQUAL_INT(DHT11_ERROR_NO_RESPONSE, dht11_decode(edges, 0, data));
+
+    // A response pulse far too long (a stuck line) is not a response
+    int count = _build_trace(frame, 1000, 0);
+    for (int i = 2; i < count; i++)
+        edges[i].t_us += 400;
+    TEST_ASSERT_EQUAL_INT(DHT11_ERROR_NO_RESPONSE, dht11_decode(edges, count, data));
+}
+
+static void
+test_truncated_frames(void)
+{
+    int count = _build_trace(frame, 1000, 0);
+    uint8_t data[5];
+
+    // Whatever arrived before the frame timeout is decoded, and only a full frame passes
+    for (int cut = 4; cut < count - 1; cut++)
+        TEST_ASSERT_EQUAL_INT(DHT11_ERROR_TIMING, dht11_decode(edges, cut, data));
+}
+
+static void
+test_missed_edges(void)
+{
+    int count = _build_trace(frame, 1000, 0);
+    dht11_edge_t full[DHT11_FRAME_EDGES];
+    memcpy(full, edges, sizeof(full));
+
+    // An edge lost to ISR latency breaks the level sequence; a frame is never half decoded
+    for (int drop = 4; drop < count - 1; drop++)
+    {
+        memcpy(edges, full, (size_t)drop * sizeof(edges[0]));
+        memcpy(edges + drop, full + drop + 1, (size_t)(count - drop - 1) * sizeof(edges[0]));
+
+        uint8_t data[5];
+        TEST_ASSERT_NOT_EQUAL(DHT11_DECODE_OK, dht11_decode(edges, count - 1, data));
+    }
+}
+
+static void
+test_pulse_out_of_range(void)
+{
+    int count = _build_trace(frame, 1000, 0);
+
+    // Stretch the high time of bit 10 to 150 us
+    int rise = 4 + 2 * 10;
+    uint32_t stretch_us = 150 - (edges[rise + 1].t_us - edges[rise].t_us);
+    for (int i = rise + 1; i < count; i++)
+        edges[i].t_us += stretch_us;
+
+    uint8_t data[5];
+    TEST_ASSERT_EQUAL_INT(DHT11_ERROR_TIMING, dht11_decode(edges, count, data));
+}
+
+void
+app_main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_clean_frame);
+    RUN_TEST(test_timestamps_that_wrap);
+    RUN_TEST(test_jittered_frames);
+    RUN_TEST(test_noise_before_the_response_is_skipped);
+    RUN_TEST(test_wrong_checksum);
+    RUN_TEST(test_no_response);
+    RUN_TEST(test_truncated_frames);
+    RUN_TEST(test_missed_edges);
+    RUN_TEST(test_pulse_out_of_range);
+    exit(UNITY_END());
+}
@@ -0,0 +1,226 @@
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unity.h>
+
+#include "event_bus.h"
+
+// Stress run; `pio test -e native_tsan` repeats it under ThreadSanitizer
+#define STRESS_EVENTS 200000
+#define STRESS_READERS 3
+
+static event_bus_t bus;
+
+void
+setUp(void)
+{
+    memset(&bus, 0, sizeof(bus));
+}
+
+void
+tearDown(void)
+{
+}
+
+static void
+_publish(int channel, event_type_t type, uint32_t n)
+{
+    // The second word checks that the payload was copied whole
+    event_t event = {.type = (uint16_t)type, .raw = {n, ~n}};
+    event_bus_publish(&bus, channel, &event, false);
+}
+
+static void
+test_events_arrive_in_order_per_channel(void)
+{
+    event_bus_reader_t reader;
+    event_bus_subscribe(&bus, &reader, EVENT_MASK(EVENT_BUTTON_EDGE), NULL, NULL);
+    for (uint32_t n = 0; n < 5; n++)
+        _publish(0, EVENT_BUTTON_EDGE, n);
+
+    event_t event;
+    for (uint32_t n = 0; n < 5; n++)
+    {
+        TEST_ASSERT_TRUE(event_bus_read(&bus, &reader, &event));
+        TEST_ASSERT_EQUAL_UINT32(n, event.raw[0]);
+        TEST_ASSERT_EQUAL_INT(0, event.channel);
+    }
+    TEST_ASSERT_FALSE(event_bus_read(&bus, &reader, &event));
+    TEST_ASSERT_EQUAL_UINT32(0, event_bus_take_lost(&reader));
+}
+
+static void
+test_reader_only_gets_its_types(void)
+{
+    event_bus_reader_t reader;
+    event_bus_subscribe(&bus, &reader, EVENT_MASK(EVENT_RELAY_COMMAND), NULL, NULL);
+    _publish(0, EVENT_BUTTON_EDGE, 1);
+    _publish(1, EVENT_RELAY_COMMAND, 2);
+    _publish(1, EVENT_BUTTON_EDGE, 3);
+
+    event_t event;
+    TEST_ASSERT_TRUE(event_bus_read(&bus, &reader, &event));
+    TEST_ASSERT_EQUAL_UINT32(2, event.raw[0]);
+    TEST_ASSERT_FALSE(event_bus_read(&bus, &reader, &event));
+}
+
+static void
+test_lapped_reader_counts_lost_events(void)
+{
+    event_bus_reader_t reader;
+    event_bus_subscribe(&bus, &reader, EVENT_MASK(EVENT_BUTTON_EDGE), NULL, NULL);
+    for (uint32_t n = 0; n < EVENT_BUS_CHANNEL_SLOTS + 5; n++)
+        _publish(0, EVENT_BUTTON_EDGE, n);
+
+    // The oldest five were overwritten; the rest are still there, in order
+    event_t event;
+    TEST_ASSERT_TRUE(event_bus_read(&bus, &reader, &event));
+    TEST_ASSERT_EQUAL_UINT32(5, event.raw[0]);
+    TEST_ASSERT_EQUAL_UINT32(5, event_bus_take_lost(&reader));
+    int count = 1;
+    while (event_bus_read(&bus, &reader, &event))
+        count++;
+    TEST_ASSERT_EQUAL_INT(EVENT_BUS_CHANNEL_SLOTS, count);
+}
+
+static void
+test_unsubscribed_channels_never_count_as_lost(void)
+{
+    event_bus_reader_t reader;
+    event_bus_subscribe(&bus, &reader, EVENT_MASK(EVENT_BUTTON_EDGE), NULL, NULL);
+
+    // Another producer laps the ring many times with types this reader does not take
+    for (uint32_t n = 0; n < 10 * EVENT_BUS_CHANNEL_SLOTS; n++)
+        _publish(1, EVENT_RELAY_COMMAND, n);
+    _publish(0, EVENT_BUTTON_EDGE, 42);
+
+    event_t event;
+    TEST_ASSERT_TRUE(event_bus_read(&bus, &reader, &event));
+    TEST_ASSERT_EQUAL_UINT32(42, event.raw[0]);
+    TEST_ASSERT_FALSE(event_bus_read(&bus, &reader, &event));
+    TEST_ASSERT_EQUAL_UINT32(0, event_bus_take_lost(&reader));
+}
+
+typedef struct
+{
+    int channel;
+    event_type_t type;
+} producer_arg_t;
+
+typedef struct
+{
+    event_bus_reader_t reader;
+    uint32_t received;
+    uint32_t lost;
+    uint32_t torn;
+    uint32_t out_of_order;
+} stress_reader_t;
+
+static atomic_int producers_running;
+
+static double
+_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static void*
+_producer(void* arg)
+{
+    const producer_arg_t* p = (const producer_arg_t*)arg;
+    for (uint32_t n = 0; n < STRESS_EVENTS; n++)
+        _publish(p->channel, p->type, n);
+    atomic_fetch_sub(&producers_running, 1);
+    return NULL;
+}
+
+static void*
+_consumer(void* arg)
+{
+    stress_reader_t* r = (stress_reader_t*)arg;
+    uint32_t next[EVENT_BUS_MAX_CHANNELS] = {0};
+    event_t event;
+
+    while (true)
+    {
+        bool done = atomic_load(&producers_running) == 0;
+        while (event_bus_read(&bus, &r->reader, &event))
+        {
+            r->received++;
+            if (event.raw[1] != ~event.raw[0])
+                r->torn++;
+            if (event.raw[0] < next[event.channel])
+                r->out_of_order++;
+            next[event.channel] = event.raw[0] + 1;
+        }
+        r->lost += event_bus_take_lost(&r->reader);
+        // One more pass after the producers stopped drains what they left
+        if (done)
+            return NULL;
+    }
+}
+
+static void
+test_stress_concurrent_producers_and_readers(void)
+{
+    static const producer_arg_t producers[] = {
+        {0, EVENT_BUTTON_EDGE},
+        {1, EVENT_RELAY_COMMAND},
+    };
+    static stress_reader_t readers[STRESS_READERS];
+    static const uint32_t masks[STRESS_READERS] = {
+        EVENT_MASK(EVENT_BUTTON_EDGE),
+        EVENT_MASK(EVENT_RELAY_COMMAND),
+        EVENT_MASK(EVENT_BUTTON_EDGE) | EVENT_MASK(EVENT_RELAY_COMMAND),
+    };
+
+    pthread_t threads[STRESS_READERS + 2];
+    memset(readers, 0, sizeof(readers));
+    for (int i = 0; i < STRESS_READERS; i++)
+        event_bus_subscribe(&bus, &readers[i].reader, masks[i], NULL, NULL);
+    atomic_store(&producers_running, 2);
+    double start = _seconds();
+    for (int i = 0; i < STRESS_READERS; i++)
+        pthread_create(&threads[i], NULL, _consumer, &readers[i]);
+    for (int i = 0; i < 2; i++)
+        pthread_create(&threads[STRESS_READERS + i], NULL, _producer, (void*)&producers[i]);
+    for (int i = 0; i < STRESS_READERS + 2; i++)
+        pthread_join(threads[i], NULL);
+    double elapsed = _seconds() - start;
+
+    uint32_t delivered = 0;
+    for (int i = 0; i < STRESS_READERS; i++)
+        delivered += readers[i].received;
+    char report[160];
+    snprintf(report, sizeof(report),
+             "%d events published in %.1f ms: %.0f events/s published, %.0f events/s delivered "
+             "to %d readers",
+             2 * STRESS_EVENTS, elapsed * 1000, 2 * STRESS_EVENTS / elapsed, delivered / elapsed,
+             STRESS_READERS);
+    TEST_MESSAGE(report);
+
+    // Every event is either received whole and in order or reported as lost
+    for (int i = 0; i < STRESS_READERS; i++)
+    {
+        uint32_t published = (i == 2) ? 2 * STRESS_EVENTS : STRESS_EVENTS;
+        TEST_ASSERT_EQUAL_UINT32(0, readers[i].torn);
+        TEST_ASSERT_EQUAL_UINT32(0, readers[i].out_of_order);
+        TEST_ASSERT_EQUAL_UINT32(published, readers[i].received + readers[i].lost);
+    }
+}
+
+void
+app_main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_events_arrive_in_order_per_channel);
+    RUN_TEST(test_reader_only_gets_its_types);
+    RUN_TEST(test_lapped_reader_counts_lost_events);
+    RUN_TEST(test_unsubscribed_channels_never_count_as_lost);
+    RUN_TEST(test_stress_concurrent_producers_and_readers);
+    exit(UNITY_END());
+}
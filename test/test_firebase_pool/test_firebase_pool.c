@@ -0,0 +1,188 @@
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <signal.h>
+#include <spawn.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <unity.h>
+
+#include "firebase.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+// The client reads FIREBASE_URL through this; the test points it at its own mock server
+extern const char* FIREBASE_BASE_URL;
+extern char** environ;
+
+#define PUT_COUNT 50
+#define MOCK_START_TIMEOUT_MS 10000
+
+static pid_t mock_pid = -1;
+static int mock_port;
+static char base_url[64];
+
+void
+setUp(void)
+{
+}
+
+void
+tearDown(void)
+{
+}
+
+static int
+_free_port(void)
+{
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in addr = {.sin_family = AF_INET, .sin_addr.s_addr = htonl(INADDR_LOOPBACK)};
+    socklen_t len = sizeof(addr);
+    bind(fd, (struct sockaddr*)&addr, sizeof(addr));
+    getsockname(fd, (struct sockaddr*)&addr, &len);
+    close(fd);
+    return ntohs(addr.sin_port);
+}
+
+// Sends one request to the mock's control API and returns the body of the answer
+static bool
+_mock_control(const char* method, const char* path, char* out, size_t out_len)
+{
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in addr = {
+        .sin_family = AF_INET,
+        .sin_port = htons(mock_port),
+        .sin_addr.s_addr = htonl(INADDR_LOOPBACK),
+    };
+    if (connect(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0)
+    {
+        close(fd);
+        return false;
+    }
+
+    char request[160];
+    int len = snprintf(request, sizeof(request),
+                       "%s %s HTTP/1.1\r\nContent-Length: 0\r\nConnection: close\r\n\r\n",
+                       method, path);
+    send(fd, request, len, 0);
+    size_t got = 0;
+    ssize_t n;
+    while (got + 1 < out_len && (n = recv(fd, out + got, out_len - 1 - got, 0)) > 0)
+        got += (size_t)n;
+    out[got] = '\0';
+    close(fd);
+    return got > 0;
+}
+
+// Connections the mock accepted so far, not counting the one asking
+static int
+_mock_connections(void)
+{
+    char response[1024];
+    TEST_ASSERT_TRUE(_mock_control("GET", "/_mock/stats", response, sizeof(response)));
+    const char* field = strstr(response, "\"connections_total\":");
+    TEST_ASSERT_NOT_NULL(field);
+    return atoi(field + strlen("\"connections_total\":")) - 1;
+}
+
+// Starts tools/mock_rtdb.py on a free port; runs outside the tests, so it reports instead of
+// asserting
+static bool
+_start_mock(void)
+{
+    // pio test runs from the project root; fall back to the path of this file
+    static char script[512] = "tools/mock_rtdb.py";
+    char* dir = NULL;
+    if (access(script, R_OK) != 0)
+    {
+        snprintf(script, sizeof(script), "%s", __FILE__);
+        dir = strstr(script, "test/test_firebase_pool/");
+        if (dir != NULL)
+            strcpy(dir, "tools/mock_rtdb.py");
+    }
+
+    mock_port = _free_port();
+    char port[8];
+    snprintf(port, sizeof(port), "%d", mock_port);
+    char* argv[] = {"python3", script, "--port", port, NULL};
+    if (posix_spawnp(&mock_pid, "python3", NULL, NULL, argv, environ) != 0)
+        return false;
+
+    char response[1024];
+    for (int waited_ms = 0; waited_ms < MOCK_START_TIMEOUT_MS; waited_ms += 50)
+    {
+        if (_mock_control("GET", "/_mock/stats", response, sizeof(response)))
+        {
+            snprintf(base_url, sizeof(base_url), "http://127.0.0.1:%d/", mock_port);
+            FIREBASE_BASE_URL = base_url;
+            return true;
+        }
+        vTaskDelay(pdMS_TO_TICKS(50));
+    }
+    return false;
+}
+
+static void
+_put_many(int count)
+{
+    for (int i = 0; i < count; i++)
+        TEST_ASSERT_EQUAL_INT(ESP_OK, firebase_put("pool/value", i));
+}
+
+static void
+test_puts_share_one_connection(void)
+{
+    firebase_stats_t before, after;
+    int server_before = _mock_connections();
+    firebase_get_stats(&before);
+
+    _put_many(PUT_COUNT);
+
+    firebase_get_stats(&after);
+    TEST_ASSERT_EQUAL_UINT32(PUT_COUNT, after.requests - before.requests);
+    TEST_ASSERT_EQUAL_UINT32(0, after.failures - before.failures);
+    TEST_ASSERT_EQUAL_UINT32(1, after.connects - before.connects);
+    // The mock's view: one handshake for all the PUTs (the stats request itself is not counted)
+    TEST_ASSERT_EQUAL_INT(1, _mock_connections() - server_before - 1);
+}
+
+static void
+test_killed_connection_reconnects_once(void)
+{
+    char response[256];
+    firebase_stats_t before, after;
+    firebase_get_stats(&before);
+
+    TEST_ASSERT_TRUE(_mock_control("POST", "/_mock/close_connections", response,
+                                   sizeof(response)));
+    TEST_ASSERT_NOT_NULL(strstr(response, "\"closed\":1"));
+
+    // The caller does not see the dead connection; the pool replaces it once
+    _put_many(PUT_COUNT);
+
+    firebase_get_stats(&after);
+    TEST_ASSERT_EQUAL_UINT32(1, after.connects - before.connects);
+    TEST_ASSERT_LESS_OR_EQUAL_UINT32(1, after.failures - before.failures);
+}
+
+void
+app_main(void)
+{
+    firebase_init();
+
+    if (!_start_mock())
+    {
+        printf("Could not start tools/mock_rtdb.py\n");
+        exit(1);
+    }
+
+    UNITY_BEGIN();
+    RUN_TEST(test_puts_share_one_connection);
+    RUN_TEST(test_killed_connection_reconnects_once);
+    kill(mock_pid, SIGTERM);
+    waitpid(mock_pid, NULL, 0);
+    exit(UNITY_END());
+}
@@ -0,0 +1,296 @@
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <pthread.h>
+#include <spawn.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <unity.h>
+
+#include "connectivity.h"
+#include "firebase.h"
+#include "firebase_queue.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "nvs.h"
+#include "nvs_flash.h"
+
+// The client reads FIREBASE_URL through this; the test points it at its own server
+extern const char* FIREBASE_BASE_URL;
+extern char** environ;
+
+// Set for the copy of this program that stages values and dies before the restart
+#define PHASE_ENV "QUEUE_TEST_PHASE"
+#define PORT_ENV "QUEUE_TEST_PORT"
+#define WAIT_TIMEOUT_MS 10000
+// Anything the drain task does late would show up within this
+#define SETTLE_MS 300
+#define MAX_PATCHES 8
+#define BODY_MAX 256
+
+typedef enum
+{
+    COUNT_FAILED_FLUSHES,
+    COUNT_SENT,
+    COUNT_COMMITS,
+} counter_t;
+
+static int server_port;
+static char base_url[64];
+
+static pthread_mutex_t patch_lock = PTHREAD_MUTEX_INITIALIZER;
+static char patch_bodies[MAX_PATCHES][BODY_MAX];
+static int patch_count;
+
+void
+setUp(void)
+{
+}
+
+void
+tearDown(void)
+{
+}
+
+static int
+_free_port(void)
+{
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in addr = {.sin_family = AF_INET, .sin_addr.s_addr = htonl(INADDR_LOOPBACK)};
+    socklen_t len = sizeof(addr);
+    bind(fd, (struct sockaddr*)&addr, sizeof(addr));
+    getsockname(fd, (struct sockaddr*)&addr, &len);
+    close(fd);
+    return ntohs(addr.sin_port);
+}
+
+static uint32_t
+_counter(counter_t counter)
+{
+    firebase_queue_stats_t stats;
+    firebase_queue_get_stats(&stats);
+    switch (counter)
+    {
+    case COUNT_FAILED_FLUSHES:
+        return stats.failed_flushes;
+    case COUNT_SENT:
+        return stats.sent;
+    default:
+        return nvs_host_commit_count();
+    }
+}
+
+// Polls until the counter reaches the value; false on timeout
+static bool
+_wait_for(counter_t counter, uint32_t value)
+{
+    for (int waited_ms = 0; waited_ms < WAIT_TIMEOUT_MS; waited_ms += 10)
+    {
+        if (_counter(counter) >= value)
+            return true;
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+    return false;
+}
+
+// Restores the queue from NVS with the client pointed at the server port
+static void
+_init_queue(void)
+{
+    nvs_flash_init();
+    connectivity_init();
+    connectivity_link_up();
+    firebase_init();
+    snprintf(base_url, sizeof(base_url), "http://127.0.0.1:%d/", server_port);
+    FIREBASE_BASE_URL = base_url;
+    firebase_queue_init();
+}
+
+// Runs in the child before the restart; nobody listens on the port, so every flush fails
+static int
+_stage_values(void)
+{
+    _init_queue();
+    xTaskCreate(firebase_queue_task, "FirebaseQueue", 8192, NULL, 6, NULL);
+
+    // The failed pass writes both values with one commit
+    firebase_queue_put("queue/a", 1);
+    firebase_queue_put("queue/b", 1);
+    firebase_queue_flush();
+    if (!_wait_for(COUNT_FAILED_FLUSHES, 1) || !_wait_for(COUNT_COMMITS, 1))
+        return 1;
+
+    // Newer values of a stored path replace it during the retry backoff
+    firebase_queue_put("queue/a", 2);
+    firebase_queue_put("queue/a", 3);
+    firebase_queue_flush();
+    if (!_wait_for(COUNT_COMMITS, 2))
+        return 1;
+
+    // Ends without any cleanup, like a power cut
+    return 0;
+}
+
+// Answers every request with 200 and keeps the bodies of the PATCH requests
+static void*
+_server_thread(void* arg)
+{
+    int listen_fd = *(int*)arg;
+    while (true)
+    {
+        int fd = accept(listen_fd, NULL, NULL);
+        if (fd < 0)
+            return NULL;
+
+        char request[1024];
+        size_t len = 0;
+        ssize_t n;
+        while ((n = recv(fd, request + len, sizeof(request) - 1 - len, 0)) > 0)
+        {
+            len += (size_t)n;
+            request[len] = '\0';
+            char* body = strstr(request, "\r\n\r\n");
+            const char* length_field = strstr(request, "Content-Length: ");
+            if (body == NULL || length_field == NULL)
+                continue;
+            body += 4;
+            size_t body_len = (size_t)atoi(length_field + strlen("Content-Length: "));
+            if ((size_t)(request + len - body) < body_len)
+                continue;
+
+            pthread_mutex_lock(&patch_lock);
+            if (strncmp(request, "PATCH ", 6) == 0 && patch_count < MAX_PATCHES)
+                snprintf(patch_bodies[patch_count++], BODY_MAX, "%.*s", (int)body_len, body);
+            pthread_mutex_unlock(&patch_lock);
+
+            static const char response[] = "HTTP/1.1 200 OK\r\nContent-Length: 4\r\n\r\nnull";
+            send(fd, response, strlen(response), MSG_NOSIGNAL);
+            len = 0;
+        }
+        close(fd);
+    }
+}
+
+static void
+_start_server(void)
+{
+    static int listen_fd;
+    listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    int on = 1;
+    setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+    struct sockaddr_in addr = {
+        .sin_family = AF_INET,
+        .sin_port = htons(server_port),
+        .sin_addr.s_addr = htonl(INADDR_LOOPBACK),
+    };
+    TEST_ASSERT_EQUAL_INT(0, bind(listen_fd, (struct sockaddr*)&addr, sizeof(addr)));
+    TEST_ASSERT_EQUAL_INT(0, listen(listen_fd, 4));
+
+    pthread_t thread;
+    pthread_create(&thread, NULL, _server_thread, &listen_fd);
+    pthread_detach(thread);
+}
+
+static void
+test_values_are_stored_while_the_server_is_down(void)
+{
+    char port[8];
+    snprintf(port, sizeof(port), "%d", server_port);
+    setenv(PHASE_ENV, "stage", 1);
+    setenv(PORT_ENV, port, 1);
+
+    pid_t pid;
+    char* argv[] = {"test_firebase_queue", NULL};
+    int spawned = posix_spawn(&pid, "/proc/self/exe", NULL, NULL, argv, environ);
+    unsetenv(PHASE_ENV);
+    TEST_ASSERT_EQUAL_INT(0, spawned);
+
+    int status = 0;
+    waitpid(pid, &status, 0);
+    TEST_ASSERT_TRUE(WIFEXITED(status));
+    TEST_ASSERT_EQUAL_INT(0, WEXITSTATUS(status));
+}
+
+static void
+test_restart_replays_only_the_latest_values(void)
+{
+    _start_server();
+    _init_queue();
+
+    firebase_queue_stats_t stats;
+    firebase_queue_get_stats(&stats);
+    TEST_ASSERT_EQUAL_UINT32(2, stats.pending);
+    TEST_ASSERT_TRUE(firebase_queue_is_pending("queue/a"));
+
+    xTaskCreate(firebase_queue_task, "FirebaseQueue", 8192, NULL, 6, NULL);
+    TEST_ASSERT_TRUE(_wait_for(COUNT_SENT, 2));
+    // Clearing both stored values is one more commit
+    TEST_ASSERT_TRUE(_wait_for(COUNT_COMMITS, 1));
+    vTaskDelay(pdMS_TO_TICKS(SETTLE_MS));
+
+    pthread_mutex_lock(&patch_lock);
+    int count = patch_count;
+    char body[BODY_MAX];
+    strcpy(body, patch_bodies[0]);
+    pthread_mutex_unlock(&patch_lock);
+
+    TEST_MESSAGE(body);
+    TEST_ASSERT_EQUAL_INT(1, count);
+    TEST_ASSERT_NOT_NULL(strstr(body, "\"queue/a\":3"));
+    TEST_ASSERT_NOT_NULL(strstr(body, "\"queue/b\":1"));
+    TEST_ASSERT_EQUAL_UINT32(1, nvs_host_commit_count());
+    firebase_queue_get_stats(&stats);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.pending);
+}
+
+static void
+test_value_sent_at_once_is_never_stored(void)
+{
+    uint32_t commits = nvs_host_commit_count();
+
+    firebase_queue_put("queue/c", 7);
+    firebase_queue_flush();
+    TEST_ASSERT_TRUE(_wait_for(COUNT_SENT, 3));
+    vTaskDelay(pdMS_TO_TICKS(SETTLE_MS));
+
+    pthread_mutex_lock(&patch_lock);
+    int count = patch_count;
+    char body[BODY_MAX];
+    strcpy(body, patch_bodies[1]);
+    pthread_mutex_unlock(&patch_lock);
+
+    TEST_ASSERT_EQUAL_UINT32(commits, nvs_host_commit_count());
+    TEST_ASSERT_EQUAL_INT(2, count);
+    TEST_ASSERT_EQUAL_STRING("{\"queue/c\":7}", body);
+}
+
+void
+app_main(void)
+{
+    if (getenv(PHASE_ENV) != NULL)
+    {
+        server_port = atoi(getenv(PORT_ENV));
+        _exit(_stage_values());
+    }
+
+    // Both runs share a private NVS directory
+    char nvs_dir[] = "/tmp/test_firebase_queue_XXXXXX";
+    if (mkdtemp(nvs_dir) == NULL)
+    {
+        printf("Could not create the NVS directory\n");
+        exit(1);
+    }
+    setenv("NVS_HOST_DIR", nvs_dir, 1);
+    server_port = _free_port();
+
+    UNITY_BEGIN();
+    RUN_TEST(test_values_are_stored_while_the_server_is_down);
+    RUN_TEST(test_restart_replays_only_the_latest_values);
+    RUN_TEST(test_value_sent_at_once_is_never_stored);
+    nvs_flash_erase();
+    rmdir(nvs_dir);
+    exit(UNITY_END());
+}
@@ -0,0 +1,208 @@
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <unity.h>
+
+#include "connectivity.h"
+#include "esp_timer.h"
+#include "firebase.h"
+#include "firebase_stream.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+// The client reads FIREBASE_URL through this; the test points it at its own server
+extern const char* FIREBASE_BASE_URL;
+
+#define MAX_SWITCH_VALUES 16
+#define SCENARIO_TIMEOUT_MS 10000
+
+#define SSE_HEADERS                                                                            \
+    "HTTP/1.1 200 OK\r\nContent-Type: text/event-stream\r\nConnection: close\r\n\r\n"
+#define SNAPSHOT_ON                                                                            \
+    "event: put\ndata: {\"path\":\"/\",\"data\":{\"pc_switch\":true,\"label\":\"a\"}}\n\n"
+#define SNAPSHOT_OFF                                                                           \
+    "event: put\ndata: {\"path\":\"/\",\"data\":{\"pc_switch\":false,\"label\":\"a\"}}\n\n"
+#define KEEP_ALIVE "event: keep-alive\ndata: null\n\n"
+
+// What the server does with each connection, in order; the last one stays open
+typedef struct
+{
+    const char* send;
+    int hold_ms;
+} connection_script_t;
+
+static const connection_script_t script[] = {
+    {SSE_HEADERS SNAPSHOT_ON KEEP_ALIVE, 100},  // boot snapshot, then the link flaps
+    {"", 0},                                    // accepted and dropped
+    {"HTTP/1.1 503 Service Unavailable\r\nContent-Length: 0\r\n\r\n", 0},
+    {SSE_HEADERS, 50},                          // accepted, but no event before closing
+    {SSE_HEADERS SNAPSHOT_ON, 100},             // unchanged resync
+    {SSE_HEADERS SNAPSHOT_OFF "event: auth_revoked\ndata: \"expired\"\n\n", 100},
+    {SSE_HEADERS SNAPSHOT_OFF "event: put\ndata: {\"path\":\"/pc_switch\",\"data\":true}\n\n",
+     -1},
+};
+#define SCRIPT_LEN ((int)(sizeof(script) / sizeof(script[0])))
+
+static int listen_fd = -1;
+static volatile int connections;
+static char base_url[64];
+
+static portMUX_TYPE seen_lock = portMUX_INITIALIZER_UNLOCKED;
+static bool switch_values[MAX_SWITCH_VALUES];
+static int switch_count;
+static int revoked_count;
+static int label_count;
+
+void
+setUp(void)
+{
+}
+
+void
+tearDown(void)
+{
+}
+
+static void*
+_server_thread(void* arg)
+{
+    (void)arg;
+    for (int n = 0;; n++)
+    {
+        int fd = accept(listen_fd, NULL, NULL);
+        if (fd < 0)
+            return NULL;
+
+        // The request is small; one read gets all of it
+        char request[1024];
+        if (recv(fd, request, sizeof(request), 0) <= 0)
+        {
+            close(fd);
+            continue;
+        }
+
+        const connection_script_t* step = &script[n < SCRIPT_LEN ? n : SCRIPT_LEN - 1];
+        send(fd, step->send, strlen(step->send), MSG_NOSIGNAL);
+        connections = n + 1;
+        if (step->hold_ms < 0)
+        {
+            while (send(fd, KEEP_ALIVE, strlen(KEEP_ALIVE), MSG_NOSIGNAL) > 0)
+                usleep(200 * 1000);
+        }
+        else
+        {
+            usleep((useconds_t)step->hold_ms * 1000);
+        }
+        close(fd);
+    }
+}
+
+static void
+_start_server(void)
+{
+    listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in addr = {.sin_family = AF_INET, .sin_addr.s_addr = htonl(INADDR_LOOPBACK)};
+    socklen_t len = sizeof(addr);
+    TEST_ASSERT_EQUAL_INT(0, bind(listen_fd, (struct sockaddr*)&addr, sizeof(addr)));
+    TEST_ASSERT_EQUAL_INT(0, listen(listen_fd, 4));
+    getsockname(listen_fd, (struct sockaddr*)&addr, &len);
+
+    snprintf(base_url, sizeof(base_url), "http://127.0.0.1:%d/", ntohs(addr.sin_port));
+    FIREBASE_BASE_URL = base_url;
+
+    pthread_t thread;
+    pthread_create(&thread, NULL, _server_thread, NULL);
+    pthread_detach(thread);
+}
+
+static void
+_on_switch(const firebase_stream_update_t* update, void* user_ctx)
+{
+    (void)user_ctx;
+    bool value;
+    portENTER_CRITICAL(&seen_lock);
+    if (update->type == FIREBASE_STREAM_AUTH_REVOKED)
+        revoked_count++;
+    else if (firebase_stream_get_bool(update, &value) == ESP_OK
+             && switch_count < MAX_SWITCH_VALUES)
+        switch_values[switch_count++] = value;
+    portEXIT_CRITICAL(&seen_lock);
+}
+
+static void
+_on_label(const firebase_stream_update_t* update, void* user_ctx)
+{
+    (void)user_ctx;
+    portENTER_CRITICAL(&seen_lock);
+    if (update->type == FIREBASE_STREAM_PUT || update->type == FIREBASE_STREAM_PATCH)
+        label_count++;
+    portEXIT_CRITICAL(&seen_lock);
+}
+
+static void
+test_flapping_server_without_duplicate_actuation(void)
+{
+    _start_server();
+    TEST_ASSERT_EQUAL_INT(ESP_OK, firebase_stream_subscribe("CONTROLS/pc_switch", _on_switch,
+                                                            NULL));
+    TEST_ASSERT_EQUAL_INT(ESP_OK, firebase_stream_subscribe("CONTROLS/label", _on_label, NULL));
+
+    int64_t start_us = esp_timer_get_time();
+    xTaskCreate(firebase_stream_task, "Stream", 8192, NULL, 5, NULL);
+
+    bool done = false;
+    while (!done && esp_timer_get_time() - start_us < SCENARIO_TIMEOUT_MS * 1000LL)
+    {
+        vTaskDelay(pdMS_TO_TICKS(20));
+        portENTER_CRITICAL(&seen_lock);
+        done = connections == SCRIPT_LEN && switch_count >= 3;
+        portEXIT_CRITICAL(&seen_lock);
+    }
+    // Anything delivered late would be a duplicate
+    vTaskDelay(pdMS_TO_TICKS(300));
+    int64_t elapsed_ms = (esp_timer_get_time() - start_us) / 1000;
+
+    char report[96];
+    snprintf(report, sizeof(report), "%d connections in %lld ms", connections,
+             (long long)elapsed_ms);
+    TEST_MESSAGE(report);
+    TEST_ASSERT_TRUE(done);
+
+    // The relay sees the boot state, the change made while offline and the live change,
+    // each once; the unchanged resyncs and the label never repeat
+    portENTER_CRITICAL(&seen_lock);
+    int count = switch_count;
+    bool values[3] = {switch_values[0], switch_values[1], switch_values[2]};
+    int revoked = revoked_count;
+    int labels = label_count;
+    portEXIT_CRITICAL(&seen_lock);
+    TEST_ASSERT_EQUAL_INT(3, count);
+    TEST_ASSERT_TRUE(values[0]);
+    TEST_ASSERT_FALSE(values[1]);
+    TEST_ASSERT_TRUE(values[2]);
+    TEST_ASSERT_EQUAL_INT(1, revoked);
+    TEST_ASSERT_EQUAL_INT(1, labels);
+
+    firebase_stream_stats_t stats;
+    firebase_stream_get_stats(&stats);
+    TEST_ASSERT_GREATER_OR_EQUAL(2, stats.failures);
+    TEST_ASSERT_GREATER_OR_EQUAL(3, stats.duplicates);
+    TEST_ASSERT_LESS_THAN(1000, stats.max_recovery_ms);
+}
+
+void
+app_main(void)
+{
+    connectivity_init();
+    connectivity_link_up();
+    firebase_init();
+
+    UNITY_BEGIN();
+    RUN_TEST(test_flapping_server_without_duplicate_actuation);
+    exit(UNITY_END());
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+// Seed documents for the fuzz test: stream payloads of the shape Firebase sends, plus
+// documents that exercise every token kind, escape and nesting rule of the tokenizer
+static const char* const json_corpus[] = {
+    "{\"path\":\"/\",\"data\":{\"pc_switch\":false,\"label\":\"desk\"}}",
+    "{\"path\":\"/pc_switch\",\"data\":true}",
+    "{\"path\":\"/pc_switch\",\"data\":false}",
+    "{\"path\":\"/\",\"data\":{\"pc_switch\":true,\"fan\":{\"speed\":3,\"mode\":\"auto\"}}}",
+    "{\"path\":\"/label\",\"data\":\"hello \\\"world\\\"\"}",
+    "{\"path\":\"/fan\",\"data\":null}",
+    "null",
+    "{\"path\":\"/true_false\",\"data\":{\"false\":\"true\"}}",
+    "[1,-2.5,3e10,-0.25E-3,true,false,null,\"s\",[],{}]",
+    "{\"a\":{\"b\":{\"c\":{\"d\":[[[[\"deep\"]]]]}}}}",
+    "{\"esc\":\"\\\\ \\/ \\b \\f \\n \\r \\t \\u0041 \\u00e9\"}",
+    " { \"spaced\" : [ 1 , 2 ] , \"x\" : \"y\" } ",
+    "{\"temperature\":21.5,\"humidity\":40,\"ts\":{\".sv\":\"timestamp\"}}",
+};
+
+#define JSON_CORPUS_LEN (sizeof(json_corpus) / sizeof(json_corpus[0]))
@@ -0,0 +1,278 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unity.h>
+
+#include "corpus.h"
+#include "esp_timer.h"
+#include "json_tok.h"
+
+#define MAX_TOKENS 32
+#define FUZZ_ROUNDS 200000
+#define BENCH_EVENTS 200000
+
+static json_token_t tokens[MAX_TOKENS];
+
+void
+setUp(void)
+{
+    memset(tokens, 0, sizeof(tokens));
+}
+
+void
+tearDown(void)
+{
+}
+
+static int
+_parse(const char* js)
+{
+    return json_parse(js, strlen(js), tokens, MAX_TOKENS);
+}
+
+static void
+test_envelope_gives_typed_values(void)
+{
+    const char* js = "{\"path\":\"/pc_switch\",\"data\":true}";
+    int count = _parse(js);
+    TEST_ASSERT_EQUAL_INT(5, count);
+
+    int path = json_object_get(js, tokens, count, 0, "path", 4);
+    int data = json_object_get(js, tokens, count, 0, "data", 4);
+    TEST_ASSERT_TRUE(json_token_eq(js, &tokens[path], "/pc_switch"));
+    bool value = false;
+    TEST_ASSERT_EQUAL_INT(0, json_get_bool(js, &tokens[data], &value));
+    TEST_ASSERT_TRUE(value);
+}
+
+static void
+test_words_in_keys_and_paths_do_not_match_values(void)
+{
+    // The old strstr() check saw "true" here and switched the relay on
+    const char* js = "{\"path\":\"/true_false\",\"data\":{\"true\":\"true\",\"on\":false}}";
+    int count = _parse(js);
+    TEST_ASSERT_GREATER_THAN(0, count);
+
+    int data = json_object_get(js, tokens, count, 0, "data", 4);
+    int on = json_object_get(js, tokens, count, data, "on", 2);
+    bool value = true;
+    TEST_ASSERT_EQUAL_INT(0, json_get_bool(js, &tokens[on], &value));
+    TEST_ASSERT_FALSE(value);
+    TEST_ASSERT_EQUAL_INT(-1, json_get_bool(js, &tokens[data], &value));
+}
+
+static void
+test_nested_values_and_skip(void)
+{
+    const char* js = "{\"fan\":{\"speed\":3,\"modes\":[\"a\",\"b\"]},\"x\":-2.5e1}";
+    int count = _parse(js);
+    TEST_ASSERT_GREATER_THAN(0, count);
+
+    int fan = json_object_get(js, tokens, count, 0, "fan", 3);
+    TEST_ASSERT_EQUAL_INT(JSON_OBJECT, tokens[fan].type);
+    TEST_ASSERT_EQUAL_INT(2, tokens[fan].size);
+    int modes = json_object_get(js, tokens, count, fan, "modes", 5);
+    TEST_ASSERT_EQUAL_INT(JSON_ARRAY, tokens[modes].type);
+    TEST_ASSERT_EQUAL_INT(2, tokens[modes].size);
+
+    // "x" comes right after everything inside "fan"
+    int after_fan = json_skip(tokens, count, fan);
+    TEST_ASSERT_TRUE(json_token_eq(js, &tokens[after_fan], "x"));
+    double x = 0;
+    TEST_ASSERT_EQUAL_INT(0, json_get_number(js, &tokens[after_fan + 1], &x));
+    TEST_ASSERT_TRUE(x == -25.0);
+    TEST_ASSERT_EQUAL_INT(-1, json_object_get(js, tokens, count, 0, "missing", 7));
+}
+
+static void
+test_string_escapes_are_resolved(void)
+{
+    const char* js = "[\"a\\\"b\\\\c\\/d\\n\\u0041\\u00e9\"]";
+    int count = _parse(js);
+    TEST_ASSERT_EQUAL_INT(2, count);
+
+    char out[32];
+    TEST_ASSERT_EQUAL_INT(0, json_get_string(js, &tokens[1], out, sizeof(out)));
+    TEST_ASSERT_EQUAL_STRING("a\"b\\c/d\nA?", out);
+    TEST_ASSERT_EQUAL_INT(-1, json_get_string(js, &tokens[1], out, 4));
+}
+
+static void
+test_null_and_primitives(void)
+{
+    const char* js = "[null,true,false,0,-1]";
+    int count = _parse(js);
+    TEST_ASSERT_EQUAL_INT(6, count);
+    TEST_ASSERT_TRUE(json_is_null(js, &tokens[1]));
+    TEST_ASSERT_FALSE(json_is_null(js, &tokens[2]));
+    double n = 1;
+    TEST_ASSERT_EQUAL_INT(0, json_get_number(js, &tokens[4], &n));
+    TEST_ASSERT_TRUE(n == 0.0);
+    TEST_ASSERT_EQUAL_INT(-1, json_get_number(js, &tokens[2], &n));
+}
+
+static void
+test_malformed_documents_are_rejected(void)
+{
+    static const char* const invalid[] = {
+        "{\"a\" 1}",    "{1:2}",          "{\"a\":1,}x", "[1,2}",   "{\"a\":tru}",
+        "{\"a\":nul}",  "{\"a\":\"\\x\"}", "\"a\nb\"",    "]",       "{\"a\":1}}",
+        "{\"a\":\"b\":1}", "[TRUE]",
+    };
+    for (size_t i = 0; i < sizeof(invalid) / sizeof(invalid[0]); i++)
+        TEST_ASSERT_EQUAL_INT_MESSAGE(JSON_ERROR_INVAL, _parse(invalid[i]), invalid[i]);
+}
+
+static void
+test_truncated_documents_are_partial(void)
+{
+    static const char* const partial[] = {
+        "{\"path\":\"/pc", "{\"a\":", "[1,2", "{\"a\":{\"b\":[]", "\"abc", "[\"\\u00",
+        "{\"data\":tr", "[fals", "[n",
+    };
+    for (size_t i = 0; i < sizeof(partial) / sizeof(partial[0]); i++)
+        TEST_ASSERT_EQUAL_INT_MESSAGE(JSON_ERROR_PART, _parse(partial[i]), partial[i]);
+}
+
+static void
+test_token_arena_limit(void)
+{
+    const char* js = "[1,2,3,4,5]";
+    TEST_ASSERT_EQUAL_INT(JSON_ERROR_NOMEM, json_parse(js, strlen(js), tokens, 3));
+    TEST_ASSERT_EQUAL_INT(6, json_parse(js, strlen(js), tokens, 6));
+}
+
+// Checks the invariants of a parse result, and that the accessors stay inside the input
+static void
+_check_result(const char* js, size_t len, int count)
+{
+    if (count < 0)
+    {
+        TEST_ASSERT_TRUE(count == JSON_ERROR_NOMEM || count == JSON_ERROR_INVAL
+                         || count == JSON_ERROR_PART);
+        return;
+    }
+    TEST_ASSERT_LESS_OR_EQUAL(MAX_TOKENS, count);
+    for (int i = 0; i < count; i++)
+    {
+        const json_token_t* t = &tokens[i];
+        TEST_ASSERT_TRUE(t->start >= 0 && t->start <= t->end && (size_t)t->end <= len);
+        TEST_ASSERT_LESS_THAN(i, t->parent);
+        int next = json_skip(tokens, count, i);
+        TEST_ASSERT_TRUE(next > i && next <= count);
+
+        char out[64];
+        bool b;
+        double d;
+        json_get_string(js, t, out, sizeof(out));
+        json_get_bool(js, t, &b);
+        json_get_number(js, t, &d);
+        json_is_null(js, t);
+        if (t->type == JSON_OBJECT)
+            json_object_get(js, tokens, count, i, "data", 4);
+    }
+}
+
+static void
+test_corpus_prefixes(void)
+{
+    // Every prefix of a valid document either parses or is reported as partial
+    for (size_t doc = 0; doc < JSON_CORPUS_LEN; doc++)
+    {
+        const char* js = json_corpus[doc];
+        size_t len = strlen(js);
+        TEST_ASSERT_GREATER_THAN(0, json_parse(js, len, tokens, MAX_TOKENS));
+        for (size_t cut = 0; cut < len; cut++)
+        {
+            int count = json_parse(js, cut, tokens, MAX_TOKENS);
+            TEST_ASSERT_TRUE(count >= 0 || count == JSON_ERROR_PART);
+            _check_result(js, cut, count);
+        }
+    }
+}
+
+static void
+test_fuzz_mutated_corpus(void)
+{
+    // Fixed seed, so a failure reproduces; each round mutates a corpus document a few times
+    uint32_t seed = 0x5eed;
+    char js[160];
+    for (int round = 0; round < FUZZ_ROUNDS; round++)
+    {
+        seed = seed * 1664525u + 1013904223u;
+        const char* base = json_corpus[(seed >> 8) % JSON_CORPUS_LEN];
+        size_t len = strlen(base);
+        memcpy(js, base, len);
+
+        int mutations = 1 + (seed >> 28) % 4;
+        for (int m = 0; m < mutations && len > 0; m++)
+        {
+            seed = seed * 1664525u + 1013904223u;
+            size_t at = (seed >> 8) % len;
+            switch ((seed >> 4) % 4)
+            {
+            case 0: // flip a bit
+                js[at] ^= (char)(1 << ((seed >> 20) % 8));
+                break;
+            case 1: // replace with a structural character
+                js[at] = "{}[]:,\"\\ tfn0-"[(seed >> 20) % 15];
+                break;
+            case 2: // delete
+                memmove(js + at, js + at + 1, len - at - 1);
+                len--;
+                break;
+            default: // truncate
+                len = at;
+                break;
+            }
+        }
+        js[len] = '\0';
+        _check_result(js, len, json_parse(js, len, tokens, MAX_TOKENS));
+    }
+}
+
+// Cost of handling one stream event: tokenize the envelope, find path and data, read data
+static void
+test_benchmark_envelope(void)
+{
+    const char* js = json_corpus[3];
+    size_t len = strlen(js);
+    int hits = 0;
+
+    int64_t start_us = esp_timer_get_time();
+    for (int i = 0; i < BENCH_EVENTS; i++)
+    {
+        int count = json_parse(js, len, tokens, MAX_TOKENS);
+        int data = json_object_get(js, tokens, count, 0, "data", 4);
+        int pc = json_object_get(js, tokens, count, data, "pc_switch", 9);
+        bool on = false;
+        if (json_object_get(js, tokens, count, 0, "path", 4) > 0
+            && json_get_bool(js, &tokens[pc], &on) == 0 && on)
+            hits++;
+    }
+    int64_t elapsed_us = esp_timer_get_time() - start_us;
+
+    TEST_ASSERT_EQUAL_INT(BENCH_EVENTS, hits);
+    char report[96];
+    snprintf(report, sizeof(report), "%.0f ns per event (%u-byte envelope)",
+             (double)elapsed_us * 1000.0 / BENCH_EVENTS, (unsigned)len);
+    TEST_MESSAGE(report);
+}
+
+void
+app_main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_envelope_gives_typed_values);
+    RUN_TEST(test_words_in_keys_and_paths_do_not_match_values);
+    RUN_TEST(test_nested_values_and_skip);
+    RUN_TEST(test_string_escapes_are_resolved);
+    RUN_TEST(test_null_and_primitives);
+    RUN_TEST(test_malformed_documents_are_rejected);
+    RUN_TEST(test_truncated_documents_are_partial);
+    RUN_TEST(test_token_arena_limit);
+    RUN_TEST(test_corpus_prefixes);
+    RUN_TEST(test_fuzz_mutated_corpus);
+    RUN_TEST(test_benchmark_envelope);
+    exit(UNITY_END());
+}
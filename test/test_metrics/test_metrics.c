@@ -0,0 +1,192 @@
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unity.h>
+
+#include "esp_timer.h"
+#include "metrics.h"
+
+#define BENCH_OPS 2000000
+#define BENCH_THREADS 4
+
+static char page[8192];
+static size_t page_len;
+
+void
+setUp(void)
+{
+    page_len = 0;
+}
+
+void
+tearDown(void)
+{
+}
+
+static bool
+_collect(void* ctx, const char* text, size_t len)
+{
+    (void)ctx;
+    TEST_ASSERT_TRUE(page_len + len < sizeof(page));
+    memcpy(page + page_len, text, len);
+    page_len += len;
+    page[page_len] = '\0';
+    return true;
+}
+
+static void
+test_create_returns_the_same_metric(void)
+{
+    metric_t* a = metrics_counter("test_requests", "method=\"GET\"", "Requests");
+    metric_t* b = metrics_counter("test_requests", "method=\"PUT\"", "Requests");
+    TEST_ASSERT_NOT_NULL(a);
+    TEST_ASSERT_NOT_NULL(b);
+    TEST_ASSERT_TRUE(a != b);
+    TEST_ASSERT_TRUE(a == metrics_counter("test_requests", "method=\"GET\"", "Requests"));
+
+    // A name keeps its type
+    TEST_ASSERT_NULL(metrics_gauge("test_requests", "method=\"POST\"", "Requests"));
+}
+
+static void
+test_updates_accept_null(void)
+{
+    metrics_inc(NULL);
+    metrics_add(NULL, 5);
+    metrics_set(NULL, 5);
+    metrics_observe(NULL, 5);
+}
+
+static void
+test_histogram_buckets(void)
+{
+    metric_t* hist = metrics_histogram("test_latency_us", NULL, "Latency");
+    metrics_observe(hist, 0);
+    metrics_observe(hist, METRICS_HIST_MIN);
+    metrics_observe(hist, METRICS_HIST_MIN + 1);
+    metrics_observe(hist, metrics_bucket_bound(METRICS_HIST_BUCKETS - 1));
+    metrics_observe(hist, metrics_bucket_bound(METRICS_HIST_BUCKETS - 1) + 1);
+
+    TEST_ASSERT_EQUAL_UINT32(2, atomic_load(&hist->buckets[0]));
+    TEST_ASSERT_EQUAL_UINT32(1, atomic_load(&hist->buckets[1]));
+    TEST_ASSERT_EQUAL_UINT32(1, atomic_load(&hist->buckets[METRICS_HIST_BUCKETS - 1]));
+    TEST_ASSERT_EQUAL_UINT32(1, atomic_load(&hist->buckets[METRICS_HIST_BUCKETS]));
+    TEST_ASSERT_EQUAL_INT32(5, atomic_load(&hist->value));
+}
+
+static void
+test_prometheus_text(void)
+{
+    metric_t* get = metrics_counter("test_page_hits", "page=\"a\"", "Page hits");
+    metric_t* put = metrics_counter("test_page_hits", "page=\"b\"", "Page hits");
+    metrics_add(get, 3);
+    metrics_inc(put);
+
+    TEST_ASSERT_TRUE(metrics_write_prometheus(_collect, NULL));
+    // One header for both label sets
+    const char* header = "# HELP test_page_hits_total Page hits\n"
+                         "# TYPE test_page_hits_total counter\n"
+                         "test_page_hits_total{page=\"a\"} 3\n"
+                         "test_page_hits_total{page=\"b\"} 1\n";
+    TEST_ASSERT_NOT_NULL(strstr(page, header));
+    TEST_ASSERT_NOT_NULL(strstr(page, "test_latency_us_bucket{le=\"+Inf\"} 5\n"));
+    TEST_ASSERT_NOT_NULL(strstr(page, "test_latency_us_count 5\n"));
+}
+
+typedef struct
+{
+    metric_t* counter;
+    metric_t* hist;
+} bench_arg_t;
+
+static void*
+_bench_worker(void* arg)
+{
+    const bench_arg_t* bench = (const bench_arg_t*)arg;
+    for (uint32_t i = 0; i < BENCH_OPS; i++)
+    {
+        metrics_inc(bench->counter);
+        metrics_observe(bench->hist, i & 0xffff);
+    }
+    return NULL;
+}
+
+static double
+_ns_per_op(int64_t elapsed_us, uint32_t ops)
+{
+    return (double)elapsed_us * 1000.0 / ops;
+}
+
+// Cost of the instrumentation itself: one counter increment and one histogram observation,
+// alone and with every thread hammering the same two metrics
+static void
+test_benchmark_updates(void)
+{
+    bench_arg_t bench = {
+        metrics_counter("bench_ops", NULL, "Benchmark operations"),
+        metrics_histogram("bench_value", NULL, "Benchmark values"),
+    };
+
+    int64_t start_us = esp_timer_get_time();
+    for (uint32_t i = 0; i < BENCH_OPS; i++)
+        metrics_inc(bench.counter);
+    double inc_ns = _ns_per_op(esp_timer_get_time() - start_us, BENCH_OPS);
+
+    start_us = esp_timer_get_time();
+    for (uint32_t i = 0; i < BENCH_OPS; i++)
+        metrics_observe(bench.hist, i & 0xffff);
+    double observe_ns = _ns_per_op(esp_timer_get_time() - start_us, BENCH_OPS);
+
+    pthread_t threads[BENCH_THREADS];
+    start_us = esp_timer_get_time();
+    for (int t = 0; t < BENCH_THREADS; t++)
+        pthread_create(&threads[t], NULL, _bench_worker, &bench);
+    for (int t = 0; t < BENCH_THREADS; t++)
+        pthread_join(threads[t], NULL);
+    double contended_ns = _ns_per_op(esp_timer_get_time() - start_us, BENCH_OPS);
+
+    // No update is lost under contention
+    TEST_ASSERT_EQUAL_INT32((BENCH_THREADS + 1) * BENCH_OPS, atomic_load(&bench.counter->value));
+    TEST_ASSERT_EQUAL_INT32((BENCH_THREADS + 1) * BENCH_OPS, atomic_load(&bench.hist->value));
+
+    char report[160];
+    snprintf(report, sizeof(report),
+             "inc %.1f ns, observe %.1f ns, inc + observe on %d threads %.1f ns per round",
+             inc_ns, observe_ns, BENCH_THREADS, contended_ns);
+    TEST_MESSAGE(report);
+}
+
+// Runs last: it fills the table for the rest of the process
+static void
+test_full_table_returns_null(void)
+{
+    static char labels[METRICS_MAX][16];
+    metric_t* first = metrics_counter("test_requests", "method=\"GET\"", "Requests");
+
+    int created = metrics_count();
+    for (int i = 0; created < METRICS_MAX; i++, created++)
+    {
+        snprintf(labels[i], sizeof(labels[i]), "n=\"%d\"", i);
+        TEST_ASSERT_NOT_NULL(metrics_gauge("test_filler", labels[i], "Filler"));
+    }
+    TEST_ASSERT_NULL(metrics_gauge("test_overflow", NULL, "Does not fit"));
+    TEST_ASSERT_NULL(metrics_histogram("test_overflow_hist", NULL, "Does not fit either"));
+    TEST_ASSERT_EQUAL_INT(METRICS_MAX, metrics_count());
+
+    // Existing metrics are still found
+    TEST_ASSERT_TRUE(first == metrics_counter("test_requests", "method=\"GET\"", "Requests"));
+}
+
+void
+app_main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_create_returns_the_same_metric);
+    RUN_TEST(test_updates_accept_null);
+    RUN_TEST(test_histogram_buckets);
+    RUN_TEST(test_prometheus_text);
+    RUN_TEST(test_benchmark_updates);
+    RUN_TEST(test_full_table_returns_null);
+    exit(UNITY_END());
+}
@@ -0,0 +1,266 @@
+#include <stdlib.h>
+#include <string.h>
+#include <unity.h>
+
+#include "sensor_sched.h"
+
+#define MAX_SAMPLES 64
+
+// Driver with scripted values; reads are logged against the virtual clock
+typedef struct
+{
+    float value;
+    int value_count;
+    bool fail_init;
+    bool fail_read;
+    int64_t read_cost_ms;
+    int64_t read_ms[MAX_SAMPLES];
+    int reads;
+} mock_sensor_t;
+
+static sensor_sched_t sched;
+static int64_t now_ms;
+static int published;
+static int flushes;
+static float last_value;
+
+static int
+_mock_init(void* ctx)
+{
+    return ((mock_sensor_t*)ctx)->fail_init ? -1 : 0;
+}
+
+static int
+_mock_read(void* ctx)
+{
+    mock_sensor_t* mock = (mock_sensor_t*)ctx;
+    if (mock->reads < MAX_SAMPLES)
+        mock->read_ms[mock->reads] = now_ms;
+    mock->reads++;
+    // A slow bus transfer holds the scheduler task
+    now_ms += mock->read_cost_ms;
+    return mock->fail_read ? -1 : 0;
+}
+
+static int
+_mock_decode(void* ctx, sensor_value_t* values, int max_values)
+{
+    mock_sensor_t* mock = (mock_sensor_t*)ctx;
+    int count = mock->value_count < max_values ? mock->value_count : max_values;
+    for (int i = 0; i < count; i++)
+        values[i] = (sensor_value_t){.name = "v", .value = mock->value + i};
+    return count;
+}
+
+static const sensor_driver_t mock_driver = {
+    .name = "mock",
+    .init = _mock_init,
+    .read = _mock_read,
+    .decode = _mock_decode,
+};
+
+static void
+_publish(const sensor_t* sensor, int index, const sensor_value_t* value, void* user_ctx)
+{
+    (void)sensor;
+    (void)index;
+    (void)user_ctx;
+    published++;
+    last_value = value->value;
+}
+
+static void
+_flush(void* user_ctx)
+{
+    (void)user_ctx;
+    flushes++;
+}
+
+// Runs the scheduler like the sensor task: sleep until the next due time, then run a pass
+static void
+_run_until(int64_t end_ms)
+{
+    while (now_ms <= end_ms)
+    {
+        int64_t next_ms = sensor_sched_run(&sched, now_ms);
+        if (next_ms > now_ms)
+            now_ms = next_ms;
+    }
+}
+
+void
+setUp(void)
+{
+    now_ms = 0;
+    published = 0;
+    flushes = 0;
+    sensor_sched_init(&sched, 0, _publish, _flush, NULL);
+}
+
+void
+tearDown(void)
+{
+}
+
+static void
+test_multiples_share_a_pass(void)
+{
+    mock_sensor_t fast = {.value_count = 1};
+    mock_sensor_t slow = {.value_count = 2};
+    TEST_ASSERT_EQUAL_INT(0, sensor_sched_add(&sched, &mock_driver, &fast, "fast", 2000, NULL,
+                                              now_ms));
+    TEST_ASSERT_EQUAL_INT(1, sensor_sched_add(&sched, &mock_driver, &slow, "slow", 6000, NULL,
+                                              now_ms));
+    _run_until(59999);
+
+    TEST_ASSERT_EQUAL_INT(30, fast.reads);
+    TEST_ASSERT_EQUAL_INT(10, slow.reads);
+    for (int i = 0; i < fast.reads; i++)
+        TEST_ASSERT_EQUAL_INT64(i * 2000, fast.read_ms[i]);
+    // Every slow sample lands in a fast pass, so there is one flush per pass
+    for (int i = 0; i < slow.reads; i++)
+        TEST_ASSERT_EQUAL_INT64(i * 6000, slow.read_ms[i]);
+    TEST_ASSERT_EQUAL_INT(30, flushes);
+    TEST_ASSERT_EQUAL_INT(30 + 2 * 10, published);
+}
+
+static void
+test_sensors_due_within_the_window_are_aligned(void)
+{
+    mock_sensor_t a = {.value_count = 1};
+    mock_sensor_t b = {.value_count = 1};
+    sensor_sched_add(&sched, &mock_driver, &a, "a", 5000, NULL, now_ms);
+
+    // Added 600 ms after the epoch: still part of the first pass, then on the common grid
+    now_ms = 600;
+    sensor_sched_add(&sched, &mock_driver, &b, "b", 5000, NULL, now_ms);
+    now_ms = 0;
+    _run_until(14999);
+
+    TEST_ASSERT_EQUAL_INT(3, a.reads);
+    TEST_ASSERT_EQUAL_INT(3, b.reads);
+    for (int i = 0; i < 3; i++)
+        TEST_ASSERT_EQUAL_INT64(a.read_ms[i], b.read_ms[i]);
+    TEST_ASSERT_EQUAL_INT(3, flushes);
+}
+
+static void
+test_late_sensor_joins_the_grid(void)
+{
+    mock_sensor_t a = {.value_count = 1};
+    mock_sensor_t late = {.value_count = 1};
+    sensor_sched_add(&sched, &mock_driver, &a, "a", 4000, NULL, now_ms);
+    _run_until(9000);
+
+    sensor_sched_add(&sched, &mock_driver, &late, "late", 4000, NULL, now_ms);
+    _run_until(20000);
+    TEST_ASSERT_EQUAL_INT64(12000, late.read_ms[0]);
+    TEST_ASSERT_EQUAL_INT64(16000, late.read_ms[1]);
+}
+
+static void
+test_missed_slots_are_skipped(void)
+{
+    mock_sensor_t slow_bus = {.value_count = 1, .read_cost_ms = 4500};
+    sensor_sched_add(&sched, &mock_driver, &slow_bus, "bus", 1000, NULL, now_ms);
+    _run_until(20000);
+
+    // Each read overruns four slots; they are dropped, not run back to back to catch up
+    TEST_ASSERT_EQUAL_INT(5, slow_bus.reads);
+    for (int i = 1; i < slow_bus.reads; i++)
+        TEST_ASSERT_EQUAL_INT64(4500, slow_bus.read_ms[i] - slow_bus.read_ms[i - 1]);
+
+    // A long stall (the task was starved) costs one sample, not a burst
+    int reads = slow_bus.reads;
+    slow_bus.read_cost_ms = 0;
+    now_ms += 60000;
+    int64_t next_ms = sensor_sched_run(&sched, now_ms);
+    TEST_ASSERT_EQUAL_INT(reads + 1, slow_bus.reads);
+    TEST_ASSERT_GREATER_THAN(now_ms, next_ms);
+    TEST_ASSERT_EQUAL_INT64(0, next_ms % 1000);
+}
+
+static void
+test_failures_publish_nothing(void)
+{
+    mock_sensor_t broken = {.value_count = 1, .fail_read = true};
+    mock_sensor_t empty = {.value_count = -1};
+    int a = sensor_sched_add(&sched, &mock_driver, &broken, "broken", 1000, NULL, now_ms);
+    int b = sensor_sched_add(&sched, &mock_driver, &empty, "empty", 1000, NULL, now_ms);
+    _run_until(4999);
+
+    TEST_ASSERT_EQUAL_INT(5, sched.sensors[a].failures);
+    TEST_ASSERT_EQUAL_INT(5, sched.sensors[b].failures);
+    TEST_ASSERT_EQUAL_INT(0, sched.sensors[a].reads);
+    TEST_ASSERT_EQUAL_INT(0, published);
+    TEST_ASSERT_EQUAL_INT(0, flushes);
+
+    // Still sampled on schedule, so it recovers on the next slot
+    broken.fail_read = false;
+    _run_until(5000);
+    TEST_ASSERT_EQUAL_INT(1, published);
+}
+
+static void
+test_report_policy_holds_back_samples(void)
+{
+    static const sensor_report_cfg_t report = {
+        .deadband = {1.0f},
+        .heartbeat_ms = 10000,
+        .filter = SENSOR_FILTER_NONE,
+        .filter_len = 1,
+    };
+    mock_sensor_t steady = {.value = 20.0f, .value_count = 1};
+    int index = sensor_sched_add(&sched, &mock_driver, &steady, "steady", 1000, &report, now_ms);
+    _run_until(9999);
+
+    // The first sample is reported, the unchanged ones are not
+    TEST_ASSERT_EQUAL_INT(10, steady.reads);
+    TEST_ASSERT_EQUAL_INT(1, published);
+    TEST_ASSERT_EQUAL_INT(9, sched.sensors[index].suppressed);
+    TEST_ASSERT_EQUAL_INT(1, flushes);
+
+    // The heartbeat is due on the grid at 10 s
+    _run_until(10000);
+    TEST_ASSERT_EQUAL_INT(2, published);
+
+    // A step past the deadband goes out at once
+    steady.value = 21.5f;
+    _run_until(11000);
+    TEST_ASSERT_EQUAL_INT(3, published);
+    TEST_ASSERT_EQUAL_FLOAT(21.5f, last_value);
+}
+
+static void
+test_add_rejects_bad_sensors(void)
+{
+    mock_sensor_t mocks[SENSOR_MAX + 1] = {0};
+    mock_sensor_t broken = {.fail_init = true};
+    TEST_ASSERT_EQUAL_INT(-1, sensor_sched_add(&sched, &mock_driver, &broken, "x", 1000, NULL,
+                                               now_ms));
+    TEST_ASSERT_EQUAL_INT(-1, sensor_sched_add(&sched, &mock_driver, &mocks[0], "x", 0, NULL,
+                                               now_ms));
+    for (int i = 0; i < SENSOR_MAX; i++)
+        TEST_ASSERT_EQUAL_INT(i, sensor_sched_add(&sched, &mock_driver, &mocks[i], "x", 1000,
+                                                  NULL, now_ms));
+    TEST_ASSERT_EQUAL_INT(-1, sensor_sched_add(&sched, &mock_driver, &mocks[SENSOR_MAX], "x",
+                                               1000, NULL, now_ms));
+
+    sensor_sched_t empty;
+    sensor_sched_init(&empty, 0, _publish, NULL, NULL);
+    TEST_ASSERT_EQUAL_INT64(INT64_MAX, sensor_sched_run(&empty, now_ms));
+}
+
+void
+app_main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_multiples_share_a_pass);
+    RUN_TEST(test_sensors_due_within_the_window_are_aligned);
+    RUN_TEST(test_late_sensor_joins_the_grid);
+    RUN_TEST(test_missed_slots_are_skipped);
+    RUN_TEST(test_failures_publish_nothing);
+    RUN_TEST(test_report_policy_holds_back_samples);
+    RUN_TEST(test_add_rejects_bad_sensors);
+    exit(UNITY_END());
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+// Event stream of /CONTROLS recorded from tools/mock_rtdb.py (--keepalive-s 1), which sends
+// the events of the Firebase REST streaming API: the initial put, puts, a patch, keep-alives.
+static const char firebase_capture[] =
+    "event: put\n"
+    "data: {\"path\":\"/\",\"data\":{\"pc_switch\":false,\"label\":\"desk\"}}\n"
+    "\n"
+    "event: put\n"
+    "data: {\"path\":\"/pc_switch\",\"data\":true}\n"
+    "\n"
+    "event: put\n"
+    "data: {\"path\":\"/pc_switch\",\"data\":false}\n"
+    "\n"
+    "event: patch\n"
+    "data: {\"path\":\"/\",\"data\":{\"pc_switch\":true,\"fan\":{\"speed\":3,\"mode\":\"auto\"}}}\n"
+    "\n"
+    "event: keep-alive\n"
+    "data: null\n"
+    "\n"
+    "event: put\n"
+    "data: {\"path\":\"/label\",\"data\":\"hello \\\"world\\\"\"}\n"
+    "\n"
+    "event: put\n"
+    "data: {\"path\":\"/fan\",\"data\":null}\n"
+    "\n"
+    "event: keep-alive\n"
+    "data: null\n"
+    "\n";
+
+/** @brief Events in firebase_capture. */
+#define FIREBASE_CAPTURE_EVENTS 8
@@ -0,0 +1,234 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unity.h>
+
+#include "esp_timer.h"
+#include "firebase_capture.h"
+#include "sse_parser.h"
+
+#define MAX_EVENTS 16
+// The stream task's buffer and read size
+#define STREAM_BUFFER_SIZE 1024
+#define BENCH_BYTES (8 * 1024 * 1024)
+
+typedef struct
+{
+    int count;
+    char name[MAX_EVENTS][SSE_EVENT_NAME_MAX];
+    char data[MAX_EVENTS][160];
+    bool truncated[MAX_EVENTS];
+} collected_t;
+
+static collected_t got;
+static char buffer[STREAM_BUFFER_SIZE];
+static sse_parser_t parser;
+
+static void
+_collect(const sse_event_t* event, void* user_ctx)
+{
+    collected_t* out = user_ctx;
+    if (out->count >= MAX_EVENTS)
+        return;
+    snprintf(out->name[out->count], sizeof(out->name[0]), "%s", event->event);
+    snprintf(out->data[out->count], sizeof(out->data[0]), "%s", event->data);
+    TEST_ASSERT_EQUAL(strlen(event->data), event->data_len);
+    out->truncated[out->count] = event->truncated;
+    out->count++;
+}
+
+static void
+_count(const sse_event_t* event, void* user_ctx)
+{
+    (void)event;
+    (*(int*)user_ctx)++;
+}
+
+void
+setUp(void)
+{
+    memset(&got, 0, sizeof(got));
+    sse_parser_init(&parser, buffer, sizeof(buffer), _collect, &got);
+}
+
+void
+tearDown(void)
+{
+}
+
+// Feeds data through the zero-copy interface in reads of at most chunk bytes
+static void
+_feed_chunked(const char* data, size_t len, size_t chunk)
+{
+    while (len > 0)
+    {
+        size_t avail;
+        char* dst = sse_parser_write_ptr(&parser, &avail);
+        size_t n = len < chunk ? len : chunk;
+        if (n > avail)
+            n = avail;
+        memcpy(dst, data, n);
+        sse_parser_commit(&parser, n);
+        data += n;
+        len -= n;
+    }
+}
+
+static void
+_assert_capture_events(void)
+{
+    TEST_ASSERT_EQUAL_INT(FIREBASE_CAPTURE_EVENTS, got.count);
+    TEST_ASSERT_EQUAL_STRING("put", got.name[0]);
+    TEST_ASSERT_EQUAL_STRING("{\"path\":\"/\",\"data\":{\"pc_switch\":false,\"label\":\"desk\"}}",
+                             got.data[0]);
+    TEST_ASSERT_EQUAL_STRING("{\"path\":\"/pc_switch\",\"data\":true}", got.data[1]);
+    TEST_ASSERT_EQUAL_STRING("patch", got.name[3]);
+    TEST_ASSERT_EQUAL_STRING("keep-alive", got.name[4]);
+    TEST_ASSERT_EQUAL_STRING("null", got.data[4]);
+    TEST_ASSERT_EQUAL_STRING("{\"path\":\"/label\",\"data\":\"hello \\\"world\\\"\"}", got.data[5]);
+    TEST_ASSERT_EQUAL_STRING("keep-alive", got.name[7]);
+    for (int i = 0; i < got.count; i++)
+        TEST_ASSERT_FALSE(got.truncated[i]);
+}
+
+static void
+test_capture_in_one_read(void)
+{
+    _feed_chunked(firebase_capture, strlen(firebase_capture), sizeof(buffer));
+    _assert_capture_events();
+    TEST_ASSERT_EQUAL_UINT32(FIREBASE_CAPTURE_EVENTS, parser.events);
+}
+
+static void
+test_capture_byte_by_byte(void)
+{
+    _feed_chunked(firebase_capture, strlen(firebase_capture), 1);
+    _assert_capture_events();
+}
+
+static void
+test_capture_in_random_reads(void)
+{
+    // Reads end anywhere: inside field names, between \r and \n, inside the blank line
+    uint32_t seed = 12345;
+    for (int round = 0; round < 50; round++)
+    {
+        setUp();
+        const char* data = firebase_capture;
+        size_t len = strlen(firebase_capture);
+        while (len > 0)
+        {
+            seed = seed * 1103515245u + 12345u;
+            size_t n = 1 + (seed >> 16) % 40;
+            if (n > len)
+                n = len;
+            sse_parser_feed(&parser, data, n);
+            data += n;
+            len -= n;
+        }
+        _assert_capture_events();
+    }
+}
+
+static void
+test_multiline_data_is_joined(void)
+{
+    const char* text = "event: put\ndata: first\ndata:second\ndata: third\n\n";
+    sse_parser_feed(&parser, text, strlen(text));
+    TEST_ASSERT_EQUAL_INT(1, got.count);
+    TEST_ASSERT_EQUAL_STRING("first\nsecond\nthird", got.data[0]);
+}
+
+static void
+test_crlf_line_endings(void)
+{
+    const char* text = "event: put\r\ndata: {\"a\":1}\r\n\r\n";
+    sse_parser_feed(&parser, text, strlen(text));
+    TEST_ASSERT_EQUAL_INT(1, got.count);
+    TEST_ASSERT_EQUAL_STRING("put", got.name[0]);
+    TEST_ASSERT_EQUAL_STRING("{\"a\":1}", got.data[0]);
+}
+
+static void
+test_comments_and_other_fields_are_ignored(void)
+{
+    const char* text = ": comment\nid: 7\nretry: 100\ndata: x\n\n\n\n";
+    sse_parser_feed(&parser, text, strlen(text));
+    TEST_ASSERT_EQUAL_INT(1, got.count);
+    TEST_ASSERT_EQUAL_STRING("message", got.name[0]);
+    TEST_ASSERT_EQUAL_STRING("x", got.data[0]);
+}
+
+static void
+test_event_larger_than_buffer_is_reported_truncated(void)
+{
+    static char small[64];
+    sse_parser_init(&parser, small, sizeof(small), _collect, &got);
+
+    char text[400];
+    int len = snprintf(text, sizeof(text), "event: put\ndata: ");
+    memset(text + len, 'x', 300);
+    len += 300;
+    len += snprintf(text + len, sizeof(text) - len, "\n\nevent: put\ndata: ok\n\n");
+    _feed_chunked(text, (size_t)len, 16);
+
+    TEST_ASSERT_EQUAL_INT(2, got.count);
+    TEST_ASSERT_TRUE(got.truncated[0]);
+    TEST_ASSERT_EQUAL_STRING("", got.data[0]);
+    TEST_ASSERT_FALSE(got.truncated[1]);
+    TEST_ASSERT_EQUAL_STRING("ok", got.data[1]);
+    TEST_ASSERT_EQUAL_UINT32(1, parser.overflows);
+}
+
+static void
+test_reset_discards_partial_event(void)
+{
+    const char* partial = "event: put\ndata: {\"path\":\"/pc_sw";
+    sse_parser_feed(&parser, partial, strlen(partial));
+    sse_parser_reset(&parser);
+    const char* next = "event: put\ndata: fresh\n\n";
+    sse_parser_feed(&parser, next, strlen(next));
+    TEST_ASSERT_EQUAL_INT(1, got.count);
+    TEST_ASSERT_EQUAL_STRING("fresh", got.data[0]);
+}
+
+// Throughput of the recorded capture, read the way the stream task reads (up to a full
+// buffer per read), and the average parse cost per event
+static void
+test_benchmark_capture_throughput(void)
+{
+    int events = 0;
+    sse_parser_init(&parser, buffer, sizeof(buffer), _count, &events);
+    size_t cap_len = strlen(firebase_capture);
+    size_t rounds = BENCH_BYTES / cap_len;
+
+    int64_t start_us = esp_timer_get_time();
+    for (size_t i = 0; i < rounds; i++)
+        _feed_chunked(firebase_capture, cap_len, sizeof(buffer));
+    int64_t elapsed_us = esp_timer_get_time() - start_us;
+    if (elapsed_us < 1)
+        elapsed_us = 1;
+
+    TEST_ASSERT_EQUAL_INT((int)(rounds * FIREBASE_CAPTURE_EVENTS), events);
+    char report[128];
+    snprintf(report, sizeof(report), "%.1f MB/s, %.0f ns per event (%d events)",
+             (double)(rounds * cap_len) / (double)elapsed_us,
+             (double)elapsed_us * 1000.0 / events, events);
+    TEST_MESSAGE(report);
+}
+
+void
+app_main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_capture_in_one_read);
+    RUN_TEST(test_capture_byte_by_byte);
+    RUN_TEST(test_capture_in_random_reads);
+    RUN_TEST(test_multiline_data_is_joined);
+    RUN_TEST(test_crlf_line_endings);
+    RUN_TEST(test_comments_and_other_fields_are_ignored);
+    RUN_TEST(test_event_larger_than_buffer_is_reported_truncated);
+    RUN_TEST(test_reset_discards_partial_event);
+    RUN_TEST(test_benchmark_capture_throughput);
+    exit(UNITY_END());
+}
@@ -0,0 +1,272 @@
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+#include <unity.h>
+
+#include "esp_event.h"
+#include "esp_wifi.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "web_server.h"
+#include "wifi_prov_api.h"
+
+// Two access points of "home", the weaker one last, and an open "cafe"
+#define SIM_NETWORKS "home:secret:-40:6,cafe::-70:1,home:secret:-80:11"
+#define SIM_SCAN_MS "100"
+#define SIM_CONNECT_MS "100"
+#define RESPONSE_MAX 2048
+
+static int server_port;
+
+void
+setUp(void)
+{
+}
+
+void
+tearDown(void)
+{
+}
+
+static int
+_free_port(void)
+{
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in addr = {.sin_family = AF_INET, .sin_addr.s_addr = htonl(INADDR_LOOPBACK)};
+    socklen_t len = sizeof(addr);
+    bind(fd, (struct sockaddr*)&addr, sizeof(addr));
+    getsockname(fd, (struct sockaddr*)&addr, &len);
+    close(fd);
+    return ntohs(addr.sin_port);
+}
+
+static int64_t
+_now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+// Feeds the Wi-Fi events to the API the way wifi_provisioning does
+static void
+_wifi_event_handler(void* arg, esp_event_base_t event_base, int32_t event_id, void* event_data)
+{
+    (void)arg;
+    if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_SCAN_DONE)
+    {
+        wifi_prov_api_on_scan_done();
+    }
+    else if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_DISCONNECTED)
+    {
+        wifi_event_sta_disconnected_t* event = event_data;
+        wifi_prov_api_on_disconnected(event->reason);
+    }
+    else if (event_base == IP_EVENT && event_id == IP_EVENT_STA_GOT_IP)
+    {
+        ip_event_got_ip_t* event = event_data;
+        wifi_prov_api_on_got_ip(&event->ip_info.ip);
+    }
+}
+
+// Sends one request on a new connection and reads the response until the server closes
+// it; returns the status code, or -1 if the server could not be reached
+static int
+_request(const char* method, const char* target, const char* body, char* response)
+{
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in addr = {
+        .sin_family = AF_INET,
+        .sin_port = htons(server_port),
+        .sin_addr.s_addr = htonl(INADDR_LOOPBACK),
+    };
+    if (connect(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0)
+    {
+        close(fd);
+        return -1;
+    }
+
+    char head[512];
+    snprintf(head, sizeof(head),
+             "%s %s HTTP/1.1\r\nHost: 192.168.4.1\r\n"
+             "Content-Type: application/x-www-form-urlencoded\r\n"
+             "Content-Length: %zu\r\n\r\n%s",
+             method, target, body != NULL ? strlen(body) : 0, body != NULL ? body : "");
+    send(fd, head, strlen(head), MSG_NOSIGNAL);
+
+    size_t len = 0;
+    ssize_t n;
+    while (len < RESPONSE_MAX - 1 && (n = recv(fd, response + len, RESPONSE_MAX - 1 - len, 0)) > 0)
+        len += (size_t)n;
+    response[len] = '\0';
+    close(fd);
+
+    int status = -1;
+    sscanf(response, "HTTP/1.1 %d", &status);
+    return status;
+}
+
+// Starts a job and returns its id
+static unsigned
+_connect(const char* params)
+{
+    char response[RESPONSE_MAX];
+    TEST_ASSERT_EQUAL_INT(202, _request("POST", "/connect", params, response));
+    TEST_ASSERT_NOT_NULL(strstr(response, "\"state\":\"connecting\""));
+
+    unsigned id = 0;
+    const char* field = strstr(response, "\"job\":");
+    TEST_ASSERT_NOT_NULL(field);
+    sscanf(field, "\"job\":%u", &id);
+    TEST_ASSERT_NOT_EQUAL(0, id);
+    return id;
+}
+
+// Long-polls the job until it finishes
+static void
+_wait_status(unsigned id, char* response)
+{
+    char target[64];
+    snprintf(target, sizeof(target), "/status?job=%u&wait=5", id);
+    TEST_ASSERT_EQUAL_INT(200, _request("GET", target, NULL, response));
+    TEST_MESSAGE(strstr(response, "{"));
+}
+
+static bool
+_start(void)
+{
+    wifi_init_config_t cfg = WIFI_INIT_CONFIG_DEFAULT();
+    if (esp_event_loop_create_default() != ESP_OK || esp_wifi_init(&cfg) != ESP_OK)
+        return false;
+    // The jobs' credentials are not kept
+    esp_wifi_set_storage(WIFI_STORAGE_RAM);
+
+    wifi_prov_api_init();
+    esp_event_handler_instance_t wifi_instance;
+    esp_event_handler_instance_t ip_instance;
+    esp_event_handler_instance_register(WIFI_EVENT, ESP_EVENT_ANY_ID, _wifi_event_handler, NULL,
+                                        &wifi_instance);
+    esp_event_handler_instance_register(IP_EVENT, IP_EVENT_STA_GOT_IP, _wifi_event_handler,
+                                        NULL, &ip_instance);
+
+    if (esp_wifi_set_mode(WIFI_MODE_APSTA) != ESP_OK || esp_wifi_start() != ESP_OK)
+        return false;
+    wifi_prov_api_start();
+    return web_server_start() == ESP_OK;
+}
+
+static void
+test_scan_waits_for_the_first_scan(void)
+{
+    char response[RESPONSE_MAX];
+    TEST_ASSERT_EQUAL_INT(200, _request("GET", "/scan?wait=5", NULL, response));
+
+    TEST_ASSERT_NOT_NULL(strstr(response, "\"scanning\":false"));
+    const char* home = strstr(response, "\"ssid\":\"home\",\"rssi\":-40,\"channel\":6");
+    const char* cafe = strstr(response, "\"ssid\":\"cafe\",\"rssi\":-70,\"channel\":1");
+    TEST_ASSERT_NOT_NULL(home);
+    TEST_ASSERT_NOT_NULL(cafe);
+    TEST_ASSERT_TRUE(home < cafe);
+    TEST_ASSERT_NULL(strstr(home + 1, "\"ssid\":\"home\""));
+    TEST_ASSERT_NOT_NULL(strstr(cafe, "\"secure\":false"));
+}
+
+static void
+test_wrong_password_fails_at_once(void)
+{
+    char response[RESPONSE_MAX];
+    unsigned id = _connect("ssid=home&password=wrong");
+    _wait_status(id, response);
+
+    TEST_ASSERT_NOT_NULL(strstr(response, "\"state\":\"failed\""));
+    TEST_ASSERT_NOT_NULL(strstr(response, "\"error\":\"auth_failed\""));
+    TEST_ASSERT_NOT_NULL(strstr(response, "\"attempts\":1"));
+}
+
+static void
+test_missing_network_fails_after_all_attempts(void)
+{
+    char response[RESPONSE_MAX];
+    unsigned id = _connect("ssid=nowhere&password=secret");
+    _wait_status(id, response);
+
+    TEST_ASSERT_NOT_NULL(strstr(response, "\"state\":\"failed\""));
+    TEST_ASSERT_NOT_NULL(strstr(response, "\"error\":\"no_ap_found\""));
+    TEST_ASSERT_NOT_NULL(strstr(response, "\"attempts\":3"));
+}
+
+static void
+test_long_poll_reports_the_address(void)
+{
+    char response[RESPONSE_MAX];
+    char target[32];
+    unsigned id = _connect("ssid=home&password=secret");
+
+    // Without a wait the running job is reported as it is
+    snprintf(target, sizeof(target), "/status?job=%u", id);
+    TEST_ASSERT_EQUAL_INT(200, _request("GET", target, NULL, response));
+    TEST_ASSERT_NOT_NULL(strstr(response, "\"state\":\"connecting\""));
+
+    int64_t started_ms = _now_ms();
+    _wait_status(id, response);
+    int64_t waited_ms = _now_ms() - started_ms;
+
+    TEST_ASSERT_NOT_NULL(strstr(response, "\"state\":\"connected\""));
+    TEST_ASSERT_NOT_NULL(strstr(response, "\"ip\":\"192.168.1.100\""));
+    // Answered when the job finished, not at the end of the wait
+    TEST_ASSERT_LESS_THAN_INT(2000, waited_ms);
+}
+
+static void
+test_new_job_supersedes_the_running_one(void)
+{
+    char response[RESPONSE_MAX];
+    unsigned first = _connect("ssid=nowhere&password=secret");
+    unsigned second = _connect("ssid=cafe");
+
+    _wait_status(first, response);
+    TEST_ASSERT_NOT_NULL(strstr(response, "\"error\":\"superseded\""));
+    _wait_status(second, response);
+    TEST_ASSERT_NOT_NULL(strstr(response, "\"state\":\"connected\""));
+    TEST_ASSERT_NOT_NULL(strstr(response, "\"ip\":\"192.168.1.101\""));
+}
+
+static void
+test_bad_requests_are_rejected(void)
+{
+    char response[RESPONSE_MAX];
+    TEST_ASSERT_EQUAL_INT(400, _request("POST", "/connect", "password=secret", response));
+    TEST_ASSERT_EQUAL_INT(400, _request("GET", "/status", NULL, response));
+    TEST_ASSERT_EQUAL_INT(404, _request("GET", "/status?job=9999&wait=5", NULL, response));
+}
+
+void
+app_main(void)
+{
+    char port[8];
+    server_port = _free_port();
+    snprintf(port, sizeof(port), "%d", server_port);
+    setenv("HTTPD_HOST_PORT", port, 1);
+    setenv("WIFI_SIM_NETWORKS", SIM_NETWORKS, 1);
+    setenv("WIFI_SIM_SCAN_MS", SIM_SCAN_MS, 1);
+    setenv("WIFI_SIM_CONNECT_MS", SIM_CONNECT_MS, 1);
+    if (!_start())
+    {
+        printf("Could not start the provisioning API\n");
+        exit(1);
+    }
+
+    UNITY_BEGIN();
+    RUN_TEST(test_scan_waits_for_the_first_scan);
+    RUN_TEST(test_wrong_password_fails_at_once);
+    RUN_TEST(test_missing_network_fails_after_all_attempts);
+    RUN_TEST(test_long_poll_reports_the_address);
+    RUN_TEST(test_new_job_supersedes_the_running_one);
+    RUN_TEST(test_bad_requests_are_rejected);
+    exit(UNITY_END());
+}
@@ -0,0 +1,183 @@
+#!/usr/bin/env python3
+"""Builds the captive portal assets in assets/portal into flash arrays.
+
+Every file is minified (comments and layout whitespace removed), gzip-compressed and written
+to src/portal_assets.c as a web_asset_t (see include/web_server.h) together with a weak ETag
+derived from the minified content. include/portal_assets.h declares one asset per file, named
+after it: ``portal_index_html`` for index.html. The compressed copy is left out when it is
+not smaller than the minified one, and files in UNCACHED get no ETag.
+
+PlatformIO runs this as a pre-build script; the generated files are committed, so plain
+ESP-IDF builds work without it. Files are only rewritten when their content changes, which
+keeps incremental builds incremental. ``--check`` fails if they are out of date.
+"""
+
+import argparse
+import gzip
+import hashlib
+import os
+import re
+import sys
+
+SOURCE_DIR = os.path.join("assets", "portal")
+HEADER_PATH = os.path.join("include", "portal_assets.h")
+SOURCE_PATH = os.path.join("src", "portal_assets.c")
+CONTENT_TYPES = {
+    ".html": "text/html; charset=utf-8",
+    ".css": "text/css",
+    ".js": "application/javascript",
+    ".txt": "text/plain",
+}
+# Bodies of responses that must not be cached, like the redirect sent to OS probe URLs
+UNCACHED = {"redirect.html"}
+BYTES_PER_LINE = 12
+# Style and script blocks, which HTML whitespace collapsing must not touch
+EMBEDDED = r"(<style[^>]*>.*?</style>|<script[^>]*>.*?</script>)"
+
+
+def _minify_css(css):
+    css = re.sub(r"/\*.*?\*/", "", css, flags=re.S)
+    css = re.sub(r"\s+", " ", css)
+    css = re.sub(r"\s*([{};:,>])\s*", r"\1", css)
+    return css.replace(";}", "}").strip()
+
+
+def _minify_js(js):
+    # Only block comments and indentation go: line breaks stay, since they can end statements
+    js = re.sub(r"/\*.*?\*/", "", js, flags=re.S)
+    return "\n".join(line.strip() for line in js.splitlines() if line.strip())
+
+
+def minify(name, text):
+    """Returns the minified text of an asset; HTML, CSS and JavaScript are rewritten."""
+    if name.endswith(".css"):
+        return _minify_css(text)
+    if name.endswith(".js"):
+        return _minify_js(text)
+    if not name.endswith(".html"):
+        return text
+
+    text = re.sub(r"<!--.*?-->", "", text, flags=re.S)
+    text = re.sub(
+        r"(<style[^>]*>)(.*?)(</style>)",
+        lambda m: m.group(1) + _minify_css(m.group(2)) + m.group(3),
+        text,
+        flags=re.S | re.I,
+    )
+    text = re.sub(
+        r"(<script[^>]*>)(.*?)(</script>)",
+        lambda m: m.group(1) + _minify_js(m.group(2)) + m.group(3),
+        text,
+        flags=re.S | re.I,
+    )
+    # Whitespace between tags is layout only; runs inside text collapse to one space
+    parts = re.split(EMBEDDED, text, flags=re.S | re.I)
+    for i in range(0, len(parts), 2):
+        parts[i] = re.sub(r"\s+", " ", parts[i])
+    return re.sub(r">\s+<", "><", "".join(parts)).strip()
+
+
+def _c_array(name, data):
+    lines = ["static const uint8_t %s[] = {" % name]
+    for i in range(0, len(data), BYTES_PER_LINE):
+        chunk = data[i : i + BYTES_PER_LINE]
+        lines.append("    " + " ".join("0x%02x," % b for b in chunk))
+    lines.append("};")
+    return lines
+
+
+def _symbol(filename):
+    return "portal_" + re.sub(r"[^0-9A-Za-z]", "_", filename)
+
+
+def render(sources):
+    """Returns the generated header and source text for {filename: content bytes}."""
+    header = [
+        "// Generated by tools/gen_assets.py from assets/portal; do not edit.",
+        "#pragma once",
+        "",
+        '#include "web_server.h"',
+        "",
+    ]
+    source = [
+        "// Generated by tools/gen_assets.py from assets/portal; do not edit.",
+        '#include "portal_assets.h"',
+    ]
+    for filename in sorted(sources):
+        symbol = _symbol(filename)
+        content_type = CONTENT_TYPES.get(os.path.splitext(filename)[1], "application/octet-stream")
+        plain = minify(filename, sources[filename].decode("utf-8")).encode("utf-8")
+        # mtime=0 keeps the output reproducible
+        packed = gzip.compress(plain, compresslevel=9, mtime=0)
+        etag = 'W/\\"%s\\"' % hashlib.sha1(plain).hexdigest()[:16]
+
+        sizes = (filename, len(plain), len(packed))
+        header.append("/** @brief %s: %d bytes minified, %d gzipped. */" % sizes)
+        header.append("extern const web_asset_t %s;" % symbol)
+
+        source.append("")
+        source.extend(_c_array(symbol + "_plain", plain))
+        use_gzip = len(packed) < len(plain)
+        if use_gzip:
+            source.append("")
+            source.extend(_c_array(symbol + "_gzip", packed))
+        source.append("")
+        source.append("const web_asset_t %s = {" % symbol)
+        source.append('    .content_type = "%s",' % content_type)
+        source.append("    .plain = %s_plain," % symbol)
+        source.append("    .plain_len = sizeof(%s_plain)," % symbol)
+        if use_gzip:
+            source.append("    .gzip = %s_gzip," % symbol)
+            source.append("    .gzip_len = sizeof(%s_gzip)," % symbol)
+        if filename not in UNCACHED:
+            source.append('    .etag = "%s",' % etag)
+        source.append("};")
+
+    return "\n".join(header) + "\n", "\n".join(source) + "\n"
+
+
+def generate(root, check=False):
+    """Regenerates the asset files under root; returns the paths that were (or would be)
+    rewritten."""
+    source_dir = os.path.join(root, SOURCE_DIR)
+    sources = {}
+    for filename in os.listdir(source_dir):
+        with open(os.path.join(source_dir, filename), "rb") as f:
+            sources[filename] = f.read()
+
+    changed = []
+    header, source = render(sources)
+    for path, text in ((HEADER_PATH, header), (SOURCE_PATH, source)):
+        full = os.path.join(root, path)
+        try:
+            with open(full, encoding="utf-8") as f:
+                if f.read() == text:
+                    continue
+        except FileNotFoundError:
+            pass
+        changed.append(path)
+        if not check:
+            with open(full, "w", encoding="utf-8", newline="\n") as f:
+                f.write(text)
+    return changed
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--check", action="store_true", help="fail if the files are stale")
+    args = parser.parse_args()
+
+    root = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+    changed = generate(root, args.check)
+    for path in changed:
+        print(("stale: " if args.check else "wrote ") + path)
+    return 1 if args.check and changed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
+else:
+    # PlatformIO pre-script: SCons provides Import() and env, but not __file__
+    Import("env")  # noqa: F821
+    for path in generate(env.subst("$PROJECT_DIR")):  # noqa: F821
+        print("gen_assets: wrote " + path)
@@ -0,0 +1,486 @@
+/**
+ * @file loadgen.c
+ * @brief Load driver for the host build.
+ *
+ * Replaces app_main() with a set of simulated devices that push traffic through the real
+ * Firebase client code against the mock server (tools/mock_rtdb.py) and reports throughput
+ * and latency percentiles. Configured through environment variables:
+ *
+ * - LOADGEN_MODE: "put" (one PUT per sample), "patch" (two values per batched PATCH),
+ *   "stream" (PUT a timestamp and measure until it arrives on the event stream), "get"
+ *   (read a large node), "get_etag" (read it conditionally with the last ETag; Firebase
+ *   still sends the body, only a mock started with --not-modified answers 304) or "dns"
+ *   (send the captive-portal DNS server A, AAAA and HTTPS queries in bursts, like a phone
+ *   joining the access point; the server listens on DNS_SERVER_PORT)
+ * - LOADGEN_NODE_BYTES: approximate size of the node read in the get modes (default 16384)
+ * - LOADGEN_DEVICES: number of simulated devices, each one task (default 100)
+ * - LOADGEN_SECONDS: test duration (default 10)
+ * - LOADGEN_RATE_HZ: writes (or DNS bursts) per second per device (default 1)
+ * - LOADGEN_TRACE: file to write the trace rings to at the end (see trace.h), for
+ *   tools/trace2json.py
+ *
+ * All devices share the client's connection pool, whose size is set with FIREBASE_POOL_SIZE.
+ * The last output line is a JSON summary for CI.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "connectivity.h"
+#include "dns_reply.h"
+#include "dns_server.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "firebase.h"
+#include "firebase_stream.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "lwip/inet.h"
+#include "lwip/sockets.h"
+#include "trace.h"
+
+#define LOADGEN_MAX_SAMPLES (1 << 20)
+#define LOADGEN_DRAIN_MS 2000
+#define LOADGEN_DNS_TIMEOUT_MS 1000
+#define LOADGEN_DNS_NAME "\x11" "connectivitycheck" "\x07" "gstatic" "\x03" "com"
+static const char* TAG = "loadgen";
+
+typedef enum
+{
+    LOADGEN_PUT,
+    LOADGEN_PATCH,
+    LOADGEN_STREAM,
+    LOADGEN_GET,
+    LOADGEN_GET_ETAG,
+    LOADGEN_DNS,
+} loadgen_mode_t;
+
+// Per-device state of the read modes
+typedef struct
+{
+    char* buf;
+    size_t buf_len;
+    char etag[FIREBASE_ETAG_MAX_LEN];
+} loadgen_reader_t;
+
+// Latencies of one operation kind, in microseconds
+typedef struct
+{
+    const char* name;
+    uint32_t* samples;
+    int count;
+    uint32_t ok;
+    uint32_t failed;
+} loadgen_hist_t;
+
+static loadgen_mode_t mode = LOADGEN_PUT;
+static int device_count = 100;
+static int duration_s = 10;
+static float rate_hz = 1.0f;
+static int node_bytes = 16384;
+
+static volatile bool running = true;
+static SemaphoreHandle_t hist_lock;
+static SemaphoreHandle_t devices_done;
+static loadgen_hist_t write_hist = {.name = "write"};
+static loadgen_hist_t read_hist = {.name = "read"};
+static loadgen_hist_t stream_hist = {.name = "stream"};
+static loadgen_hist_t dns_hist = {.name = "dns"};
+static uint64_t bytes_read;
+static uint32_t not_modified;
+
+static int
+_env_int(const char* name, int fallback)
+{
+    const char* value = getenv(name);
+    return (value != NULL && *value != '\0') ? atoi(value) : fallback;
+}
+
+static void
+_hist_record(loadgen_hist_t* hist, int64_t latency_us, bool ok)
+{
+    xSemaphoreTake(hist_lock, portMAX_DELAY);
+    if (ok)
+        hist->ok++;
+    else
+        hist->failed++;
+    if (ok && hist->count < LOADGEN_MAX_SAMPLES)
+        hist->samples[hist->count++] = (uint32_t)latency_us;
+    xSemaphoreGive(hist_lock);
+}
+
+static int
+_cmp_u32(const void* a, const void* b)
+{
+    uint32_t x = *(const uint32_t*)a;
+    uint32_t y = *(const uint32_t*)b;
+    return (x > y) - (x < y);
+}
+
+static double
+_percentile_ms(const loadgen_hist_t* hist, double p)
+{
+    if (hist->count == 0)
+        return 0.0;
+    int i = (int)(p / 100.0 * hist->count);
+    if (i >= hist->count)
+        i = hist->count - 1;
+    return hist->samples[i] / 1000.0;
+}
+
+static void
+_hist_report(loadgen_hist_t* hist, double elapsed_s, char* json, size_t json_len)
+{
+    qsort(hist->samples, hist->count, sizeof(uint32_t), _cmp_u32);
+
+    double throughput = hist->ok / elapsed_s;
+    printf("%-6s ok=%u failed=%u throughput=%.1f/s p50=%.2fms p90=%.2fms p99=%.2fms "
+           "max=%.2fms\n",
+           hist->name, hist->ok, hist->failed, throughput, _percentile_ms(hist, 50),
+           _percentile_ms(hist, 90), _percentile_ms(hist, 99), _percentile_ms(hist, 100));
+    snprintf(json, json_len,
+             "\"%s\":{\"ok\":%u,\"failed\":%u,\"throughput\":%.1f,\"p50_ms\":%.3f,"
+             "\"p90_ms\":%.3f,\"p99_ms\":%.3f,\"max_ms\":%.3f}",
+             hist->name, hist->ok, hist->failed, throughput, _percentile_ms(hist, 50),
+             _percentile_ms(hist, 90), _percentile_ms(hist, 99), _percentile_ms(hist, 100));
+}
+
+// Writes carry the send time, so the stream callback can measure the end-to-end delay
+static void
+_loadgen_stream_cb(const firebase_stream_update_t* update, void* user_ctx)
+{
+    (void)user_ctx;
+
+    double sent_us;
+    if (firebase_stream_get_number(update, &sent_us) != ESP_OK)
+        return;
+    _hist_record(&stream_hist, esp_timer_get_time() - (int64_t)sent_us, true);
+}
+
+static esp_err_t
+_device_read(loadgen_reader_t* reader)
+{
+    firebase_get_opts_t opts = {
+        .if_none_match = (mode == LOADGEN_GET_ETAG && reader->etag[0] != '\0') ? reader->etag
+                                                                               : NULL,
+    };
+    firebase_result_t result;
+
+    esp_err_t err = firebase_get_ex("loadgen/big", &opts, reader->buf, reader->buf_len, &result);
+    if (err == ESP_OK)
+    {
+        snprintf(reader->etag, sizeof(reader->etag), "%s", result.etag);
+        xSemaphoreTake(hist_lock, portMAX_DELAY);
+        bytes_read += result.body_len;
+        if (result.not_modified)
+            not_modified++;
+        xSemaphoreGive(hist_lock);
+    }
+    return err;
+}
+
+// Fills loadgen/big with numbered entries until it is about node_bytes long
+static esp_err_t
+_seed_big_node(void)
+{
+    char* json = malloc(node_bytes + 64);
+    size_t len = 0;
+
+    json[len++] = '{';
+    for (int i = 0; len < (size_t)node_bytes; i++)
+    {
+        len += snprintf(json + len, node_bytes + 64 - len, "\"k%05d\":%d,", i, i * 7);
+    }
+    json[len - 1] = '}';
+    json[len] = '\0';
+
+    esp_err_t err = firebase_put("loadgen/big", json);
+    free(json);
+    return err;
+}
+
+static esp_err_t
+_device_write(int id, firebase_batch_t* batch, uint32_t seq)
+{
+    char path[64];
+
+    switch (mode)
+    {
+    case LOADGEN_PATCH:
+        snprintf(path, sizeof(path), "loadgen/dev%04d/temperature", id);
+        firebase_batch_add(batch, path, 20.0f + (float)(seq % 10));
+        snprintf(path, sizeof(path), "loadgen/dev%04d/humidity", id);
+        firebase_batch_add(batch, path, 40.0f + (float)(seq % 20));
+        return firebase_batch_flush(batch);
+    case LOADGEN_STREAM:
+    {
+        char stamp[24];
+        snprintf(stamp, sizeof(stamp), "%lld", (long long)esp_timer_get_time());
+        snprintf(path, sizeof(path), "loadgen/echo/dev%04d", id);
+        return firebase_put(path, stamp);
+    }
+    default:
+        snprintf(path, sizeof(path), "loadgen/dev%04d/seq", id);
+        return firebase_put(path, (int)seq);
+    }
+}
+
+static int
+_dns_socket(void)
+{
+    int sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    struct sockaddr_in addr = {
+        .sin_family = AF_INET,
+        .sin_port = htons(DNS_SERVER_PORT),
+        .sin_addr.s_addr = htonl(INADDR_LOOPBACK),
+    };
+    struct timeval timeout = {
+        .tv_sec = LOADGEN_DNS_TIMEOUT_MS / 1000,
+        .tv_usec = (LOADGEN_DNS_TIMEOUT_MS % 1000) * 1000,
+    };
+    setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    connect(sock, (struct sockaddr*)&addr, sizeof(addr));
+    return sock;
+}
+
+// Checks a reply: the A query gets the portal address, the others an empty NOERROR answer
+static bool
+_dns_reply_ok(const uint8_t* reply, int len, uint16_t type)
+{
+    if (len < 12 || (reply[3] & 0x0f) != DNS_RCODE_NOERROR)
+        return false;
+    int answers = reply[6] << 8 | reply[7];
+    if (type != DNS_TYPE_A)
+        return answers == 0;
+    static const uint8_t portal[4] = {192, 168, 4, 1};
+    return answers == 1 && memcmp(reply + len - 4, portal, 4) == 0;
+}
+
+// Sends a phone-like burst of A, AAAA and HTTPS queries and times each reply
+static void
+_device_dns_burst(int sock, uint16_t id_base)
+{
+    static const uint16_t types[] = {DNS_TYPE_A, DNS_TYPE_AAAA, DNS_TYPE_HTTPS};
+    const int count = sizeof(types) / sizeof(types[0]);
+    int64_t sent_us[sizeof(types) / sizeof(types[0])];
+    bool answered[sizeof(types) / sizeof(types[0])] = {false};
+    uint8_t packet[DNS_MAX_PACKET];
+
+    for (int i = 0; i < count; i++)
+    {
+        static const uint8_t header[] = {0, 0, 0x01, 0x00, 0, 1, 0, 0, 0, 0, 0, 0};
+        const size_t name_len = sizeof(LOADGEN_DNS_NAME); // Includes the root label
+        memcpy(packet, header, sizeof(header));
+        packet[0] = (uint8_t)((id_base + i) >> 8);
+        packet[1] = (uint8_t)(id_base + i);
+        memcpy(packet + 12, LOADGEN_DNS_NAME, name_len);
+        uint8_t* tail = packet + 12 + name_len;
+        tail[0] = (uint8_t)(types[i] >> 8);
+        tail[1] = (uint8_t)types[i];
+        tail[2] = 0;
+        tail[3] = DNS_CLASS_IN;
+        sent_us[i] = esp_timer_get_time();
+        send(sock, packet, 12 + name_len + 4, 0);
+    }
+
+    for (int received = 0; received < count; received++)
+    {
+        int len = recv(sock, packet, sizeof(packet), 0);
+        if (len < 2)
+            break;
+        int i = (uint16_t)(packet[0] << 8 | packet[1]) - id_base;
+        if (i < 0 || i >= count || answered[i])
+            continue;
+        answered[i] = true;
+        _hist_record(&dns_hist, esp_timer_get_time() - sent_us[i],
+                     _dns_reply_ok(packet, len, types[i]));
+    }
+
+    for (int i = 0; i < count; i++)
+    {
+        if (!answered[i])
+            _hist_record(&dns_hist, 0, false);
+    }
+}
+
+static void
+_device_task(void* pvParameters)
+{
+    int id = (int)(intptr_t)pvParameters;
+    TickType_t period = pdMS_TO_TICKS(1000.0f / rate_hz);
+    if (period == 0)
+        period = 1;
+
+    // Staggered start so the devices do not fire in lockstep
+    vTaskDelay((TickType_t)(id * 7919) % period);
+
+    firebase_batch_t batch;
+    firebase_batch_init(&batch, FIREBASE_BATCH_MAX_ENTRIES, 0);
+    bool reading = (mode == LOADGEN_GET || mode == LOADGEN_GET_ETAG);
+    loadgen_reader_t reader = {0};
+    if (reading)
+    {
+        reader.buf_len = node_bytes + 1024;
+        reader.buf = malloc(reader.buf_len);
+    }
+
+    TickType_t last_wake = xTaskGetTickCount();
+    int dns_sock = mode == LOADGEN_DNS ? _dns_socket() : -1;
+    for (uint32_t seq = 0; running; seq++)
+    {
+        if (mode == LOADGEN_DNS)
+        {
+            _device_dns_burst(dns_sock, (uint16_t)(seq * 4));
+            vTaskDelayUntil(&last_wake, period);
+            continue;
+        }
+
+        int64_t start_us = esp_timer_get_time();
+        esp_err_t err = reading ? _device_read(&reader) : _device_write(id, &batch, seq);
+        _hist_record(reading ? &read_hist : &write_hist, esp_timer_get_time() - start_us,
+                     err == ESP_OK);
+        vTaskDelayUntil(&last_wake, period);
+    }
+
+    free(reader.buf);
+    if (dns_sock >= 0)
+        close(dns_sock);
+
+    xSemaphoreGive(devices_done);
+    vTaskDelete(NULL);
+}
+
+static bool
+_trace_file_write(void* ctx, const void* data, size_t len)
+{
+    return fwrite(data, 1, len, (FILE*)ctx) == len;
+}
+
+static void
+_loadgen_write_trace(const char* path)
+{
+    FILE* file = fopen(path, "wb");
+    if (file == NULL || !trace_dump(_trace_file_write, file))
+        ESP_LOGE(TAG, "Could not write the trace to %s", path);
+    if (file != NULL)
+        fclose(file);
+}
+
+void
+app_main(void)
+{
+    const char* mode_name = getenv("LOADGEN_MODE");
+    if (mode_name != NULL && strcmp(mode_name, "patch") == 0)
+        mode = LOADGEN_PATCH;
+    else if (mode_name != NULL && strcmp(mode_name, "stream") == 0)
+        mode = LOADGEN_STREAM;
+    else if (mode_name != NULL && strcmp(mode_name, "get") == 0)
+        mode = LOADGEN_GET;
+    else if (mode_name != NULL && strcmp(mode_name, "get_etag") == 0)
+        mode = LOADGEN_GET_ETAG;
+    else if (mode_name != NULL && strcmp(mode_name, "dns") == 0)
+        mode = LOADGEN_DNS;
+    else
+        mode_name = "put";
+
+    device_count = _env_int("LOADGEN_DEVICES", device_count);
+    duration_s = _env_int("LOADGEN_SECONDS", duration_s);
+    node_bytes = _env_int("LOADGEN_NODE_BYTES", node_bytes);
+    if (getenv("LOADGEN_RATE_HZ") != NULL)
+        rate_hz = strtof(getenv("LOADGEN_RATE_HZ"), NULL);
+    if (device_count <= 0 || duration_s <= 0 || rate_hz <= 0.0f || node_bytes <= 0)
+    {
+        ESP_LOGE(TAG, "Invalid configuration");
+        exit(2);
+    }
+
+    // Per-request logs would dominate the run time
+    esp_log_level_set("*", ESP_LOG_WARN);
+    esp_log_level_set(TAG, ESP_LOG_INFO);
+
+    write_hist.samples = malloc(LOADGEN_MAX_SAMPLES * sizeof(uint32_t));
+    stream_hist.samples = malloc(LOADGEN_MAX_SAMPLES * sizeof(uint32_t));
+    read_hist.samples = malloc(LOADGEN_MAX_SAMPLES * sizeof(uint32_t));
+    dns_hist.samples = malloc(LOADGEN_MAX_SAMPLES * sizeof(uint32_t));
+    hist_lock = xSemaphoreCreateMutex();
+    devices_done = xSemaphoreCreateCounting(device_count, 0);
+    firebase_init();
+    // The host network is up from the start
+    connectivity_init();
+    connectivity_link_up();
+
+    if (mode == LOADGEN_STREAM)
+    {
+        firebase_stream_subscribe("loadgen/echo", _loadgen_stream_cb, NULL);
+        xTaskCreate(firebase_stream_task, "FirebaseStream", 8192, NULL, 7, NULL);
+        // Let the stream deliver its initial snapshot before any device writes
+        vTaskDelay(pdMS_TO_TICKS(500));
+    }
+
+    if (mode == LOADGEN_DNS)
+    {
+        dns_server_start();
+        vTaskDelay(pdMS_TO_TICKS(200));
+    }
+
+    if ((mode == LOADGEN_GET || mode == LOADGEN_GET_ETAG) && _seed_big_node() != ESP_OK)
+    {
+        ESP_LOGE(TAG, "Could not write the node to read");
+        exit(1);
+    }
+
+    ESP_LOGI(TAG, "%s: %d devices at %.2f Hz for %d s, pool of %d", mode_name, device_count,
+             rate_hz, duration_s, FIREBASE_POOL_SIZE);
+
+    int64_t start_us = esp_timer_get_time();
+    for (int i = 0; i < device_count; i++)
+    {
+        xTaskCreate(_device_task, "Device", 4096, (void*)(intptr_t)i, 5, NULL);
+    }
+
+    vTaskDelay(pdMS_TO_TICKS(duration_s * 1000));
+    running = false;
+    for (int i = 0; i < device_count; i++)
+    {
+        xSemaphoreTake(devices_done, portMAX_DELAY);
+    }
+    double elapsed_s = (esp_timer_get_time() - start_us) / 1e6;
+    if (mode == LOADGEN_STREAM)
+        vTaskDelay(pdMS_TO_TICKS(LOADGEN_DRAIN_MS));
+
+    firebase_stats_t stats;
+    firebase_get_stats(&stats);
+    printf("client requests=%u failures=%u connects=%u bytes_read=%llu not_modified=%u\n",
+           stats.requests, stats.failures, stats.connects, (unsigned long long)bytes_read,
+           not_modified);
+
+    if (mode == LOADGEN_STREAM)
+    {
+        firebase_stream_stats_t stream_stats;
+        firebase_stream_get_stats(&stream_stats);
+        printf("stream connects=%u failures=%u duplicates=%u recovery=%ums max_recovery=%ums\n",
+               stream_stats.connects, stream_stats.failures, stream_stats.duplicates,
+               stream_stats.last_recovery_ms, stream_stats.max_recovery_ms);
+    }
+
+    char write_json[256];
+    char stream_json[256];
+    char read_json[256];
+    char dns_json[256];
+    _hist_report(&write_hist, elapsed_s, write_json, sizeof(write_json));
+    _hist_report(&stream_hist, elapsed_s, stream_json, sizeof(stream_json));
+    _hist_report(&read_hist, elapsed_s, read_json, sizeof(read_json));
+    _hist_report(&dns_hist, elapsed_s, dns_json, sizeof(dns_json));
+    printf("{\"mode\":\"%s\",\"devices\":%d,\"rate_hz\":%.2f,\"seconds\":%.1f,\"requests\":%u,"
+           "\"connects\":%u,\"bytes_read\":%llu,\"not_modified\":%u,%s,%s,%s,%s}\n",
+           mode_name, device_count, rate_hz, elapsed_s, stats.requests, stats.connects,
+           (unsigned long long)bytes_read, not_modified, write_json, stream_json, read_json,
+           dns_json);
+    fflush(stdout);
+
+    if (getenv("LOADGEN_TRACE") != NULL)
+        _loadgen_write_trace(getenv("LOADGEN_TRACE"));
+
+    exit(write_hist.ok + read_hist.ok + dns_hist.ok > 0 ? 0 : 1);
+}
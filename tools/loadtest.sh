@@ -0,0 +1,32 @@
+#!/bin/sh
+# Runs the load driver against the mock RTDB server and prints the statistics of both sides.
+#
+# Usage: tools/loadtest.sh [mock_rtdb.py fault options...]
+# LOADGEN_* variables are passed to the driver (see tools/loadgen/loadgen.c), e.g.
+#   LOADGEN_MODE=stream LOADGEN_DEVICES=500 tools/loadtest.sh --latency-ms 50 --drop-rate 0.01
+set -eu
+cd "$(dirname "$0")/.."
+
+PROGRAM=${LOADGEN_PROGRAM:-.pio/build/loadgen/program}
+[ -x "$PROGRAM" ] || pio run -e loadgen
+
+# The port matches FIREBASE_URL of the native environments
+python3 tools/mock_rtdb.py --port 8080 "$@" &
+mock=$!
+trap 'kill $mock 2>/dev/null || true' EXIT
+
+python3 - <<'PY'
+import socket, time
+for _ in range(50):
+    try:
+        socket.create_connection(("127.0.0.1", 8080), timeout=0.2).close()
+        break
+    except OSError:
+        time.sleep(0.1)
+PY
+
+status=0
+"$PROGRAM" || status=$?
+
+echo "mock: $(python3 -c 'import urllib.request; print(urllib.request.urlopen("http://127.0.0.1:8080/_mock/stats").read().decode())')"
+exit $status
@@ -0,0 +1,515 @@
+#!/usr/bin/env python3
+"""Local stand-in for the Firebase Realtime Database REST API.
+
+Serves PUT, PATCH, GET and DELETE on ``<path>.json`` from an in-memory tree and streams
+changes to ``Accept: text/event-stream`` clients with the same put/patch/keep-alive events
+as Firebase. Plain HTTP only, so it pairs with the host build (``pio run -e native``).
+
+Faults can be injected to exercise the client's error handling under load:
+
+* ``--latency-ms`` / ``--jitter-ms``: delay before every response
+* ``--drop-rate``: close the connection instead of answering
+* ``--error-rate`` / ``--error-burst`` / ``--error-status``: answer a run of requests with 5xx
+* ``--drip-rate`` / ``--drip-bytes`` / ``--drip-interval-ms``: send a response a few bytes
+  at a time
+* ``--stream-max-s``: close event streams after a random time up to this limit
+
+Requests with ``X-Firebase-ETag: true`` get the node's ETag, and ``if-match`` makes writes
+conditional (412 with the current value on mismatch), as in Firebase. Firebase ignores
+``If-None-Match`` on reads and always sends the full body, and so does the mock by default;
+``--not-modified`` answers a GET whose ``If-None-Match`` still matches with an empty 304
+instead. That is NOT Firebase behaviour; it only models a server or proxy that honours the
+header.
+
+Faults can also be changed while running with ``PUT /_mock/faults`` (JSON object with the
+option names in snake case, e.g. ``{"drop_rate": 0.1}``). ``GET /_mock/stats`` returns
+request counters and server-side latency percentiles, ``POST /_mock/reset`` clears the
+database and the counters. ``POST /_mock/stream_event`` with ``{"event": "cancel"}`` or
+``{"event": "auth_revoked"}`` sends that event to every open stream and closes it.
+``POST /_mock/close_connections`` closes every other client connection, as a server or NAT
+timing out idle keep-alive sessions would; ``connections_total`` in the stats counts the
+connections accepted, i.e. the handshakes clients paid for.
+"""
+
+import argparse
+import asyncio
+import base64
+import hashlib
+import json
+import random
+import signal
+import sys
+import time
+from urllib.parse import parse_qs, unquote
+
+MAX_HEADER_BYTES = 16 * 1024
+MAX_BODY_BYTES = 1024 * 1024
+MAX_LATENCY_SAMPLES = 1000000
+REASONS = {
+    200: "OK",
+    204: "No Content",
+    304: "Not Modified",
+    400: "Bad Request",
+    404: "Not Found",
+    405: "Method Not Allowed",
+    412: "Precondition Failed",
+    413: "Payload Too Large",
+    500: "Internal Server Error",
+    503: "Service Unavailable",
+}
+
+
+class Faults:
+    def __init__(self, args):
+        self.latency_ms = args.latency_ms
+        self.jitter_ms = args.jitter_ms
+        self.drop_rate = args.drop_rate
+        self.error_rate = args.error_rate
+        self.error_burst = args.error_burst
+        self.error_status = args.error_status
+        self.drip_rate = args.drip_rate
+        self.drip_bytes = args.drip_bytes
+        self.drip_interval_ms = args.drip_interval_ms
+        self.stream_max_s = args.stream_max_s
+        self.burst_left = 0
+
+    def update(self, values):
+        for key, value in values.items():
+            if key == "burst_left" or not hasattr(self, key):
+                raise ValueError("unknown fault '%s'" % key)
+            setattr(self, key, type(getattr(self, key))(value))
+
+    def as_dict(self):
+        return {k: v for k, v in vars(self).items() if k != "burst_left"}
+
+    def delay(self, rng):
+        return (self.latency_ms + rng.uniform(0, self.jitter_ms)) / 1000.0
+
+    def next_error(self, rng):
+        """Returns the status to fail this request with, or None."""
+        if self.burst_left == 0 and self.error_rate > 0 and rng.random() < self.error_rate:
+            self.burst_left = max(1, self.error_burst)
+        if self.burst_left > 0:
+            self.burst_left -= 1
+            return self.error_status
+        return None
+
+
+class Stats:
+    def __init__(self):
+        self.reset()
+
+    def reset(self):
+        self.counts = {}
+        self.latencies_ms = []
+        self.streams_open = 0
+        self.streams_total = 0
+        self.connections_total = 0
+        self.events_sent = 0
+        self.bytes_in = 0
+
+    def count(self, key):
+        self.counts[key] = self.counts.get(key, 0) + 1
+
+    def as_dict(self):
+        lat = sorted(self.latencies_ms)
+
+        def pct(p):
+            return round(lat[min(len(lat) - 1, int(p / 100.0 * len(lat)))], 3) if lat else None
+
+        return {
+            "counts": self.counts,
+            "streams_open": self.streams_open,
+            "streams_total": self.streams_total,
+            "connections_total": self.connections_total,
+            "events_sent": self.events_sent,
+            "bytes_in": self.bytes_in,
+            "latency_ms": {"p50": pct(50), "p90": pct(90), "p99": pct(99), "max": pct(100)},
+        }
+
+
+def etag_of(value):
+    if value is None:
+        return "null_etag"
+    canonical = json.dumps(value, sort_keys=True, separators=(",", ":")).encode()
+    return base64.b64encode(hashlib.sha1(canonical).digest()).decode()
+
+
+def split_path(path):
+    return [unquote(s) for s in path.split("/") if s]
+
+
+def is_prefix(prefix, path):
+    return path[: len(prefix)] == prefix
+
+
+class Database:
+    def __init__(self):
+        self.root = None
+
+    def get(self, segments):
+        node = self.root
+        for s in segments:
+            if not isinstance(node, dict) or s not in node:
+                return None
+            node = node[s]
+        return node
+
+    def set(self, segments, value):
+        if isinstance(value, dict):
+            value = prune(value)
+        if not segments:
+            self.root = value
+            return
+        if not isinstance(self.root, dict):
+            self.root = {}
+        node = self.root
+        for s in segments[:-1]:
+            if not isinstance(node.get(s), dict):
+                node[s] = {}
+            node = node[s]
+        if value is None:
+            node.pop(segments[-1], None)
+        else:
+            node[segments[-1]] = value
+        self.root = prune(self.root)
+
+
+def prune(value):
+    """Drops nulls and empty objects, which Firebase does not store."""
+    if not isinstance(value, dict):
+        return value
+    out = {}
+    for k, v in value.items():
+        v = prune(v)
+        if v is not None:
+            out[k] = v
+    return out or None
+
+
+class Stream:
+    def __init__(self, segments, writer):
+        self.segments = segments
+        self.queue = asyncio.Queue()
+        self.writer = writer
+
+
+class MockRtdb:
+    def __init__(self, args):
+        self.faults = Faults(args)
+        self.stats = Stats()
+        self.db = Database()
+        self.streams = set()
+        self.connections = set()
+        self.rng = random.Random(args.seed)
+        self.keepalive_s = args.keepalive_s
+        self.not_modified = args.not_modified
+        self.verbose = args.verbose
+
+    # --- change notification -------------------------------------------------------------
+
+    def _notify(self, writes, patch_base=None, patch_data=None):
+        """Queues events for a list of (segments, value) writes.
+
+        A patch is reported as one patch event to streams at or above its location and as
+        individual puts to streams below it, like Firebase does.
+        """
+        for stream in self.streams:
+            sp = stream.segments
+            if patch_base is not None and is_prefix(sp, patch_base):
+                rel = "/" + "/".join(patch_base[len(sp):])
+                stream.queue.put_nowait(("patch", {"path": rel, "data": patch_data}))
+                continue
+            for segments, value in writes:
+                if is_prefix(sp, segments):
+                    rel = "/" + "/".join(segments[len(sp):])
+                    stream.queue.put_nowait(("put", {"path": rel, "data": value}))
+                elif is_prefix(segments, sp):
+                    stream.queue.put_nowait(("put", {"path": "/", "data": self.db.get(sp)}))
+
+    # --- request handling ----------------------------------------------------------------
+
+    async def handle(self, reader, writer):
+        self.stats.connections_total += 1
+        self.connections.add(writer)
+        try:
+            while await self._handle_one(reader, writer):
+                pass
+        except (ConnectionError, asyncio.IncompleteReadError, asyncio.LimitOverrunError):
+            pass
+        except asyncio.CancelledError:
+            # Idle keep-alive connections are cancelled when the server shuts down
+            pass
+        finally:
+            self.connections.discard(writer)
+            writer.close()
+
+    async def _handle_one(self, reader, writer):
+        request_line = await reader.readline()
+        if not request_line:
+            return False
+        try:
+            method, target, version = request_line.decode("latin-1").split()
+        except ValueError:
+            await self._respond(writer, 400, {"error": "bad request line"}, keep_alive=False)
+            return False
+
+        headers = {}
+        size = 0
+        while True:
+            line = await reader.readline()
+            size += len(line)
+            if size > MAX_HEADER_BYTES:
+                return False
+            line = line.decode("latin-1").rstrip("\r\n")
+            if not line:
+                break
+            name, _, value = line.partition(":")
+            headers[name.strip().lower()] = value.strip()
+
+        length = int(headers.get("content-length", "0") or 0)
+        if length > MAX_BODY_BYTES:
+            await self._respond(writer, 413, {"error": "body too large"}, keep_alive=False)
+            return False
+        body = await reader.readexactly(length) if length else b""
+        self.stats.bytes_in += len(request_line) + size + length
+
+        keep_alive = version == "HTTP/1.1" and headers.get("connection", "").lower() != "close"
+        # Split by hand: urlsplit() would read "//a/b.json" as a host name
+        path, _, query_string = target.partition("?")
+        if path.startswith("/_mock/"):
+            return await self._control(writer, method, path, body, keep_alive)
+
+        started = time.monotonic()
+        self.stats.count(method)
+        faults = self.faults
+
+        if faults.drop_rate > 0 and self.rng.random() < faults.drop_rate:
+            self.stats.count("dropped")
+            return False
+
+        delay = faults.delay(self.rng)
+        if delay > 0:
+            await asyncio.sleep(delay)
+
+        status = faults.next_error(self.rng)
+        if status is not None:
+            self.stats.count("errors")
+            await self._respond(writer, status, {"error": "injected"}, keep_alive)
+            return keep_alive
+
+        if not path.endswith(".json"):
+            await self._respond(writer, 404, {"error": "path must end in .json"}, keep_alive)
+            return keep_alive
+        segments = split_path(path[: -len(".json")])
+        query = parse_qs(query_string)
+
+        if method == "GET" and "text/event-stream" in headers.get("accept", ""):
+            await self._stream(writer, segments)
+            return False
+
+        extra = {}
+        status, result = self._precondition(method, segments, headers, extra)
+        if status is None:
+            status, result = self._apply(method, segments, body, query)
+            if headers.get("x-firebase-etag") == "true" and status == 200:
+                extra["ETag"] = etag_of(self.db.get(segments))
+        if status == 304:
+            self.stats.count("not_modified")
+        drip = faults.drip_rate > 0 and self.rng.random() < faults.drip_rate
+        await self._respond(writer, status, result, keep_alive, drip=drip, headers=extra)
+        if len(self.stats.latencies_ms) < MAX_LATENCY_SAMPLES:
+            self.stats.latencies_ms.append((time.monotonic() - started) * 1000.0)
+        if self.verbose:
+            print("%s /%s -> %d" % (method, "/".join(segments), status), file=sys.stderr)
+        return keep_alive
+
+    def _precondition(self, method, segments, headers, extra):
+        """Answers conditional requests whose condition decides the outcome."""
+        if headers.get("x-firebase-etag") != "true":
+            return None, None
+        current = self.db.get(segments)
+        etag = etag_of(current)
+        if self.not_modified and method == "GET" and headers.get("if-none-match") == etag:
+            extra["ETag"] = etag
+            return 304, None
+        if method != "GET" and "if-match" in headers and headers["if-match"] != etag:
+            extra["ETag"] = etag
+            return 412, current
+        return None, None
+
+    def _apply(self, method, segments, body, query):
+        if method == "GET":
+            value = self.db.get(segments)
+            if query.get("shallow") == ["true"] and isinstance(value, dict):
+                value = {k: (True if isinstance(v, dict) else v) for k, v in value.items()}
+            return 200, value
+        if method == "DELETE":
+            self.db.set(segments, None)
+            self._notify([(segments, None)])
+            return 200, None
+
+        try:
+            value = json.loads(body or b"null")
+        except ValueError:
+            return 400, {"error": "Invalid data; couldn't parse JSON object."}
+
+        if method == "PUT":
+            self.db.set(segments, value)
+            self._notify([(segments, self.db.get(segments))])
+            return 200, value
+        if method == "PATCH":
+            if not isinstance(value, dict):
+                return 400, {"error": "Invalid data; PATCH needs an object."}
+            # Keys may be multi-segment paths (multi-location update)
+            writes = []
+            for key, child in value.items():
+                child_segments = segments + split_path(key)
+                self.db.set(child_segments, child)
+                writes.append((child_segments, self.db.get(child_segments)))
+            self._notify(writes, patch_base=segments, patch_data=value)
+            return 200, value
+        return 405, {"error": "method not allowed"}
+
+    async def _respond(self, writer, status, value, keep_alive, drip=False, headers=None):
+        lines = ["HTTP/1.1 %d %s" % (status, REASONS.get(status, "Error"))]
+        body = b""
+        if status != 304:
+            body = json.dumps(value, separators=(",", ":")).encode()
+            lines.append("Content-Type: application/json; charset=utf-8")
+            lines.append("Content-Length: %d" % len(body))
+        for name, header_value in (headers or {}).items():
+            lines.append("%s: %s" % (name, header_value))
+        lines.append("Connection: %s" % ("keep-alive" if keep_alive else "close"))
+        head = ("\r\n".join(lines) + "\r\n\r\n").encode()
+        await self._send(writer, head + body, drip)
+
+    async def _send(self, writer, data, drip):
+        if not drip:
+            writer.write(data)
+            await writer.drain()
+            return
+        self.stats.count("dripped")
+        step = max(1, self.faults.drip_bytes)
+        for i in range(0, len(data), step):
+            writer.write(data[i : i + step])
+            await writer.drain()
+            await asyncio.sleep(self.faults.drip_interval_ms / 1000.0)
+
+    def _event(self, name, data):
+        payload = json.dumps(data, separators=(",", ":"))
+        return ("event: %s\ndata: %s\n\n" % (name, payload)).encode()
+
+    async def _stream(self, writer, segments):
+        writer.write(
+            b"HTTP/1.1 200 OK\r\n"
+            b"Content-Type: text/event-stream\r\n"
+            b"Cache-Control: no-cache\r\n"
+            b"Connection: close\r\n\r\n"
+        )
+        stream = Stream(segments, writer)
+        stream.queue.put_nowait(("put", {"path": "/", "data": self.db.get(segments)}))
+        self.streams.add(stream)
+        self.stats.streams_open += 1
+        self.stats.streams_total += 1
+
+        deadline = None
+        if self.faults.stream_max_s > 0:
+            deadline = time.monotonic() + self.rng.uniform(0.1, 1.0) * self.faults.stream_max_s
+        try:
+            while True:
+                timeout = self.keepalive_s
+                if deadline is not None:
+                    timeout = min(timeout, deadline - time.monotonic())
+                    if timeout <= 0:
+                        self.stats.count("streams_cut")
+                        return
+                try:
+                    name, data = await asyncio.wait_for(stream.queue.get(), timeout)
+                except asyncio.TimeoutError:
+                    if deadline is not None and time.monotonic() >= deadline:
+                        continue
+                    name, data = "keep-alive", None
+                drip = self.faults.drip_rate > 0 and self.rng.random() < self.faults.drip_rate
+                await self._send(writer, self._event(name, data), drip)
+                self.stats.events_sent += 1
+                # Firebase ends the stream after these
+                if name in ("cancel", "auth_revoked"):
+                    return
+        finally:
+            self.streams.discard(stream)
+            self.stats.streams_open -= 1
+
+    async def _control(self, writer, method, path, body, keep_alive):
+        status, result = 200, None
+        try:
+            if path == "/_mock/faults" and method == "PUT":
+                self.faults.update(json.loads(body or b"{}"))
+                result = self.faults.as_dict()
+            elif path == "/_mock/faults":
+                result = self.faults.as_dict()
+            elif path == "/_mock/stats":
+                result = self.stats.as_dict()
+            elif path == "/_mock/stream_event" and method == "POST":
+                event = json.loads(body or b"{}")
+                name = event.get("event", "cancel")
+                default = "credential is no longer valid" if name == "auth_revoked" else None
+                data = event.get("data", default)
+                for stream in self.streams:
+                    stream.queue.put_nowait((name, data))
+                result = {"streams": len(self.streams)}
+            elif path == "/_mock/close_connections" and method == "POST":
+                others = [w for w in self.connections if w is not writer]
+                for other in others:
+                    other.close()
+                result = {"closed": len(others)}
+            elif path == "/_mock/reset" and method == "POST":
+                self.db = Database()
+                self.stats.reset()
+            else:
+                status, result = 404, {"error": "unknown control endpoint"}
+        except (ValueError, TypeError) as e:
+            status, result = 400, {"error": str(e)}
+        await self._respond(writer, status, result, keep_alive)
+        return keep_alive
+
+
+def parse_args(argv=None):
+    p = argparse.ArgumentParser(description=__doc__.split("\n\n")[0])
+    p.add_argument("--host", default="127.0.0.1")
+    p.add_argument("--port", type=int, default=8080)
+    p.add_argument("--seed", type=int, default=None, help="seed for the fault RNG")
+    p.add_argument("--keepalive-s", type=float, default=30.0, help="stream keep-alive period")
+    p.add_argument("--latency-ms", type=float, default=0.0)
+    p.add_argument("--jitter-ms", type=float, default=0.0, help="uniform extra delay")
+    p.add_argument("--drop-rate", type=float, default=0.0, help="probability of a drop")
+    p.add_argument("--error-rate", type=float, default=0.0, help="probability a burst starts")
+    p.add_argument("--error-burst", type=int, default=1, help="requests per error burst")
+    p.add_argument("--error-status", type=int, default=503)
+    p.add_argument("--drip-rate", type=float, default=0.0, help="probability of slow-drip")
+    p.add_argument("--drip-bytes", type=int, default=16)
+    p.add_argument("--drip-interval-ms", type=float, default=50.0)
+    p.add_argument("--stream-max-s", type=float, default=0.0, help="0 keeps streams open")
+    p.add_argument("--not-modified", action="store_true",
+                   help="answer a matching If-None-Match with 304 (Firebase never does)")
+    p.add_argument("--verbose", action="store_true", help="log every request")
+    return p.parse_args(argv)
+
+
+async def main(argv=None):
+    args = parse_args(argv)
+    mock = MockRtdb(args)
+    server = await asyncio.start_server(mock.handle, args.host, args.port, backlog=1024)
+    print("mock_rtdb listening on http://%s:%d/" % (args.host, args.port), file=sys.stderr)
+
+    stop = asyncio.Event()
+    loop = asyncio.get_running_loop()
+    for sig in (signal.SIGINT, signal.SIGTERM):
+        loop.add_signal_handler(sig, stop.set)
+    async with server:
+        await stop.wait()
+    print(json.dumps(mock.stats.as_dict()), file=sys.stderr)
+
+
+if __name__ == "__main__":
+    asyncio.run(main())
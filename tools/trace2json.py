@@ -0,0 +1,103 @@
+#!/usr/bin/env python3
+"""Converts a binary trace dump (see include/trace.h) to Chrome trace event JSON.
+
+The dump comes from ``GET /trace.bin`` on the device or the host build, or from the load
+driver's ``LOADGEN_TRACE`` file. Open the output in ``chrome://tracing`` or
+https://ui.perfetto.dev. Each core becomes a process and each task a thread; timestamps are
+microseconds since boot.
+
+Records hold only the low 32 bits of the cycle counter. They are placed on the timeline by
+walking back from an anchor pair (cycle count and ``esp_timer`` time) taken on the same core
+at dump time, so a gap longer than one counter wrap (about 18 s at 240 MHz) between two
+records shortens the trace before it.
+"""
+
+import argparse
+import json
+import struct
+import sys
+
+HEADER = struct.Struct("<4sHHIHH")
+CORE = struct.Struct("<IqI")
+RECORD = struct.Struct("<IIHBBI")
+PHASES = {0: "i", 1: "B", 2: "E"}
+
+
+def parse(data):
+    magic, version, record_size, ticks_per_us, cores, event_count = HEADER.unpack_from(data)
+    if magic != b"TRC1" or version != 1 or record_size != RECORD.size:
+        raise ValueError("not a version 1 trace dump")
+    pos = HEADER.size
+
+    names = []
+    for _ in range(event_count):
+        length = data[pos]
+        names.append(data[pos + 1 : pos + 1 + length].decode())
+        pos += 1 + length
+
+    rings = []
+    for _ in range(cores):
+        anchor_cycles, anchor_us, count = CORE.unpack_from(data, pos)
+        pos += CORE.size
+        records = [RECORD.unpack_from(data, pos + i * RECORD.size) for i in range(count)]
+        pos += count * RECORD.size
+        rings.append((anchor_cycles, anchor_us, records))
+    return ticks_per_us, names, rings
+
+
+def unwrap(anchor_cycles, records):
+    """Returns cycle offsets of the records relative to the anchor (negative = earlier)."""
+    offsets = [0] * len(records)
+    later_cycles, later_offset = anchor_cycles, 0
+    for i in range(len(records) - 1, -1, -1):
+        delta = (later_cycles - records[i][0]) & 0xFFFFFFFF
+        # Tasks on one core can store their records slightly out of order
+        if delta >= 1 << 31:
+            delta -= 1 << 32
+        offsets[i] = later_offset - delta
+        later_cycles, later_offset = records[i][0], offsets[i]
+    return offsets
+
+
+def convert(data):
+    ticks_per_us, names, rings = parse(data)
+    events = []
+    for core, (anchor_cycles, anchor_us, records) in enumerate(rings):
+        events.append(
+            {"name": "process_name", "ph": "M", "pid": core, "args": {"name": f"core {core}"}}
+        )
+        for record, offset in zip(records, unwrap(anchor_cycles, records)):
+            _, arg, event, phase, _, task = record
+            name = names[event] if event < len(names) else f"event_{event}"
+            entry = {
+                "name": name,
+                "ph": PHASES.get(phase, "i"),
+                "ts": anchor_us + offset / ticks_per_us,
+                "pid": core,
+                "tid": task,
+                "args": {"arg": arg},
+            }
+            if entry["ph"] == "i":
+                entry["s"] = "t"
+            events.append(entry)
+    return {"traceEvents": events, "displayTimeUnit": "ns"}
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("input", help="binary trace dump")
+    parser.add_argument("-o", "--output", help="JSON file to write (default: stdout)")
+    args = parser.parse_args()
+
+    with open(args.input, "rb") as f:
+        trace = convert(f.read())
+
+    out = open(args.output, "w") if args.output else sys.stdout
+    json.dump(trace, out)
+    if args.output:
+        out.close()
+        print(f"{len(trace['traceEvents'])} events written to {args.output}", file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()